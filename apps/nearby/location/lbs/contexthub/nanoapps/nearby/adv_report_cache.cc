@@ -25,6 +25,21 @@
 
 namespace nearby {
 
+namespace {
+
+// Returns the FNV-1a hash of the advertiser address of report.
+uint32_t HashAddress(const chreBleAdvertisingReport &report) {
+  constexpr uint32_t kFnvOffsetBasis = 2166136261u;
+  constexpr uint32_t kFnvPrime = 16777619u;
+  uint32_t hash = (kFnvOffsetBasis ^ report.addressType) * kFnvPrime;
+  for (size_t i = 0; i < CHRE_BLE_ADDRESS_LEN; i++) {
+    hash = (hash ^ report.address[i]) * kFnvPrime;
+  }
+  return hash;
+}
+
+}  // namespace
+
 void AdvReportCache::Clear() {
   // Release all resources.
   for (const auto &report : cache_reports_) {
@@ -34,31 +49,59 @@ void AdvReportCache::Clear() {
     chreHeapFree(const_cast<uint8_t *>(report.data));
   }
   cache_reports_.clear();
+  nodes_.clear();
+  for (uint16_t &bucket : buckets_) {
+    bucket = kNoIndex;
+  }
+  ResetWheel();
+}
+
+void AdvReportCache::SetCacheTimeout(uint64_t cache_expire_millisec) {
+  cache_expire_nanosec_ =
+      cache_expire_millisec * chre::kOneMillisecondInNanoseconds;
+  wheel_slot_nanosec_ = cache_expire_nanosec_ / kWheelSlotsPerTimeout;
+  if (wheel_slot_nanosec_ == 0) {
+    wheel_slot_nanosec_ = 1;
+  }
+  ResetWheel();
 }
 
 void AdvReportCache::Refresh() {
-  if (cache_expire_nanosec_ == kMaxExpireTimeNanoSec) {
+  if (!HasWheel() || cache_reports_.empty()) {
     return;
   }
 
   uint64_t current_time = chreGetTime();
-  size_t index = 0;
-  while (index < cache_reports_.size()) {
-    if (current_time - cache_reports_[index].timestamp >
-        cache_expire_nanosec_) {
-      // TODO(b/285043291): Refactor cache element by wrapper struct/class
-      // which deallocates data in its destructor.
-      chreHeapFree(const_cast<uint8_t *>(cache_reports_[index].data));
-      // The index does not need to increase because the current element is
-      // replaced by the end of the element and the list is resized.
-      cache_reports_.swap(index, cache_reports_.size() - 1);
-      cache_reports_.resize(cache_reports_.size() - 1);
-    } else {
-      ++index;
+  if (current_time < cache_expire_nanosec_) {
+    return;
+  }
+  // Slots before last_slot only hold expired reports, last_slot may hold both.
+  uint64_t last_slot = GetWheelSlot(current_time - cache_expire_nanosec_);
+  if (next_expire_slot_ > last_slot) {
+    return;
+  }
+  uint64_t slot_count = last_slot - next_expire_slot_ + 1;
+  if (slot_count > kNumWheelSlots) {
+    slot_count = kNumWheelSlots;
+  }
+  for (uint64_t slot = last_slot + 1 - slot_count; slot <= last_slot; slot++) {
+    uint16_t index = wheel_[slot % kNumWheelSlots];
+    while (index != kNoIndex) {
+      uint16_t next = nodes_[index].wheel_next;
+      if (current_time - cache_reports_[index].timestamp >
+          cache_expire_nanosec_) {
+        // RemoveAt() moves the last report to index, which may be next.
+        uint16_t last = static_cast<uint16_t>(cache_reports_.size() - 1);
+        RemoveAt(index);
+        if (next == last) {
+          next = index;
+        }
+      }
+      index = next;
     }
   }
+  next_expire_slot_ = last_slot;
 }
-
 void AdvReportCache::RefreshIfNeeded() {
   if (cache_reports_.size() > kRefreshCacheCountThreshold) {
     Refresh();
@@ -69,29 +112,31 @@ void AdvReportCache::Push(const chreBleAdvertisingReport &event_report) {
 #ifdef NEARBY_PROFILE
   ashProfileBegin(&profile_data_);
 #endif
-  bool is_duplicate = false;
-  for (auto &cache_report : cache_reports_) {
-    if (cache_report.addressType == event_report.addressType &&
-        memcmp(cache_report.address, event_report.address,
-               CHRE_BLE_ADDRESS_LEN) == 0 &&
-        cache_report.dataLength == event_report.dataLength &&
-        memcmp(cache_report.data, event_report.data, cache_report.dataLength) ==
-            0) {
-      // Updates RSSI by max value in the duplicated report.
-      if (cache_report.rssi == CHRE_BLE_RSSI_NONE ||
-          (event_report.rssi != CHRE_BLE_RSSI_NONE &&
-           event_report.rssi > cache_report.rssi)) {
-        cache_report.rssi = event_report.rssi;
-      }
-      // Updates timestamp to latest in the duplicated report.
-      if (event_report.timestamp > cache_report.timestamp) {
+  uint32_t hash = HashAddress(event_report);
+  uint16_t index = Find(event_report, hash);
+  if (index != kNoIndex) {
+    chreBleAdvertisingReport &cache_report = cache_reports_[index];
+    // Updates RSSI by max value in the duplicated report.
+    if (cache_report.rssi == CHRE_BLE_RSSI_NONE ||
+        (event_report.rssi != CHRE_BLE_RSSI_NONE &&
+         event_report.rssi > cache_report.rssi)) {
+      cache_report.rssi = event_report.rssi;
+    }
+    // Updates timestamp to latest in the duplicated report.
+    if (event_report.timestamp > cache_report.timestamp) {
+      if (HasWheel()) {
+        UnlinkWheel(index);
+        cache_report.timestamp = event_report.timestamp;
+        LinkWheel(index);
+      } else {
         cache_report.timestamp = event_report.timestamp;
       }
-      is_duplicate = true;
-      break;
     }
-  }
-  if (!is_duplicate) {
+    LOGD("Duplicated report in advertising reports cache");
+  } else if (cache_reports_.size() >= kNoIndex) {
+    LOGE("Advertising reports cache is full!");
+    Refresh();
+  } else {
     LOGD("Adds to advertising reports cache");
     // Copies advertise report by value.
     chreBleAdvertisingReport new_report = event_report;
@@ -110,18 +155,177 @@ void AdvReportCache::Push(const chreBleAdvertisingReport &event_report) {
       memcpy(data, event_report.data, dataLength);
       new_report.data = data;
     }
-    if (!cache_reports_.push_back(std::move(new_report))) {
+    Node node = {hash, kNoIndex, kNoIndex, kNoIndex, kNoIndex};
+    if (!nodes_.push_back(node)) {
+      LOGE("Pushes advertise report failed!");
+      chreHeapFree(data);
+    } else if (!cache_reports_.push_back(std::move(new_report))) {
       LOGE("Pushes advertise report failed!");
-      if (data != nullptr) {
-        chreHeapFree(const_cast<uint8_t *>(data));
+      nodes_.pop_back();
+      chreHeapFree(data);
+    } else {
+      index = static_cast<uint16_t>(cache_reports_.size() - 1);
+      // Rehash() links every report, including the new one.
+      bool linked = buckets_.size() < cache_reports_.size() &&
+                    Rehash(buckets_.empty() ? kMinBucketCount
+                                            : 2 * buckets_.size());
+      if (!linked && !buckets_.empty()) {
+        LinkBucket(index);
+        linked = true;
+      }
+      if (!linked) {
+        LOGE("Pushes advertise report failed!");
+        nodes_.pop_back();
+        cache_reports_.pop_back();
+        chreHeapFree(data);
+      } else if (HasWheel()) {
+        LinkWheel(index);
       }
     }
-  } else {
-    LOGD("Duplicated report in advertising reports cache");
   }
 #ifdef NEARBY_PROFILE
   ashProfileEnd(&profile_data_, nullptr /* output */);
 #endif
 }
 
+uint16_t AdvReportCache::Find(const chreBleAdvertisingReport &report,
+                              uint32_t hash) const {
+  if (buckets_.empty()) {
+    return kNoIndex;
+  }
+  uint16_t index = buckets_[hash & (buckets_.size() - 1)];
+  while (index != kNoIndex) {
+    const chreBleAdvertisingReport &cache_report = cache_reports_[index];
+    if (nodes_[index].hash == hash &&
+        cache_report.addressType == report.addressType &&
+        memcmp(cache_report.address, report.address, CHRE_BLE_ADDRESS_LEN) ==
+            0 &&
+        cache_report.dataLength == report.dataLength &&
+        memcmp(cache_report.data, report.data, cache_report.dataLength) == 0) {
+      return index;
+    }
+    index = nodes_[index].bucket_next;
+  }
+  return kNoIndex;
+}
+
+void AdvReportCache::RemoveAt(uint16_t index) {
+  // TODO(b/285043291): Refactor cache element by wrapper struct/class
+  // which deallocates data in its destructor.
+  chreHeapFree(const_cast<uint8_t *>(cache_reports_[index].data));
+  UnlinkBucket(index);
+  if (HasWheel()) {
+    UnlinkWheel(index);
+  }
+
+  size_t last = cache_reports_.size() - 1;
+  if (index != last) {
+    // Moves the last report to index and points its list neighbors at it.
+    cache_reports_.swap(index, last);
+    Node &node = nodes_[index];
+    node = nodes_[last];
+    if (node.bucket_prev == kNoIndex) {
+      buckets_[node.hash & (buckets_.size() - 1)] = index;
+    } else {
+      nodes_[node.bucket_prev].bucket_next = index;
+    }
+    if (node.bucket_next != kNoIndex) {
+      nodes_[node.bucket_next].bucket_prev = index;
+    }
+    if (HasWheel()) {
+      if (node.wheel_prev == kNoIndex) {
+        wheel_[GetWheelSlot(cache_reports_[index].timestamp) %
+               kNumWheelSlots] = index;
+      } else {
+        nodes_[node.wheel_prev].wheel_next = index;
+      }
+      if (node.wheel_next != kNoIndex) {
+        nodes_[node.wheel_next].wheel_prev = index;
+      }
+    }
+  }
+  cache_reports_.pop_back();
+  nodes_.pop_back();
+}
+
+bool AdvReportCache::Rehash(size_t bucket_count) {
+  chre::DynamicVector<uint16_t> buckets;
+  if (!buckets.resize(bucket_count)) {
+    LOGW("Failed to grow advertising reports cache buckets to %zu",
+         bucket_count);
+    return false;
+  }
+  buckets_ = std::move(buckets);
+  for (uint16_t &bucket : buckets_) {
+    bucket = kNoIndex;
+  }
+  for (size_t i = 0; i < nodes_.size(); i++) {
+    LinkBucket(static_cast<uint16_t>(i));
+  }
+  return true;
+}
+
+void AdvReportCache::LinkBucket(uint16_t index) {
+  Node &node = nodes_[index];
+  uint16_t &head = buckets_[node.hash & (buckets_.size() - 1)];
+  node.bucket_prev = kNoIndex;
+  node.bucket_next = head;
+  if (head != kNoIndex) {
+    nodes_[head].bucket_prev = index;
+  }
+  head = index;
+}
+
+void AdvReportCache::UnlinkBucket(uint16_t index) {
+  const Node &node = nodes_[index];
+  if (node.bucket_prev == kNoIndex) {
+    buckets_[node.hash & (buckets_.size() - 1)] = node.bucket_next;
+  } else {
+    nodes_[node.bucket_prev].bucket_next = node.bucket_next;
+  }
+  if (node.bucket_next != kNoIndex) {
+    nodes_[node.bucket_next].bucket_prev = node.bucket_prev;
+  }
+}
+
+void AdvReportCache::LinkWheel(uint16_t index) {
+  uint64_t slot = GetWheelSlot(cache_reports_[index].timestamp);
+  Node &node = nodes_[index];
+  uint16_t &head = wheel_[slot % kNumWheelSlots];
+  node.wheel_prev = kNoIndex;
+  node.wheel_next = head;
+  if (head != kNoIndex) {
+    nodes_[head].wheel_prev = index;
+  }
+  head = index;
+  if (slot < next_expire_slot_) {
+    next_expire_slot_ = slot;
+  }
+}
+
+void AdvReportCache::UnlinkWheel(uint16_t index) {
+  const Node &node = nodes_[index];
+  if (node.wheel_prev == kNoIndex) {
+    wheel_[GetWheelSlot(cache_reports_[index].timestamp) % kNumWheelSlots] =
+        node.wheel_next;
+  } else {
+    nodes_[node.wheel_prev].wheel_next = node.wheel_next;
+  }
+  if (node.wheel_next != kNoIndex) {
+    nodes_[node.wheel_next].wheel_prev = node.wheel_prev;
+  }
+}
+
+void AdvReportCache::ResetWheel() {
+  for (uint16_t &head : wheel_) {
+    head = kNoIndex;
+  }
+  next_expire_slot_ = std::numeric_limits<uint64_t>::max();
+  if (HasWheel()) {
+    for (size_t i = 0; i < nodes_.size(); i++) {
+      LinkWheel(static_cast<uint16_t>(i));
+    }
+  }
+}
+
 }  // namespace nearby
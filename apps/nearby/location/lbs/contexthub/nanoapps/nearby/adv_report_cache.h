@@ -22,9 +22,12 @@
 #include <ash/profile.h>
 #endif
 
+#include <cstdint>
+#include <cstring>
 #include <limits>
 #include <utility>
 
+#include "chre_api/chre.h"
 #include "third_party/contexthub/chre/util/include/chre/util/dynamic_vector.h"
 
 namespace nearby {
@@ -37,9 +40,12 @@ class AdvReportCache {
     ashProfileInit(
         &profile_data_, "[NEARBY_ADV_CACHE_PERF]", 1000 /* print_interval_ms */,
         false /* report_total_thread_cycles */, true /* printCsvFormat */);
+    ResetWheel();
   }
 #else
-  AdvReportCache() = default;
+  AdvReportCache() {
+    ResetWheel();
+  }
 #endif
 
   // Deconstructs advertise report cache and releases all resources.
@@ -54,7 +60,13 @@ class AdvReportCache {
     }
     Clear();
     cache_reports_ = std::move(other.cache_reports_);
+    nodes_ = std::move(other.nodes_);
+    buckets_ = std::move(other.buckets_);
     cache_expire_nanosec_ = other.cache_expire_nanosec_;
+    wheel_slot_nanosec_ = other.wheel_slot_nanosec_;
+    memcpy(wheel_, other.wheel_, sizeof(wheel_));
+    next_expire_slot_ = other.next_expire_slot_;
+    other.ResetWheel();
     return *this;
   }
 
@@ -81,10 +93,7 @@ class AdvReportCache {
   }
 
   // Sets current cache timeout value.
-  void SetCacheTimeout(uint64_t cache_expire_millisec) {
-    cache_expire_nanosec_ =
-        cache_expire_millisec * chre::kOneMillisecondInNanoseconds;
-  }
+  void SetCacheTimeout(uint64_t cache_expire_millisec);
 
   // Removes cached elements older than the cache timeout.
   void Refresh();
@@ -107,9 +116,67 @@ class AdvReportCache {
   // cache elements exired.
   static constexpr size_t kRefreshCacheCountThreshold = 8;
 
+  // Marks the end of a list of cache indices.
+  static constexpr uint16_t kNoIndex = std::numeric_limits<uint16_t>::max();
+
+  // Initial number of address hash buckets, a power of two. The count doubles
+  // when the cache holds more reports than buckets.
+  static constexpr size_t kMinBucketCount = 16;
+
+  // The expiry wheel spreads the cache timeout over kWheelSlotsPerTimeout
+  // slots, and holds twice as many so that unexpired reports do not wrap.
+  static constexpr size_t kWheelSlotsPerTimeout = 8;
+  static constexpr size_t kNumWheelSlots = 2 * kWheelSlotsPerTimeout;
+
+  // Links of the report at the same index in cache_reports_. Each report is in
+  // the doubly linked list of its address hash bucket and, when the cache
+  // expires, in the list of the wheel slot its timestamp falls in.
+  struct Node {
+    uint32_t hash;
+    uint16_t bucket_prev;
+    uint16_t bucket_next;
+    uint16_t wheel_prev;
+    uint16_t wheel_next;
+  };
+
+  // Returns the index of the cached report with the key of report, or
+  // kNoIndex if there is none.
+  uint16_t Find(const chreBleAdvertisingReport &report, uint32_t hash) const;
+
+  // Removes the report at index, moving the last report in its place.
+  void RemoveAt(uint16_t index);
+
+  // Rebuilds the address hash buckets with bucket_count buckets. Returns false
+  // and keeps the current buckets if they cannot be allocated.
+  bool Rehash(size_t bucket_count);
+
+  void LinkBucket(uint16_t index);
+  void UnlinkBucket(uint16_t index);
+  void LinkWheel(uint16_t index);
+  void UnlinkWheel(uint16_t index);
+
+  // Empties the expiry wheel and relinks every cached report.
+  void ResetWheel();
+
+  bool HasWheel() const {
+    return cache_expire_nanosec_ != kMaxExpireTimeNanoSec;
+  }
+
+  uint64_t GetWheelSlot(uint64_t timestamp) const {
+    return timestamp / wheel_slot_nanosec_;
+  }
+
   chre::DynamicVector<chreBleAdvertisingReport> cache_reports_;
+  chre::DynamicVector<Node> nodes_;
+  // Heads of the address hash bucket lists.
+  chre::DynamicVector<uint16_t> buckets_;
   // Current cache timeout value.
   uint64_t cache_expire_nanosec_ = kMaxExpireTimeNanoSec;
+  uint64_t wheel_slot_nanosec_ = 1;
+  // Heads of the wheel slot lists, indexed by slot modulo kNumWheelSlots.
+  uint16_t wheel_[kNumWheelSlots];
+  // Oldest wheel slot which may hold reports, all older ones are empty.
+  uint64_t next_expire_slot_ = std::numeric_limits<uint64_t>::max();
 #ifdef NEARBY_PROFILE
   ashProfileData profile_data_;
 #endif
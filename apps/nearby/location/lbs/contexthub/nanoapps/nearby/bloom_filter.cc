@@ -49,10 +49,12 @@ size_t BloomFilter::Init(const uint8_t filter[], size_t size) {
 bool BloomFilter::MayContain(const uint8_t key[], size_t size) {
   uint32_t hash[SHA2_HASH_WORDS];
   sha256(key, static_cast<uint32_t>(size), hash, sizeof(hash));
+  return MayContainDigest(hash);
+}
 
+bool BloomFilter::MayContainDigest(const uint32_t hash[SHA2_HASH_WORDS]) const {
   for (size_t i = 0; i < SHA2_HASH_WORDS; i++) {
-    hash[i] = BSWAP32(hash[i]);
-    uint32_t bitPos = hash[i] % (filter_bit_size_);
+    uint32_t bitPos = BSWAP32(hash[i]) % (filter_bit_size_);
     if (!(filter_[bitPos / 8] & (1 << (bitPos % 8)))) {
       return false;
     }
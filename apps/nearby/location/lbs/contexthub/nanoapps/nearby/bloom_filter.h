@@ -22,6 +22,8 @@
 
 #include <cstddef>
 
+#include "location/lbs/contexthub/nanoapps/nearby/crypto/sha2.h"
+
 namespace nearby {
 
 // Bloom filter to test if an account key is included.
@@ -37,6 +39,10 @@ class BloomFilter {
   // Returns true if the key is set in the Bloom filter.
   bool MayContain(const uint8_t key[], size_t size);
 
+  // Returns true if the key whose SHA-256 digest is hash is set in the Bloom
+  // filter.
+  bool MayContainDigest(const uint32_t hash[SHA2_HASH_WORDS]) const;
+
  private:
   uint8_t filter_[kMaxBloomFilterByteSize] = {0};
   size_t filter_bit_size_;
@@ -17,13 +17,21 @@
 #include "location/lbs/contexthub/nanoapps/nearby/crypto/aes.h"
 
 #include <stdalign.h>
-#include <stdbool.h>
 #include <string.h>
 
+// AES-NI is used when the compiler targets it, unless AES_DISABLE_HW is set.
+#if defined(__AES__) && defined(__SSE2__) && !defined(AES_DISABLE_HW)
+#define AES_USE_AESNI
+#include <wmmintrin.h>
+#endif
+
 #define AES_128_KEY_NUM_ROUNDS 10
 #define AES_192_KEY_NUM_ROUNDS 12
 #define AES_256_KEY_NUM_ROUNDS 14
 
+// Number of AES/CTR key stream blocks generated at once.
+#define AES_CTR_PARALLEL_BLOCKS 4
+
 #define IS_ALIGNED(ptr, type) (((uintptr_t)(ptr) & (alignof(type) - 1)) == 0)
 static const uint8_t FwdSbox[] = {
     0x63, 0x7C, 0x77, 0x7B, 0xF2, 0x6B, 0x6F, 0xC5, 0x30, 0x01, 0x67, 0x2B,
@@ -96,6 +104,148 @@ static const uint32_t FwdTab0[] = {
     0x7BB0B0CB, 0xA85454FC, 0x6DBBBBD6, 0x2C16163A,
 };
 
+#ifdef AES_FULL_TABLES
+// FwdTab0 rotated right by 8, 16 and 24 bits, trading 3KB of tables for the
+// rotations in each round.
+static const uint32_t FwdTab1[] = {
+    0xA5C66363, 0x84F87C7C, 0x99EE7777, 0x8DF67B7B, 0x0DFFF2F2, 0xBDD66B6B,
+    0xB1DE6F6F, 0x5491C5C5, 0x50603030, 0x03020101, 0xA9CE6767, 0x7D562B2B,
+    0x19E7FEFE, 0x62B5D7D7, 0xE64DABAB, 0x9AEC7676, 0x458FCACA, 0x9D1F8282,
+    0x4089C9C9, 0x87FA7D7D, 0x15EFFAFA, 0xEBB25959, 0xC98E4747, 0x0BFBF0F0,
+    0xEC41ADAD, 0x67B3D4D4, 0xFD5FA2A2, 0xEA45AFAF, 0xBF239C9C, 0xF753A4A4,
+    0x96E47272, 0x5B9BC0C0, 0xC275B7B7, 0x1CE1FDFD, 0xAE3D9393, 0x6A4C2626,
+    0x5A6C3636, 0x417E3F3F, 0x02F5F7F7, 0x4F83CCCC, 0x5C683434, 0xF451A5A5,
+    0x34D1E5E5, 0x08F9F1F1, 0x93E27171, 0x73ABD8D8, 0x53623131, 0x3F2A1515,
+    0x0C080404, 0x5295C7C7, 0x65462323, 0x5E9DC3C3, 0x28301818, 0xA1379696,
+    0x0F0A0505, 0xB52F9A9A, 0x090E0707, 0x36241212, 0x9B1B8080, 0x3DDFE2E2,
+    0x26CDEBEB, 0x694E2727, 0xCD7FB2B2, 0x9FEA7575, 0x1B120909, 0x9E1D8383,
+    0x74582C2C, 0x2E341A1A, 0x2D361B1B, 0xB2DC6E6E, 0xEEB45A5A, 0xFB5BA0A0,
+    0xF6A45252, 0x4D763B3B, 0x61B7D6D6, 0xCE7DB3B3, 0x7B522929, 0x3EDDE3E3,
+    0x715E2F2F, 0x97138484, 0xF5A65353, 0x68B9D1D1, 0x00000000, 0x2CC1EDED,
+    0x60402020, 0x1FE3FCFC, 0xC879B1B1, 0xEDB65B5B, 0xBED46A6A, 0x468DCBCB,
+    0xD967BEBE, 0x4B723939, 0xDE944A4A, 0xD4984C4C, 0xE8B05858, 0x4A85CFCF,
+    0x6BBBD0D0, 0x2AC5EFEF, 0xE54FAAAA, 0x16EDFBFB, 0xC5864343, 0xD79A4D4D,
+    0x55663333, 0x94118585, 0xCF8A4545, 0x10E9F9F9, 0x06040202, 0x81FE7F7F,
+    0xF0A05050, 0x44783C3C, 0xBA259F9F, 0xE34BA8A8, 0xF3A25151, 0xFE5DA3A3,
+    0xC0804040, 0x8A058F8F, 0xAD3F9292, 0xBC219D9D, 0x48703838, 0x04F1F5F5,
+    0xDF63BCBC, 0xC177B6B6, 0x75AFDADA, 0x63422121, 0x30201010, 0x1AE5FFFF,
+    0x0EFDF3F3, 0x6DBFD2D2, 0x4C81CDCD, 0x14180C0C, 0x35261313, 0x2FC3ECEC,
+    0xE1BE5F5F, 0xA2359797, 0xCC884444, 0x392E1717, 0x5793C4C4, 0xF255A7A7,
+    0x82FC7E7E, 0x477A3D3D, 0xACC86464, 0xE7BA5D5D, 0x2B321919, 0x95E67373,
+    0xA0C06060, 0x98198181, 0xD19E4F4F, 0x7FA3DCDC, 0x66442222, 0x7E542A2A,
+    0xAB3B9090, 0x830B8888, 0xCA8C4646, 0x29C7EEEE, 0xD36BB8B8, 0x3C281414,
+    0x79A7DEDE, 0xE2BC5E5E, 0x1D160B0B, 0x76ADDBDB, 0x3BDBE0E0, 0x56643232,
+    0x4E743A3A, 0x1E140A0A, 0xDB924949, 0x0A0C0606, 0x6C482424, 0xE4B85C5C,
+    0x5D9FC2C2, 0x6EBDD3D3, 0xEF43ACAC, 0xA6C46262, 0xA8399191, 0xA4319595,
+    0x37D3E4E4, 0x8BF27979, 0x32D5E7E7, 0x438BC8C8, 0x596E3737, 0xB7DA6D6D,
+    0x8C018D8D, 0x64B1D5D5, 0xD29C4E4E, 0xE049A9A9, 0xB4D86C6C, 0xFAAC5656,
+    0x07F3F4F4, 0x25CFEAEA, 0xAFCA6565, 0x8EF47A7A, 0xE947AEAE, 0x18100808,
+    0xD56FBABA, 0x88F07878, 0x6F4A2525, 0x725C2E2E, 0x24381C1C, 0xF157A6A6,
+    0xC773B4B4, 0x5197C6C6, 0x23CBE8E8, 0x7CA1DDDD, 0x9CE87474, 0x213E1F1F,
+    0xDD964B4B, 0xDC61BDBD, 0x860D8B8B, 0x850F8A8A, 0x90E07070, 0x427C3E3E,
+    0xC471B5B5, 0xAACC6666, 0xD8904848, 0x05060303, 0x01F7F6F6, 0x121C0E0E,
+    0xA3C26161, 0x5F6A3535, 0xF9AE5757, 0xD069B9B9, 0x91178686, 0x5899C1C1,
+    0x273A1D1D, 0xB9279E9E, 0x38D9E1E1, 0x13EBF8F8, 0xB32B9898, 0x33221111,
+    0xBBD26969, 0x70A9D9D9, 0x89078E8E, 0xA7339494, 0xB62D9B9B, 0x223C1E1E,
+    0x92158787, 0x20C9E9E9, 0x4987CECE, 0xFFAA5555, 0x78502828, 0x7AA5DFDF,
+    0x8F038C8C, 0xF859A1A1, 0x80098989, 0x171A0D0D, 0xDA65BFBF, 0x31D7E6E6,
+    0xC6844242, 0xB8D06868, 0xC3824141, 0xB0299999, 0x775A2D2D, 0x111E0F0F,
+    0xCB7BB0B0, 0xFCA85454, 0xD66DBBBB, 0x3A2C1616,
+};
+
+static const uint32_t FwdTab2[] = {
+    0x63A5C663, 0x7C84F87C, 0x7799EE77, 0x7B8DF67B, 0xF20DFFF2, 0x6BBDD66B,
+    0x6FB1DE6F, 0xC55491C5, 0x30506030, 0x01030201, 0x67A9CE67, 0x2B7D562B,
+    0xFE19E7FE, 0xD762B5D7, 0xABE64DAB, 0x769AEC76, 0xCA458FCA, 0x829D1F82,
+    0xC94089C9, 0x7D87FA7D, 0xFA15EFFA, 0x59EBB259, 0x47C98E47, 0xF00BFBF0,
+    0xADEC41AD, 0xD467B3D4, 0xA2FD5FA2, 0xAFEA45AF, 0x9CBF239C, 0xA4F753A4,
+    0x7296E472, 0xC05B9BC0, 0xB7C275B7, 0xFD1CE1FD, 0x93AE3D93, 0x266A4C26,
+    0x365A6C36, 0x3F417E3F, 0xF702F5F7, 0xCC4F83CC, 0x345C6834, 0xA5F451A5,
+    0xE534D1E5, 0xF108F9F1, 0x7193E271, 0xD873ABD8, 0x31536231, 0x153F2A15,
+    0x040C0804, 0xC75295C7, 0x23654623, 0xC35E9DC3, 0x18283018, 0x96A13796,
+    0x050F0A05, 0x9AB52F9A, 0x07090E07, 0x12362412, 0x809B1B80, 0xE23DDFE2,
+    0xEB26CDEB, 0x27694E27, 0xB2CD7FB2, 0x759FEA75, 0x091B1209, 0x839E1D83,
+    0x2C74582C, 0x1A2E341A, 0x1B2D361B, 0x6EB2DC6E, 0x5AEEB45A, 0xA0FB5BA0,
+    0x52F6A452, 0x3B4D763B, 0xD661B7D6, 0xB3CE7DB3, 0x297B5229, 0xE33EDDE3,
+    0x2F715E2F, 0x84971384, 0x53F5A653, 0xD168B9D1, 0x00000000, 0xED2CC1ED,
+    0x20604020, 0xFC1FE3FC, 0xB1C879B1, 0x5BEDB65B, 0x6ABED46A, 0xCB468DCB,
+    0xBED967BE, 0x394B7239, 0x4ADE944A, 0x4CD4984C, 0x58E8B058, 0xCF4A85CF,
+    0xD06BBBD0, 0xEF2AC5EF, 0xAAE54FAA, 0xFB16EDFB, 0x43C58643, 0x4DD79A4D,
+    0x33556633, 0x85941185, 0x45CF8A45, 0xF910E9F9, 0x02060402, 0x7F81FE7F,
+    0x50F0A050, 0x3C44783C, 0x9FBA259F, 0xA8E34BA8, 0x51F3A251, 0xA3FE5DA3,
+    0x40C08040, 0x8F8A058F, 0x92AD3F92, 0x9DBC219D, 0x38487038, 0xF504F1F5,
+    0xBCDF63BC, 0xB6C177B6, 0xDA75AFDA, 0x21634221, 0x10302010, 0xFF1AE5FF,
+    0xF30EFDF3, 0xD26DBFD2, 0xCD4C81CD, 0x0C14180C, 0x13352613, 0xEC2FC3EC,
+    0x5FE1BE5F, 0x97A23597, 0x44CC8844, 0x17392E17, 0xC45793C4, 0xA7F255A7,
+    0x7E82FC7E, 0x3D477A3D, 0x64ACC864, 0x5DE7BA5D, 0x192B3219, 0x7395E673,
+    0x60A0C060, 0x81981981, 0x4FD19E4F, 0xDC7FA3DC, 0x22664422, 0x2A7E542A,
+    0x90AB3B90, 0x88830B88, 0x46CA8C46, 0xEE29C7EE, 0xB8D36BB8, 0x143C2814,
+    0xDE79A7DE, 0x5EE2BC5E, 0x0B1D160B, 0xDB76ADDB, 0xE03BDBE0, 0x32566432,
+    0x3A4E743A, 0x0A1E140A, 0x49DB9249, 0x060A0C06, 0x246C4824, 0x5CE4B85C,
+    0xC25D9FC2, 0xD36EBDD3, 0xACEF43AC, 0x62A6C462, 0x91A83991, 0x95A43195,
+    0xE437D3E4, 0x798BF279, 0xE732D5E7, 0xC8438BC8, 0x37596E37, 0x6DB7DA6D,
+    0x8D8C018D, 0xD564B1D5, 0x4ED29C4E, 0xA9E049A9, 0x6CB4D86C, 0x56FAAC56,
+    0xF407F3F4, 0xEA25CFEA, 0x65AFCA65, 0x7A8EF47A, 0xAEE947AE, 0x08181008,
+    0xBAD56FBA, 0x7888F078, 0x256F4A25, 0x2E725C2E, 0x1C24381C, 0xA6F157A6,
+    0xB4C773B4, 0xC65197C6, 0xE823CBE8, 0xDD7CA1DD, 0x749CE874, 0x1F213E1F,
+    0x4BDD964B, 0xBDDC61BD, 0x8B860D8B, 0x8A850F8A, 0x7090E070, 0x3E427C3E,
+    0xB5C471B5, 0x66AACC66, 0x48D89048, 0x03050603, 0xF601F7F6, 0x0E121C0E,
+    0x61A3C261, 0x355F6A35, 0x57F9AE57, 0xB9D069B9, 0x86911786, 0xC15899C1,
+    0x1D273A1D, 0x9EB9279E, 0xE138D9E1, 0xF813EBF8, 0x98B32B98, 0x11332211,
+    0x69BBD269, 0xD970A9D9, 0x8E89078E, 0x94A73394, 0x9BB62D9B, 0x1E223C1E,
+    0x87921587, 0xE920C9E9, 0xCE4987CE, 0x55FFAA55, 0x28785028, 0xDF7AA5DF,
+    0x8C8F038C, 0xA1F859A1, 0x89800989, 0x0D171A0D, 0xBFDA65BF, 0xE631D7E6,
+    0x42C68442, 0x68B8D068, 0x41C38241, 0x99B02999, 0x2D775A2D, 0x0F111E0F,
+    0xB0CB7BB0, 0x54FCA854, 0xBBD66DBB, 0x163A2C16,
+};
+
+static const uint32_t FwdTab3[] = {
+    0x6363A5C6, 0x7C7C84F8, 0x777799EE, 0x7B7B8DF6, 0xF2F20DFF, 0x6B6BBDD6,
+    0x6F6FB1DE, 0xC5C55491, 0x30305060, 0x01010302, 0x6767A9CE, 0x2B2B7D56,
+    0xFEFE19E7, 0xD7D762B5, 0xABABE64D, 0x76769AEC, 0xCACA458F, 0x82829D1F,
+    0xC9C94089, 0x7D7D87FA, 0xFAFA15EF, 0x5959EBB2, 0x4747C98E, 0xF0F00BFB,
+    0xADADEC41, 0xD4D467B3, 0xA2A2FD5F, 0xAFAFEA45, 0x9C9CBF23, 0xA4A4F753,
+    0x727296E4, 0xC0C05B9B, 0xB7B7C275, 0xFDFD1CE1, 0x9393AE3D, 0x26266A4C,
+    0x36365A6C, 0x3F3F417E, 0xF7F702F5, 0xCCCC4F83, 0x34345C68, 0xA5A5F451,
+    0xE5E534D1, 0xF1F108F9, 0x717193E2, 0xD8D873AB, 0x31315362, 0x15153F2A,
+    0x04040C08, 0xC7C75295, 0x23236546, 0xC3C35E9D, 0x18182830, 0x9696A137,
+    0x05050F0A, 0x9A9AB52F, 0x0707090E, 0x12123624, 0x80809B1B, 0xE2E23DDF,
+    0xEBEB26CD, 0x2727694E, 0xB2B2CD7F, 0x75759FEA, 0x09091B12, 0x83839E1D,
+    0x2C2C7458, 0x1A1A2E34, 0x1B1B2D36, 0x6E6EB2DC, 0x5A5AEEB4, 0xA0A0FB5B,
+    0x5252F6A4, 0x3B3B4D76, 0xD6D661B7, 0xB3B3CE7D, 0x29297B52, 0xE3E33EDD,
+    0x2F2F715E, 0x84849713, 0x5353F5A6, 0xD1D168B9, 0x00000000, 0xEDED2CC1,
+    0x20206040, 0xFCFC1FE3, 0xB1B1C879, 0x5B5BEDB6, 0x6A6ABED4, 0xCBCB468D,
+    0xBEBED967, 0x39394B72, 0x4A4ADE94, 0x4C4CD498, 0x5858E8B0, 0xCFCF4A85,
+    0xD0D06BBB, 0xEFEF2AC5, 0xAAAAE54F, 0xFBFB16ED, 0x4343C586, 0x4D4DD79A,
+    0x33335566, 0x85859411, 0x4545CF8A, 0xF9F910E9, 0x02020604, 0x7F7F81FE,
+    0x5050F0A0, 0x3C3C4478, 0x9F9FBA25, 0xA8A8E34B, 0x5151F3A2, 0xA3A3FE5D,
+    0x4040C080, 0x8F8F8A05, 0x9292AD3F, 0x9D9DBC21, 0x38384870, 0xF5F504F1,
+    0xBCBCDF63, 0xB6B6C177, 0xDADA75AF, 0x21216342, 0x10103020, 0xFFFF1AE5,
+    0xF3F30EFD, 0xD2D26DBF, 0xCDCD4C81, 0x0C0C1418, 0x13133526, 0xECEC2FC3,
+    0x5F5FE1BE, 0x9797A235, 0x4444CC88, 0x1717392E, 0xC4C45793, 0xA7A7F255,
+    0x7E7E82FC, 0x3D3D477A, 0x6464ACC8, 0x5D5DE7BA, 0x19192B32, 0x737395E6,
+    0x6060A0C0, 0x81819819, 0x4F4FD19E, 0xDCDC7FA3, 0x22226644, 0x2A2A7E54,
+    0x9090AB3B, 0x8888830B, 0x4646CA8C, 0xEEEE29C7, 0xB8B8D36B, 0x14143C28,
+    0xDEDE79A7, 0x5E5EE2BC, 0x0B0B1D16, 0xDBDB76AD, 0xE0E03BDB, 0x32325664,
+    0x3A3A4E74, 0x0A0A1E14, 0x4949DB92, 0x06060A0C, 0x24246C48, 0x5C5CE4B8,
+    0xC2C25D9F, 0xD3D36EBD, 0xACACEF43, 0x6262A6C4, 0x9191A839, 0x9595A431,
+    0xE4E437D3, 0x79798BF2, 0xE7E732D5, 0xC8C8438B, 0x3737596E, 0x6D6DB7DA,
+    0x8D8D8C01, 0xD5D564B1, 0x4E4ED29C, 0xA9A9E049, 0x6C6CB4D8, 0x5656FAAC,
+    0xF4F407F3, 0xEAEA25CF, 0x6565AFCA, 0x7A7A8EF4, 0xAEAEE947, 0x08081810,
+    0xBABAD56F, 0x787888F0, 0x25256F4A, 0x2E2E725C, 0x1C1C2438, 0xA6A6F157,
+    0xB4B4C773, 0xC6C65197, 0xE8E823CB, 0xDDDD7CA1, 0x74749CE8, 0x1F1F213E,
+    0x4B4BDD96, 0xBDBDDC61, 0x8B8B860D, 0x8A8A850F, 0x707090E0, 0x3E3E427C,
+    0xB5B5C471, 0x6666AACC, 0x4848D890, 0x03030506, 0xF6F601F7, 0x0E0E121C,
+    0x6161A3C2, 0x35355F6A, 0x5757F9AE, 0xB9B9D069, 0x86869117, 0xC1C15899,
+    0x1D1D273A, 0x9E9EB927, 0xE1E138D9, 0xF8F813EB, 0x9898B32B, 0x11113322,
+    0x6969BBD2, 0xD9D970A9, 0x8E8E8907, 0x9494A733, 0x9B9BB62D, 0x1E1E223C,
+    0x87879215, 0xE9E920C9, 0xCECE4987, 0x5555FFAA, 0x28287850, 0xDFDF7AA5,
+    0x8C8C8F03, 0xA1A1F859, 0x89898009, 0x0D0D171A, 0xBFBFDA65, 0xE6E631D7,
+    0x4242C684, 0x6868B8D0, 0x4141C382, 0x9999B029, 0x2D2D775A, 0x0F0F111E,
+    0xB0B0CB7B, 0x5454FCA8, 0xBBBBD66D, 0x16163A2C,
+};
+#endif  // AES_FULL_TABLES
+
 static const uint32_t rcon[] = {
     0x01000000, 0x02000000, 0x04000000, 0x08000000, 0x10000000,
     0x20000000, 0x40000000, 0x80000000, 0x1B000000, 0x36000000,
@@ -142,6 +292,16 @@ inline static uint32_t ror(uint32_t val, uint32_t by) {
 
 #endif
 
+#ifdef AES_FULL_TABLES
+#define FWD_TAB1(i) FwdTab1[i]
+#define FWD_TAB2(i) FwdTab2[i]
+#define FWD_TAB3(i) FwdTab3[i]
+#else
+#define FWD_TAB1(i) ror(FwdTab0[i], 8)
+#define FWD_TAB2(i) ror(FwdTab0[i], 16)
+#define FWD_TAB3(i) ror(FwdTab0[i], 24)
+#endif  // AES_FULL_TABLES
+
 int aesInitForEncr(struct AesContext *ctx, const uint32_t *k) {
   uint32_t i, *ks = ctx->round_key;
 
@@ -201,25 +361,25 @@ void aesEncr(struct AesContext *ctx, const uint32_t *src, uint32_t *dst) {
   for (i = 0; i < ctx->aes_num_rounds - 1; i++) {
     uint32_t t0, t1, t2;
 
-    t0 = *k++ ^ ror(FwdTab0[(x0 >> 24) & 0xff], 0) ^
-         ror(FwdTab0[(x1 >> 16) & 0xff], 8) ^
-         ror(FwdTab0[(x2 >> 8) & 0xff], 16) ^
-         ror(FwdTab0[(x3 >> 0) & 0xff], 24);
+    t0 = *k++ ^ FwdTab0[(x0 >> 24) & 0xff] ^
+         FWD_TAB1((x1 >> 16) & 0xff) ^
+         FWD_TAB2((x2 >> 8) & 0xff) ^
+         FWD_TAB3((x3 >> 0) & 0xff);
 
-    t1 = *k++ ^ ror(FwdTab0[(x1 >> 24) & 0xff], 0) ^
-         ror(FwdTab0[(x2 >> 16) & 0xff], 8) ^
-         ror(FwdTab0[(x3 >> 8) & 0xff], 16) ^
-         ror(FwdTab0[(x0 >> 0) & 0xff], 24);
+    t1 = *k++ ^ FwdTab0[(x1 >> 24) & 0xff] ^
+         FWD_TAB1((x2 >> 16) & 0xff) ^
+         FWD_TAB2((x3 >> 8) & 0xff) ^
+         FWD_TAB3((x0 >> 0) & 0xff);
 
-    t2 = *k++ ^ ror(FwdTab0[(x2 >> 24) & 0xff], 0) ^
-         ror(FwdTab0[(x3 >> 16) & 0xff], 8) ^
-         ror(FwdTab0[(x0 >> 8) & 0xff], 16) ^
-         ror(FwdTab0[(x1 >> 0) & 0xff], 24);
+    t2 = *k++ ^ FwdTab0[(x2 >> 24) & 0xff] ^
+         FWD_TAB1((x3 >> 16) & 0xff) ^
+         FWD_TAB2((x0 >> 8) & 0xff) ^
+         FWD_TAB3((x1 >> 0) & 0xff);
 
-    x3 = *k++ ^ ror(FwdTab0[(x3 >> 24) & 0xff], 0) ^
-         ror(FwdTab0[(x0 >> 16) & 0xff], 8) ^
-         ror(FwdTab0[(x1 >> 8) & 0xff], 16) ^
-         ror(FwdTab0[(x2 >> 0) & 0xff], 24);
+    x3 = *k++ ^ FwdTab0[(x3 >> 24) & 0xff] ^
+         FWD_TAB1((x0 >> 16) & 0xff) ^
+         FWD_TAB2((x1 >> 8) & 0xff) ^
+         FWD_TAB3((x2 >> 0) & 0xff);
 
     x0 = t0;
     x1 = t1;
@@ -251,7 +411,7 @@ void aesEncr(struct AesContext *ctx, const uint32_t *src, uint32_t *dst) {
 int aesCtrInit(struct AesCtrContext *ctx, const void *k, const void *iv,
                enum AesKeyType key_type) {
   const uint32_t *p_k;
-  uint32_t aligned_k[AES_BLOCK_WORDS];
+  uint32_t aligned_k[AES_KEY_MAX_WORDS];
 
   if (AES_128_KEY_TYPE == key_type) {
     ctx->aes.aes_key_words = AES_128_KEY_WORDS;
@@ -266,7 +426,7 @@ int aesCtrInit(struct AesCtrContext *ctx, const void *k, const void *iv,
   if (IS_ALIGNED(k, uint32_t)) {
     p_k = (const uint32_t *)k;
   } else {
-    memcpy(aligned_k, k, sizeof(aligned_k));
+    memcpy(aligned_k, k, ctx->aes.aes_key_words * sizeof(uint32_t));
     p_k = aligned_k;
   }
 
@@ -274,69 +434,109 @@ int aesCtrInit(struct AesCtrContext *ctx, const void *k, const void *iv,
   return aesInitForEncr(&ctx->aes, p_k);
 }
 
+// Increases the big endian AES/CTR counter block by one.
+static void aesCtrIncrement(uint32_t *iv) {
+  for (int i = AES_BLOCK_SIZE - 1; i >= 0; i--) {
+    ((uint8_t *)iv)[i]++;
+    if (((uint8_t *)iv)[i]) break;
+  }
+}
+
+#ifdef AES_USE_AESNI
+
+// Converts the round keys to the byte order used by the AES-NI instructions.
+static void aesNiLoadRoundKeys(const struct AesContext *ctx,
+                               __m128i *round_keys) {
+  const uint32_t *k = ctx->round_key;
+  for (uint32_t i = 0; i <= ctx->aes_num_rounds; i++, k += AES_BLOCK_WORDS) {
+    round_keys[i] = _mm_set_epi32((int)BSWAP32(k[3]), (int)BSWAP32(k[2]),
+                                  (int)BSWAP32(k[1]), (int)BSWAP32(k[0]));
+  }
+}
+
+// Encrypts num_blocks consecutive counter blocks into keystream. The blocks
+// go through each round together to keep the AES unit pipelined.
+static void aesNiCtrKeystream(struct AesCtrContext *ctx,
+                              const __m128i *round_keys, uint32_t *keystream,
+                              size_t num_blocks) {
+  __m128i blocks[AES_CTR_PARALLEL_BLOCKS];
+  for (size_t i = 0; i < num_blocks; i++) {
+    blocks[i] = _mm_xor_si128(_mm_loadu_si128((const __m128i *)ctx->iv),
+                              round_keys[0]);
+    aesCtrIncrement(ctx->iv);
+  }
+  for (uint32_t r = 1; r < ctx->aes.aes_num_rounds; r++) {
+    for (size_t i = 0; i < num_blocks; i++) {
+      blocks[i] = _mm_aesenc_si128(blocks[i], round_keys[r]);
+    }
+  }
+  for (size_t i = 0; i < num_blocks; i++) {
+    blocks[i] =
+        _mm_aesenclast_si128(blocks[i], round_keys[ctx->aes.aes_num_rounds]);
+    _mm_storeu_si128((__m128i *)(keystream + i * AES_BLOCK_WORDS), blocks[i]);
+  }
+}
+
+#else
+
+// Encrypts num_blocks consecutive counter blocks into keystream.
+static void aesCtrKeystream(struct AesCtrContext *ctx, uint32_t *keystream,
+                            size_t num_blocks) {
+  for (size_t i = 0; i < num_blocks; i++) {
+    aesEncr(&ctx->aes, ctx->iv, keystream + i * AES_BLOCK_WORDS);
+    aesCtrIncrement(ctx->iv);
+  }
+}
+
+#endif  // AES_USE_AESNI
+
 void aesCtr(struct AesCtrContext *ctx, const void *src, void *dst,
             size_t data_len) {
   const uint8_t *p_src_pos = (const uint8_t *)src;
   uint8_t *p_dst_pos = (uint8_t *)dst;
-  const bool is_src_aligned = IS_ALIGNED(src, uint32_t);
-  const bool is_dst_aligned = IS_ALIGNED(dst, uint32_t);
-  const uint32_t *p_src;
-  uint32_t *p_dst;
-  uint32_t aligned_src[AES_BLOCK_WORDS];
-  uint32_t aligned_dst[AES_BLOCK_WORDS];
+  uint32_t keystream[AES_CTR_PARALLEL_BLOCKS * AES_BLOCK_WORDS];
+  const uint8_t *p_keystream = (const uint8_t *)keystream;
   size_t bytes_to_process = data_len;
+#ifdef AES_USE_AESNI
+  __m128i round_keys[AES_256_KEY_NUM_ROUNDS + 1];
+  aesNiLoadRoundKeys(&ctx->aes, round_keys);
+#endif
 
   while (bytes_to_process > 0) {
-    size_t chunk_bytes_len =
-        (bytes_to_process < AES_BLOCK_SIZE) ? bytes_to_process : AES_BLOCK_SIZE;
-
-    // if source is not aligned or size is not multiple of words,
-    // copy it to stack
-    if (is_src_aligned && (chunk_bytes_len % sizeof(uint32_t) == 0)) {
-      // Cast to "void *" first to prevent the -Wcast-align compiling
-      // error when casting the uint8_t pointer to the uint32_t pointer.
-      // Note, we already verified the alignment above before casting.
-      p_src = (const uint32_t *)(void *)p_src_pos;
-    } else {
-      memcpy(aligned_src, p_src_pos, chunk_bytes_len);
-      p_src = aligned_src;
+    size_t num_blocks =
+        (bytes_to_process + AES_BLOCK_SIZE - 1) / AES_BLOCK_SIZE;
+    if (num_blocks > AES_CTR_PARALLEL_BLOCKS) {
+      num_blocks = AES_CTR_PARALLEL_BLOCKS;
     }
-
-    // if destination is not aligned or full block size,
-    // copy results to stack
-    if (is_dst_aligned && chunk_bytes_len == AES_BLOCK_SIZE) {
-      // Cast to "void *" first to prevent the -Wcast-align compiling
-      // error when casting the uint8_t pointer to the uint32_t pointer.
-      // Note, we already verified the alignment above before casting.
-      p_dst = (uint32_t *)(void *)p_dst_pos;
-    } else {
-      p_dst = aligned_dst;
+    size_t chunk_bytes_len = num_blocks * AES_BLOCK_SIZE;
+    if (chunk_bytes_len > bytes_to_process) {
+      chunk_bytes_len = bytes_to_process;
     }
 
     // encrypt/decrypt by AES/CTR mode
     // encryption and decryption are same operation in AES/CTR mode
-    size_t num_words =
-        (chunk_bytes_len + (sizeof(uint32_t) - 1)) / sizeof(uint32_t);
-    aesEncr(&ctx->aes, ctx->iv, p_dst);
-    for (size_t i = 0; i < num_words; i++) {
-      p_dst[i] ^= p_src[i];
-    }
+#ifdef AES_USE_AESNI
+    aesNiCtrKeystream(ctx, round_keys, keystream, num_blocks);
+#else
+    aesCtrKeystream(ctx, keystream, num_blocks);
+#endif
 
-    // if p_dst is aligned_dst, we used stack
-    // then, copy stack to destination by safe way
-    if (p_dst == aligned_dst) {
-      memcpy(p_dst_pos, aligned_dst, chunk_bytes_len);
+    // memcpy() lets the compiler pick word accesses which are safe for
+    // unaligned source and destination.
+    size_t i = 0;
+    for (; i + sizeof(uint32_t) <= chunk_bytes_len; i += sizeof(uint32_t)) {
+      uint32_t word;
+      memcpy(&word, p_src_pos + i, sizeof(word));
+      word ^= keystream[i / sizeof(uint32_t)];
+      memcpy(p_dst_pos + i, &word, sizeof(word));
+    }
+    for (; i < chunk_bytes_len; i++) {
+      p_dst_pos[i] = p_src_pos[i] ^ p_keystream[i];
     }
 
     // update position and left bytes
     p_dst_pos += chunk_bytes_len;
     p_src_pos += chunk_bytes_len;
     bytes_to_process -= chunk_bytes_len;
-
-    // increase AES block counter
-    for (int i = AES_BLOCK_SIZE - 1; i >= 0; i--) {
-      ((uint8_t *)ctx->iv)[i]++;
-      if (((uint8_t *)ctx->iv)[i]) break;
-    }
   }
 }
@@ -145,9 +145,51 @@ bool MatchInitialFastPair(const BleServiceData &ble_service_data,
   return FillResult(ble_service_data, nullptr, result);
 }
 
-bool MatchSubsequentPair(const uint8_t *account_key,
-                         const BleServiceData &service_data,
-                         nearby_BleFilterResult *result) {
+bool MatchFastPair(const nearby_BleFilter &filter,
+                   const BleScanRecord &scan_record,
+                   nearby_BleFilterResult *result) {
+  FastPairFilterState state;
+  state.Init(filter);
+  return state.Match(scan_record, result);
+}
+
+void FastPairFilterState::Init(const nearby_BleFilter &filter) {
+  account_keys_.clear();
+  for (SaltDigests &salt_digests : salt_digests_) {
+    salt_digests.length = 0;
+  }
+  next_salt_digests_ = 0;
+  has_initial_pair_ = CheckFastPairFilter(filter, &account_keys_);
+}
+
+bool FastPairFilterState::Match(const BleScanRecord &scan_record,
+                                nearby_BleFilterResult *result) {
+  LOGD("MatchFastPair");
+  if (has_initial_pair_) {
+    LOGD("Fast Pair initial pair filter found.");
+    for (const auto &ble_service_data : scan_record.service_data) {
+      if (MatchInitialFastPair(ble_service_data, result)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  if (account_keys_.empty()) {
+    return false;
+  }
+  for (size_t i = 0; i < account_keys_.size(); i++) {
+    for (const auto &service_data : scan_record.service_data) {
+      if (MatchSubsequentPair(i, service_data) &&
+          FillResult(service_data, account_keys_[i], result)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool FastPairFilterState::MatchSubsequentPair(
+    size_t key_index, const BleServiceData &service_data) {
   LOGD("MatchSubsequentPair");
   if (service_data.uuid != kFastPairUuid) {
     LOGD("service data uuid %x is not Fast Pair uuid %x", service_data.uuid,
@@ -181,10 +223,10 @@ bool MatchSubsequentPair(const uint8_t *account_key,
   CHRE_ASSERT((kFpAccountKeyLength + account_data.salt.length +
                account_data.battery.length + account_data.rrd.length) <=
               kMaxBloomFilterKeyLength);
+  // The key fed into the Bloom filter is an account key followed by the salt
+  // data, which is the same for every account key.
   uint8_t key[kMaxBloomFilterKeyLength];
-  size_t pos = 0;
-  memcpy(&key[pos], account_key, kFpAccountKeyLength);
-  pos += kFpAccountKeyLength;
+  size_t pos = kFpAccountKeyLength;
   memcpy(&key[pos], account_data.salt.data, account_data.salt.length);
   pos += account_data.salt.length;
   LOGD_SENSITIVE_INFO("Fast Pair subsequent pair SALT");
@@ -206,49 +248,62 @@ bool MatchSubsequentPair(const uint8_t *account_key,
     }
   }
 
-  LOGD_SENSITIVE_INFO("Fast Pair subsequent pair combined key:");
-  for (size_t i = 0; i < pos; i++) {
-    LOGD_SENSITIVE_INFO("%x", key[i]);
-  }
-  bool matched = bloom_filter.MayContain(key, pos);
-  if (!matched && account_data.rrd.length > 0) {
-    // Flip the first byte to 4, 5, 6 when RRD is presented.
-    for (uint8_t firstByte : kAccountKeyFirstByte) {
-      key[0] = firstByte;
-      matched = bloom_filter.MayContain(key, pos);
-      if (matched) break;
+  // Flips the first byte to 4, 5, 6 when RRD is presented.
+  size_t num_variants = (account_data.rrd.length > 0) ? kNumKeyVariants : 1;
+  SaltDigests *salt_digests =
+      GetSaltDigests(&key[kFpAccountKeyLength], pos - kFpAccountKeyLength);
+  for (size_t variant = 0; variant < num_variants; variant++) {
+    KeyDigest computed_digest;
+    KeyDigest *digest =
+        (salt_digests == nullptr)
+            ? &computed_digest
+            : &salt_digests->key_digests[key_index * kNumKeyVariants + variant];
+    if (!digest->computed) {
+      memcpy(key, account_keys_[key_index], kFpAccountKeyLength);
+      if (variant > 0) {
+        key[0] = kAccountKeyFirstByte[variant - 1];
+      }
+      LOGD_SENSITIVE_INFO("Fast Pair subsequent pair combined key:");
+      for (size_t i = 0; i < pos; i++) {
+        LOGD_SENSITIVE_INFO("%x", key[i]);
+      }
+      sha256(key, static_cast<uint32_t>(pos), digest->hash,
+             sizeof(digest->hash));
+      digest->computed = true;
+    }
+    if (bloom_filter.MayContainDigest(digest->hash)) {
+      LOGD("Subsequent Pair match succeeds.");
+      return true;
     }
   }
-  if (matched) {
-    LOGD("Subsequent Pair match succeeds.");
-    return FillResult(service_data, account_key, result);
-  } else {
-    return false;
-  }
+  return false;
 }
 
-bool MatchFastPair(const nearby_BleFilter &filter,
-                   const BleScanRecord &scan_record,
-                   nearby_BleFilterResult *result) {
-  LOGD("MatchFastPair");
-  chre::DynamicVector<const uint8_t *> account_keys;
-  if (CheckFastPairFilter(filter, &account_keys)) {
-    LOGD("Fast Pair initial pair filter found.");
-    for (const auto &ble_service_data : scan_record.service_data) {
-      if (MatchInitialFastPair(ble_service_data, result)) {
-        return true;
-      }
-    }
-  } else {
-    for (const auto account_key : account_keys) {
-      for (const auto &ble_service_data : scan_record.service_data) {
-        if (MatchSubsequentPair(account_key, ble_service_data, result)) {
-          return true;
-        }
-      }
+FastPairFilterState::SaltDigests *FastPairFilterState::GetSaltDigests(
+    const uint8_t *salt_data, size_t length) {
+  if (length == 0 || length > kMaxSaltDataLength) {
+    return nullptr;
+  }
+  for (SaltDigests &salt_digests : salt_digests_) {
+    if (salt_digests.length == length &&
+        memcmp(salt_digests.salt_data, salt_data, length) == 0) {
+      LOGD("Reuse the Fast Pair digests of a recent salt.");
+      return &salt_digests;
     }
   }
-  return false;
+
+  SaltDigests &salt_digests = salt_digests_[next_salt_digests_];
+  next_salt_digests_ = (next_salt_digests_ + 1) % kNumSaltDigests;
+  salt_digests.length = 0;
+  salt_digests.key_digests.clear();
+  if (!salt_digests.key_digests.resize(account_keys_.size() *
+                                       kNumKeyVariants)) {
+    LOGE("Failed to allocate Fast Pair digests.");
+    return nullptr;
+  }
+  memcpy(salt_digests.salt_data, salt_data, length);
+  salt_digests.length = length;
+  return &salt_digests;
 }
 
 }  // namespace nearby
@@ -17,8 +17,13 @@
 #ifndef LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_FAST_PAIR_FILTER_H_
 #define LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_FAST_PAIR_FILTER_H_
 
+#include <cstddef>
+#include <cstdint>
+
 #include "location/lbs/contexthub/nanoapps/nearby/ble_scan_record.h"
+#include "location/lbs/contexthub/nanoapps/nearby/crypto/sha2.h"
 #include "location/lbs/contexthub/nanoapps/nearby/proto/ble_filter.nanopb.h"
+#include "third_party/contexthub/chre/util/include/chre/util/dynamic_vector.h"
 
 namespace nearby {
 
@@ -26,6 +31,62 @@ bool MatchFastPair(const nearby_BleFilter &filter,
                    const BleScanRecord &scan_record,
                    nearby_BleFilterResult *result);
 
+// Fast Pair matching state precomputed from one BLE filter. The account keys
+// are extracted once when the host updates the filters instead of for every
+// report. The SHA-256 digests that place each account key in the Bloom filter
+// of a subsequent pair advertisement are kept per salt, i.e. per salt, battery
+// and RRD bytes hashed after the key. A device repeating its advertisement is
+// then matched or rejected by testing the Bloom filter bits of the kept
+// digests, without hashing every account key again.
+class FastPairFilterState {
+ public:
+  // Precomputes the state for filter, which must outlive this object.
+  void Init(const nearby_BleFilter &filter);
+
+  // Behaves like MatchFastPair() with the filter passed to Init().
+  bool Match(const BleScanRecord &scan_record, nearby_BleFilterResult *result);
+
+ private:
+  // Each account key is hashed as is, then with each first byte of
+  // kAccountKeyFirstByte when the advertisement has RRD.
+  static constexpr size_t kNumKeyVariants = 4;
+  // Max length of the salt, battery and RRD, whose lengths are less than 2^4.
+  static constexpr size_t kMaxSaltDataLength = 48;
+  // Number of salts whose digests are kept, e.g. for the Fast Pair devices
+  // advertising around at once. Bounds the memory used to
+  // kNumSaltDigests x kNumKeyVariants x 36 bytes per account key.
+  static constexpr size_t kNumSaltDigests = 4;
+
+  struct KeyDigest {
+    bool computed = false;
+    uint32_t hash[SHA2_HASH_WORDS];
+  };
+
+  // The digests of the account key variants for the salt data of an
+  // advertisement, computed on first use.
+  struct SaltDigests {
+    uint8_t salt_data[kMaxSaltDataLength];
+    // Length of salt_data, or 0 if the entry is unused.
+    size_t length = 0;
+    // kNumKeyVariants digests for each key of account_keys_.
+    chre::DynamicVector<KeyDigest> key_digests;
+  };
+
+  // Returns true if the key at key_index in account_keys_ is found in the
+  // Bloom filter of the subsequent pair service_data.
+  bool MatchSubsequentPair(size_t key_index,
+                           const BleServiceData &service_data);
+
+  // Returns the digests for salt_data, reusing the oldest entry on a miss, or
+  // nullptr if no entry can be allocated.
+  SaltDigests *GetSaltDigests(const uint8_t *salt_data, size_t length);
+
+  bool has_initial_pair_ = false;
+  chre::DynamicVector<const uint8_t *> account_keys_;
+  SaltDigests salt_digests_[kNumSaltDigests];
+  size_t next_salt_digests_ = 0;
+};
+
 }  // namespace nearby
 
 #endif  // LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_FAST_PAIR_FILTER_H_
@@ -27,8 +27,6 @@
 #include "location/lbs/contexthub/nanoapps/nearby/ble_scan_record.h"
 #include "location/lbs/contexthub/nanoapps/nearby/fast_pair_filter.h"
 #ifdef ENABLE_PRESENCE
-#include "location/lbs/contexthub/nanoapps/nearby/presence_crypto_identity_v1.h"
-#include "location/lbs/contexthub/nanoapps/nearby/presence_crypto_v1.h"
 #include "location/lbs/contexthub/nanoapps/nearby/presence_filter.h"
 #endif
 #include "third_party/contexthub/chre/util/include/chre/util/nanoapp/log.h"
@@ -42,6 +40,11 @@ constexpr nearby_BleFilters kDefaultBleFilters = nearby_BleFilters_init_zero;
 bool Filter::Update(const uint8_t *message, uint32_t message_size) {
   LOGD("Decode a Filters message with size %" PRIu32, message_size);
   ble_filters_ = kDefaultBleFilters;
+  fast_pair_filters_.clear();
+#ifdef ENABLE_PRESENCE
+  presence_keys_.Clear();
+  presence_identity_keys_.Clear();
+#endif
   pb_istream_t stream = pb_istream_from_buffer(message, message_size);
   if (!pb_decode(&stream, nearby_BleFilters_fields, &ble_filters_)) {
     LOGE("Failed to decode a Filters message.");
@@ -73,6 +76,25 @@ bool Filter::Update(const uint8_t *message, uint32_t message_size) {
       scan_interval_ms_ = filter->latency_ms;
     }
   }
+#ifdef ENABLE_PRESENCE
+  for (int i = 0; i < ble_filters_.filter_count; i++) {
+    const nearby_BleFilter &filter = ble_filters_.filter[i];
+    for (int j = 0; j < filter.certificate_count; j++) {
+      ByteArray authenticity_key(
+          const_cast<uint8_t *>(filter.certificate[j].authenticity_key),
+          PresenceKeyCache::kAuthenticityKeySize);
+      presence_keys_.Add(authenticity_key);
+      presence_identity_keys_.Add(authenticity_key);
+    }
+  }
+#endif
+  if (!fast_pair_filters_.resize(ble_filters_.filter_count)) {
+    LOGE("Failed to allocate Fast Pair filters.");
+  } else {
+    for (int i = 0; i < ble_filters_.filter_count; i++) {
+      fast_pair_filters_[i].Init(ble_filters_.filter[i]);
+    }
+  }
   return true;
 }
 
@@ -117,7 +139,11 @@ void Filter::MatchBle(
     result.timestamp_ns =
         report.timestamp +
         static_cast<uint64_t>(chreGetEstimatedHostTimeOffset());
-    if (MatchFastPair(ble_filters_.filter[filter_index], record, &result)) {
+    bool fast_pair_matched =
+        static_cast<size_t>(filter_index) < fast_pair_filters_.size()
+            ? fast_pair_filters_[filter_index].Match(record, &result)
+            : MatchFastPair(ble_filters_.filter[filter_index], record, &result);
+    if (fast_pair_matched) {
       LOGD("Add a matched Fast Pair filter result");
       fp_filter_results->push_back(result);
       return;
@@ -125,8 +151,7 @@ void Filter::MatchBle(
 #ifdef ENABLE_PRESENCE
     if (MatchPresenceV0(ble_filters_.filter[filter_index], record, &result) ||
         MatchPresenceV1(ble_filters_.filter[filter_index], record,
-                        PresenceCryptoV1Impl(), PresenceCryptoIdentityV1Impl(),
-                        &result)) {
+                        presence_keys_, presence_identity_keys_, &result)) {
       LOGD("Filter result TX power %" PRId32 ", RSSI %" PRId32, result.tx_power,
            result.rssi);
 
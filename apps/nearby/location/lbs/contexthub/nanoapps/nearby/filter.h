@@ -17,6 +17,11 @@
 #ifndef LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_FILTER_H_
 #define LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_FILTER_H_
 
+#ifdef ENABLE_PRESENCE
+#include "location/lbs/contexthub/nanoapps/nearby/presence_crypto_identity_v1.h"
+#include "location/lbs/contexthub/nanoapps/nearby/presence_crypto_v1.h"
+#endif
+#include "location/lbs/contexthub/nanoapps/nearby/fast_pair_filter.h"
 #include "location/lbs/contexthub/nanoapps/nearby/proto/ble_filter.nanopb.h"
 #include "third_party/contexthub/chre/util/include/chre/util/dynamic_vector.h"
 
@@ -48,6 +53,13 @@ class Filter {
   nearby_BleFilters ble_filters_ = nearby_BleFilters_init_zero;
   // BLE Scan interval. Default to 1 minute.
   uint64_t scan_interval_ms_ = 60 * 1000;
+  // Fast Pair state of each filter in ble_filters_, rebuilt by Update().
+  chre::DynamicVector<FastPairFilterState> fast_pair_filters_;
+#ifdef ENABLE_PRESENCE
+  // Keys derived from the certificates of ble_filters_, rebuilt by Update().
+  PresenceCryptoV1Impl::KeyCache presence_keys_;
+  PresenceCryptoIdentityV1Impl::KeyCache presence_identity_keys_;
+#endif
 };
 
 }  // namespace nearby
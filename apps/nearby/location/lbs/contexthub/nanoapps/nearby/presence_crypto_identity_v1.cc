@@ -16,12 +16,23 @@
 
 #include "location/lbs/contexthub/nanoapps/nearby/presence_crypto_identity_v1.h"
 
+#include <cstring>
+
 #include "location/lbs/contexthub/nanoapps/nearby/crypto/aes.h"
 #include "location/lbs/contexthub/nanoapps/nearby/crypto/hkdf.h"
 #include "third_party/contexthub/chre/util/include/chre/util/macros.h"
 #include "third_party/contexthub/chre/util/include/chre/util/nanoapp/log.h"
 #define LOG_TAG "[NEARBY][PRESENCE_CRYPTO_V1]"
 namespace nearby {
+PresenceCryptoIdentityV1Impl::PresenceCryptoIdentityV1Impl(
+    const KeyCache &key_cache, const ByteArray &salt)
+    : key_cache_(key_cache) {
+  if (salt.data != nullptr && salt.length == kSaltSize) {
+    memcpy(salt_, salt.data, kSaltSize);
+    key_cache_.DeriveIv(salt, iv_);
+    has_iv_ = true;
+  }
+}
 bool PresenceCryptoIdentityV1Impl::decrypt(const ByteArray &input,
                                            const ByteArray &salt,
                                            const ByteArray &key,
@@ -38,17 +49,17 @@ bool PresenceCryptoIdentityV1Impl::decrypt(const ByteArray &input,
     LOGE("Input and output data length are different");
     return false;
   }
-  // Generate a 32 bytes decryption key from authenticity_key
-  uint8_t decryption_key[kEncryptionKeySize] = {0};
-  hkdf(kEkIv, ARRAY_SIZE(kEkIv), key.data, key.length, decryption_key,
-       ARRAY_SIZE(decryption_key));
-  // Decrypt the input cipher text using the decryption key
-  uint8_t e_salt[kAesCtrIvSize] = {0};
-  hkdf(kEsaltIv, ARRAY_SIZE(kEsaltIv), salt.data, salt.length, e_salt,
-       ARRAY_SIZE(e_salt));
+  // Decrypt the input cipher text using the 32 bytes decryption key derived
+  // from authenticity_key and the IV derived from salt.
+  uint8_t iv[PresenceKeyCache::kAesCtrIvSize];
+  const uint8_t *ctr_iv = iv_;
+  if (!has_iv_ || memcmp(salt_, salt.data, kSaltSize) != 0) {
+    key_cache_.DeriveIv(salt, iv);
+    ctr_iv = iv;
+  }
   struct AesCtrContext ctx;
-  if (aesCtrInit(&ctx, decryption_key, e_salt, AES_256_KEY_TYPE) < 0) {
-    LOGE("aesCtrInit() is failed");
+  if (!key_cache_.InitAesCtr(key, ctr_iv, &ctx)) {
+    LOGE("Failed to initialize AES/CTR");
     return false;
   }
   aesCtr(&ctx, input.data, output.data, output.length);
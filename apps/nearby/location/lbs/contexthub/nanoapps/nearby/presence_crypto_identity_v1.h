@@ -17,11 +17,24 @@
 #ifndef LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_PRESENCE_CRYPTO_IDENTITY_V1_H_
 #define LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_PRESENCE_CRYPTO_IDENTITY_V1_H_
 #include "location/lbs/contexthub/nanoapps/nearby/crypto.h"
+#include "location/lbs/contexthub/nanoapps/nearby/presence_key_cache.h"
 namespace nearby {
 // Implements Crypto interface for Identity in Presence v1 specification.
 // Crypto algorithms: AES/CTR, HMAC, HKDF, SHA256.
 class PresenceCryptoIdentityV1Impl : public Crypto {
  public:
+  // Keys derived from the authenticity keys of the filter certificates with
+  // the HKDF salts of this implementation.
+  class KeyCache : public PresenceKeyCache {
+   public:
+    KeyCache() : PresenceKeyCache(kEkIv, kEsaltIv, nullptr) {}
+  };
+
+  // Uses the keys of key_cache, which must outlive the object. salt is the
+  // advertisement salt, whose AES/CTR IV is derived once for every identity
+  // tried against the advertisement.
+  PresenceCryptoIdentityV1Impl(const KeyCache &key_cache,
+                               const ByteArray &salt);
   // Decrypts input with salt and key. Places the decrypted result in output.
   bool decrypt(const ByteArray &input, const ByteArray &salt,
                const ByteArray &key, ByteArray &output) const override;
@@ -31,8 +44,6 @@ class PresenceCryptoIdentityV1Impl : public Crypto {
 
  private:
   static constexpr size_t kAuthenticityKeySize = 16;
-  static constexpr size_t kEncryptionKeySize = 32;
-  static constexpr size_t kAesCtrIvSize = 16;
   static constexpr size_t kHmacTagSize = 8;
   static constexpr size_t kSaltSize = 2;
   static constexpr uint8_t kEkIv[] = {0x0E, 0x85, 0xD9, 0x2A, 0x6D, 0x7F,
@@ -44,6 +55,11 @@ class PresenceCryptoIdentityV1Impl : public Crypto {
   static constexpr uint8_t kKtagIv[] = {0xEA, 0xAD, 0xFA, 0x43, 0x10, 0x9D,
                                         0xF3, 0xF7, 0x08, 0xFD, 0xF0, 0x25,
                                         0xB5, 0x2F, 0x01, 0xC8};
+  const KeyCache &key_cache_;
+  // The salt given at construction and its IV, if the salt is valid.
+  bool has_iv_ = false;
+  uint8_t salt_[kSaltSize] = {0};
+  uint8_t iv_[PresenceKeyCache::kAesCtrIvSize] = {0};
 };
 }  // namespace nearby
 #endif  // LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_PRESENCE_CRYPTO_IDENTITY_V1_H_
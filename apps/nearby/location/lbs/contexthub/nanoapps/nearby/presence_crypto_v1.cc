@@ -16,12 +16,23 @@
 
 #include "location/lbs/contexthub/nanoapps/nearby/presence_crypto_v1.h"
 
+#include <cstring>
+
 #include "location/lbs/contexthub/nanoapps/nearby/crypto/aes.h"
 #include "location/lbs/contexthub/nanoapps/nearby/crypto/hkdf.h"
 #include "third_party/contexthub/chre/util/include/chre/util/macros.h"
 #include "third_party/contexthub/chre/util/include/chre/util/nanoapp/log.h"
 #define LOG_TAG "[NEARBY][PRESENCE_CRYPTO_V1]"
 namespace nearby {
+PresenceCryptoV1Impl::PresenceCryptoV1Impl(const KeyCache &key_cache,
+                                            const ByteArray &salt)
+    : key_cache_(key_cache) {
+  if (salt.data != nullptr && salt.length == kSaltSize) {
+    memcpy(salt_, salt.data, kSaltSize);
+    key_cache_.DeriveIv(salt, iv_);
+    has_iv_ = true;
+  }
+}
 bool PresenceCryptoV1Impl::decrypt(const ByteArray &input,
                                    const ByteArray &salt, const ByteArray &key,
                                    ByteArray &output) const {
@@ -38,17 +49,17 @@ bool PresenceCryptoV1Impl::decrypt(const ByteArray &input,
     return false;
   }
 
-  // Generate a 32 bytes decryption key from authenticity_key
-  uint8_t decryption_key[kEncryptionKeySize] = {0};
-  hkdf(kAkIv, ARRAY_SIZE(kAkIv), key.data, key.length, decryption_key,
-       ARRAY_SIZE(decryption_key));
-  // Decrypt the input cipher text using the decryption key
-  uint8_t a_salt[kAesCtrIvSize] = {0};
-  hkdf(kAsaltIv, ARRAY_SIZE(kAsaltIv), salt.data, salt.length, a_salt,
-       ARRAY_SIZE(a_salt));
+  // Decrypt the input cipher text using the 32 bytes decryption key derived
+  // from authenticity_key and the IV derived from salt.
+  uint8_t iv[PresenceKeyCache::kAesCtrIvSize];
+  const uint8_t *ctr_iv = iv_;
+  if (!has_iv_ || memcmp(salt_, salt.data, kSaltSize) != 0) {
+    key_cache_.DeriveIv(salt, iv);
+    ctr_iv = iv;
+  }
   struct AesCtrContext ctx;
-  if (aesCtrInit(&ctx, decryption_key, a_salt, AES_256_KEY_TYPE) < 0) {
-    LOGE("aesCtrInit() is failed");
+  if (!key_cache_.InitAesCtr(key, ctr_iv, &ctx)) {
+    LOGE("Failed to initialize AES/CTR");
     return false;
   }
   aesCtr(&ctx, input.data, output.data, output.length);
@@ -69,14 +80,16 @@ bool PresenceCryptoV1Impl::verify(const ByteArray &input, const ByteArray &key,
     LOGE("Invalid signature size");
     return false;
   }
-  // Generates a 16 bytes HMAC key from authenticity_key
-  uint8_t hmac_key[kAesCtrIvSize] = {0};
-  hkdf(kHkIv, ARRAY_SIZE(kHkIv), key.data, key.length, hmac_key,
-       ARRAY_SIZE(hmac_key));
+  // Gets the 16 bytes HMAC key derived from authenticity_key
+  uint8_t hmac_key[PresenceKeyCache::kHmacKeySize];
+  if (!key_cache_.GetHmacKey(key, hmac_key)) {
+    LOGE("Failed to derive HMAC key");
+    return false;
+  }
   // Generates a 16 bytes HMAC tag from the data
   uint8_t hmac_tag[kHmacTagSize] = {0};
-  hkdf(hmac_key, ARRAY_SIZE(hmac_key), input.data, input.length, hmac_tag,
-       ARRAY_SIZE(hmac_tag));
+  hkdf(hmac_key, PresenceKeyCache::kHmacKeySize, input.data, input.length,
+       hmac_tag, ARRAY_SIZE(hmac_tag));
   // Verify the generated HMAC tag matching the signature
   return memcmp(hmac_tag, signature.data, signature.length) == 0;
 }
@@ -17,11 +17,23 @@
 #ifndef LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_PRESENCE_CRYPTO_V1_H_
 #define LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_PRESENCE_CRYPTO_V1_H_
 #include "location/lbs/contexthub/nanoapps/nearby/crypto.h"
+#include "location/lbs/contexthub/nanoapps/nearby/presence_key_cache.h"
 namespace nearby {
 // Implements Crypto interface for Data Elements in Presence v1 specification.
 // Crypto algorithms: AES/CTR, HMAC, HKDF, SHA256.
 class PresenceCryptoV1Impl : public Crypto {
  public:
+  // Keys derived from the authenticity keys of the filter certificates with
+  // the HKDF salts of this implementation.
+  class KeyCache : public PresenceKeyCache {
+   public:
+    KeyCache() : PresenceKeyCache(kAkIv, kAsaltIv, kHkIv) {}
+  };
+
+  // Uses the keys of key_cache, which must outlive the object. salt is the
+  // advertisement salt, whose AES/CTR IV is derived once for every identity
+  // tried against the advertisement.
+  PresenceCryptoV1Impl(const KeyCache &key_cache, const ByteArray &salt);
   // Decrypts input with salt and key. Places the decrypted result in output.
   bool decrypt(const ByteArray &input, const ByteArray &salt,
                const ByteArray &key, ByteArray &output) const override;
@@ -31,8 +43,6 @@ class PresenceCryptoV1Impl : public Crypto {
 
  private:
   static constexpr size_t kAuthenticityKeySize = 16;
-  static constexpr size_t kEncryptionKeySize = 32;
-  static constexpr size_t kAesCtrIvSize = 16;
   static constexpr size_t kHmacTagSize = 16;
   static constexpr size_t kSaltSize = 2;
   static constexpr uint8_t kAkIv[] = {0x0C, 0xC5, 0x13, 0x17, 0x60, 0x39,
@@ -44,6 +54,11 @@ class PresenceCryptoV1Impl : public Crypto {
   static constexpr uint8_t kHkIv[] = {0x0C, 0xC5, 0x13, 0x17, 0x60, 0x39,
                                       0xC5, 0x13, 0x75, 0xE1, 0x8C, 0xC3,
                                       0x56, 0xE7, 0xDF, 0xB2};
+  const KeyCache &key_cache_;
+  // The salt given at construction and its IV, if the salt is valid.
+  bool has_iv_ = false;
+  uint8_t salt_[kSaltSize] = {0};
+  uint8_t iv_[PresenceKeyCache::kAesCtrIvSize] = {0};
 };
 }  // namespace nearby
 #endif  // LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_PRESENCE_CRYPTO_V1_H_
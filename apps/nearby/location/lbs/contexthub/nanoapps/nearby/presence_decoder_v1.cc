@@ -24,6 +24,32 @@
 #define LOG_TAG "[NEARBY][PRESENCE_DECODER_V1]"
 
 namespace nearby {
+constexpr size_t kHeaderIndex = 0;
+constexpr size_t kSaltIndex = 1;
+constexpr size_t kSaltDataElementLength = 3;
+constexpr uint8_t kVersionMask = 0b11100000;
+constexpr uint8_t kVersion = 1;
+
+bool PresenceDecoderV1::DecodeSalt(
+    const ByteArray &encoded_data,
+    uint8_t salt[DataElementHeaderV1::kSaltLength]) {
+  const uint8_t *const data = encoded_data.data;
+  const size_t data_size = encoded_data.length;
+  if (data == nullptr || data_size < kSaltIndex + kSaltDataElementLength) {
+    return false;
+  }
+  chre::Optional<DataElementHeaderV1> de_header =
+      DataElementHeaderV1::Decode(&data[kSaltIndex], data_size - kSaltIndex);
+  if (!de_header.has_value() ||
+      de_header->type != DataElementHeaderV1::kSaltType ||
+      de_header->length != DataElementHeaderV1::kSaltLength) {
+    return false;
+  }
+  salt[0] = data[kSaltIndex + 1];
+  salt[1] = data[kSaltIndex + 2];
+  return true;
+}
+
 // The Presence v1 advertisement is defined in the format below:
 // Header (1 byte) | salt (1+2 bytes) | Identity + filter (2+16 bytes)
 // | repeated Data Element fields (various bytes)
@@ -36,16 +62,11 @@ bool PresenceDecoderV1::Decode(const ByteArray &encoded_data,
                                const ByteArray &metadata_encryption_key_tag) {
   // 1 + 1 + 2 + 2 + 16
   constexpr size_t kMinAdvertisementLength = 22;
-  constexpr size_t kHeaderIndex = 0;
-  constexpr size_t kSaltIndex = 1;
   constexpr size_t kIdentityIndex = 4;
   constexpr size_t kDataElementIndex = 22;
   constexpr size_t kIdentityHeaderLength = 2;
   constexpr size_t kDataElementSignatureLength = 16;
 
-  constexpr uint8_t kVersionMask = 0b11100000;
-  constexpr uint8_t kVersion = 1;
-
   chre::Optional<DataElementHeaderV1> de_header;
   uint8_t *const data = encoded_data.data;
   const size_t data_size = encoded_data.length;
@@ -61,15 +82,7 @@ bool PresenceDecoderV1::Decode(const ByteArray &encoded_data,
     return false;
   }
 
-  // Decodes salt.
-  de_header =
-      DataElementHeaderV1::Decode(&data[kSaltIndex], data_size - kSaltIndex);
-  if (de_header.has_value() &&
-      de_header->type == DataElementHeaderV1::kSaltType &&
-      de_header->length == DataElementHeaderV1::kSaltLength) {
-    salt[0] = data[kSaltIndex + 1];
-    salt[1] = data[kSaltIndex + 2];
-  } else {
+  if (!DecodeSalt(encoded_data, salt)) {
     LOGE("Advertisement has no valid salt.");
     return false;
   }
@@ -74,6 +74,11 @@ struct PresenceDecoderV1 {
   static constexpr size_t kDecryptionOutputBufSize = 16 * 20;
 
   PresenceDecoderV1() = default;
+  // Decodes the salt of encoded_data, an advertisement encoded by following
+  // the Presence V1 specification, into salt. Returns false if the
+  // advertisement has no valid salt.
+  static bool DecodeSalt(const ByteArray &encoded_data,
+                         uint8_t salt[DataElementHeaderV1::kSaltLength]);
   // Decodes encoded_data which is a byte array encoded by following the
   // Presence V1 specification. Returns true when decoding succeeds.
   bool Decode(const ByteArray &encoded_data, const Crypto &crypto,
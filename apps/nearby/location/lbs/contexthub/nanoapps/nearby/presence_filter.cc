@@ -187,15 +187,24 @@ static bool MatchExtendedDE(
   return true;
 }
 
-bool MatchPresenceV1(const nearby_BleFilter &filter,
-                     const BleScanRecord &scan_record, const Crypto &crypto,
-                     const Crypto &identity_crypto,
-                     nearby_BleFilterResult *result) {
+bool MatchPresenceV1(
+    const nearby_BleFilter &filter, const BleScanRecord &scan_record,
+    const PresenceCryptoV1Impl::KeyCache &keys,
+    const PresenceCryptoIdentityV1Impl::KeyCache &identity_keys,
+    nearby_BleFilterResult *result) {
   LOGD_SENSITIVE_INFO("Filter Presence V1 with %" PRIu16 " certificates",
                       filter.certificate_count);
   PresenceDecoderV1 decoder;
   for (const auto &ble_service_data : scan_record.service_data) {
-    if (ble_service_data.uuid == PresenceServiceData::kUuid) {
+    uint8_t salt[DataElementHeaderV1::kSaltLength];
+    ByteArray encoded_data(const_cast<uint8_t *>(ble_service_data.data),
+                           ble_service_data.length);
+    if (ble_service_data.uuid == PresenceServiceData::kUuid &&
+        PresenceDecoderV1::DecodeSalt(encoded_data, salt)) {
+      // Every certificate is tried with the IVs derived here.
+      ByteArray salt_array(salt, DataElementHeaderV1::kSaltLength);
+      PresenceCryptoV1Impl crypto(keys, salt_array);
+      PresenceCryptoIdentityV1Impl identity_crypto(identity_keys, salt_array);
       for (int cert_index = 0; cert_index < filter.certificate_count;
            cert_index++) {
         ByteArray authenticity_key(
@@ -212,11 +221,8 @@ bool MatchPresenceV1(const nearby_BleFilter &filter,
             const_cast<uint8_t *>(
                 filter.certificate[cert_index].metadata_encryption_key_tag),
             kMetaDataEncryptionTagLength);
-        if (decoder.Decode(
-                ByteArray(const_cast<uint8_t *>(ble_service_data.data),
-                          ble_service_data.length),
-                crypto, identity_crypto, authenticity_key,
-                metadata_encryption_key_tag)) {
+        if (decoder.Decode(encoded_data, crypto, identity_crypto,
+                           authenticity_key, metadata_encryption_key_tag)) {
           result->has_public_credential = true;
           result->public_credential.has_encrypted_metadata_tag = true;
           for (size_t i = 0; i < kMetaDataEncryptionTagLength; i++) {
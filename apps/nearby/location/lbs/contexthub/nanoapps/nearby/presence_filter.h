@@ -18,7 +18,8 @@
 #define LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_PRESENCE_FILTER_H_
 
 #include "location/lbs/contexthub/nanoapps/nearby/ble_scan_record.h"
-#include "location/lbs/contexthub/nanoapps/nearby/crypto.h"
+#include "location/lbs/contexthub/nanoapps/nearby/presence_crypto_identity_v1.h"
+#include "location/lbs/contexthub/nanoapps/nearby/presence_crypto_v1.h"
 #include "location/lbs/contexthub/nanoapps/nearby/proto/ble_filter.nanopb.h"
 
 namespace nearby {
@@ -27,10 +28,15 @@ bool MatchPresenceV0(const nearby_BleFilter &filter,
                      const BleScanRecord &scan_record,
                      nearby_BleFilterResult *result);
 
-bool MatchPresenceV1(const nearby_BleFilter &filter,
-                     const BleScanRecord &scan_record, const Crypto &crypto,
-                     const Crypto &identity_crypto,
-                     nearby_BleFilterResult *result);
+// Matches the Presence V1 advertisements of scan_record against the
+// certificates of filter. keys and identity_keys hold the keys derived from
+// the certificates, and the AES/CTR IV of each advertisement is derived once
+// for all of them.
+bool MatchPresenceV1(
+    const nearby_BleFilter &filter, const BleScanRecord &scan_record,
+    const PresenceCryptoV1Impl::KeyCache &keys,
+    const PresenceCryptoIdentityV1Impl::KeyCache &identity_keys,
+    nearby_BleFilterResult *result);
 
 }  // namespace nearby
 
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "location/lbs/contexthub/nanoapps/nearby/presence_key_cache.h"
+
+#include <cstring>
+
+#include "location/lbs/contexthub/nanoapps/nearby/crypto/hkdf.h"
+#include "third_party/contexthub/chre/util/include/chre/util/nanoapp/log.h"
+
+#define LOG_TAG "[NEARBY][PRESENCE_KEY_CACHE]"
+
+namespace nearby {
+
+PresenceKeyCache::PresenceKeyCache(const uint8_t *encryption_key_salt,
+                                   const uint8_t *iv_salt,
+                                   const uint8_t *hmac_key_salt)
+    : encryption_key_salt_(encryption_key_salt),
+      iv_salt_(iv_salt),
+      hmac_key_salt_(hmac_key_salt) {}
+
+bool PresenceKeyCache::Add(const ByteArray &key) {
+  if (Find(key) != nullptr) {
+    return true;
+  }
+  if (entries_.size() >= kMaxEntries) {
+    LOGW("Presence key cache full, deriving keys on each match");
+    return false;
+  }
+  Entry entry;
+  if (!Derive(key, &entry)) {
+    return false;
+  }
+  if (!entries_.push_back(entry)) {
+    LOGE("Failed to cache Presence keys");
+    return false;
+  }
+  return true;
+}
+
+void PresenceKeyCache::Clear() {
+  entries_.clear();
+}
+
+void PresenceKeyCache::DeriveIv(const ByteArray &salt, uint8_t *iv) const {
+  hkdf(iv_salt_, kHkdfSaltSize, salt.data, salt.length, iv, kAesCtrIvSize);
+}
+
+bool PresenceKeyCache::InitAesCtr(const ByteArray &key, const uint8_t *iv,
+                                  AesCtrContext *ctx) const {
+  const Entry *entry = Find(key);
+  Entry derived;
+  if (entry == nullptr) {
+    if (!Derive(key, &derived)) {
+      return false;
+    }
+    entry = &derived;
+  }
+  // Copying the context skips the AES key expansion done by aesCtrInit().
+  *ctx = entry->aes_ctr;
+  memcpy(ctx->iv, iv, sizeof(ctx->iv));
+  return true;
+}
+
+bool PresenceKeyCache::GetHmacKey(const ByteArray &key,
+                                  uint8_t *hmac_key) const {
+  if (hmac_key_salt_ == nullptr || key.data == nullptr ||
+      key.length != kAuthenticityKeySize) {
+    return false;
+  }
+  const Entry *entry = Find(key);
+  if (entry != nullptr) {
+    memcpy(hmac_key, entry->hmac_key, kHmacKeySize);
+  } else {
+    hkdf(hmac_key_salt_, kHkdfSaltSize, key.data, key.length, hmac_key,
+         kHmacKeySize);
+  }
+  return true;
+}
+
+bool PresenceKeyCache::Derive(const ByteArray &key, Entry *entry) const {
+  if (key.data == nullptr || key.length != kAuthenticityKeySize) {
+    return false;
+  }
+  memcpy(entry->authenticity_key, key.data, kAuthenticityKeySize);
+  // Word aligned so that aesCtrInit() reads the key in place.
+  uint32_t encryption_key[kEncryptionKeySize / sizeof(uint32_t)] = {0};
+  hkdf(encryption_key_salt_, kHkdfSaltSize, key.data, key.length,
+       encryption_key, sizeof(encryption_key));
+  uint8_t zero_iv[kAesCtrIvSize] = {0};
+  if (aesCtrInit(&entry->aes_ctr, encryption_key, zero_iv, AES_256_KEY_TYPE) <
+      0) {
+    LOGE("aesCtrInit() is failed");
+    return false;
+  }
+  if (hmac_key_salt_ != nullptr) {
+    hkdf(hmac_key_salt_, kHkdfSaltSize, key.data, key.length, entry->hmac_key,
+         kHmacKeySize);
+  }
+  return true;
+}
+
+const PresenceKeyCache::Entry *PresenceKeyCache::Find(
+    const ByteArray &key) const {
+  if (key.data == nullptr || key.length != kAuthenticityKeySize) {
+    return nullptr;
+  }
+  for (const Entry &entry : entries_) {
+    if (memcmp(entry.authenticity_key, key.data, kAuthenticityKeySize) == 0) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace nearby
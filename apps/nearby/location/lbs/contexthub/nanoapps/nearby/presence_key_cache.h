@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_PRESENCE_KEY_CACHE_H_
+#define LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_PRESENCE_KEY_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "location/lbs/contexthub/nanoapps/nearby/byte_array.h"
+#include "location/lbs/contexthub/nanoapps/nearby/crypto/aes.h"
+#include "third_party/contexthub/chre/util/include/chre/util/dynamic_vector.h"
+
+namespace nearby {
+
+// Keeps the keys a Presence crypto implementation derives with HKDF from the
+// authenticity keys of the filter certificates, together with the expanded AES
+// round keys. Identities only change when the host updates the filters, so the
+// owner adds the certificate keys on each update and the derivation is done
+// once per identity instead of once per identity for every advertisement.
+// Lookups are read-only, and keys that were not added are derived on the fly.
+class PresenceKeyCache {
+ public:
+  static constexpr size_t kAuthenticityKeySize = 16;
+  static constexpr size_t kEncryptionKeySize = 32;
+  static constexpr size_t kHkdfSaltSize = 16;
+  static constexpr size_t kAesCtrIvSize = 16;
+  static constexpr size_t kHmacKeySize = 16;
+  static constexpr size_t kSaltSize = 2;
+  // Bounds the memory used by the cache. Filters carry at most 10 x 3
+  // certificates, so this is only reached if the host sends more.
+  static constexpr size_t kMaxEntries = 32;
+
+  // encryption_key_salt, iv_salt and hmac_key_salt are the 16 byte HKDF salts
+  // used to derive the encryption key, the AES/CTR IV and the HMAC key.
+  // hmac_key_salt is nullptr if no HMAC key is derived from the authenticity
+  // key. The salts must outlive the cache.
+  PresenceKeyCache(const uint8_t *encryption_key_salt, const uint8_t *iv_salt,
+                   const uint8_t *hmac_key_salt);
+
+  // Derives and keeps the keys of an authenticity key. Returns false if key
+  // has an unexpected length, the cache is full or the keys cannot be
+  // derived.
+  bool Add(const ByteArray &key);
+
+  // Drops all cached keys. Called when the host updates the filters.
+  void Clear();
+
+  // Derives the kAesCtrIvSize bytes AES/CTR IV of an advertisement salt,
+  // which every identity tried against the advertisement shares. The caller
+  // validates the length of salt.
+  void DeriveIv(const ByteArray &salt, uint8_t *iv) const;
+
+  // Initializes ctx for AES/CTR with the encryption key derived from key and
+  // an IV returned by DeriveIv(). The caller validates the length of key.
+  // Returns false if ctx cannot be initialized.
+  bool InitAesCtr(const ByteArray &key, const uint8_t *iv,
+                  AesCtrContext *ctx) const;
+
+  // Writes the kHmacKeySize bytes HMAC key derived from key to hmac_key.
+  // Returns false if the cache has no HMAC key salt or key has an unexpected
+  // length.
+  bool GetHmacKey(const ByteArray &key, uint8_t *hmac_key) const;
+
+ private:
+  struct Entry {
+    uint8_t authenticity_key[kAuthenticityKeySize];
+    // AES/CTR context with the round keys of the derived encryption key.
+    AesCtrContext aes_ctr;
+    uint8_t hmac_key[kHmacKeySize];
+  };
+
+  // Derives the keys of key into entry. Returns false if key has an
+  // unexpected length or the AES round keys cannot be expanded.
+  bool Derive(const ByteArray &key, Entry *entry) const;
+
+  // Returns the entry added for key, or nullptr if there is none.
+  const Entry *Find(const ByteArray &key) const;
+
+  const uint8_t *encryption_key_salt_;
+  const uint8_t *iv_salt_;
+  const uint8_t *hmac_key_salt_;
+
+  chre::DynamicVector<Entry> entries_;
+};
+
+}  // namespace nearby
+
+#endif  // LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_PRESENCE_KEY_CACHE_H_
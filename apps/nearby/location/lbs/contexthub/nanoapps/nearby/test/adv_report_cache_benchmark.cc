@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures AdvReportCache in a crowded venue: every device advertises every
+// 100 ms, rotates a byte of its payload now and then, and is sometimes
+// replaced by a new device. The cache is refreshed after each batch of
+// reports, as the filter extension results are. The same reports are pushed
+// to a cache scanning all of its reports on each push and refresh, as without
+// the address index and expiry wheel, and both must hold the same reports.
+//
+// Usage: adv_report_cache_benchmark [num_devices]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "location/lbs/contexthub/nanoapps/nearby/adv_report_cache.h"
+#include "location/lbs/contexthub/nanoapps/nearby/test/fake_chre_time.h"
+
+namespace nearby {
+namespace {
+
+constexpr uint64_t kBatchPeriodNanosec = 100000000;
+constexpr uint32_t kNumBatches = 600;
+constexpr uint64_t kCacheTimeoutMillisec = 2000;
+constexpr size_t kMaxDataLength = 31;
+
+struct Device {
+  uint8_t address[CHRE_BLE_ADDRESS_LEN];
+  uint8_t data[kMaxDataLength];
+  uint16_t data_length;
+};
+
+// Cache deduplicating and expiring reports by scanning all of them.
+class LinearAdvReportCache {
+ public:
+  void Push(const chreBleAdvertisingReport &report) {
+    for (Entry &entry : entries_) {
+      if (memcmp(entry.address, report.address, CHRE_BLE_ADDRESS_LEN) == 0 &&
+          entry.data_length == report.dataLength &&
+          memcmp(entry.data, report.data, report.dataLength) == 0) {
+        if (report.timestamp > entry.timestamp) {
+          entry.timestamp = report.timestamp;
+        }
+        return;
+      }
+    }
+    Entry entry;
+    memcpy(entry.address, report.address, CHRE_BLE_ADDRESS_LEN);
+    memcpy(entry.data, report.data, report.dataLength);
+    entry.data_length = report.dataLength;
+    entry.timestamp = report.timestamp;
+    entries_.push_back(entry);
+  }
+
+  void Refresh(uint64_t current_time) {
+    for (size_t i = 0; i < entries_.size();) {
+      if (current_time - entries_[i].timestamp >
+          kCacheTimeoutMillisec * 1000000) {
+        entries_[i] = entries_.back();
+        entries_.pop_back();
+      } else {
+        i++;
+      }
+    }
+  }
+
+  size_t size() const {
+    return entries_.size();
+  }
+
+ private:
+  struct Entry {
+    uint8_t address[CHRE_BLE_ADDRESS_LEN];
+    uint8_t data[kMaxDataLength];
+    uint16_t data_length;
+    uint64_t timestamp;
+  };
+
+  std::vector<Entry> entries_;
+};
+
+uint32_t random_state = 1;
+
+uint32_t NextRandom() {
+  random_state = random_state * 1103515245u + 12345u;
+  return random_state >> 8;
+}
+
+void RandomizeAddress(Device *device) {
+  for (uint8_t &byte : device->address) {
+    byte = static_cast<uint8_t>(NextRandom());
+  }
+}
+
+int Run(uint32_t num_devices) {
+  std::vector<Device> devices(num_devices);
+  for (Device &device : devices) {
+    RandomizeAddress(&device);
+    device.data_length = static_cast<uint16_t>(20 + NextRandom() % 12);
+    for (uint8_t &byte : device.data) {
+      byte = static_cast<uint8_t>(NextRandom());
+    }
+  }
+
+  AdvReportCache cache;
+  cache.SetCacheTimeout(kCacheTimeoutMillisec);
+  LinearAdvReportCache linear_cache;
+  std::chrono::duration<double, std::nano> cache_elapsed(0);
+  std::chrono::duration<double, std::nano> linear_elapsed(0);
+  uint32_t num_reports = 0;
+  uint32_t num_mismatches = 0;
+  uint64_t now = 0;
+  for (uint32_t batch = 0; batch < kNumBatches; batch++) {
+    now += kBatchPeriodNanosec;
+    SetFakeChreTime(now);
+    for (Device &device : devices) {
+      if (NextRandom() % 20 == 0) {
+        device.data[NextRandom() % device.data_length]++;
+      }
+      if (NextRandom() % 500 == 0) {
+        RandomizeAddress(&device);
+      }
+      // Missed advertisement.
+      if (NextRandom() % 4 == 0) {
+        continue;
+      }
+      chreBleAdvertisingReport report = {};
+      report.timestamp = now - NextRandom() % (kBatchPeriodNanosec / 2);
+      memcpy(report.address, device.address, CHRE_BLE_ADDRESS_LEN);
+      report.rssi = static_cast<int8_t>(-40 - NextRandom() % 50);
+      report.data = device.data;
+      report.dataLength = device.data_length;
+      num_reports++;
+
+      auto start = std::chrono::steady_clock::now();
+      cache.Push(report);
+      auto middle = std::chrono::steady_clock::now();
+      linear_cache.Push(report);
+      auto end = std::chrono::steady_clock::now();
+      cache_elapsed += middle - start;
+      linear_elapsed += end - middle;
+    }
+    auto start = std::chrono::steady_clock::now();
+    cache.Refresh();
+    auto middle = std::chrono::steady_clock::now();
+    linear_cache.Refresh(now);
+    auto end = std::chrono::steady_clock::now();
+    cache_elapsed += middle - start;
+    linear_elapsed += end - middle;
+    if (cache.GetAdvReports().size() != linear_cache.size()) {
+      num_mismatches++;
+    }
+  }
+
+  printf("%u devices, %u reports in %u batches, %zu cached at the end\n",
+         num_devices, num_reports, kNumBatches, linear_cache.size());
+  printf("address index and expiry wheel: %.0f ns/report\n",
+         cache_elapsed.count() / num_reports);
+  printf("linear scan:                    %.0f ns/report\n",
+         linear_elapsed.count() / num_reports);
+  if (num_mismatches > 0) {
+    printf("%u batches with different cache sizes\n", num_mismatches);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+}  // namespace
+}  // namespace nearby
+
+int main(int argc, char **argv) {
+  uint32_t num_devices =
+      (argc > 1) ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 500;
+  return nearby::Run(num_devices == 0 ? 1 : num_devices);
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "location/lbs/contexthub/nanoapps/nearby/adv_report_cache.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "location/lbs/contexthub/nanoapps/nearby/test/fake_chre_time.h"
+
+namespace nearby {
+namespace {
+
+constexpr uint64_t kOneSecondInNanoseconds = 1000000000;
+
+class AdvReportCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    SetFakeChreTime(0);
+  }
+
+  // Returns a report of the device with id, advertising data as its payload.
+  chreBleAdvertisingReport MakeReport(uint32_t id, uint8_t data,
+                                      uint64_t timestamp, int8_t rssi) {
+    chreBleAdvertisingReport report = {};
+    report.timestamp = timestamp;
+    memcpy(report.address, &id, sizeof(id));
+    report.rssi = rssi;
+    data_[id % kMaxDevices] = data;
+    report.data = &data_[id % kMaxDevices];
+    report.dataLength = 1;
+    return report;
+  }
+
+  static constexpr uint32_t kMaxDevices = 4096;
+  uint8_t data_[kMaxDevices];
+  AdvReportCache cache_;
+};
+
+TEST_F(AdvReportCacheTest, DeduplicatesByAddressAndData) {
+  cache_.Push(MakeReport(1, 0xAA, 10, -80));
+  cache_.Push(MakeReport(1, 0xAA, 30, -60));
+  cache_.Push(MakeReport(1, 0xAA, 20, -70));
+  cache_.Push(MakeReport(1, 0xBB, 40, -50));
+  cache_.Push(MakeReport(2, 0xAA, 50, -40));
+
+  chre::DynamicVector<chreBleAdvertisingReport> &reports =
+      cache_.GetAdvReports();
+  ASSERT_EQ(reports.size(), 3);
+  // The highest RSSI and latest timestamp are kept.
+  EXPECT_EQ(reports[0].rssi, -60);
+  EXPECT_EQ(reports[0].timestamp, 30);
+  EXPECT_EQ(reports[0].data[0], 0xAA);
+  EXPECT_EQ(reports[1].data[0], 0xBB);
+  EXPECT_EQ(reports[2].address[0], 2);
+}
+
+TEST_F(AdvReportCacheTest, ExpiresReportsOlderThanTheTimeout) {
+  cache_.SetCacheTimeout(1000);
+  for (uint32_t i = 0; i < 100; i++) {
+    cache_.Push(MakeReport(i, 0, i * kOneSecondInNanoseconds / 100, -50));
+  }
+  // Reports of the first half second are more than one second old.
+  SetFakeChreTime(kOneSecondInNanoseconds * 3 / 2);
+  chre::DynamicVector<chreBleAdvertisingReport> &reports =
+      cache_.GetAdvReports();
+  ASSERT_EQ(reports.size(), 50);
+  for (const chreBleAdvertisingReport &report : reports) {
+    EXPECT_GE(report.timestamp, kOneSecondInNanoseconds / 2);
+  }
+
+  // A duplicate extends the lifetime of its report.
+  cache_.Push(MakeReport(60, 0, 2 * kOneSecondInNanoseconds, -50));
+  SetFakeChreTime(kOneSecondInNanoseconds * 5 / 2);
+  ASSERT_EQ(cache_.GetAdvReports().size(), 1);
+  EXPECT_EQ(cache_.GetAdvReports()[0].address[0], 60);
+}
+
+TEST_F(AdvReportCacheTest, FindsReportsAfterRemovalsAndGrowth) {
+  cache_.SetCacheTimeout(1000);
+  constexpr uint32_t kNumDevices = 1000;
+  for (uint32_t i = 0; i < kNumDevices; i++) {
+    // Odd devices expire first.
+    uint64_t timestamp = (i % 2 == 0) ? kOneSecondInNanoseconds : 0;
+    cache_.Push(MakeReport(i, static_cast<uint8_t>(i), timestamp, -90));
+  }
+  SetFakeChreTime(kOneSecondInNanoseconds * 3 / 2);
+  cache_.Refresh();
+  ASSERT_EQ(cache_.GetAdvReports().size(), kNumDevices / 2);
+
+  // Remaining reports are found as duplicates.
+  for (uint32_t i = 0; i < kNumDevices; i += 2) {
+    cache_.Push(MakeReport(i, static_cast<uint8_t>(i),
+                           kOneSecondInNanoseconds * 6 / 5, -10));
+  }
+  chre::DynamicVector<chreBleAdvertisingReport> &reports =
+      cache_.GetAdvReports();
+  ASSERT_EQ(reports.size(), kNumDevices / 2);
+  for (const chreBleAdvertisingReport &report : reports) {
+    EXPECT_EQ(report.rssi, -10);
+  }
+}
+
+TEST_F(AdvReportCacheTest, ClearEmptiesTheCache) {
+  cache_.SetCacheTimeout(1000);
+  cache_.Push(MakeReport(1, 0xAA, 0, -80));
+  cache_.Clear();
+  EXPECT_EQ(cache_.GetAdvReports().size(), 0);
+  cache_.Push(MakeReport(1, 0xAA, 0, -80));
+  EXPECT_EQ(cache_.GetAdvReports().size(), 1);
+}
+
+}  // namespace
+}  // namespace nearby
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the AES/CTR throughput for the lengths decrypted by Presence, one
+// to five blocks, and for bulk data. Build it with the same AES options as
+// aes.c to name the block function in the output.
+//
+// Usage: aes_benchmark [total_bytes_per_length]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "location/lbs/contexthub/nanoapps/nearby/crypto/aes.h"
+
+namespace nearby {
+namespace {
+
+#if defined(__AES__) && defined(__SSE2__) && !defined(AES_DISABLE_HW)
+constexpr char kBlockFunction[] = "AES-NI";
+#elif defined(AES_FULL_TABLES)
+constexpr char kBlockFunction[] = "full tables";
+#else
+constexpr char kBlockFunction[] = "portable";
+#endif
+
+constexpr size_t kLengths[] = {16, 32, 48, 64, 80, 256, 4096};
+
+// Returns the throughput of aesCtr() over length byte calls in MB/s.
+double MeasureThroughput(AesKeyType key_type, size_t length,
+                         size_t total_bytes) {
+  uint8_t key[AES_KEY_MAX_WORDS * 4] = {1, 2, 3};
+  uint8_t iv[AES_BLOCK_SIZE] = {0};
+  std::vector<uint8_t> data(length);
+  AesCtrContext ctx;
+  aesCtrInit(&ctx, key, iv, key_type);
+  size_t iterations = total_bytes / length;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; i++) {
+    aesCtr(&ctx, data.data(), data.data(), length);
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return iterations * length / elapsed.count() / 1e6;
+}
+
+int Run(size_t total_bytes) {
+  printf("AES/CTR with the %s block function\n", kBlockFunction);
+  printf("%6s %12s %12s\n", "bytes", "AES-128 MB/s", "AES-256 MB/s");
+  for (size_t length : kLengths) {
+    printf("%6zu %12.1f %12.1f\n", length,
+           MeasureThroughput(AES_128_KEY_TYPE, length, total_bytes),
+           MeasureThroughput(AES_256_KEY_TYPE, length, total_bytes));
+  }
+  return EXIT_SUCCESS;
+}
+
+}  // namespace
+}  // namespace nearby
+
+int main(int argc, char **argv) {
+  size_t total_bytes =
+      (argc > 1) ? strtoul(argv[1], nullptr, 10) : 16 * 1024 * 1024;
+  return nearby::Run(total_bytes < 4096 ? 4096 : total_bytes);
+}
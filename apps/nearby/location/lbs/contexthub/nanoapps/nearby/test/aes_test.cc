@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Known answer tests of the AES/CTR implementation. aes.c picks its block
+// function at build time, so these tests must be run with aes.c built each
+// way: with no option for the portable code, with -DAES_FULL_TABLES, and
+// with -maes for AES-NI (-DAES_DISABLE_HW with -maes for the portable code).
+
+#include "location/lbs/contexthub/nanoapps/nearby/crypto/aes.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+namespace nearby {
+namespace {
+
+// FIPS-197 appendix C.1 and C.3.
+constexpr uint8_t kFipsPlaintext[] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55,
+                                      0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb,
+                                      0xcc, 0xdd, 0xee, 0xff};
+constexpr uint8_t kFipsKey[] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a,
+    0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15,
+    0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f};
+constexpr uint8_t kFips128Ciphertext[] = {0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b,
+                                          0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80,
+                                          0x70, 0xb4, 0xc5, 0x5a};
+constexpr uint8_t kFips256Ciphertext[] = {0x8e, 0xa2, 0xb7, 0xca, 0x51, 0x67,
+                                          0x45, 0xbf, 0xea, 0xfc, 0x49, 0x90,
+                                          0x4b, 0x49, 0x60, 0x89};
+
+// SP 800-38A F.5.1 and F.5.5, with a fifth block repeating the first
+// plaintext block so that tails after four blocks are covered.
+constexpr size_t kCtrLength = 5 * AES_BLOCK_SIZE;
+constexpr uint8_t kCtrCounter[] = {0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5,
+                                   0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb,
+                                   0xfc, 0xfd, 0xfe, 0xff};
+constexpr uint8_t kCtrPlaintext[kCtrLength] = {
+    0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11,
+    0x73, 0x93, 0x17, 0x2a, 0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c,
+    0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51, 0x30, 0xc8, 0x1c, 0x46,
+    0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+    0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b,
+    0xe6, 0x6c, 0x37, 0x10, 0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96,
+    0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a};
+constexpr uint8_t kCtr128Key[] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae,
+                                  0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88,
+                                  0x09, 0xcf, 0x4f, 0x3c};
+constexpr uint8_t kCtr128Ciphertext[kCtrLength] = {
+    0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64,
+    0x99, 0x0d, 0xb6, 0xce, 0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff,
+    0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff, 0x5a, 0xe4, 0xdf, 0x3e,
+    0xdb, 0xd5, 0xd3, 0x5e, 0x5b, 0x4f, 0x09, 0x02, 0x0d, 0xb0, 0x3e, 0xab,
+    0x1e, 0x03, 0x1d, 0xda, 0x2f, 0xbe, 0x03, 0xd1, 0x79, 0x21, 0x70, 0xa0,
+    0xf3, 0x00, 0x9c, 0xee, 0xdb, 0xcc, 0xf9, 0x1a, 0x3a, 0xca, 0x0e, 0x98,
+    0x19, 0x55, 0x4e, 0x86, 0xe3, 0xd8, 0xb2, 0x28};
+constexpr uint8_t kCtr256Key[] = {
+    0x60, 0x3d, 0xeb, 0x10, 0x15, 0xca, 0x71, 0xbe, 0x2b, 0x73, 0xae,
+    0xf0, 0x85, 0x7d, 0x77, 0x81, 0x1f, 0x35, 0x2c, 0x07, 0x3b, 0x61,
+    0x08, 0xd7, 0x2d, 0x98, 0x10, 0xa3, 0x09, 0x14, 0xdf, 0xf4};
+constexpr uint8_t kCtr256Ciphertext[kCtrLength] = {
+    0x60, 0x1e, 0xc3, 0x13, 0x77, 0x57, 0x89, 0xa5, 0xb7, 0xa7, 0xf5, 0x04,
+    0xbb, 0xf3, 0xd2, 0x28, 0xf4, 0x43, 0xe3, 0xca, 0x4d, 0x62, 0xb5, 0x9a,
+    0xca, 0x84, 0xe9, 0x90, 0xca, 0xca, 0xf5, 0xc5, 0x2b, 0x09, 0x30, 0xda,
+    0xa2, 0x3d, 0xe9, 0x4c, 0xe8, 0x70, 0x17, 0xba, 0x2d, 0x84, 0x98, 0x8d,
+    0xdf, 0xc9, 0xc5, 0x8d, 0xb6, 0x7a, 0xad, 0xa6, 0x13, 0xc2, 0xdd, 0x08,
+    0x45, 0x79, 0x41, 0xa6, 0xe0, 0xb6, 0x41, 0x02, 0xf7, 0x3c, 0x96, 0x04,
+    0x3e, 0xca, 0x70, 0x0d, 0x9a, 0x5c, 0xd4, 0x9d};
+
+// AES-128/CTR key stream of kCtr128Key from counter 0xff..fe, which wraps to
+// zero on the third block.
+constexpr uint8_t kWrapCounter[] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                                    0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                                    0xff, 0xff, 0xff, 0xfe};
+constexpr uint8_t kWrapKeystream[kCtrLength] = {
+    0xd1, 0xb7, 0x14, 0xb6, 0xfb, 0xf5, 0xff, 0xf1, 0x28, 0x9a, 0xee, 0x2a,
+    0x4c, 0x4e, 0xed, 0xa3, 0x8a, 0xf2, 0x86, 0x01, 0x42, 0xf7, 0x86, 0xf4,
+    0x09, 0x30, 0x7c, 0x1a, 0x3f, 0x7e, 0xaa, 0xac, 0x7d, 0xf7, 0x6b, 0x0c,
+    0x1a, 0xb8, 0x99, 0xb3, 0x3e, 0x42, 0xf0, 0x47, 0xb9, 0x1b, 0x54, 0x6f,
+    0x57, 0x12, 0x7d, 0x40, 0x34, 0xb1, 0xbe, 0xbf, 0xae, 0xf4, 0x66, 0xb9,
+    0xc7, 0x72, 0x6f, 0xc6, 0x97, 0x3f, 0x2e, 0xf3, 0x48, 0x79, 0xe2, 0x02,
+    0x7f, 0x17, 0x34, 0x30, 0x3f, 0xf2, 0x1f, 0x89};
+
+struct CtrVector {
+  const uint8_t *key;
+  size_t key_length;
+  AesKeyType key_type;
+  const uint8_t *ciphertext;
+};
+
+constexpr CtrVector kCtrVectors[] = {
+    {kCtr128Key, sizeof(kCtr128Key), AES_128_KEY_TYPE, kCtr128Ciphertext},
+    {kCtr256Key, sizeof(kCtr256Key), AES_256_KEY_TYPE, kCtr256Ciphertext},
+};
+
+TEST(AesTest, EncryptsFips197Blocks) {
+  // The CTR key stream of a counter block is its encryption.
+  uint8_t zero[AES_BLOCK_SIZE] = {0};
+  uint8_t output[AES_BLOCK_SIZE];
+  AesCtrContext ctx;
+  ASSERT_EQ(aesCtrInit(&ctx, kFipsKey, kFipsPlaintext, AES_128_KEY_TYPE), 0);
+  aesCtr(&ctx, zero, output, sizeof(output));
+  EXPECT_EQ(memcmp(output, kFips128Ciphertext, sizeof(output)), 0);
+
+  ASSERT_EQ(aesCtrInit(&ctx, kFipsKey, kFipsPlaintext, AES_256_KEY_TYPE), 0);
+  aesCtr(&ctx, zero, output, sizeof(output));
+  EXPECT_EQ(memcmp(output, kFips256Ciphertext, sizeof(output)), 0);
+}
+
+TEST(AesTest, MatchesSp80038aForEveryLengthUpToFiveBlocks) {
+  for (const CtrVector &vector : kCtrVectors) {
+    for (size_t length = 1; length <= kCtrLength; length++) {
+      // Unaligned key, source and destination.
+      uint8_t key[AES_KEY_MAX_WORDS * 4 + 1];
+      uint8_t input[kCtrLength + 1];
+      uint8_t output[kCtrLength + 3];
+      memcpy(&key[1], vector.key, vector.key_length);
+      memcpy(&input[1], kCtrPlaintext, length);
+      AesCtrContext ctx;
+      ASSERT_EQ(aesCtrInit(&ctx, &key[1], kCtrCounter, vector.key_type), 0);
+      aesCtr(&ctx, &input[1], &output[3], length);
+      EXPECT_EQ(memcmp(&output[3], vector.ciphertext, length), 0)
+          << "key type " << vector.key_type << ", length " << length;
+    }
+  }
+}
+
+TEST(AesTest, DecryptsInPlace) {
+  for (const CtrVector &vector : kCtrVectors) {
+    uint8_t data[kCtrLength];
+    memcpy(data, vector.ciphertext, sizeof(data));
+    AesCtrContext ctx;
+    ASSERT_EQ(aesCtrInit(&ctx, vector.key, kCtrCounter, vector.key_type), 0);
+    aesCtr(&ctx, data, data, sizeof(data));
+    EXPECT_EQ(memcmp(data, kCtrPlaintext, sizeof(data)), 0);
+  }
+}
+
+TEST(AesTest, ContinuesTheCounterAcrossCalls) {
+  // Each call uses a new counter block for its first byte, so calls of whole
+  // blocks produce the same stream as a single call.
+  for (const CtrVector &vector : kCtrVectors) {
+    for (size_t first_blocks = 0; first_blocks <= 5; first_blocks++) {
+      size_t first_length = first_blocks * AES_BLOCK_SIZE;
+      uint8_t output[kCtrLength];
+      AesCtrContext ctx;
+      ASSERT_EQ(aesCtrInit(&ctx, vector.key, kCtrCounter, vector.key_type), 0);
+      aesCtr(&ctx, kCtrPlaintext, output, first_length);
+      aesCtr(&ctx, &kCtrPlaintext[first_length], &output[first_length],
+             kCtrLength - first_length);
+      EXPECT_EQ(memcmp(output, vector.ciphertext, kCtrLength), 0)
+          << "key type " << vector.key_type << ", split " << first_length;
+    }
+  }
+}
+
+TEST(AesTest, WrapsTheCounter) {
+  for (size_t length = 1; length <= kCtrLength; length++) {
+    uint8_t zero[kCtrLength] = {0};
+    uint8_t output[kCtrLength];
+    AesCtrContext ctx;
+    ASSERT_EQ(aesCtrInit(&ctx, kCtr128Key, kWrapCounter, AES_128_KEY_TYPE), 0);
+    aesCtr(&ctx, zero, output, length);
+    EXPECT_EQ(memcmp(output, kWrapKeystream, length), 0) << "length " << length;
+  }
+}
+
+TEST(AesTest, RejectsUnsupportedKeyTypes) {
+  AesCtrContext ctx;
+  EXPECT_NE(aesCtrInit(&ctx, kFipsKey, kCtrCounter, AES_192_KEY_TYPE), 0);
+}
+
+}  // namespace
+}  // namespace nearby
@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "location/lbs/contexthub/nanoapps/nearby/test/fake_chre_time.h"
+
+#include "chre_api/chre.h"
+
+namespace nearby {
+namespace {
+
+uint64_t fake_time_nanosec = 0;
+
+}  // namespace
+
+void SetFakeChreTime(uint64_t time_nanosec) {
+  fake_time_nanosec = time_nanosec;
+}
+
+}  // namespace nearby
+
+uint64_t chreGetTime() {
+  return nearby::fake_time_nanosec;
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the cost of matching Fast Pair subsequent pair advertisements
+// against a filter with many account keys, with the key digests kept per salt
+// by FastPairFilterState, and with every key hashed for every report as
+// without the digest table. Devices repeat their advertisement, with the same
+// salt, until they rotate it.
+//
+// Usage: fast_pair_filter_benchmark [num_reports]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "location/lbs/contexthub/nanoapps/nearby/fast_pair_filter.h"
+#include "location/lbs/contexthub/nanoapps/nearby/test/fast_pair_test_util.h"
+
+namespace nearby {
+namespace {
+
+// The most account keys of a filter.
+constexpr uint32_t kNumKeys = 8;
+// Devices advertising at once, one of which has a key of the filter.
+constexpr uint32_t kNumDevices = 4;
+// Reports of a device before it rotates its salt.
+constexpr uint32_t kReportsPerSalt = 16;
+constexpr size_t kMaxScanRecordSize = 64;
+
+struct Report {
+  uint8_t data[kMaxScanRecordSize];
+  size_t length;
+};
+
+// Matches every report, returning the number of matches and the mean time
+// per report in nanoseconds.
+template <typename MatchFunction>
+uint32_t MatchReports(const std::vector<Report> &reports, MatchFunction match,
+                      double *ns_per_report) {
+  uint32_t num_matches = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (const Report &report : reports) {
+    BleScanRecord record = BleScanRecord::Parse(
+        report.data, static_cast<uint16_t>(report.length));
+    if (match(record)) {
+      num_matches++;
+    }
+  }
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  *ns_per_report = elapsed.count() / reports.size();
+  return num_matches;
+}
+
+int Run(uint32_t num_reports) {
+  uint8_t keys[kNumKeys + kNumDevices][kFastPairTestAccountKeyLength];
+  for (uint32_t i = 0; i < kNumKeys + kNumDevices; i++) {
+    for (size_t j = 0; j < kFastPairTestAccountKeyLength; j++) {
+      keys[i][j] = static_cast<uint8_t>(i * 31 + j * 7 + 1);
+    }
+  }
+  nearby_BleFilter filter = nearby_BleFilter_init_zero;
+  for (uint32_t i = 0; i < kNumKeys; i++) {
+    AddFastPairTestAccountKey(keys[i], &filter);
+  }
+
+  std::vector<Report> reports(num_reports);
+  for (uint32_t i = 0; i < num_reports; i++) {
+    uint32_t device = i % kNumDevices;
+    FastPairTestAdvertisement advertisement;
+    // Device 0 has the last key of the filter, the others keys of other
+    // users.
+    advertisement.account_key =
+        (device == 0) ? keys[kNumKeys - 1] : keys[kNumKeys + device];
+    advertisement.version = 1;
+    advertisement.rrd_length = 2;
+    advertisement.salt = static_cast<uint16_t>(
+        device * 4099 + i / (kNumDevices * kReportsPerSalt));
+    reports[i].length = MakeFastPairScanRecord(advertisement, reports[i].data,
+                                               sizeof(reports[i].data));
+  }
+
+  FastPairFilterState state;
+  state.Init(filter);
+  double state_ns;
+  uint32_t state_matches = MatchReports(
+      reports,
+      [&state](const BleScanRecord &record) {
+        nearby_BleFilterResult result = nearby_BleFilterResult_init_zero;
+        return state.Match(record, &result);
+      },
+      &state_ns);
+  double reference_ns;
+  uint32_t reference_matches = MatchReports(
+      reports,
+      [&filter](const BleScanRecord &record) {
+        const BleServiceData *service_data = nullptr;
+        return MatchFastPairReference(filter, record, &service_data) !=
+               nullptr;
+      },
+      &reference_ns);
+  printf("%u reports, %u account keys, %u devices, %u reports per salt\n",
+         num_reports, kNumKeys, kNumDevices, kReportsPerSalt);
+  printf("digests kept per salt:  %.0f ns/report, %u matches\n", state_ns,
+         state_matches);
+  printf("keys hashed per report: %.0f ns/report, %u matches\n",
+         reference_ns, reference_matches);
+  return state_matches == reference_matches ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+}  // namespace
+}  // namespace nearby
+
+int main(int argc, char **argv) {
+  uint32_t num_reports =
+      (argc > 1) ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 4096;
+  return nearby::Run(num_reports == 0 ? 1 : num_reports);
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "location/lbs/contexthub/nanoapps/nearby/fast_pair_filter.h"
+
+#include <cstring>
+#include <iterator>
+
+#include "gtest/gtest.h"
+#include "location/lbs/contexthub/nanoapps/nearby/test/fast_pair_test_util.h"
+
+namespace nearby {
+namespace {
+
+constexpr size_t kNumKeys = 4;
+constexpr uint8_t kAccountKeyFirstBytes[] = {0, 0b00000100, 0b00000101,
+                                             0b00000110};
+
+class FastPairFilterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    for (size_t i = 0; i < kNumKeys + 1; i++) {
+      for (size_t j = 0; j < kFastPairTestAccountKeyLength; j++) {
+        keys_[i][j] = static_cast<uint8_t>(0x11 * (i + 1) + j);
+      }
+    }
+    // The last key is of another user.
+    for (size_t i = 0; i < kNumKeys; i++) {
+      AddFastPairTestAccountKey(keys_[i], &filter_);
+    }
+    state_.Init(filter_);
+  }
+
+  // Matches the scan record in data with state_, checking that the matched
+  // account key and service data are the ones of the reference matching.
+  // Returns the index of the matched key in keys_, or -1.
+  int MatchAndCompare(const uint8_t *data, size_t length) {
+    BleScanRecord record =
+        BleScanRecord::Parse(data, static_cast<uint16_t>(length));
+    const BleServiceData *expected_service_data = nullptr;
+    const uint8_t *expected_key =
+        MatchFastPairReference(filter_, record, &expected_service_data);
+    nearby_BleFilterResult result = nearby_BleFilterResult_init_zero;
+    bool matched = state_.Match(record, &result);
+    EXPECT_EQ(matched, expected_key != nullptr);
+    if (!matched || expected_key == nullptr) {
+      return -1;
+    }
+    EXPECT_EQ(result.data_element_count, 1);
+    EXPECT_EQ(memcmp(result.data_element[0].value, expected_key,
+                     kFastPairTestAccountKeyLength),
+              0);
+    EXPECT_EQ(result.ble_service_data[0], expected_service_data->length + 2);
+    EXPECT_EQ(memcmp(&result.ble_service_data[3], expected_service_data->data,
+                     expected_service_data->length),
+              0);
+    for (size_t i = 0; i < kNumKeys + 1; i++) {
+      if (memcmp(keys_[i], expected_key, kFastPairTestAccountKeyLength) ==
+          0) {
+        return static_cast<int>(i);
+      }
+    }
+    return -1;
+  }
+
+  int Match(const FastPairTestAdvertisement &advertisement) {
+    uint8_t data[64];
+    size_t length = MakeFastPairScanRecord(advertisement, data, sizeof(data));
+    EXPECT_GT(length, 0);
+    return MatchAndCompare(data, length);
+  }
+
+  uint8_t keys_[kNumKeys + 1][kFastPairTestAccountKeyLength];
+  nearby_BleFilter filter_ = nearby_BleFilter_init_zero;
+  FastPairFilterState state_;
+};
+
+TEST_F(FastPairFilterTest, MatchesTheAccountKeyOfTheAdvertisement) {
+  for (size_t i = 0; i < kNumKeys; i++) {
+    FastPairTestAdvertisement advertisement;
+    advertisement.account_key = keys_[i];
+    advertisement.salt = 0x1234;
+    EXPECT_EQ(Match(advertisement), static_cast<int>(i));
+  }
+}
+
+TEST_F(FastPairFilterTest, DoesNotMatchKeysOfOtherUsers) {
+  FastPairTestAdvertisement advertisement;
+  advertisement.account_key = keys_[kNumKeys];
+  advertisement.salt = 0x1234;
+  EXPECT_EQ(Match(advertisement), -1);
+  advertisement.account_key = nullptr;
+  EXPECT_EQ(Match(advertisement), -1);
+}
+
+TEST_F(FastPairFilterTest, MatchesAccountKeyFirstBytesWithRrd) {
+  for (uint8_t version = 0; version < 2; version++) {
+    for (uint8_t first_byte : kAccountKeyFirstBytes) {
+      FastPairTestAdvertisement advertisement;
+      advertisement.account_key = keys_[2];
+      advertisement.account_key_first_byte = first_byte;
+      advertisement.version = version;
+      advertisement.rrd_length = 2;
+      advertisement.salt = 0x4321;
+      EXPECT_EQ(Match(advertisement), 2);
+    }
+  }
+}
+
+TEST_F(FastPairFilterTest, RepeatedSaltIsMatchedAgainstItsOwnBloomFilter) {
+  // The digests of a salt are kept, but the Bloom filter of each
+  // advertisement must still be tested.
+  FastPairTestAdvertisement advertisement;
+  advertisement.salt = 0xABCD;
+  for (int round = 0; round < 2; round++) {
+    for (size_t i = 0; i < kNumKeys + 1; i++) {
+      advertisement.account_key = keys_[i];
+      EXPECT_EQ(Match(advertisement),
+                (i < kNumKeys) ? static_cast<int>(i) : -1);
+    }
+    advertisement.account_key = nullptr;
+    EXPECT_EQ(Match(advertisement), -1);
+  }
+}
+
+TEST_F(FastPairFilterTest, MatchesTheFirstKeyOverServiceData) {
+  // Keys are tried in the filter order, each against every service data.
+  FastPairTestAdvertisement first;
+  first.account_key = keys_[3];
+  first.salt = 0x0101;
+  FastPairTestAdvertisement second;
+  second.account_key = keys_[1];
+  second.salt = 0x0202;
+  uint8_t data[128];
+  size_t length = MakeFastPairScanRecord(first, data, sizeof(data));
+  length +=
+      MakeFastPairScanRecord(second, &data[length], sizeof(data) - length);
+  EXPECT_EQ(MatchAndCompare(data, length), 1);
+}
+
+TEST_F(FastPairFilterTest, AgreesWithReferenceOnRandomAdvertisements) {
+  uint32_t state = 1;
+  auto next = [&state]() {
+    state = state * 1103515245u + 12345u;
+    return state >> 16;
+  };
+  int num_matches = 0;
+  for (int i = 0; i < 2000; i++) {
+    FastPairTestAdvertisement advertisement;
+    uint32_t key = next() % (kNumKeys + 2);
+    advertisement.account_key = (key <= kNumKeys) ? keys_[key] : nullptr;
+    advertisement.version = next() % 2;
+    advertisement.filter_length = 1 + next() % 9;
+    // Few salts, so that devices repeat the salts of others.
+    advertisement.salt = static_cast<uint16_t>(next() % 6);
+    advertisement.battery[0] = static_cast<uint8_t>(next() % 2);
+    if (next() % 2 == 0) {
+      advertisement.rrd_length = 1 + next() % 2;
+      advertisement.account_key_first_byte =
+          kAccountKeyFirstBytes[next() % std::size(kAccountKeyFirstBytes)];
+    }
+    if (Match(advertisement) >= 0) {
+      num_matches++;
+    }
+  }
+  EXPECT_GT(num_matches, 0);
+}
+
+TEST_F(FastPairFilterTest, AgreesWithReferenceAfterFilterUpdate) {
+  FastPairTestAdvertisement advertisement;
+  advertisement.account_key = keys_[kNumKeys];
+  advertisement.salt = 0x5555;
+  EXPECT_EQ(Match(advertisement), -1);
+
+  filter_ = nearby_BleFilter_init_zero;
+  AddFastPairTestAccountKey(keys_[kNumKeys], &filter_);
+  state_.Init(filter_);
+  EXPECT_EQ(Match(advertisement), static_cast<int>(kNumKeys));
+}
+
+TEST_F(FastPairFilterTest, MatchesInitialPair) {
+  uint8_t zero_key[kFastPairTestAccountKeyLength] = {0};
+  AddFastPairTestAccountKey(zero_key, &filter_);
+  state_.Init(filter_);
+  // Model ID service data.
+  uint8_t data[] = {0x06, 0x16, 0x2C, 0xFE, 0x01, 0x02, 0x03};
+  BleScanRecord record = BleScanRecord::Parse(data, sizeof(data));
+  nearby_BleFilterResult result = nearby_BleFilterResult_init_zero;
+  ASSERT_TRUE(state_.Match(record, &result));
+  EXPECT_EQ(result.result_type,
+            nearby_BleFilterResult_ResultType_RESULT_FAST_PAIR);
+  EXPECT_EQ(result.ble_service_data[0], 5);
+}
+
+}  // namespace
+}  // namespace nearby
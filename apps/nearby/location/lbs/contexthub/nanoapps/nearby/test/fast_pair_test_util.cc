@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "location/lbs/contexthub/nanoapps/nearby/test/fast_pair_test_util.h"
+
+#include <cstring>
+
+#include "location/lbs/contexthub/nanoapps/nearby/bloom_filter.h"
+#include "location/lbs/contexthub/nanoapps/nearby/crypto/sha2.h"
+#include "location/lbs/contexthub/nanoapps/nearby/fast_pair_account_data.h"
+
+namespace nearby {
+namespace {
+
+constexpr uint16_t kFastPairUuid = 0xFE2C;
+constexpr uint8_t kServiceDataType = 0x16;
+constexpr uint8_t kAccountFilterType = 0b0000;
+constexpr uint8_t kSaltType = 0b0001;
+constexpr uint8_t kBatteryType = 0b0011;
+constexpr uint8_t kRrdType = 0b0110;
+constexpr uint8_t kAccountKeyFirstBytes[] = {0b00000100, 0b00000101,
+                                             0b00000110};
+constexpr size_t kMaxBloomFilterKeyLength = kFastPairTestAccountKeyLength + 48;
+
+// Sets the bits of key in the Bloom filter of a Fast Pair advertisement.
+void AddToBloomFilter(const uint8_t *key, size_t length, uint8_t *filter,
+                      size_t filter_length) {
+  uint32_t hash[SHA2_HASH_WORDS];
+  sha256(key, static_cast<uint32_t>(length), hash, sizeof(hash));
+  for (uint32_t word : hash) {
+    uint32_t bit = __builtin_bswap32(word) % (filter_length * 8);
+    filter[bit / 8] |= static_cast<uint8_t>(1 << (bit % 8));
+  }
+}
+
+}  // namespace
+
+void AddFastPairTestAccountKey(const uint8_t *account_key,
+                               nearby_BleFilter *filter) {
+  nearby_DataElement &data_element =
+      filter->data_element[filter->data_element_count++];
+  data_element.has_key = true;
+  data_element.key = nearby_DataElement_ElementType_DE_FAST_PAIR_ACCOUNT_KEY;
+  data_element.has_value = true;
+  data_element.has_value_length = true;
+  data_element.value_length = kFastPairTestAccountKeyLength;
+  memcpy(data_element.value, account_key, kFastPairTestAccountKeyLength);
+}
+
+size_t MakeFastPairServiceData(const FastPairTestAdvertisement &advertisement,
+                               uint8_t *data, size_t size) {
+  size_t length = 1 + 1 + advertisement.filter_length + 1 + 2 + 1 +
+                  sizeof(advertisement.battery);
+  if (advertisement.rrd_length > 0) {
+    length += 1 + advertisement.rrd_length;
+  }
+  if (length > size) {
+    return 0;
+  }
+  size_t index = 0;
+  data[index++] = static_cast<uint8_t>(advertisement.version << 4);
+  data[index++] = static_cast<uint8_t>(advertisement.filter_length << 4) |
+                  kAccountFilterType;
+  uint8_t *filter = &data[index];
+  memset(filter, 0, advertisement.filter_length);
+  index += advertisement.filter_length;
+  // The salt, battery and RRD with their headers follow the account key in
+  // the Bloom filter key.
+  size_t salt_index = index;
+  data[index++] = (2 << 4) | kSaltType;
+  data[index++] = static_cast<uint8_t>(advertisement.salt >> 8);
+  data[index++] = static_cast<uint8_t>(advertisement.salt);
+  size_t battery_index = index;
+  data[index++] =
+      static_cast<uint8_t>(sizeof(advertisement.battery) << 4) | kBatteryType;
+  memcpy(&data[index], advertisement.battery, sizeof(advertisement.battery));
+  index += sizeof(advertisement.battery);
+  size_t rrd_index = index;
+  if (advertisement.rrd_length > 0) {
+    data[index++] =
+        static_cast<uint8_t>(advertisement.rrd_length << 4) | kRrdType;
+    memcpy(&data[index], advertisement.rrd, advertisement.rrd_length);
+    index += advertisement.rrd_length;
+  }
+
+  if (advertisement.account_key != nullptr) {
+    uint8_t key[kMaxBloomFilterKeyLength];
+    size_t pos = 0;
+    memcpy(key, advertisement.account_key, kFastPairTestAccountKeyLength);
+    if (advertisement.account_key_first_byte != 0) {
+      key[0] = advertisement.account_key_first_byte;
+    }
+    pos += kFastPairTestAccountKeyLength;
+    // The salt value, then the battery with its header.
+    memcpy(&key[pos], &data[salt_index + 1], 2);
+    pos += 2;
+    memcpy(&key[pos], &data[battery_index], rrd_index - battery_index);
+    pos += rrd_index - battery_index;
+    if (advertisement.version == 1) {
+      memcpy(&key[pos], &data[rrd_index], index - rrd_index);
+      pos += index - rrd_index;
+    }
+    AddToBloomFilter(key, pos, filter, advertisement.filter_length);
+  }
+  return length;
+}
+
+size_t MakeFastPairScanRecord(const FastPairTestAdvertisement &advertisement,
+                              uint8_t *data, size_t size) {
+  constexpr size_t kHeaderLength = 4;
+  if (size < kHeaderLength) {
+    return 0;
+  }
+  size_t length = MakeFastPairServiceData(
+      advertisement, &data[kHeaderLength], size - kHeaderLength);
+  if (length == 0) {
+    return 0;
+  }
+  data[0] = static_cast<uint8_t>(length + 3);
+  data[1] = kServiceDataType;
+  data[2] = static_cast<uint8_t>(kFastPairUuid);
+  data[3] = static_cast<uint8_t>(kFastPairUuid >> 8);
+  return length + kHeaderLength;
+}
+
+const uint8_t *MatchFastPairReference(
+    const nearby_BleFilter &filter, const BleScanRecord &scan_record,
+    const BleServiceData **matched_service_data) {
+  for (int i = 0; i < filter.data_element_count; i++) {
+    const nearby_DataElement &data_element = filter.data_element[i];
+    if (data_element.key !=
+            nearby_DataElement_ElementType_DE_FAST_PAIR_ACCOUNT_KEY ||
+        data_element.value_length != kFastPairTestAccountKeyLength) {
+      continue;
+    }
+    for (const BleServiceData &service_data : scan_record.service_data) {
+      if (service_data.uuid != kFastPairUuid || service_data.length == 3) {
+        continue;
+      }
+      FastPairAccountData account_data = FastPairAccountData::Parse(ByteArray(
+          const_cast<uint8_t *>(service_data.data), service_data.length));
+      if (!account_data.is_valid ||
+          account_data.filter.length > BloomFilter::kMaxBloomFilterByteSize) {
+        continue;
+      }
+      BloomFilter bloom_filter(account_data.filter.data,
+                               account_data.filter.length);
+      uint8_t key[kMaxBloomFilterKeyLength];
+      size_t pos = 0;
+      memcpy(key, data_element.value, kFastPairTestAccountKeyLength);
+      pos += kFastPairTestAccountKeyLength;
+      memcpy(&key[pos], account_data.salt.data, account_data.salt.length);
+      pos += account_data.salt.length;
+      memcpy(&key[pos], account_data.battery.data, account_data.battery.length);
+      pos += account_data.battery.length;
+      if (account_data.version == 1) {
+        memcpy(&key[pos], account_data.rrd.data, account_data.rrd.length);
+        pos += account_data.rrd.length;
+      }
+      bool matched = bloom_filter.MayContain(key, pos);
+      if (!matched && account_data.rrd.length > 0) {
+        for (uint8_t first_byte : kAccountKeyFirstBytes) {
+          key[0] = first_byte;
+          matched = bloom_filter.MayContain(key, pos);
+          if (matched) {
+            break;
+          }
+        }
+      }
+      if (matched) {
+        *matched_service_data = &service_data;
+        return data_element.value;
+      }
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace nearby
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_TEST_FAST_PAIR_TEST_UTIL_H_
+#define LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_TEST_FAST_PAIR_TEST_UTIL_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "location/lbs/contexthub/nanoapps/nearby/ble_scan_record.h"
+#include "location/lbs/contexthub/nanoapps/nearby/proto/ble_filter.nanopb.h"
+
+namespace nearby {
+
+constexpr size_t kFastPairTestAccountKeyLength = 16;
+
+// Fields of a Fast Pair subsequent pair advertisement.
+struct FastPairTestAdvertisement {
+  // Account key added to the Bloom filter, or nullptr if none is.
+  const uint8_t *account_key = nullptr;
+  // First byte replacing the one of account_key when added, or 0 to add the
+  // key as is. The phone replaces it when the advertisement has RRD.
+  uint8_t account_key_first_byte = 0;
+  uint8_t version = 0;
+  uint8_t filter_length = 9;
+  uint16_t salt = 0;
+  uint8_t battery[3] = {0x50, 0x55, 0x60};
+  // RRD value, not included if rrd_length is 0.
+  uint8_t rrd[2] = {0x10, 0x01};
+  uint8_t rrd_length = 0;
+};
+
+// Adds an account key data element to filter.
+void AddFastPairTestAccountKey(const uint8_t *account_key,
+                               nearby_BleFilter *filter);
+
+// Writes the service data of advertisement to data. Returns its length, or 0
+// if it exceeds size.
+size_t MakeFastPairServiceData(const FastPairTestAdvertisement &advertisement,
+                               uint8_t *data, size_t size);
+
+// Writes a BLE scan record with the Fast Pair service data of advertisement
+// to data. Returns its length, or 0 if it exceeds size.
+size_t MakeFastPairScanRecord(const FastPairTestAdvertisement &advertisement,
+                              uint8_t *data, size_t size);
+
+// Matches the subsequent pair service data of scan_record against the
+// account keys of filter by hashing every key for every report, which
+// FastPairFilterState must agree with. Returns the matched account key and
+// sets matched_service_data, or returns nullptr if no key matches.
+const uint8_t *MatchFastPairReference(
+    const nearby_BleFilter &filter, const BleScanRecord &scan_record,
+    const BleServiceData **matched_service_data);
+
+}  // namespace nearby
+
+#endif  // LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_TEST_FAST_PAIR_TEST_UTIL_H_
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the cost of matching sets of Presence V1 advertisements against
+// the filters of the host, with the keys of the filter certificates derived
+// once on filter update, and derived on each match as without the cache.
+//
+// Usage: presence_filter_benchmark [num_reports]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "location/lbs/contexthub/nanoapps/nearby/presence_filter.h"
+#include "location/lbs/contexthub/nanoapps/nearby/test/presence_test_util.h"
+
+namespace nearby {
+namespace {
+
+// The most filters and certificates per filter the host sends.
+constexpr uint32_t kNumFilters = 10;
+constexpr uint32_t kNumCertificates = 3;
+// One advertisement in kMatchingPeriod is from an identity of the filters,
+// the others from devices of other users.
+constexpr uint32_t kMatchingPeriod = 10;
+constexpr size_t kMaxScanRecordSize = 64;
+
+struct Report {
+  uint8_t data[kMaxScanRecordSize];
+  size_t length;
+};
+
+// Matches every report against every filter, returning the number of
+// matches and the mean time per report in nanoseconds.
+uint32_t MatchReports(const std::vector<nearby_BleFilter> &filters,
+                      const std::vector<Report> &reports,
+                      const PresenceCryptoV1Impl::KeyCache &keys,
+                      const PresenceCryptoIdentityV1Impl::KeyCache
+                          &identity_keys,
+                      double *ns_per_report) {
+  uint32_t num_matches = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (const Report &report : reports) {
+    BleScanRecord record = BleScanRecord::Parse(
+        report.data, static_cast<uint16_t>(report.length));
+    for (const nearby_BleFilter &filter : filters) {
+      nearby_BleFilterResult result = nearby_BleFilterResult_init_zero;
+      if (MatchPresenceV1(filter, record, keys, identity_keys, &result)) {
+        num_matches++;
+      }
+    }
+  }
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  *ns_per_report = elapsed.count() / reports.size();
+  return num_matches;
+}
+
+int Run(uint32_t num_reports) {
+  std::vector<nearby_BleFilter> filters(kNumFilters);
+  PresenceCryptoV1Impl::KeyCache keys;
+  PresenceCryptoIdentityV1Impl::KeyCache identity_keys;
+  for (uint32_t i = 0; i < kNumFilters; i++) {
+    filters[i] = nearby_BleFilter_init_zero;
+    for (uint32_t j = 0; j < kNumCertificates; j++) {
+      PresenceTestIdentity identity =
+          MakePresenceTestIdentity(i * kNumCertificates + j);
+      AddPresenceTestCertificate(identity, &filters[i]);
+      ByteArray key(identity.authenticity_key,
+                    sizeof(identity.authenticity_key));
+      keys.Add(key);
+      identity_keys.Add(key);
+    }
+  }
+
+  std::vector<Report> reports(num_reports);
+  for (uint32_t i = 0; i < num_reports; i++) {
+    uint32_t seed = (i % kMatchingPeriod == 0)
+                        ? i % (kNumFilters * kNumCertificates)
+                        : 1000 + i;
+    reports[i].length = MakePresenceV1ScanRecord(
+        MakePresenceTestIdentity(seed), static_cast<uint16_t>(i * 7919),
+        /* action= */ 1, reports[i].data, sizeof(reports[i].data));
+  }
+
+  double cached_ns;
+  double derived_ns;
+  uint32_t cached_matches =
+      MatchReports(filters, reports, keys, identity_keys, &cached_ns);
+  uint32_t derived_matches =
+      MatchReports(filters, reports, PresenceCryptoV1Impl::KeyCache(),
+                   PresenceCryptoIdentityV1Impl::KeyCache(), &derived_ns);
+  printf("%u reports, %u filters x %u certificates\n", num_reports,
+         kNumFilters, kNumCertificates);
+  printf("keys derived on filter update: %.0f ns/report, %u matches\n",
+         cached_ns, cached_matches);
+  printf("keys derived on each match:    %.0f ns/report, %u matches\n",
+         derived_ns, derived_matches);
+  return cached_matches == derived_matches ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+}  // namespace
+}  // namespace nearby
+
+int main(int argc, char **argv) {
+  uint32_t num_reports =
+      (argc > 1) ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 1000;
+  return nearby::Run(num_reports == 0 ? 1 : num_reports);
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "location/lbs/contexthub/nanoapps/nearby/presence_filter.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "location/lbs/contexthub/nanoapps/nearby/test/presence_test_util.h"
+
+namespace nearby {
+namespace {
+
+constexpr uint8_t kAction = 7;
+
+class PresenceFilterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    for (uint32_t i = 0; i < 3; i++) {
+      identities_[i] = MakePresenceTestIdentity(i);
+      AddPresenceTestCertificate(identities_[i], &filter_);
+    }
+  }
+
+  void AddCertificateKeys() {
+    for (int i = 0; i < filter_.certificate_count; i++) {
+      ByteArray key(filter_.certificate[i].authenticity_key,
+                    PresenceKeyCache::kAuthenticityKeySize);
+      ASSERT_TRUE(keys_.Add(key));
+      ASSERT_TRUE(identity_keys_.Add(key));
+    }
+  }
+
+  // Matches an advertisement of identity against filter_, returning the
+  // authenticity key of the matched certificate in matched_key.
+  bool Match(const PresenceTestIdentity &identity, uint16_t salt,
+             uint8_t *matched_key) {
+    uint8_t data[64];
+    size_t length = MakePresenceV1ScanRecord(identity, salt, kAction, data,
+                                             sizeof(data));
+    EXPECT_GT(length, 0);
+    BleScanRecord record =
+        BleScanRecord::Parse(data, static_cast<uint16_t>(length));
+    nearby_BleFilterResult result = nearby_BleFilterResult_init_zero;
+    if (!MatchPresenceV1(filter_, record, keys_, identity_keys_, &result)) {
+      return false;
+    }
+    EXPECT_TRUE(result.public_credential.has_authenticity_key);
+    memcpy(matched_key, result.public_credential.authenticity_key,
+           PresenceKeyCache::kAuthenticityKeySize);
+    return true;
+  }
+
+  PresenceTestIdentity identities_[3];
+  nearby_BleFilter filter_ = nearby_BleFilter_init_zero;
+  PresenceCryptoV1Impl::KeyCache keys_;
+  PresenceCryptoIdentityV1Impl::KeyCache identity_keys_;
+};
+
+TEST_F(PresenceFilterTest, MatchesTheCertificateOfTheAdvertisement) {
+  AddCertificateKeys();
+  for (const PresenceTestIdentity &identity : identities_) {
+    uint8_t matched_key[PresenceKeyCache::kAuthenticityKeySize];
+    ASSERT_TRUE(Match(identity, /* salt= */ 0x1234, matched_key));
+    EXPECT_EQ(memcmp(matched_key, identity.authenticity_key,
+                     sizeof(matched_key)),
+              0);
+  }
+}
+
+TEST_F(PresenceFilterTest, DoesNotMatchUnknownIdentities) {
+  AddCertificateKeys();
+  uint8_t matched_key[PresenceKeyCache::kAuthenticityKeySize];
+  EXPECT_FALSE(Match(MakePresenceTestIdentity(/* seed= */ 100),
+                     /* salt= */ 0x1234, matched_key));
+}
+
+TEST_F(PresenceFilterTest, MatchesWithoutCachedKeys) {
+  // Keys not added to the caches, as when they are full, are derived on each
+  // match.
+  uint8_t matched_key[PresenceKeyCache::kAuthenticityKeySize];
+  ASSERT_TRUE(Match(identities_[2], /* salt= */ 0xBEEF, matched_key));
+  EXPECT_EQ(memcmp(matched_key, identities_[2].authenticity_key,
+                   sizeof(matched_key)),
+            0);
+}
+
+TEST_F(PresenceFilterTest, MatchesAdvertisementsWithDifferentSalts) {
+  AddCertificateKeys();
+  uint8_t matched_key[PresenceKeyCache::kAuthenticityKeySize];
+  for (uint32_t salt = 0; salt < 0x10000; salt += 0x1111) {
+    EXPECT_TRUE(
+        Match(identities_[1], static_cast<uint16_t>(salt), matched_key));
+  }
+}
+
+TEST_F(PresenceFilterTest, KeyCacheIsBounded) {
+  for (uint32_t i = 0; i < PresenceKeyCache::kMaxEntries; i++) {
+    PresenceTestIdentity identity = MakePresenceTestIdentity(i + 10);
+    EXPECT_TRUE(keys_.Add(ByteArray(identity.authenticity_key,
+                                    sizeof(identity.authenticity_key))));
+  }
+  EXPECT_FALSE(keys_.Add(ByteArray(identities_[0].authenticity_key,
+                                   sizeof(identities_[0].authenticity_key))));
+
+  // Adding a key again is not an error.
+  PresenceTestIdentity identity = MakePresenceTestIdentity(10);
+  EXPECT_TRUE(keys_.Add(
+      ByteArray(identity.authenticity_key, sizeof(identity.authenticity_key))));
+
+  keys_.Clear();
+  EXPECT_TRUE(keys_.Add(ByteArray(identities_[0].authenticity_key,
+                                  sizeof(identities_[0].authenticity_key))));
+}
+
+TEST_F(PresenceFilterTest, DecryptsSaltsOtherThanTheConstructionOne) {
+  AddCertificateKeys();
+  uint8_t salt_a[] = {1, 2};
+  uint8_t salt_b[] = {3, 4};
+  PresenceCryptoV1Impl crypto_a(keys_, ByteArray(salt_a, sizeof(salt_a)));
+  PresenceCryptoV1Impl crypto_b(keys_, ByteArray(salt_b, sizeof(salt_b)));
+
+  uint8_t input[40];
+  for (size_t i = 0; i < sizeof(input); i++) {
+    input[i] = static_cast<uint8_t>(i);
+  }
+  uint8_t output_a[sizeof(input)];
+  uint8_t output_b[sizeof(input)];
+  ByteArray key(identities_[0].authenticity_key,
+                sizeof(identities_[0].authenticity_key));
+  ByteArray output_a_array(output_a, sizeof(output_a));
+  ByteArray output_b_array(output_b, sizeof(output_b));
+  ASSERT_TRUE(crypto_a.decrypt(ByteArray(input, sizeof(input)),
+                               ByteArray(salt_b, sizeof(salt_b)), key,
+                               output_a_array));
+  ASSERT_TRUE(crypto_b.decrypt(ByteArray(input, sizeof(input)),
+                               ByteArray(salt_b, sizeof(salt_b)), key,
+                               output_b_array));
+  EXPECT_EQ(memcmp(output_a, output_b, sizeof(output_a)), 0);
+}
+
+}  // namespace
+}  // namespace nearby
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "location/lbs/contexthub/nanoapps/nearby/test/presence_test_util.h"
+
+#include <cstring>
+
+#include "location/lbs/contexthub/nanoapps/nearby/crypto/aes.h"
+#include "location/lbs/contexthub/nanoapps/nearby/crypto/hkdf.h"
+
+namespace nearby {
+namespace {
+
+// HKDF salts of the Presence V1 specification.
+constexpr uint8_t kAkIv[] = {0x0C, 0xC5, 0x13, 0x17, 0x60, 0x39, 0xC5, 0x13,
+                             0x75, 0xE1, 0x8C, 0xC3, 0x56, 0xE7, 0xDF, 0xB2};
+constexpr uint8_t kAsaltIv[] = {0x6F, 0x30, 0xAD, 0xB1, 0xF6, 0x9A,
+                                0xF0, 0x49, 0x2B, 0x37, 0x66, 0x81,
+                                0x3A, 0xED, 0x8F, 0x04};
+constexpr uint8_t kHkIv[] = {0x0C, 0xC5, 0x13, 0x17, 0x60, 0x39, 0xC5, 0x13,
+                             0x75, 0xE1, 0x8C, 0xC3, 0x56, 0xE7, 0xDF, 0xB2};
+constexpr uint8_t kEkIv[] = {0x0E, 0x85, 0xD9, 0x2A, 0x6D, 0x7F, 0x53, 0x1B,
+                             0x1B, 0x0B, 0x5B, 0xDA, 0x5C, 0x11, 0xAC, 0x42};
+constexpr uint8_t kEsaltIv[] = {0x2E, 0x53, 0xED, 0x0A, 0x81, 0xE1,
+                                0xE1, 0x0C, 0x1F, 0x4C, 0x3F, 0xF7,
+                                0x21, 0xBE, 0x0F, 0xF6};
+constexpr uint8_t kKtagIv[] = {0xEA, 0xAD, 0xFA, 0x43, 0x10, 0x9D,
+                               0xF3, 0xF7, 0x08, 0xFD, 0xF0, 0x25,
+                               0xB5, 0x2F, 0x01, 0xC8};
+
+constexpr uint8_t kServiceDataType = 0x16;
+constexpr uint8_t kPresenceUuid[] = {0xF1, 0xFC};
+constexpr uint8_t kHeaderV1 = 0b00100000;
+constexpr uint8_t kSaltHeader = 0b00100000;
+constexpr uint8_t kIdentityHeader[] = {0b10010000, 0b00000100};
+constexpr uint8_t kActionHeader = 0b00010110;
+constexpr uint8_t kTxPowerHeader = 0b00010101;
+constexpr size_t kSignatureLength = 16;
+
+// Encrypts data in place with AES-256/CTR, with the key derived from
+// authenticity_key with key_salt and the IV derived from salt with iv_salt.
+void Encrypt(const uint8_t *authenticity_key, const uint8_t *key_salt,
+             const uint8_t *salt, const uint8_t *iv_salt, uint8_t *data,
+             size_t length) {
+  uint32_t key[8];
+  hkdf(key_salt, 16, authenticity_key, 16, key, sizeof(key));
+  uint32_t iv[4];
+  hkdf(iv_salt, 16, salt, 2, iv, sizeof(iv));
+  AesCtrContext ctx;
+  aesCtrInit(&ctx, key, iv, AES_256_KEY_TYPE);
+  aesCtr(&ctx, data, data, length);
+}
+
+}  // namespace
+
+PresenceTestIdentity MakePresenceTestIdentity(uint32_t seed) {
+  PresenceTestIdentity identity;
+  uint32_t state = seed * 2654435761u + 1;
+  for (size_t i = 0; i < sizeof(identity.authenticity_key); i++) {
+    state = state * 1103515245u + 12345u;
+    identity.authenticity_key[i] = static_cast<uint8_t>(state >> 16);
+  }
+  for (size_t i = 0; i < sizeof(identity.identity); i++) {
+    state = state * 1103515245u + 12345u;
+    identity.identity[i] = static_cast<uint8_t>(state >> 16);
+  }
+  hkdf(kKtagIv, sizeof(kKtagIv), identity.identity, sizeof(identity.identity),
+       identity.metadata_encryption_key_tag,
+       sizeof(identity.metadata_encryption_key_tag));
+  return identity;
+}
+
+void AddPresenceTestCertificate(const PresenceTestIdentity &identity,
+                                nearby_BleFilter *filter) {
+  nearby_PublicateCertificate &certificate =
+      filter->certificate[filter->certificate_count++];
+  certificate.has_authenticity_key = true;
+  memcpy(certificate.authenticity_key, identity.authenticity_key,
+         sizeof(identity.authenticity_key));
+  certificate.has_metadata_encryption_key_tag = true;
+  memcpy(certificate.metadata_encryption_key_tag,
+         identity.metadata_encryption_key_tag,
+         sizeof(identity.metadata_encryption_key_tag));
+}
+
+size_t MakePresenceV1ScanRecord(const PresenceTestIdentity &identity,
+                                uint16_t salt, uint8_t action, uint8_t *data,
+                                size_t size) {
+  uint8_t salt_bytes[] = {static_cast<uint8_t>(salt >> 8),
+                          static_cast<uint8_t>(salt)};
+  uint8_t encrypted_identity[sizeof(identity.identity)];
+  memcpy(encrypted_identity, identity.identity, sizeof(encrypted_identity));
+  Encrypt(identity.authenticity_key, kEkIv, salt_bytes, kEsaltIv,
+          encrypted_identity, sizeof(encrypted_identity));
+
+  uint8_t data_elements[] = {kActionHeader, action, kTxPowerHeader, 20};
+  uint8_t hmac_key[16];
+  hkdf(kHkIv, sizeof(kHkIv), identity.authenticity_key,
+       sizeof(identity.authenticity_key), hmac_key, sizeof(hmac_key));
+  uint8_t signature[kSignatureLength];
+  hkdf(hmac_key, sizeof(hmac_key), data_elements, sizeof(data_elements),
+       signature, sizeof(signature));
+  Encrypt(identity.authenticity_key, kAkIv, salt_bytes, kAsaltIv,
+          data_elements, sizeof(data_elements));
+
+  size_t service_data_length = 1 + 1 + sizeof(salt_bytes) +
+                               sizeof(kIdentityHeader) +
+                               sizeof(encrypted_identity) +
+                               sizeof(data_elements) + sizeof(signature);
+  size_t length = 2 + sizeof(kPresenceUuid) + service_data_length;
+  if (length > size) {
+    return 0;
+  }
+  size_t index = 0;
+  data[index++] = static_cast<uint8_t>(length - 1);
+  data[index++] = kServiceDataType;
+  memcpy(&data[index], kPresenceUuid, sizeof(kPresenceUuid));
+  index += sizeof(kPresenceUuid);
+  data[index++] = kHeaderV1;
+  data[index++] = kSaltHeader;
+  memcpy(&data[index], salt_bytes, sizeof(salt_bytes));
+  index += sizeof(salt_bytes);
+  memcpy(&data[index], kIdentityHeader, sizeof(kIdentityHeader));
+  index += sizeof(kIdentityHeader);
+  memcpy(&data[index], encrypted_identity, sizeof(encrypted_identity));
+  index += sizeof(encrypted_identity);
+  memcpy(&data[index], data_elements, sizeof(data_elements));
+  index += sizeof(data_elements);
+  memcpy(&data[index], signature, sizeof(signature));
+  return length;
+}
+
+}  // namespace nearby
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_TEST_PRESENCE_TEST_UTIL_H_
+#define LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_TEST_PRESENCE_TEST_UTIL_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "location/lbs/contexthub/nanoapps/nearby/proto/ble_filter.nanopb.h"
+
+namespace nearby {
+
+// A Presence V1 identity, as sent by the host in a filter certificate, and
+// the plain text identity its advertisements carry.
+struct PresenceTestIdentity {
+  uint8_t authenticity_key[16];
+  uint8_t metadata_encryption_key_tag[8];
+  uint8_t identity[16];
+};
+
+// Returns an identity whose keys are generated from seed.
+PresenceTestIdentity MakePresenceTestIdentity(uint32_t seed);
+
+// Adds identity as a certificate of filter.
+void AddPresenceTestCertificate(const PresenceTestIdentity &identity,
+                                nearby_BleFilter *filter);
+
+// Writes to data a BLE scan record with one Presence V1 advertisement of
+// identity, encrypted with salt, whose data elements carry action. The keys
+// are derived from the authenticity key without the code under test.
+// Returns the length of the scan record, or 0 if it exceeds size.
+size_t MakePresenceV1ScanRecord(const PresenceTestIdentity &identity,
+                                uint16_t salt, uint8_t action, uint8_t *data,
+                                size_t size);
+
+}  // namespace nearby
+
+#endif  // LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_TEST_PRESENCE_TEST_UTIL_H_
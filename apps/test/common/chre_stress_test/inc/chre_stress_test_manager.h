@@ -25,6 +25,7 @@
 #include "chre/util/singleton.h"
 #include "chre/util/time.h"
 #include "chre_api/chre.h"
+#include "delivery_stats.h"
 
 namespace chre {
 
@@ -83,6 +84,27 @@ class Manager {
    */
   void handleMessageFromHost(uint32_t senderInstanceId,
                              const chreMessageFromHostData *hostData);
+
+  /**
+   * Applies a LoadProfile sent by the host.
+   *
+   * @param hostData The data from the host.
+   *
+   * @return true if the profile was decoded.
+   */
+  bool handleLoadProfileMessage(const chreMessageFromHostData *hostData);
+
+  /**
+   * Sends the delivery statistics to the host and clears them.
+   *
+   * @param hostEndpoint The host endpoint that requested the report.
+   */
+  void sendLoadReport(uint16_t hostEndpoint);
+
+  /**
+   * Sends a LOAD_MESSAGE of the size set by the load profile to the host.
+   */
+  void sendLoadMessage();
   /**
    * Processes data from CHRE.
    *
@@ -272,6 +294,7 @@ class Manager {
   uint32_t mSensorTimerHandle = CHRE_TIMER_INVALID;
   uint32_t mAudioTimerHandle = CHRE_TIMER_INVALID;
   uint32_t mBleScanTimerHandle = CHRE_TIMER_INVALID;
+  uint32_t mHostMessageTimerHandle = CHRE_TIMER_INVALID;
 
   //! true if the test has been started for the feature.
   bool mWifiTestStarted = false;
@@ -314,6 +337,18 @@ class Manager {
   uint64_t mPrevAudioEventTimestampMs = 0;
   uint64_t mPrevBleAdTimestampMs = 0;
 
+  //! The load requested by the host, zero fields use the default load.
+  chre_stress_test_LoadProfile mLoadProfile =
+      chre_stress_test_LoadProfile_init_zero;
+
+  //! The delivery statistics, indexed by chre_stress_test_SourceStats_Source.
+  static constexpr size_t kNumDeliverySources =
+      _chre_stress_test_SourceStats_Source_MAX + 1;
+  DeliveryStats mDeliveryStats[kNumDeliverySources];
+
+  //! The time the delivery statistics were last cleared.
+  uint64_t mDeliveryStatsStartTimeNs = chreGetTime();
+
   //! Number of ble scan mode.
   static constexpr uint32_t kNumBleScanModes = 3;
 
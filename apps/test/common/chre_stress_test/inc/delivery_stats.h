@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_STRESS_TEST_DELIVERY_STATS_H_
+#define CHRE_STRESS_TEST_DELIVERY_STATS_H_
+
+#include "chre_stress_test.nanopb.h"
+
+#include <cinttypes>
+#include <cstddef>
+
+namespace chre {
+
+namespace stress_test {
+
+/**
+ * Gathers the latency and drop count of the events delivered by one source.
+ * The histogram layout is described by SourceStats.latency_histogram in
+ * chre_stress_test.proto.
+ */
+class DeliveryStats {
+ public:
+  //! The number of buckets of the latency histogram.
+  static constexpr size_t kNumHistogramBuckets = 20;
+
+  //! The upper bound of the first bucket of the latency histogram.
+  static constexpr uint64_t kHistogramBaseNs = 250000;  // 250 us
+
+  /**
+   * Records an event whose last sample has the given timestamp, in the time
+   * base of chreGetTime().
+   *
+   * @param timestampNs The timestamp of the last sample of the event.
+   * @param nowNs The time the event is handled.
+   */
+  void addEvent(uint64_t timestampNs, uint64_t nowNs);
+
+  /**
+   * Records an event that has no timestamp in the time base of chreGetTime().
+   */
+  void addEventWithoutLatency() {
+    mEventCount++;
+  }
+
+  /**
+   * Checks the gap between the first sample of an event of a data stream and
+   * the last sample of the previous event, and counts the samples that are
+   * missing from it.
+   *
+   * @param firstTimestampNs The timestamp of the first sample of the event.
+   * @param lastTimestampNs The timestamp of the last sample of the event.
+   * @param intervalNs The expected interval between two samples.
+   */
+  void checkStreamGap(uint64_t firstTimestampNs, uint64_t lastTimestampNs,
+                      uint64_t intervalNs);
+
+  /**
+   * Forgets the last sample of the data stream, to be called when the stream
+   * is stopped so that the time it was off is not counted as drops.
+   */
+  void restartStream() {
+    mLastStreamTimestampNs = 0;
+  }
+
+  void addDrops(uint32_t count) {
+    mDropCount += count;
+  }
+
+  bool empty() const {
+    return mEventCount == 0 && mDropCount == 0;
+  }
+
+  /**
+   * Copies the statistics to a proto message.
+   *
+   * @param source The source the statistics are for.
+   * @param stats The message to fill.
+   */
+  void toProto(chre_stress_test_SourceStats_Source source,
+               chre_stress_test_SourceStats *stats) const;
+
+  /**
+   * Clears the statistics. The last sample of the data stream is kept so that
+   * gaps across reports are still detected.
+   */
+  void clear();
+
+ private:
+  uint32_t mEventCount = 0;
+  uint32_t mDropCount = 0;
+  uint32_t mLatencyCount = 0;
+  uint64_t mMinLatencyNs = UINT64_MAX;
+  uint64_t mMaxLatencyNs = 0;
+  uint64_t mTotalLatencyNs = 0;
+  uint32_t mHistogram[kNumHistogramBuckets] = {};
+
+  //! The timestamp of the last sample of the data stream, 0 if unknown.
+  uint64_t mLastStreamTimestampNs = 0;
+};
+
+}  // namespace stress_test
+
+}  // namespace chre
+
+#endif  // CHRE_STRESS_TEST_DELIVERY_STATS_H_
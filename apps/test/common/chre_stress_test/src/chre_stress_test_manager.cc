@@ -18,6 +18,7 @@
 
 #include <pb_decode.h>
 #include <pb_encode.h>
+#include <cstring>
 
 #include "chre/util/macros.h"
 #include "chre/util/memory.h"
@@ -49,6 +50,7 @@ constexpr chre::Nanoseconds kWifiScanInterval = chre::Seconds(5);
 constexpr chre::Nanoseconds kSensorRequestInterval = chre::Seconds(5);
 constexpr chre::Nanoseconds kAudioRequestInterval = chre::Seconds(5);
 constexpr chre::Nanoseconds kBleRequestInterval = chre::Seconds(5);
+constexpr uint32_t kGnssIntervalMs = 1000;
 constexpr uint64_t kSensorSamplingDelayNs = 0;
 constexpr uint8_t kAccelSensorIndex = 0;
 constexpr uint8_t kGyroSensorIndex = 1;
@@ -57,6 +59,30 @@ constexpr uint8_t kInstantMotionSensorIndex = 1;
 //! Report delay for BLE scans.
 constexpr uint32_t gBleBatchDurationMs = 0;
 
+//! Returns the interval of the load profile if set, the default otherwise.
+uint64_t getProfileIntervalNs(uint32_t profileIntervalMs,
+                              Nanoseconds defaultInterval) {
+  return (profileIntervalMs > 0)
+             ? profileIntervalMs * kOneMillisecondInNanoseconds
+             : defaultInterval.toRawNanoseconds();
+}
+
+//! Gets the timestamps of the first and last samples of a sensor event.
+void getSampleTimestamps(const chreSensorThreeAxisData *eventData,
+                         uint64_t *firstTimestampNs,
+                         uint64_t *lastTimestampNs) {
+  const auto &header = eventData->header;
+  uint64_t timestamp = header.baseTimestamp;
+  *firstTimestampNs = timestamp;
+  for (uint16_t i = 0; i < header.readingCount; i++) {
+    timestamp += eventData->readings[i].timestampDelta;
+    if (i == 0) {
+      *firstTimestampNs = timestamp;
+    }
+  }
+  *lastTimestampNs = timestamp;
+}
+
 bool isRequestTypeForLocation(uint8_t requestType) {
   return (requestType == CHRE_GNSS_REQUEST_TYPE_LOCATION_SESSION_START) ||
          (requestType == CHRE_GNSS_REQUEST_TYPE_LOCATION_SESSION_STOP);
@@ -109,6 +135,11 @@ void Manager::handleMessageFromHost(uint32_t senderInstanceId,
   } else if (messageType == chre_stress_test_MessageType_GET_CAPABILITIES) {
     sendCapabilitiesMessage();
     success = true;
+  } else if (messageType == chre_stress_test_MessageType_GET_LOAD_REPORT) {
+    sendLoadReport(hostData->hostEndpoint);
+    success = true;
+  } else if (messageType == chre_stress_test_MessageType_SET_LOAD_PROFILE) {
+    success = handleLoadProfileMessage(hostData);
   } else if (messageType != chre_stress_test_MessageType_TEST_COMMAND) {
     LOGE("Invalid message type %" PRIu32, messageType);
   } else if (mHostEndpoint.has_value() &&
@@ -287,6 +318,8 @@ void Manager::handleTimerEvent(const uint32_t *handle) {
     sendFailure("WiFi scan monitor request timed out");
   } else if (*handle == mAudioTimerHandle) {
     makeAudioRequest();
+  } else if (*handle == mHostMessageTimerHandle) {
+    sendLoadMessage();
   } else {
     sendFailure("Unknown timer handle");
   }
@@ -364,6 +397,16 @@ void Manager::handleAudioDataEvent(const chreAudioDataEvent *event) {
 
   checkTimestamp(timestamp, mPrevAudioEventTimestampMs);
   mPrevAudioEventTimestampMs = timestamp;
+
+  if (event->sampleRate > 0 && event->sampleCount > 0) {
+    uint64_t sampleIntervalNs = CHRE_NSEC_PER_SEC / event->sampleRate;
+    uint64_t lastTimestampNs =
+        timestamp + (event->sampleCount - 1) * sampleIntervalNs;
+    DeliveryStats &stats =
+        mDeliveryStats[chre_stress_test_SourceStats_Source_AUDIO];
+    stats.checkStreamGap(timestamp, lastTimestampNs, sampleIntervalNs);
+    stats.addEvent(lastTimestampNs, chreGetTime());
+  }
 }
 
 void Manager::handleAudioSamplingChangeEvent(
@@ -389,7 +432,10 @@ void Manager::validateGnssAsyncResult(const chreAsyncResult *result,
 
 void Manager::handleBleAdvertismentEvent(
     const chreBleAdvertisementEvent *event) {
+  uint64_t nowNs = chreGetTime();
   for (uint8_t i = 0; i < event->numReports; i++) {
+    mDeliveryStats[chre_stress_test_SourceStats_Source_BLE].addEvent(
+        event->reports[i].timestamp, nowNs);
     uint64_t timestamp =
         event->reports[i].timestamp / chre::kOneMillisecondInNanoseconds;
 
@@ -431,6 +477,9 @@ void Manager::checkTimestampInterval(uint64_t timestamp, uint64_t pastTimestamp,
 
 void Manager::handleGnssLocationEvent(const chreGnssLocationEvent *event) {
   LOGI("Received GNSS location event at %" PRIu64 " ms", event->timestamp);
+  // The location timestamp is a UTC time, so no latency is recorded.
+  mDeliveryStats[chre_stress_test_SourceStats_Source_GNSS_LOCATION]
+      .addEventWithoutLatency();
 
   checkTimestamp(event->timestamp, mPrevGnssLocationEventTimestampMs);
   mPrevGnssLocationEventTimestampMs = event->timestamp;
@@ -442,6 +491,9 @@ void Manager::handleGnssDataEvent(const chreGnssDataEvent *event) {
        " flags 0x%" PRIx16,
        event->clock.time_ns, event->clock.hw_clock_discontinuity_count,
        event->clock.flags);
+  // The clock of the GNSS receiver is not the CHRE clock.
+  mDeliveryStats[chre_stress_test_SourceStats_Source_GNSS_MEASUREMENT]
+      .addEventWithoutLatency();
 
   if (sPrevDiscontCount == event->clock.hw_clock_discontinuity_count) {
     checkTimestamp(event->clock.time_ns, mPrevGnssMeasurementEventTimestampNs);
@@ -457,6 +509,8 @@ void Manager::handleWifiScanEvent(const chreWifiScanEvent *event) {
        event->scanType, event->resultCount, event->referenceTime);
 
   if (event->eventIndex == 0) {
+    mDeliveryStats[chre_stress_test_SourceStats_Source_WIFI_SCAN].addEvent(
+        event->referenceTime, chreGetTime());
     checkTimestamp(event->referenceTime, mPrevWifiScanEventTimestampNs);
     mPrevWifiScanEventTimestampNs = event->referenceTime;
   }
@@ -474,6 +528,15 @@ void Manager::handleAccelSensorDataEvent(
   const auto &header = eventData->header;
   uint64_t timestamp = header.baseTimestamp;
 
+  uint64_t firstTimestampNs;
+  uint64_t lastTimestampNs;
+  getSampleTimestamps(eventData, &firstTimestampNs, &lastTimestampNs);
+  DeliveryStats &stats =
+      mDeliveryStats[chre_stress_test_SourceStats_Source_ACCELEROMETER];
+  stats.checkStreamGap(firstTimestampNs, lastTimestampNs,
+                       mSensors[kAccelSensorIndex].samplingInterval);
+  stats.addEvent(lastTimestampNs, chreGetTime());
+
   // Note: The stress test sends streaming data request for accel, so only
   // non-batched data are checked for timestamp. The allowed interval between
   // data events is selected 1 ms higher than the sensor sampling interval to
@@ -493,6 +556,15 @@ void Manager::handleGyroSensorDataEvent(
   const auto &header = eventData->header;
   uint64_t timestamp = header.baseTimestamp;
 
+  uint64_t firstTimestampNs;
+  uint64_t lastTimestampNs;
+  getSampleTimestamps(eventData, &firstTimestampNs, &lastTimestampNs);
+  DeliveryStats &stats =
+      mDeliveryStats[chre_stress_test_SourceStats_Source_GYROSCOPE];
+  stats.checkStreamGap(firstTimestampNs, lastTimestampNs,
+                       mSensors[kGyroSensorIndex].samplingInterval);
+  stats.addEvent(lastTimestampNs, chreGetTime());
+
   // Note: The stress test sends streaming data request for gyro, so only
   // non-batched data are checked for timestamp. The interval is selected 1ms
   // higher than the sensor sampling interval to account for processing delays.
@@ -549,6 +621,11 @@ void Manager::handleCellInfoResult(const chreWwanCellInfoResult *event) {
     }
 
     mPrevWwanCellInfoEventTimestampNs = maxTimestamp;
+    mDeliveryStats[chre_stress_test_SourceStats_Source_WWAN].addEvent(
+        maxTimestamp, chreGetTime());
+  } else {
+    mDeliveryStats[chre_stress_test_SourceStats_Source_WWAN]
+        .addEventWithoutLatency();
   }
 }
 
@@ -646,6 +723,11 @@ void Manager::handleSensorStartCommand(bool start) {
       bool infoStatus = chreGetSensorInfo(sensor.handle, &info);
       if (infoStatus) {
         sensor.samplingInterval = info.minInterval;
+        if (mLoadProfile.sensor_interval_ns > 0 && !info.isOnChange &&
+            !info.isOneShot) {
+          sensor.samplingInterval =
+              MAX(mLoadProfile.sensor_interval_ns, info.minInterval);
+        }
         LOGI("SensorInfo: %s, Type=%" PRIu8
              " OnChange=%d OneShot=%d Passive=%d "
              "minInterval=%" PRIu64 "nsec",
@@ -721,6 +803,13 @@ void Manager::makeSensorRequests() {
     SensorState &sensor = mSensors[i];
     bool status = false;
     if (!sensor.enabled) {
+      if (i == kAccelSensorIndex) {
+        mDeliveryStats[chre_stress_test_SourceStats_Source_ACCELEROMETER]
+            .restartStream();
+      } else if (i == kGyroSensorIndex) {
+        mDeliveryStats[chre_stress_test_SourceStats_Source_GYROSCOPE]
+            .restartStream();
+      }
       if (sensor.info.isOneShot) {
         status = chreSensorConfigure(
             sensor.handle, CHRE_SENSOR_CONFIGURE_MODE_ONE_SHOT,
@@ -747,8 +836,9 @@ void Manager::makeSensorRequests() {
     anySensorConfigured = anySensorConfigured || status;
   }
   if (anySensorConfigured) {
-    setTimer(kSensorRequestInterval.toRawNanoseconds(), true /* oneShot */,
-             &mSensorTimerHandle);
+    setTimer(getProfileIntervalNs(mLoadProfile.toggle_interval_ms,
+                                  kSensorRequestInterval),
+             true /* oneShot */, &mSensorTimerHandle);
   } else {
     LOGW("Failed to make sensor request");
   }
@@ -778,14 +868,18 @@ void Manager::makeBleScanRequest() {
   if (!success) {
     LOGE("Failed to send BLE %s scan request", !mBleEnabled ? "start" : "stop");
   } else {
-    setTimer(kBleRequestInterval.toRawNanoseconds(), true /* oneShot */,
-             &mBleScanTimerHandle);
+    setTimer(getProfileIntervalNs(mLoadProfile.toggle_interval_ms,
+                                  kBleRequestInterval),
+             true /* oneShot */, &mBleScanTimerHandle);
   }
 }
 
 void Manager::makeGnssLocationRequest() {
   // The list of location intervals to iterate; wraps around.
-  static const uint32_t kMinIntervalMsList[] = {1000, 0};
+  const uint32_t kMinIntervalMsList[] = {
+      (mLoadProfile.gnss_interval_ms > 0) ? mLoadProfile.gnss_interval_ms
+                                          : kGnssIntervalMs,
+      0};
   static size_t sIntervalIndex = 0;
 
   uint32_t minIntervalMs = 0;
@@ -818,7 +912,10 @@ void Manager::makeGnssLocationRequest() {
 
 void Manager::makeGnssMeasurementRequest() {
   // The list of measurement intervals to iterate; wraps around.
-  static const uint32_t kMinIntervalMsList[] = {1000, 0};
+  const uint32_t kMinIntervalMsList[] = {
+      (mLoadProfile.gnss_interval_ms > 0) ? mLoadProfile.gnss_interval_ms
+                                          : kGnssIntervalMs,
+      0};
   static size_t sIntervalIndex = 0;
 
   uint32_t minIntervalMs = 0;
@@ -854,8 +951,9 @@ void Manager::makeGnssMeasurementRequest() {
 void Manager::requestDelayedWifiScan() {
   if (mWifiTestStarted) {
     if (chreWifiGetCapabilities() & CHRE_WIFI_CAPABILITIES_ON_DEMAND_SCAN) {
-      setTimer(kWifiScanInterval.toRawNanoseconds(), true /* oneShot */,
-               &mWifiScanTimerHandle);
+      setTimer(getProfileIntervalNs(mLoadProfile.wifi_scan_interval_ms,
+                                    kWifiScanInterval),
+               true /* oneShot */, &mWifiScanTimerHandle);
     } else {
       LOGW("Platform has no on-demand scan capability");
     }
@@ -887,6 +985,7 @@ void Manager::makeAudioRequest() {
   bool success = false;
   struct chreAudioSource source;
   if (mAudioEnabled) {
+    mDeliveryStats[chre_stress_test_SourceStats_Source_AUDIO].restartStream();
     for (uint32_t i = 0; chreAudioGetSource(i, &source); i++) {
       if (chreAudioConfigureSource(i, true, source.minBufferDuration,
                                    source.minBufferDuration)) {
@@ -909,8 +1008,9 @@ void Manager::makeAudioRequest() {
 
   if (success) {
     mAudioEnabled = !mAudioEnabled;
-    setTimer(kAudioRequestInterval.toRawNanoseconds(), true /* oneShot */,
-             &mAudioTimerHandle);
+    setTimer(getProfileIntervalNs(mLoadProfile.toggle_interval_ms,
+                                  kAudioRequestInterval),
+             true /* oneShot */, &mAudioTimerHandle);
   } else {
     sendFailure("Failed to make audio request");
   }
@@ -957,6 +1057,95 @@ void Manager::sendCapabilitiesMessage() {
   }
 }
 
+bool Manager::handleLoadProfileMessage(
+    const chreMessageFromHostData *hostData) {
+  pb_istream_t istream = pb_istream_from_buffer(
+      static_cast<const pb_byte_t *>(hostData->message),
+      hostData->messageSize);
+  chre_stress_test_LoadProfile profile = chre_stress_test_LoadProfile_init_zero;
+  if (!pb_decode(&istream, chre_stress_test_LoadProfile_fields, &profile)) {
+    LOGE("Failed to decode load profile error %s", PB_GET_ERROR(&istream));
+    return false;
+  }
+
+  LOGI("Load profile: sensor %" PRIu64 " ns, WiFi %" PRIu32
+       " ms, GNSS %" PRIu32 " ms, toggle %" PRIu32 " ms, host message %" PRIu32
+       " bytes every %" PRIu32 " ms",
+       profile.sensor_interval_ns, profile.wifi_scan_interval_ms,
+       profile.gnss_interval_ms, profile.toggle_interval_ms,
+       profile.host_message_size, profile.host_message_interval_ms);
+  mLoadProfile = profile;
+  mHostEndpoint = hostData->hostEndpoint;
+
+  cancelTimer(&mHostMessageTimerHandle);
+  if (mLoadProfile.host_message_interval_ms > 0) {
+    setTimer(mLoadProfile.host_message_interval_ms *
+                 kOneMillisecondInNanoseconds,
+             false /* oneShot */, &mHostMessageTimerHandle);
+  }
+  return true;
+}
+
+void Manager::sendLoadReport(uint16_t hostEndpoint) {
+  static_assert(ARRAY_SIZE(chre_stress_test_LoadReport{}.sources) ==
+                    kNumDeliverySources - 1,
+                "chre_stress_test.options does not match the source count");
+
+  auto report = MakeUniqueZeroFill<chre_stress_test_LoadReport>();
+  if (report.isNull()) {
+    LOG_OOM();
+    return;
+  }
+
+  uint64_t nowNs = chreGetTime();
+  report->has_duration_ns = true;
+  report->duration_ns = nowNs - mDeliveryStatsStartTimeNs;
+  for (size_t i = 1; i < kNumDeliverySources; i++) {
+    DeliveryStats &stats = mDeliveryStats[i];
+    if (!stats.empty()) {
+      chre_stress_test_SourceStats &sourceStats =
+          report->sources[report->sources_count++];
+      stats.toProto(static_cast<chre_stress_test_SourceStats_Source>(i),
+                    &sourceStats);
+      LOGI("Source %zu: %" PRIu32 " events, %" PRIu32
+           " drops, max latency %" PRIu64 " ns",
+           i, sourceStats.event_count, sourceStats.drop_count,
+           sourceStats.max_latency_ns);
+      stats.clear();
+    }
+  }
+  mDeliveryStatsStartTimeNs = nowNs;
+
+  test_shared::sendMessageToHost(hostEndpoint, report.get(),
+                                 chre_stress_test_LoadReport_fields,
+                                 chre_stress_test_MessageType_LOAD_REPORT);
+}
+
+void Manager::sendLoadMessage() {
+  DeliveryStats &stats =
+      mDeliveryStats[chre_stress_test_SourceStats_Source_HOST_MESSAGE];
+  uint32_t size =
+      MIN(mLoadProfile.host_message_size, CHRE_MESSAGE_TO_HOST_MAX_SIZE);
+  void *message = nullptr;
+  if (size > 0) {
+    message = chreHeapAlloc(size);
+    if (message == nullptr) {
+      LOG_OOM();
+      stats.addDrops(1);
+      return;
+    }
+    memset(message, 0xa5, size);
+  }
+
+  if (chreSendMessageToHostEndpoint(
+          message, size, chre_stress_test_MessageType_LOAD_MESSAGE,
+          mHostEndpoint.value(), heapFreeMessageCallback)) {
+    stats.addEventWithoutLatency();
+  } else {
+    stats.addDrops(1);
+  }
+}
+
 }  // namespace stress_test
 
 }  // namespace chre
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "delivery_stats.h"
+
+#include "chre/util/macros.h"
+
+namespace chre {
+
+namespace stress_test {
+
+static_assert(ARRAY_SIZE(chre_stress_test_SourceStats{}.latency_histogram) ==
+                  DeliveryStats::kNumHistogramBuckets,
+              "chre_stress_test.options does not match the histogram size");
+
+void DeliveryStats::addEvent(uint64_t timestampNs, uint64_t nowNs) {
+  mEventCount++;
+  // A timestamp in the future is a source bug caught by the timestamp checks
+  // of the manager, it is not a latency.
+  if (timestampNs > nowNs) {
+    return;
+  }
+
+  uint64_t latencyNs = nowNs - timestampNs;
+  mLatencyCount++;
+  mTotalLatencyNs += latencyNs;
+  mMinLatencyNs = MIN(mMinLatencyNs, latencyNs);
+  mMaxLatencyNs = MAX(mMaxLatencyNs, latencyNs);
+
+  size_t bucket = 0;
+  for (uint64_t boundNs = kHistogramBaseNs;
+       latencyNs >= boundNs && bucket < kNumHistogramBuckets - 1;
+       boundNs <<= 1) {
+    bucket++;
+  }
+  mHistogram[bucket]++;
+}
+
+void DeliveryStats::checkStreamGap(uint64_t firstTimestampNs,
+                                   uint64_t lastTimestampNs,
+                                   uint64_t intervalNs) {
+  if (mLastStreamTimestampNs != 0 && intervalNs > 0 &&
+      firstTimestampNs > mLastStreamTimestampNs) {
+    uint64_t gapNs = firstTimestampNs - mLastStreamTimestampNs;
+    // Allow half an interval of jitter before counting a sample as missing.
+    if (2 * gapNs > 3 * intervalNs) {
+      mDropCount +=
+          static_cast<uint32_t>((gapNs + intervalNs / 2) / intervalNs - 1);
+    }
+  }
+  mLastStreamTimestampNs = lastTimestampNs;
+}
+
+void DeliveryStats::toProto(chre_stress_test_SourceStats_Source source,
+                            chre_stress_test_SourceStats *stats) const {
+  *stats = chre_stress_test_SourceStats_init_default;
+  stats->has_source = true;
+  stats->source = source;
+  stats->has_event_count = true;
+  stats->event_count = mEventCount;
+  stats->has_drop_count = true;
+  stats->drop_count = mDropCount;
+  stats->has_latency_count = true;
+  stats->latency_count = mLatencyCount;
+  if (mLatencyCount > 0) {
+    stats->has_min_latency_ns = true;
+    stats->min_latency_ns = mMinLatencyNs;
+    stats->has_max_latency_ns = true;
+    stats->max_latency_ns = mMaxLatencyNs;
+    stats->has_total_latency_ns = true;
+    stats->total_latency_ns = mTotalLatencyNs;
+    stats->latency_histogram_count = kNumHistogramBuckets;
+    for (size_t i = 0; i < kNumHistogramBuckets; i++) {
+      stats->latency_histogram[i] = mHistogram[i];
+    }
+  }
+}
+
+void DeliveryStats::clear() {
+  uint64_t lastStreamTimestampNs = mLastStreamTimestampNs;
+  *this = DeliveryStats();
+  mLastStreamTimestampNs = lastStreamTimestampNs;
+}
+
+}  // namespace stress_test
+
+}  // namespace chre
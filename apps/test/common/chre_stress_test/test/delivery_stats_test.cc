@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include "delivery_stats.h"
+
+using chre::stress_test::DeliveryStats;
+
+namespace {
+
+constexpr uint64_t kUs = 1000;
+constexpr uint64_t kMs = 1000 * kUs;
+constexpr uint64_t kNowNs = 1000 * kMs;
+
+constexpr chre_stress_test_SourceStats_Source kSource =
+    chre_stress_test_SourceStats_Source_ACCELEROMETER;
+
+chre_stress_test_SourceStats toProto(const DeliveryStats &stats) {
+  chre_stress_test_SourceStats proto;
+  stats.toProto(kSource, &proto);
+  return proto;
+}
+
+//! @return the index of the bucket holding the given percentile of the
+//! latencies, as computed by the host from the histogram.
+size_t getPercentileBucket(const chre_stress_test_SourceStats &proto,
+                           uint32_t percentile) {
+  uint32_t target = (proto.latency_count * percentile + 99) / 100;
+  uint32_t count = 0;
+  for (size_t i = 0; i < proto.latency_histogram_count; i++) {
+    count += proto.latency_histogram[i];
+    if (count >= target) {
+      return i;
+    }
+  }
+  return proto.latency_histogram_count;
+}
+
+}  // namespace
+
+TEST(DeliveryStatsTest, EmptyStatsHaveNoLatency) {
+  DeliveryStats stats;
+  EXPECT_TRUE(stats.empty());
+
+  chre_stress_test_SourceStats proto = toProto(stats);
+  EXPECT_TRUE(proto.has_source);
+  EXPECT_EQ(proto.source, kSource);
+  EXPECT_EQ(proto.event_count, 0);
+  EXPECT_EQ(proto.drop_count, 0);
+  EXPECT_EQ(proto.latency_count, 0);
+  EXPECT_FALSE(proto.has_min_latency_ns);
+  EXPECT_FALSE(proto.has_max_latency_ns);
+  EXPECT_EQ(proto.latency_histogram_count, 0);
+}
+
+TEST(DeliveryStatsTest, AccumulatesLatencies) {
+  DeliveryStats stats;
+  stats.addEvent(kNowNs - 100 * kUs, kNowNs);
+  stats.addEvent(kNowNs - 3 * kMs, kNowNs);
+  stats.addEvent(kNowNs - 2 * kUs, kNowNs);
+  stats.addEventWithoutLatency();
+  // A timestamp in the future counts the event but not its latency.
+  stats.addEvent(kNowNs + kMs, kNowNs);
+
+  chre_stress_test_SourceStats proto = toProto(stats);
+  EXPECT_FALSE(stats.empty());
+  EXPECT_EQ(proto.event_count, 5);
+  EXPECT_EQ(proto.latency_count, 3);
+  EXPECT_EQ(proto.min_latency_ns, 2 * kUs);
+  EXPECT_EQ(proto.max_latency_ns, 3 * kMs);
+  EXPECT_EQ(proto.total_latency_ns, 3 * kMs + 102 * kUs);
+}
+
+TEST(DeliveryStatsTest, HistogramBucketsDoubleFromTheBase) {
+  DeliveryStats stats;
+  const uint64_t baseNs = DeliveryStats::kHistogramBaseNs;
+  stats.addEvent(kNowNs, kNowNs);
+  stats.addEvent(kNowNs - (baseNs - 1), kNowNs);
+  stats.addEvent(kNowNs - baseNs, kNowNs);
+  stats.addEvent(kNowNs - (2 * baseNs - 1), kNowNs);
+  stats.addEvent(kNowNs - 2 * baseNs, kNowNs);
+  stats.addEvent(kNowNs - 5 * baseNs, kNowNs);
+  // Latencies past the last bound go to the last bucket.
+  stats.addEvent(0, baseNs << DeliveryStats::kNumHistogramBuckets);
+
+  chre_stress_test_SourceStats proto = toProto(stats);
+  ASSERT_EQ(proto.latency_histogram_count,
+            DeliveryStats::kNumHistogramBuckets);
+  EXPECT_EQ(proto.latency_histogram[0], 2);
+  EXPECT_EQ(proto.latency_histogram[1], 2);
+  EXPECT_EQ(proto.latency_histogram[2], 1);
+  EXPECT_EQ(proto.latency_histogram[3], 1);
+  EXPECT_EQ(proto.latency_histogram[DeliveryStats::kNumHistogramBuckets - 1],
+            1);
+
+  uint32_t total = 0;
+  for (size_t i = 0; i < proto.latency_histogram_count; i++) {
+    total += proto.latency_histogram[i];
+  }
+  EXPECT_EQ(total, proto.latency_count);
+}
+
+TEST(DeliveryStatsTest, HistogramGivesLatencyPercentiles) {
+  DeliveryStats stats;
+  for (int i = 0; i < 98; i++) {
+    stats.addEvent(kNowNs - 100 * kUs, kNowNs);
+  }
+  stats.addEvent(kNowNs - kMs, kNowNs);
+  stats.addEvent(kNowNs - 10 * kMs, kNowNs);
+
+  chre_stress_test_SourceStats proto = toProto(stats);
+  // < 250 us
+  EXPECT_EQ(getPercentileBucket(proto, 50), 0);
+  EXPECT_EQ(getPercentileBucket(proto, 98), 0);
+  // [1, 2) ms
+  EXPECT_EQ(getPercentileBucket(proto, 99), 3);
+  // [8, 16) ms
+  EXPECT_EQ(getPercentileBucket(proto, 100), 6);
+}
+
+TEST(DeliveryStatsTest, CountsMissingSamplesOfAStream) {
+  constexpr uint64_t kIntervalNs = 10 * kMs;
+  DeliveryStats stats;
+
+  // The first event has nothing to compare against.
+  stats.checkStreamGap(kNowNs, kNowNs + 4 * kIntervalNs, kIntervalNs);
+  // Within half an interval of jitter.
+  stats.checkStreamGap(kNowNs + 5 * kIntervalNs + kIntervalNs / 4,
+                       kNowNs + 9 * kIntervalNs, kIntervalNs);
+  EXPECT_EQ(toProto(stats).drop_count, 0);
+
+  // Three samples missing between 9 and 13.
+  stats.checkStreamGap(kNowNs + 13 * kIntervalNs, kNowNs + 15 * kIntervalNs,
+                       kIntervalNs);
+  EXPECT_EQ(toProto(stats).drop_count, 3);
+
+  stats.addDrops(2);
+  EXPECT_EQ(toProto(stats).drop_count, 5);
+  EXPECT_FALSE(stats.empty());
+}
+
+TEST(DeliveryStatsTest, RestartedStreamHasNoGap) {
+  constexpr uint64_t kIntervalNs = 10 * kMs;
+  DeliveryStats stats;
+
+  stats.checkStreamGap(kNowNs, kNowNs, kIntervalNs);
+  stats.restartStream();
+  stats.checkStreamGap(kNowNs + 100 * kIntervalNs,
+                       kNowNs + 100 * kIntervalNs, kIntervalNs);
+  EXPECT_EQ(toProto(stats).drop_count, 0);
+}
+
+TEST(DeliveryStatsTest, ClearKeepsTheLastSampleOfTheStream) {
+  constexpr uint64_t kIntervalNs = 10 * kMs;
+  DeliveryStats stats;
+
+  stats.checkStreamGap(kNowNs, kNowNs, kIntervalNs);
+  stats.addEvent(kNowNs - kMs, kNowNs);
+  stats.addDrops(1);
+  stats.clear();
+  EXPECT_TRUE(stats.empty());
+  EXPECT_EQ(toProto(stats).latency_count, 0);
+
+  // The gap across the clear is still detected.
+  stats.checkStreamGap(kNowNs + 3 * kIntervalNs, kNowNs + 3 * kIntervalNs,
+                       kIntervalNs);
+  EXPECT_EQ(toProto(stats).drop_count, 2);
+}
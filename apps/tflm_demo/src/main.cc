@@ -14,19 +14,68 @@
  * limitations under the License.
  */
 
+#include <cmath>
+
 #include "chre/util/nanoapp/log.h"
+#include "chre/util/nanoapp/model_runner.h"
 #include "chre_api/chre.h"
 #include "model.h"
 
 #define LOG_TAG "[TFLM demo]"
 
+namespace {
+
+// Sized from the arena usage logged at start for the sine model,
+// with some headroom. The arena is static so that it neither comes from the
+// CHRE heap nor from the nanoapp stack.
+constexpr size_t kTensorArenaSize = 2 * 1024;
+alignas(16) uint8_t gTensorArena[kTensorArenaSize];
+
+// Number of inferences run at start, spread over [0, 2 * pi].
+constexpr uint32_t kNumInferences = 1000;
+constexpr float kTwoPi = 6.2831853f;
+
+tflite::MicroMutableOpResolver gResolver;
+chre::ModelRunner gRunner;
+float gMaxError = 0.0f;
+
+float getInputValue(uint32_t index) {
+  return kTwoPi * static_cast<float>(index) / kNumInferences;
+}
+
+void fillInput(uint32_t index, TfLiteTensor *input, void * /* cookie */) {
+  input->data.f[0] = getInputValue(index);
+}
+
+void consumeOutput(uint32_t index, const TfLiteTensor *output,
+                   void * /* cookie */) {
+  float error = std::fabs(output->data.f[0] - std::sin(getInputValue(index)));
+  if (error > gMaxError) {
+    gMaxError = error;
+  }
+}
+
+}  // namespace
+
 bool nanoappStart(void) {
-  float y_val = ::demo::run(3.14);
-  LOGI("result = %f", y_val);
-  return true;
+  demo::registerOps(&gResolver);
+  if (!gRunner.init(demo::getModel(), gResolver, gTensorArena,
+                    kTensorArenaSize)) {
+    LOGE("Failed to allocate tensors in a %zu byte arena", kTensorArenaSize);
+    return false;
+  }
+  LOGI("Model uses %zu of %zu tensor arena bytes", gRunner.getArenaUsedBytes(),
+       kTensorArenaSize);
+  return gRunner.startBatch(kNumInferences, fillInput, consumeOutput,
+                            nullptr /* cookie */);
 }
 
 void nanoappEnd(void) {}
 
-void nanoappHandleEvent(uint32_t sender_instance_id, uint16_t event_type,
-                        const void *event_data) {}
+void nanoappHandleEvent(uint32_t /* sender_instance_id */, uint16_t event_type,
+                        const void * /* event_data */) {
+  if (gRunner.handleEvent(event_type) && !gRunner.isBatchRunning()) {
+    gRunner.logStats();
+    LOGI("Max error against sin(x): %f", gMaxError);
+  }
+}
@@ -18,8 +18,6 @@
 
 #include "sine_model_data.h"
 #include "tensorflow/lite/micro/kernels/micro_ops.h"
-#include "tensorflow/lite/micro/micro_interpreter.h"
-#include "tensorflow/lite/micro/micro_log.h"
 #include "tensorflow/lite/micro/micro_mutable_op_resolver.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 
@@ -38,29 +36,14 @@ void RegisterSelectedOps(::tflite::MicroMutableOpResolver *resolver) {
 }  // namespace
 
 namespace demo {
-float run(float x_val) {
-  const tflite::Model *model = tflite::GetModel(g_sine_model_data);
-  // TODO(wangtz): Check for schema version.
-
-  tflite::MicroMutableOpResolver resolver;
-  RegisterSelectedOps(&resolver);
-  constexpr int kTensorAreanaSize = 2 * 1024;
-  uint8_t tensor_arena[kTensorAreanaSize];
 
-  tflite::MicroInterpreter interpreter(model, resolver, tensor_arena,
-                                       kTensorAreanaSize);
-  interpreter.AllocateTensors();
+const tflite::Model *getModel() {
+  // TODO(wangtz): Check for schema version.
+  return tflite::GetModel(g_sine_model_data);
+}
 
-  TfLiteTensor *input = interpreter.input(0);
-  TfLiteTensor *output = interpreter.output(0);
-  input->data.f[0] = x_val;
-  TfLiteStatus invoke_status = interpreter.Invoke();
-  if (invoke_status != kTfLiteOk) {
-    MicroPrintf("Internal error: invoke failed.");
-    return 0.0;
-  }
-  float y_val = output->data.f[0];
-  return y_val;
+void registerOps(tflite::MicroMutableOpResolver *resolver) {
+  RegisterSelectedOps(resolver);
 }
 
 }  // namespace demo
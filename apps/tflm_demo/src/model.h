@@ -17,8 +17,17 @@
 #ifndef NANOAPPS_TFLM_DEMO_MODEL_H_
 #define NANOAPPS_TFLM_DEMO_MODEL_H_
 
+#include "tensorflow/lite/micro/micro_mutable_op_resolver.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
 namespace demo {
-float run(float x_val);
-}
+
+// Returns the sine model.
+const tflite::Model *getModel();
+
+// Registers the ops used by the sine model.
+void registerOps(tflite::MicroMutableOpResolver *resolver);
+
+}  // namespace demo
 
 #endif  // NANOAPPS_TFLM_DEMO_MODEL_H_
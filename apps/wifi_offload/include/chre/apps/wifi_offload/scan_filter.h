@@ -21,6 +21,7 @@
 
 #include "chre/apps/wifi_offload/generated/flatbuffers_types_generated.h"
 #include "chre/apps/wifi_offload/preferred_network.h"
+#include "chre/apps/wifi_offload/scan_result.h"
 
 namespace wifi_offload {
 
@@ -47,8 +48,44 @@ class ScanFilter {
 
   void Log() const;
 
-  Vector<PreferredNetwork> networks_to_match_;  // empty means match all
+  /**
+   * @return true if the result is at or above the RSSI threshold and its SSID
+   *         and security modes match one of networks_to_match()
+   */
+  bool Match(const ScanResult &result) const;
+
+  const Vector<PreferredNetwork> &networks_to_match() const {
+    return networks_to_match_;
+  }
+
+  /**
+   * Replaces the networks to match and rebuilds the index used by Match().
+   */
+  void SetNetworksToMatch(Vector<PreferredNetwork> &&networks);
+
   int8_t min_rssi_threshold_dbm_;
+
+ private:
+  struct MatchIndexEntry {
+    uint32_t ssid_hash;
+    uint8_t security_modes;
+    size_t network_index;  // Index into networks_to_match_
+  };
+
+  /* Rebuilds match_index_ from networks_to_match_ */
+  void BuildMatchIndex();
+
+  /* Fallback of Match() if the index could not be allocated */
+  bool MatchLinear(const ScanResult &result) const;
+
+  /* Only modified through SetNetworksToMatch() and Deserialize(), which keep
+   * match_index_ in sync */
+  Vector<PreferredNetwork> networks_to_match_;  // empty means match all
+
+  /* Entries of networks_to_match_ sorted by SSID hash */
+  Vector<MatchIndexEntry> match_index_;
+  /* Union of the security modes of all networks_to_match_ */
+  uint8_t indexed_security_modes_ = 0;
 };
 
 }  // namespace wifi_offload
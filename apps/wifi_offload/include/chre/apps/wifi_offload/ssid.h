@@ -53,6 +53,9 @@ class Ssid {
 
   void ToChreWifiSsidListItem(chreWifiSsidListItem *chre_ssid) const;
 
+  /* Returns the 32-bit FNV-1a hash of the SSID bytes */
+  uint32_t Hash() const;
+
  private:
   Vector<uint8_t> ssid_vec_;
 };
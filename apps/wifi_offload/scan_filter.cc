@@ -17,6 +17,9 @@
 #include "chre/apps/wifi_offload/scan_filter.h"
 #include "chre/apps/wifi_offload/vector_serialization.h"
 
+#include <algorithm>
+#include <utility>
+
 namespace wifi_offload {
 
 ScanFilter::ScanFilter() : min_rssi_threshold_dbm_(0) {}
@@ -48,6 +51,7 @@ bool ScanFilter::Deserialize(const ScanFilter::FbsType &fbs_filter) {
   }
 
   min_rssi_threshold_dbm_ = fbs_filter.min_rssi_threshold_dbm();
+  BuildMatchIndex();
   return true;
 }
 
@@ -60,4 +64,70 @@ void ScanFilter::Log() const {
   }
 }
 
+void ScanFilter::SetNetworksToMatch(Vector<PreferredNetwork> &&networks) {
+  networks_to_match_ = std::move(networks);
+  BuildMatchIndex();
+}
+
+void ScanFilter::BuildMatchIndex() {
+  match_index_.clear();
+  indexed_security_modes_ = 0;
+  match_index_.reserve(networks_to_match_.size());
+  for (size_t i = 0; i < networks_to_match_.size(); i++) {
+    const PreferredNetwork &net = networks_to_match_[i];
+    match_index_.push_back(
+        MatchIndexEntry{net.ssid_.Hash(), net.security_modes_, i});
+    indexed_security_modes_ |= net.security_modes_;
+  }
+
+  if (match_index_.size() != networks_to_match_.size()) {
+    LOGE("Failed to build ScanFilter match index.");
+    match_index_.clear();
+    return;
+  }
+
+  std::sort(match_index_.data(), match_index_.data() + match_index_.size(),
+            [](const MatchIndexEntry &a, const MatchIndexEntry &b) {
+              return a.ssid_hash < b.ssid_hash;
+            });
+}
+
+bool ScanFilter::Match(const ScanResult &result) const {
+  if (result.rssi_dbm_ < min_rssi_threshold_dbm_) {
+    return false;
+  }
+  if (networks_to_match_.empty()) {
+    return true;
+  }
+  if (match_index_.size() != networks_to_match_.size()) {
+    return MatchLinear(result);
+  }
+  if ((result.security_modes_ & indexed_security_modes_) == 0) {
+    return false;
+  }
+
+  const uint32_t hash = result.ssid_.Hash();
+  const MatchIndexEntry *end = match_index_.data() + match_index_.size();
+  const MatchIndexEntry *entry = std::lower_bound(
+      match_index_.data(), end, hash,
+      [](const MatchIndexEntry &e, uint32_t h) { return e.ssid_hash < h; });
+  for (; entry != end && entry->ssid_hash == hash; entry++) {
+    if ((entry->security_modes & result.security_modes_) != 0 &&
+        networks_to_match_[entry->network_index].ssid_ == result.ssid_) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ScanFilter::MatchLinear(const ScanResult &result) const {
+  for (const auto &net : networks_to_match_) {
+    if ((net.security_modes_ & result.security_modes_) != 0 &&
+        net.ssid_ == result.ssid_) {
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace wifi_offload
@@ -76,4 +76,16 @@ void Ssid::ToChreWifiSsidListItem(chreWifiSsidListItem *chre_ssid) const {
   chre_ssid->ssidLen = static_cast<uint8_t>(ssid_vec_.size());
 }
 
+uint32_t Ssid::Hash() const {
+  constexpr uint32_t kFnvOffsetBasis = 2166136261u;
+  constexpr uint32_t kFnvPrime = 16777619u;
+
+  uint32_t hash = kFnvOffsetBasis;
+  for (size_t i = 0; i < ssid_vec_.size(); i++) {
+    hash ^= ssid_vec_[i];
+    hash *= kFnvPrime;
+  }
+  return hash;
+}
+
 }  // namespace wifi_offload
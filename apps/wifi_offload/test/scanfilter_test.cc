@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <utility>
+
+#include "include/utility.h"
+
+namespace {
+
+/* Large preferred network list pushed by the host */
+constexpr size_t kNumPreferredNetworks = 512;
+/* Results reported by a scan in a dense environment */
+constexpr size_t kNumScanResults = 128;
+
+wifi_offload::PreferredNetwork MakeNetwork(const char *ssid,
+                                           uint8_t security_modes) {
+  wifi_offload::PreferredNetwork net;
+  net.ssid_.SetData(reinterpret_cast<const uint8_t *>(ssid), strlen(ssid));
+  net.security_modes_ = security_modes;
+  return net;
+}
+
+wifi_offload::ScanResult MakeResult(const char *ssid, uint8_t security_modes,
+                                    int8_t rssi_dbm) {
+  wifi_offload::ScanResult result;
+  result.ssid_.SetData(reinterpret_cast<const uint8_t *>(ssid), strlen(ssid));
+  result.security_modes_ = security_modes;
+  result.rssi_dbm_ = rssi_dbm;
+  return result;
+}
+
+/* Populates filter with random networks */
+void InitNetworks(wifi_offload::ScanFilter &filter, size_t count,
+                  wifi_offload_test::RandomGenerator &rand_gen) {
+  wifi_offload::Vector<wifi_offload::PreferredNetwork> networks;
+  for (size_t i = 0; i < count; i++) {
+    wifi_offload::PreferredNetwork net;
+    init(net, rand_gen);
+    networks.push_back(std::move(net));
+  }
+  filter.SetNetworksToMatch(std::move(networks));
+  filter.min_rssi_threshold_dbm_ = -100;
+}
+
+/* Half of the results share an SSID with a preferred network */
+void InitResults(const wifi_offload::ScanFilter &filter,
+                 wifi_offload::Vector<wifi_offload::ScanResult> &results,
+                 wifi_offload_test::RandomGenerator &rand_gen) {
+  for (size_t i = 0; i < kNumScanResults; i++) {
+    wifi_offload::ScanResult result;
+    init(result, rand_gen);
+    if (i % 2 == 0) {
+      size_t index =
+          rand_gen.get<size_t>() % filter.networks_to_match().size();
+      chreWifiSsidListItem ssid;
+      filter.networks_to_match()[index].ssid_.ToChreWifiSsidListItem(&ssid);
+      result.ssid_.SetData(ssid.ssid, ssid.ssidLen);
+    }
+    results.push_back(std::move(result));
+  }
+}
+
+/* Reference matching against every network */
+bool MatchAllNetworks(const wifi_offload::ScanFilter &filter,
+                      const wifi_offload::ScanResult &result) {
+  if (result.rssi_dbm_ < filter.min_rssi_threshold_dbm_) {
+    return false;
+  }
+  for (const auto &net : filter.networks_to_match()) {
+    if ((net.security_modes_ & result.security_modes_) != 0 &&
+        net.ssid_ == result.ssid_) {
+      return true;
+    }
+  }
+  return filter.networks_to_match().empty();
+}
+
+}  // namespace
+
+TEST(ScanFilterTest, EmptyNetworkListMatchesResultsAboveThreshold) {
+  wifi_offload::ScanFilter filter;
+  filter.min_rssi_threshold_dbm_ = -70;
+
+  EXPECT_TRUE(filter.Match(MakeResult("any", wifi_offload::OPEN, -60)));
+  EXPECT_FALSE(filter.Match(MakeResult("any", wifi_offload::OPEN, -80)));
+}
+
+TEST(ScanFilterTest, MatchRequiresSsidAndSecurityMode) {
+  wifi_offload::ScanFilter filter;
+  filter.min_rssi_threshold_dbm_ = -100;
+  wifi_offload::Vector<wifi_offload::PreferredNetwork> networks;
+  networks.push_back(MakeNetwork("home", wifi_offload::PSK));
+  networks.push_back(MakeNetwork("cafe", wifi_offload::OPEN));
+  networks.push_back(
+      MakeNetwork("work", wifi_offload::EAP | wifi_offload::PSK));
+  filter.SetNetworksToMatch(std::move(networks));
+
+  EXPECT_TRUE(filter.Match(MakeResult("home", wifi_offload::PSK, -50)));
+  EXPECT_TRUE(filter.Match(MakeResult("work", wifi_offload::EAP, -50)));
+  EXPECT_FALSE(filter.Match(MakeResult("home", wifi_offload::OPEN, -50)));
+  EXPECT_FALSE(filter.Match(MakeResult("hotel", wifi_offload::PSK, -50)));
+  EXPECT_FALSE(filter.Match(MakeResult("cafe", wifi_offload::WEP, -50)));
+}
+
+TEST(ScanFilterTest, SettingNetworksReplacesTheIndex) {
+  wifi_offload::ScanFilter filter;
+  filter.min_rssi_threshold_dbm_ = -100;
+  wifi_offload::Vector<wifi_offload::PreferredNetwork> networks;
+  networks.push_back(MakeNetwork("home", wifi_offload::PSK));
+  filter.SetNetworksToMatch(std::move(networks));
+
+  networks = wifi_offload::Vector<wifi_offload::PreferredNetwork>();
+  networks.push_back(MakeNetwork("cafe", wifi_offload::OPEN));
+  filter.SetNetworksToMatch(std::move(networks));
+
+  EXPECT_TRUE(filter.Match(MakeResult("cafe", wifi_offload::OPEN, -50)));
+  EXPECT_FALSE(filter.Match(MakeResult("home", wifi_offload::PSK, -50)));
+}
+
+TEST(ScanFilterTest, DeserializeBuildsMatchIndex) {
+  wifi_offload::ScanFilter filter;
+  filter.min_rssi_threshold_dbm_ = -100;
+  wifi_offload::Vector<wifi_offload::PreferredNetwork> networks;
+  networks.push_back(MakeNetwork("home", wifi_offload::PSK));
+  filter.SetNetworksToMatch(std::move(networks));
+
+  flatbuffers::FlatBufferBuilder builder;
+  builder.Finish(filter.Serialize(&builder));
+  const auto *fbs_filter =
+      flatbuffers::GetRoot<wifi_offload::ScanFilter::FbsType>(
+          builder.GetBufferPointer());
+
+  wifi_offload::ScanFilter deserialized;
+  ASSERT_TRUE(deserialized.Deserialize(*fbs_filter));
+  EXPECT_TRUE(deserialized.Match(MakeResult("home", wifi_offload::PSK, -50)));
+  EXPECT_FALSE(deserialized.Match(MakeResult("cafe", wifi_offload::PSK, -50)));
+}
+
+TEST(ScanFilterTest, IndexedMatchAgreesWithMatchingEveryNetwork) {
+  wifi_offload_test::RandomGenerator rand_gen;
+  wifi_offload::ScanFilter filter;
+  InitNetworks(filter, kNumPreferredNetworks, rand_gen);
+
+  wifi_offload::Vector<wifi_offload::ScanResult> results;
+  InitResults(filter, results, rand_gen);
+
+  size_t num_matched = 0;
+  for (const auto &result : results) {
+    EXPECT_EQ(filter.Match(result), MatchAllNetworks(filter, result));
+    num_matched += filter.Match(result) ? 1 : 0;
+  }
+  EXPECT_GT(num_matched, 0u);
+}
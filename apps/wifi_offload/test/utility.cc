@@ -16,6 +16,8 @@
 
 #include "include/utility.h"
 
+#include <utility>
+
 using RpcLog = wifi_offload::RpcLogRecord::RpcLogRecordType;
 
 namespace wifi_offload_test {
@@ -124,7 +126,9 @@ void init(wifi_offload::ScanParams &params, RandomGenerator &rand_gen) {
 }
 
 void init(wifi_offload::ScanFilter &filter, RandomGenerator &rand_gen) {
-  init<wifi_offload::PreferredNetwork>(filter.networks_to_match_, rand_gen);
+  wifi_offload::Vector<wifi_offload::PreferredNetwork> networks;
+  init<wifi_offload::PreferredNetwork>(networks, rand_gen);
+  filter.SetNetworksToMatch(std::move(networks));
   init_rssi(filter.min_rssi_threshold_dbm_, rand_gen);
 }
 
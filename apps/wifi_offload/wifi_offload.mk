@@ -37,6 +37,7 @@ GOOGLETEST_SRCS += $(WIFI_OFFLOAD_TYPES_PREFIX)/test/flatbuffersserialization_te
 GOOGLETEST_SRCS += $(WIFI_OFFLOAD_TYPES_PREFIX)/test/offloadtypes_test.cc
 GOOGLETEST_SRCS += $(WIFI_OFFLOAD_TYPES_PREFIX)/test/random_generator.cc
 GOOGLETEST_SRCS += $(WIFI_OFFLOAD_TYPES_PREFIX)/test/randomgenerator_test.cc
+GOOGLETEST_SRCS += $(WIFI_OFFLOAD_TYPES_PREFIX)/test/scanfilter_test.cc
 GOOGLETEST_SRCS += $(WIFI_OFFLOAD_TYPES_PREFIX)/test/scanresult_test.cc
 GOOGLETEST_SRCS += $(WIFI_OFFLOAD_TYPES_PREFIX)/test/utility.cc
 GOOGLETEST_SRCS += $(WIFI_OFFLOAD_TYPES_PREFIX)/test/wifioffloadutility_test.cc
@@ -969,6 +969,46 @@ bool chrePublishRpcServices(struct chreNanoappRpcService *services,
 bool chreGetHostEndpointInfo(uint16_t hostEndpointId,
                              struct chreHostEndpointInfo *info);
 
+/**
+ * Retains the data of an event past nanoappHandleEvent(), so that the nanoapp
+ * can keep using it without copying it, e.g. to process it later or to
+ * compare it with the data of the following events.
+ *
+ * Only the data of some of the events posted by the CHRE implementation can
+ * be retained, which may differ between implementations, so nanoapps must
+ * copy the data they need when this function returns false. Retained data,
+ * including the memory it points to, e.g. the results of a struct
+ * chreWifiScanEvent, remains valid until the nanoapp releases it through
+ * chreEventDataRelease() or is unloaded. It must not be modified, as it may
+ * be shared with other nanoapps. The same data may be retained several times,
+ * in which case it must be released as many times.
+ *
+ * @param eventData The eventData argument of the nanoappHandleEvent() call in
+ *     progress.
+ *
+ * @return true if the data has been retained.
+ *
+ * @see chreEventDataRelease
+ *
+ * @since v1.9
+ */
+bool chreEventDataRetain(const void *eventData);
+
+/**
+ * Releases event data retained through chreEventDataRetain(), which must no
+ * longer be accessed by the nanoapp unless it holds other references to it.
+ *
+ * @param eventData The data to release.
+ *
+ * @return true if the data was retained by this nanoapp and has been
+ *     released.
+ *
+ * @see chreEventDataRetain
+ *
+ * @since v1.9
+ */
+bool chreEventDataRelease(const void *eventData);
+
 #ifdef __cplusplus
 }
 #endif
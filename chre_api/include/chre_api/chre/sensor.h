@@ -399,7 +399,20 @@ extern "C" {
 #define CHRE_EVENT_SENSOR_UNCALIBRATED_ACCELEROMETER_BIAS_INFO \
     (CHRE_EVENT_SENSOR_OTHER_EVENTS_BASE + 7)
 
-#if CHRE_EVENT_SENSOR_UNCALIBRATED_ACCELEROMETER_BIAS_INFO > \
+/**
+ * nanoappHandleEvent argument: struct chreSensorSynchronizedBatchEvent
+ *
+ * Delivers together the data events of the sensors grouped by
+ * chreSensorConfigureSynchronizedBatch().
+ *
+ * @see chreSensorConfigureSynchronizedBatch
+ *
+ * @since v1.9
+ */
+#define CHRE_EVENT_SENSOR_SYNCHRONIZED_BATCH \
+    (CHRE_EVENT_SENSOR_OTHER_EVENTS_BASE + 8)
+
+#if CHRE_EVENT_SENSOR_SYNCHRONIZED_BATCH > \
     CHRE_EVENT_SENSOR_LAST_EVENT
 #error Too many sensor events.
 #endif
@@ -413,6 +426,14 @@ extern "C" {
  */
 #define CHRE_SENSOR_LATENCY_ASAP  UINT64_C(0)
 
+/**
+ * The maximum number of sensors that can be grouped by
+ * chreSensorConfigureSynchronizedBatch().
+ *
+ * @since v1.9
+ */
+#define CHRE_SENSOR_SYNCHRONIZED_BATCH_MAX_SENSORS  UINT8_C(4)
+
 /**
  * Special value indicating non-importance, or non-applicability of the sampling
  * interval.
@@ -695,6 +716,37 @@ struct chreSensorSamplingStatusEvent {
     struct chreSensorSamplingStatus status;
 };
 
+/**
+ * The nanoappHandleEvent argument for CHRE_EVENT_SENSOR_SYNCHRONIZED_BATCH.
+ *
+ * @see chreSensorConfigureSynchronizedBatch
+ *
+ * @since v1.9
+ */
+struct chreSensorSynchronizedBatchEvent {
+    /**
+     * The number of sensors in the group, as given to
+     * chreSensorConfigureSynchronizedBatch().
+     */
+    uint8_t sensorCount;
+
+    /**
+     * Reserved for future use. Set to 0.
+     */
+    uint8_t reserved[3];
+
+    /**
+     * sensorData[i] is the data event of the i-th sensor given to
+     * chreSensorConfigureSynchronizedBatch(), or NULL if that sensor did not
+     * deliver data for this batch. A non-NULL entry points to a copy of the
+     * structure that would have been delivered in the data event of the
+     * sensor, e.g. a struct chreSensorThreeAxisData for an accelerometer,
+     * valid for the lifetime of this event. Entries at and after sensorCount
+     * are NULL.
+     */
+    const void *sensorData[CHRE_SENSOR_SYNCHRONIZED_BATCH_MAX_SENSORS];
+};
+
 /**
  * The nanoappHandleEvent argument for CHRE_EVENT_SENSOR_FLUSH_COMPLETE.
  *
@@ -1115,6 +1167,40 @@ bool chreSensorGetThreeAxisBias(uint32_t sensorHandle,
  */
 bool chreSensorFlushAsync(uint32_t sensorHandle, const void *cookie);
 
+/**
+ * Groups continuous sensors so that their data is delivered to this nanoapp
+ * in a single CHRE_EVENT_SENSOR_SYNCHRONIZED_BATCH event instead of one data
+ * event per sensor.
+ *
+ * This is intended for nanoapps that fuse the data of several sensors, e.g.
+ * accelerometer, gyroscope and magnetometer. The sensors are still configured
+ * individually through chreSensorConfigure(), and should use the same
+ * latency so that their batches are delivered by the platform around the
+ * same time. A batch event is delivered once every sensor of the group has
+ * delivered a data event, or shortly after the first data event of the batch
+ * if some sensor does not deliver data in time, in which case its entry in
+ * the event is NULL. While a group is configured, this nanoapp does not
+ * receive the individual data events of the grouped sensors.
+ *
+ * A nanoapp has at most one group. Configuring a new group replaces the
+ * previous one, after delivering any data received for it, and a
+ * sensorCount of 0 removes the group.
+ *
+ * @param sensorHandles  The handles of the sensors to group, as obtained from
+ *     chreSensorFindDefault(). Must contain sensorCount distinct handles of
+ *     continuous sensors whose type is defined by this API, i.e. not vendor
+ *     sensor types. May be NULL if sensorCount is 0.
+ * @param sensorCount  The number of sensors to group, at most
+ *     CHRE_SENSOR_SYNCHRONIZED_BATCH_MAX_SENSORS.
+ *
+ * @return true if the group was configured, false if the arguments are
+ *     invalid or the feature is not supported by the CHRE implementation.
+ *
+ * @since v1.9
+ */
+bool chreSensorConfigureSynchronizedBatch(const uint32_t *sensorHandles,
+                                          uint8_t sensorCount);
+
 #ifdef __cplusplus
 }
 #endif
@@ -454,7 +454,7 @@ void AudioRequestManager::postAudioDataEventFatal(
     mPlatformAudio.releaseAudioDataEvent(event);
   } else {
     for (const auto &instanceId : instanceIds) {
-      EventLoopManagerSingleton::get()->getEventLoop().postEventOrDie(
+      EventLoopManagerSingleton::get()->getEventLoop().postEventInlineOrDie(
           CHRE_EVENT_AUDIO_DATA, event, freeAudioDataEventCallback, instanceId);
     }
 
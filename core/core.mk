@@ -13,6 +13,7 @@ COMMON_SRCS += $(CHRE_PREFIX)/core/debug_dump_manager.cc
 COMMON_SRCS += $(CHRE_PREFIX)/core/event.cc
 COMMON_SRCS += $(CHRE_PREFIX)/core/event_loop.cc
 COMMON_SRCS += $(CHRE_PREFIX)/core/event_loop_manager.cc
+COMMON_SRCS += $(CHRE_PREFIX)/core/event_payload_arena.cc
 COMMON_SRCS += $(CHRE_PREFIX)/core/event_ref_queue.cc
 COMMON_SRCS += $(CHRE_PREFIX)/core/host_comms_manager.cc
 COMMON_SRCS += $(CHRE_PREFIX)/core/host_endpoint_manager.cc
@@ -44,6 +45,7 @@ endif
 # Optional sensors support.
 ifeq ($(CHRE_SENSORS_SUPPORT_ENABLED), true)
 COMMON_SRCS += $(CHRE_PREFIX)/core/sensor.cc
+COMMON_SRCS += $(CHRE_PREFIX)/core/sensor_batch_synchronizer.cc
 COMMON_SRCS += $(CHRE_PREFIX)/core/sensor_request.cc
 COMMON_SRCS += $(CHRE_PREFIX)/core/sensor_request_manager.cc
 COMMON_SRCS += $(CHRE_PREFIX)/core/sensor_request_multiplexer.cc
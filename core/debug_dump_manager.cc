@@ -72,6 +72,7 @@ void DebugDumpManager::appendNanoappLog(const Nanoapp &nanoapp,
 void DebugDumpManager::collectFrameworkDebugDumps() {
   auto *eventLoopManager = EventLoopManagerSingleton::get();
   eventLoopManager->getMemoryManager().logStateToBuffer(mDebugDump);
+  eventLoopManager->getEventPayloadArena().logStateToBuffer(mDebugDump);
   eventLoopManager->getEventLoop().handleNanoappWakeupBuckets();
   eventLoopManager->getEventLoop().logStateToBuffer(mDebugDump);
 #ifdef CHRE_SENSORS_SUPPORT_ENABLED
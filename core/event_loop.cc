@@ -26,6 +26,7 @@
 #include "chre/platform/fatal_error.h"
 #include "chre/platform/log.h"
 #include "chre/platform/system_time.h"
+#include "chre/platform/tracing.h"
 #include "chre/util/conditional_lock_guard.h"
 #include "chre/util/lock_guard.h"
 #include "chre/util/system/debug_dump.h"
@@ -39,6 +40,10 @@ namespace chre {
 // Out of line declaration required for nonintegral static types
 constexpr Nanoseconds EventLoop::kIntervalWakeupBucket;
 
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+thread_local EventLoop::Shard *EventLoop::tCurrentShard = nullptr;
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
+
 namespace {
 
 #ifndef CHRE_STATIC_EVENT_LOOP
@@ -95,6 +100,25 @@ void deallocateFromMemoryPool(Event *event, void *memoryPool) {
 }
 #endif
 
+/**
+ * @return true if an event is one posted by the system to nanoapps with
+ *         postEventOrDie, as opposed to a system callback or an event sent by
+ *         a nanoapp. These are never removed from the queue to make space.
+ */
+bool isEventFromSystem(const Event *event) {
+  return event->senderInstanceId == kSystemInstanceId &&
+         event->targetInstanceId != kSystemInstanceId && !event->isLowPriority;
+}
+
+/**
+ * @return true if a nanoapp must receive an event.
+ */
+bool isEventRecipient(const Event *event, const Nanoapp &app) {
+  return (event->targetInstanceId == kBroadcastInstanceId &&
+          app.isRegisteredForBroadcastEvent(event)) ||
+         event->targetInstanceId == app.getInstanceId();
+}
+
 }  // anonymous namespace
 
 bool EventLoop::findNanoappInstanceIdByAppId(uint64_t appId,
@@ -128,6 +152,13 @@ void EventLoop::invokeMessageFreeFunction(uint64_t appId,
   Nanoapp *nanoapp = lookupAppByAppId(appId);
   if (nanoapp == nullptr) {
     LOGE("Couldn't find app 0x%016" PRIx64 " for message free callback", appId);
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+  } else if (mNumShards > 0) {
+    // The nanoapp may be running on its shard.
+    ShardItem item = {ShardItem::Type::FreeMessage, nanoapp, nullptr,
+                      freeFunction, message, messageSize};
+    pushShardItem(getShard(*nanoapp), item);
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
   } else {
     auto prevCurrentApp = mCurrentApp;
     mCurrentApp = nanoapp;
@@ -148,6 +179,9 @@ void EventLoop::run() {
 
     // mEvents.pop() will be a blocking call if mEvents.empty()
     Event *event = mEvents.pop();
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+    ConditionalLockGuard<Mutex> systemLock(mSystemLock, mNumShards > 0);
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
     // Need size() + 1 since the to-be-processed event has already been removed.
     mPowerControlManager.preEventLoopProcess(mEvents.size() + 1);
     distributeEvent(event);
@@ -155,6 +189,10 @@ void EventLoop::run() {
     mPowerControlManager.postEventLoopProcess(mEvents.size());
   }
 
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+  ConditionalLockGuard<Mutex> systemLock(mSystemLock, mNumShards > 0);
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
+
   // Purge the main queue of events pending distribution. All nanoapps should be
   // prevented from sending events or messages at this point via
   // currentNanoappIsStopping() returning true.
@@ -162,11 +200,24 @@ void EventLoop::run() {
     freeEvent(mEvents.pop());
   }
 
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+  if (mNumShards > 0) {
+    waitForShards();
+  }
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
+
   // Unload all running nanoapps
   while (!mNanoapps.empty()) {
     unloadNanoappAtIndex(mNanoapps.size() - 1);
   }
 
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+  for (size_t i = 0; i < mNumShards; i++) {
+    ShardItem item = {ShardItem::Type::Stop};
+    pushShardItem(mShards[i], item);
+  }
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
+
   LOGI("Exiting EventLoop");
 }
 
@@ -241,6 +292,11 @@ bool EventLoop::unloadNanoapp(uint16_t instanceId,
         // interested in handling any message free callbacks generated by
         // flushInboundEventQueue()
         flushInboundEventQueue();
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+        if (mNumShards > 0) {
+          waitForShards();
+        }
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
 
         // Post the unload event now (so we can reference the Nanoapp instance
         // directly), but nanoapps won't get it until after the unload
@@ -307,6 +363,29 @@ void EventLoop::postEventOrDie(uint16_t eventType, void *eventData,
   }
 }
 
+void EventLoop::postEventInlineOrDie(uint16_t eventType, void *eventData,
+                                     chreEventCompleteFunction *freeCallback,
+                                     uint16_t targetInstanceId,
+                                     uint16_t targetGroupMask) {
+  bool distributeInline = mRunning && mInSystemCallback &&
+                          mCurrentApp == nullptr &&
+                          mNumInlineEvents < kMaxInlineEventCount &&
+                          mNumQueuedEventsFromSystem.load() == 0;
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+  // Inline events live on the stack, while shards process events later.
+  distributeInline = distributeInline && mNumShards == 0;
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
+  if (distributeInline) {
+    CHRE_ASSERT(targetInstanceId != kSystemInstanceId);
+    mInlineEvents[mNumInlineEvents++] = {eventType, targetInstanceId,
+                                         targetGroupMask, eventData,
+                                         freeCallback};
+  } else {
+    postEventOrDie(eventType, eventData, freeCallback, targetInstanceId,
+                   targetGroupMask);
+  }
+}
+
 bool EventLoop::postSystemEvent(uint16_t eventType, void *eventData,
                                 SystemEventCallbackFunction *callback,
                                 void *extraData) {
@@ -327,6 +406,7 @@ bool EventLoop::postSystemEvent(uint16_t eventType, void *eventData,
                 ": out of memory",
                 eventType);
   }
+  CHRE_TRACE_INSTANT_DATA("Defer callback", "type:" TRACE_U16, eventType);
 
   return true;
 }
@@ -390,8 +470,16 @@ bool EventLoop::populateNanoappInfoForInstanceId(
   return populateNanoappInfo(app, info);
 }
 
+size_t EventLoop::getNumEventsAllocated() {
+#ifdef CHRE_STATIC_EVENT_LOOP
+  return kMaxEventCount - mEventPool.getFreeBlockCount();
+#else
+  return kMaxEventCount - mEventPool.getFreeSpaceCount();
+#endif
+}
+
 bool EventLoop::currentNanoappIsStopping() const {
-  return (mCurrentApp == mStoppingNanoapp || !mRunning);
+  return (getCurrentNanoapp() == mStoppingNanoapp || !mRunning);
 }
 
 void EventLoop::logStateToBuffer(DebugDumpWrapper &debugDump) const {
@@ -444,25 +532,65 @@ bool EventLoop::allocateAndPostEvent(uint16_t eventType, void *eventData,
       mEventPool.allocate(eventType, eventData, freeCallback, isLowPriority,
                           senderInstanceId, targetInstanceId, targetGroupMask);
   if (event != nullptr) {
-    success = mEvents.push(event);
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+    success = postEventToTargetShard(event);
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
+    if (!success) {
+      // Counted before the push so it can't be distributed before.
+      bool isFromSystem = isEventFromSystem(event);
+      if (isFromSystem) {
+        mNumQueuedEventsFromSystem.fetch_increment();
+      }
+      success = mEvents.push(event);
+      if (!success && isFromSystem) {
+        mNumQueuedEventsFromSystem.fetch_decrement();
+      }
+    }
+  }
+  if (success) {
+    CHRE_TRACE_INSTANT_DATA("Post event",
+                            "type:" TRACE_U16 ",sender:" TRACE_U16
+                            ",target:" TRACE_U16,
+                            eventType, senderInstanceId, targetInstanceId);
   }
 
   return success;
 }
 
 void EventLoop::deliverNextEvent(const UniquePtr<Nanoapp> &app, Event *event) {
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+  if (mNumShards > 0) {
+    // Referenced until processed by the shard.
+    event->incrementRefCount();
+    ShardItem item = {ShardItem::Type::DeliverEvent, app.get(), event};
+    pushShardItem(getShard(*app), item);
+    return;
+  }
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
+
   // TODO: cleaner way to set/clear this? RAII-style?
   mCurrentApp = app.get();
+  mCurrentEvent = event;
   app->processEvent(event);
+  mCurrentEvent = nullptr;
   mCurrentApp = nullptr;
 }
 
 void EventLoop::distributeEvent(Event *event) {
+  CHRE_TRACE_START_DATA("Distribute event", "type:" TRACE_U16,
+                        event->eventType);
+  if (isEventFromSystem(event)) {
+    mNumQueuedEventsFromSystem.fetch_decrement();
+  }
+  deliverEvent(event);
+  freeEvent(event);
+  CHRE_TRACE_END("Distribute event");
+}
+
+void EventLoop::deliverEvent(Event *event) {
   bool eventDelivered = false;
   for (const UniquePtr<Nanoapp> &app : mNanoapps) {
-    if ((event->targetInstanceId == chre::kBroadcastInstanceId &&
-         app->isRegisteredForBroadcastEvent(event)) ||
-        event->targetInstanceId == app->getInstanceId()) {
+    if (isEventRecipient(event, *app)) {
       eventDelivered = true;
       deliverNextEvent(app, event);
     }
@@ -477,8 +605,26 @@ void EventLoop::distributeEvent(Event *event) {
     LOGW("Dropping event 0x%" PRIx16 " from instanceId %" PRIu16 "->%" PRIu16,
          event->eventType, event->senderInstanceId, event->targetInstanceId);
   }
-  CHRE_ASSERT(event->isUnreferenced());
-  freeEvent(event);
+}
+
+void EventLoop::distributeInlineEvents(size_t firstIndex) {
+  // No event is added while distributing, as nanoapps and free callbacks don't
+  // run in the context of a system callback.
+  for (size_t i = firstIndex; i < mNumInlineEvents; i++) {
+    const InlineEvent &inlineEvent = mInlineEvents[i];
+    CHRE_TRACE_START_DATA("Distribute inline event", "type:" TRACE_U16,
+                          inlineEvent.eventType);
+    Event event(inlineEvent.eventType, inlineEvent.eventData,
+                inlineEvent.freeCallback, /* isLowPriority= */ false,
+                kSystemInstanceId, inlineEvent.targetInstanceId,
+                inlineEvent.targetGroupMask);
+    deliverEvent(&event);
+    if (event.hasFreeCallback()) {
+      invokeEventFreeCallback(&event);
+    }
+    CHRE_TRACE_END("Distribute inline event");
+  }
+  mNumInlineEvents = firstIndex;
 }
 
 void EventLoop::flushInboundEventQueue() {
@@ -488,14 +634,40 @@ void EventLoop::flushInboundEventQueue() {
 }
 
 void EventLoop::freeEvent(Event *event) {
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+  if (mNumShards > 0 && event->targetInstanceId != kSystemInstanceId) {
+    if (event->isUnreferenced()) {
+      releaseShardedEvent(event);
+    }
+    return;
+  }
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
+
+  CHRE_ASSERT(event->isUnreferenced());
+  // System callbacks may run nested, e.g. when a nanoapp unload flushes the
+  // inbound queue, so each one only distributes the events it posted.
+  size_t firstInlineEvent = mNumInlineEvents;
   if (event->hasFreeCallback()) {
-    // TODO: find a better way to set the context to the creator of the event
-    mCurrentApp = lookupAppByInstanceId(event->senderInstanceId);
-    event->invokeFreeCallback();
-    mCurrentApp = nullptr;
+    invokeEventFreeCallback(event);
   }
 
   mEventPool.deallocate(event);
+  distributeInlineEvents(firstInlineEvent);
+}
+
+void EventLoop::invokeEventFreeCallback(Event *event) {
+  bool isSystemEvent = (event->targetInstanceId == kSystemInstanceId);
+  bool wasInSystemCallback = mInSystemCallback;
+  mInSystemCallback = isSystemEvent;
+
+  // The sender of a system event is always the system, senderInstanceId
+  // being part of extraData.
+  // TODO: find a better way to set the context to the creator of the event
+  mCurrentApp = isSystemEvent ? nullptr
+                              : lookupAppByInstanceId(event->senderInstanceId);
+  event->invokeFreeCallback();
+  mCurrentApp = nullptr;
+  mInSystemCallback = wasInSystemCallback;
 }
 
 Nanoapp *EventLoop::lookupAppByAppId(uint64_t appId) const {
@@ -601,6 +773,11 @@ void EventLoop::unloadNanoappAtIndex(size_t index, bool nanoappStarted) {
           nanoapp.get());
   logDanglingResources("heap blocks", numFreedBlocks);
 
+  const uint32_t numReleasedPayloads = EventLoopManagerSingleton::get()
+                                           ->getEventPayloadArena()
+                                           .nanoappReleaseAll(nanoapp.get());
+  logDanglingResources("retained event payloads", numReleasedPayloads);
+
   // Destroy the Nanoapp instance
   mNanoapps.erase(index);
 
@@ -625,4 +802,138 @@ void EventLoop::logDanglingResources(const char *name, uint32_t count) {
   }
 }
 
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+EventLoop::SystemLockGuard::SystemLockGuard() {
+  Shard *shard = tCurrentShard;
+  if (shard != nullptr && shard->systemLockDepth++ == 0) {
+    EventLoopManagerSingleton::get()->getEventLoop().mSystemLock.lock();
+  }
+}
+
+EventLoop::SystemLockGuard::~SystemLockGuard() {
+  Shard *shard = tCurrentShard;
+  if (shard != nullptr && --shard->systemLockDepth == 0) {
+    EventLoopManagerSingleton::get()->getEventLoop().mSystemLock.unlock();
+  }
+}
+
+void EventLoop::setNumShards(size_t numShards) {
+  CHRE_ASSERT(numShards <= kMaxShardCount);
+  CHRE_ASSERT(mNanoapps.empty());
+  mNumShards = (numShards < kMaxShardCount) ? numShards : kMaxShardCount;
+}
+
+void EventLoop::runShard(size_t shardIndex) {
+  CHRE_ASSERT(shardIndex < mNumShards);
+  Shard &shard = mShards[shardIndex];
+  tCurrentShard = &shard;
+
+  bool running = true;
+  while (running) {
+    ShardItem item = shard.items.pop();
+    running = (item.type != ShardItem::Type::Stop);
+    processShardItem(shard, item);
+  }
+
+  tCurrentShard = nullptr;
+}
+
+void EventLoop::pushShardItem(Shard &shard, const ShardItem &item) {
+  if (!shard.items.push(item)) {
+    FATAL_ERROR("Failed to post to event loop shard %zu",
+                static_cast<size_t>(&shard - mShards));
+  }
+}
+
+bool EventLoop::postEventToTargetShard(Event *event) {
+  bool posted = false;
+  if (tCurrentShard != nullptr &&
+      event->senderInstanceId != kSystemInstanceId &&
+      event->targetInstanceId != kBroadcastInstanceId) {
+    SystemLockGuard lock;
+    Nanoapp *target = lookupAppByInstanceId(event->targetInstanceId);
+    if (target != nullptr && target != mStoppingNanoapp) {
+      event->incrementRefCount();
+      ShardItem item = {ShardItem::Type::DeliverEvent, target, event};
+      pushShardItem(getShard(*target), item);
+      posted = true;
+    }
+  }
+  return posted;
+}
+
+void EventLoop::releaseShardedEvent(Event *event) {
+  Nanoapp *sender = lookupAppByInstanceId(event->senderInstanceId);
+  if (event->freeCallback != nullptr && sender != nullptr) {
+    ShardItem item = {ShardItem::Type::FreeEvent, sender, event};
+    pushShardItem(getShard(*sender), item);
+  } else {
+    // The free callbacks of the system run on the thread releasing the event,
+    // with the system lock held.
+    if (event->freeCallback != nullptr) {
+      event->invokeFreeCallback();
+    }
+    mEventPool.deallocate(event);
+  }
+}
+
+void EventLoop::processShardItem(Shard &shard, const ShardItem &item) {
+  switch (item.type) {
+    case ShardItem::Type::DeliverEvent: {
+      shard.currentApp = item.nanoapp;
+      shard.currentEvent = item.event;
+      item.nanoapp->processEvent(item.event);
+      shard.currentEvent = nullptr;
+      shard.currentApp = nullptr;
+
+      SystemLockGuard lock;
+      item.event->decrementRefCount();
+      if (item.event->isUnreferenced()) {
+        releaseShardedEvent(item.event);
+      }
+      break;
+    }
+
+    case ShardItem::Type::FreeEvent:
+      shard.currentApp = item.nanoapp;
+      item.event->invokeFreeCallback();
+      shard.currentApp = nullptr;
+      mEventPool.deallocate(item.event);
+      break;
+
+    case ShardItem::Type::FreeMessage:
+      shard.currentApp = item.nanoapp;
+      item.messageFreeFunction(item.message, item.messageSize);
+      shard.currentApp = nullptr;
+      break;
+
+    case ShardItem::Type::Barrier: {
+      SystemLockGuard lock;
+      if (--mNumPendingShardBarriers == 0) {
+        mShardBarrierCondition.notify_one();
+      }
+      break;
+    }
+
+    case ShardItem::Type::Stop:
+      break;
+  }
+}
+
+void EventLoop::waitForShards() {
+  // Delivering an event sent by a nanoapp may post its free callback to
+  // another shard, which has already passed its barrier, hence a second pass.
+  for (int pass = 0; pass < 2; pass++) {
+    mNumPendingShardBarriers = mNumShards;
+    for (size_t i = 0; i < mNumShards; i++) {
+      ShardItem item = {ShardItem::Type::Barrier};
+      pushShardItem(mShards[i], item);
+    }
+    while (mNumPendingShardBarriers > 0) {
+      mShardBarrierCondition.wait(mSystemLock);
+    }
+  }
+}
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
+
 }  // namespace chre
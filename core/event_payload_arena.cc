@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre/core/event_payload_arena.h"
+
+#include <cinttypes>
+#include <new>
+
+#include "chre/core/event_loop_manager.h"
+#include "chre/platform/assert.h"
+#include "chre/platform/log.h"
+#include "chre/platform/memory.h"
+#include "chre/util/lock_guard.h"
+
+namespace chre {
+
+void *EventPayloadArena::allocate(size_t size) {
+  LockGuard<Mutex> lock(mMutex);
+
+  // Falls back to the larger classes, then to the heap, when a pool is
+  // exhausted.
+  void *block = nullptr;
+  SizeClass sizeClass = SizeClass::Small;
+  if (size <= kSmallPayloadSize) {
+    block = mSmallPool.allocate();
+  }
+  if (block == nullptr && size <= kMediumPayloadSize) {
+    sizeClass = SizeClass::Medium;
+    block = mMediumPool.allocate();
+  }
+  if (block == nullptr && size <= kLargePayloadSize) {
+    sizeClass = SizeClass::Large;
+    block = mLargePool.allocate();
+  }
+  if (block == nullptr) {
+    sizeClass = SizeClass::Heap;
+    if (mHeapPayloads.reserve(mHeapPayloads.size() + 1)) {
+      block = memoryAlloc(kHeaderSize + size);
+    }
+  }
+
+  void *payload = nullptr;
+  if (block == nullptr) {
+    LOG_OOM();
+  } else {
+    payload = static_cast<uint8_t *>(block) + kHeaderSize;
+    new (getHeader(payload)) PayloadHeader{1, sizeClass};
+    if (sizeClass == SizeClass::Heap) {
+      mHeapPayloads.push_back(payload);
+      mNumHeapAllocations++;
+    }
+    mPayloadCount++;
+    if (mPayloadCount > mPeakPayloadCount) {
+      mPeakPayloadCount = mPayloadCount;
+    }
+  }
+  return payload;
+}
+
+bool EventPayloadArena::addReference(const void *payload) {
+  LockGuard<Mutex> lock(mMutex);
+  bool success = isPayloadLocked(payload);
+  if (success) {
+    getHeader(payload)->refCount++;
+  }
+  return success;
+}
+
+void EventPayloadArena::release(const void *payload) {
+  LockGuard<Mutex> lock(mMutex);
+  if (!isPayloadLocked(payload)) {
+    LOGE("Releasing unknown event payload %p", payload);
+    CHRE_ASSERT(false);
+  } else {
+    releaseLocked(payload);
+  }
+}
+
+void EventPayloadArena::freeEventCallback(uint16_t /* eventType */,
+                                          void *eventData) {
+  EventLoopManagerSingleton::get()->getEventPayloadArena().release(eventData);
+}
+
+bool EventPayloadArena::nanoappRetain(Nanoapp *app, const Event *currentEvent,
+                                      const void *payload) {
+  if (currentEvent == nullptr || currentEvent->eventData != payload) {
+    return false;
+  }
+
+  LockGuard<Mutex> lock(mMutex);
+  bool success = isPayloadLocked(payload) &&
+                 mRetentions.push_back({app->getInstanceId(), payload});
+  if (success) {
+    getHeader(payload)->refCount++;
+  }
+  return success;
+}
+
+bool EventPayloadArena::nanoappRelease(Nanoapp *app, const void *payload) {
+  LockGuard<Mutex> lock(mMutex);
+  for (size_t i = 0; i < mRetentions.size(); i++) {
+    if (mRetentions[i].instanceId == app->getInstanceId() &&
+        mRetentions[i].payload == payload) {
+      mRetentions.erase(i);
+      releaseLocked(payload);
+      return true;
+    }
+  }
+  return false;
+}
+
+uint32_t EventPayloadArena::nanoappReleaseAll(Nanoapp *app) {
+  LockGuard<Mutex> lock(mMutex);
+  uint32_t numReleased = 0;
+  for (size_t i = mRetentions.size(); i > 0; i--) {
+    if (mRetentions[i - 1].instanceId == app->getInstanceId()) {
+      const void *payload = mRetentions[i - 1].payload;
+      mRetentions.erase(i - 1);
+      releaseLocked(payload);
+      numReleased++;
+    }
+  }
+  return numReleased;
+}
+
+size_t EventPayloadArena::getPayloadCount() const {
+  LockGuard<Mutex> lock(mMutex);
+  return mPayloadCount;
+}
+
+void EventPayloadArena::logStateToBuffer(DebugDumpWrapper &debugDump) const {
+  LockGuard<Mutex> lock(mMutex);
+  debugDump.print(
+      "\nEvent payloads: %zu allocated, %zu peak allocated, %" PRIu32
+      " heap allocations, %zu references held by nanoapps\n",
+      mPayloadCount, mPeakPayloadCount, mNumHeapAllocations,
+      mRetentions.size());
+}
+
+bool EventPayloadArena::isPayloadLocked(const void *payload) {
+  uintptr_t blockAddress = getBlockAddress(payload);
+  bool isPayload =
+      mSmallPool.containsAddress(
+          reinterpret_cast<SmallBlock *>(blockAddress)) ||
+      mMediumPool.containsAddress(
+          reinterpret_cast<MediumBlock *>(blockAddress)) ||
+      mLargePool.containsAddress(reinterpret_cast<LargeBlock *>(blockAddress));
+  if (!isPayload) {
+    isPayload = (mHeapPayloads.find(payload) != mHeapPayloads.size());
+  }
+  return isPayload && getHeader(payload)->refCount > 0;
+}
+
+void EventPayloadArena::releaseLocked(const void *payload) {
+  PayloadHeader *header = getHeader(payload);
+  if (--header->refCount == 0) {
+    uintptr_t blockAddress = getBlockAddress(payload);
+    switch (header->sizeClass) {
+      case SizeClass::Small:
+        mSmallPool.deallocate(reinterpret_cast<SmallBlock *>(blockAddress));
+        break;
+      case SizeClass::Medium:
+        mMediumPool.deallocate(reinterpret_cast<MediumBlock *>(blockAddress));
+        break;
+      case SizeClass::Large:
+        mLargePool.deallocate(reinterpret_cast<LargeBlock *>(blockAddress));
+        break;
+      case SizeClass::Heap:
+        mHeapPayloads.erase(mHeapPayloads.find(payload));
+        memoryFree(reinterpret_cast<void *>(blockAddress));
+        break;
+    }
+    mPayloadCount--;
+  }
+}
+
+}  // namespace chre
@@ -304,7 +304,7 @@ void GnssSession::handleReportEvent(void *event) {
              .getSettingEnabled(Setting::LOCATION)) {
       freeReportEventCallback(reportEventType, data);
     } else {
-      EventLoopManagerSingleton::get()->getEventLoop().postEventOrDie(
+      EventLoopManagerSingleton::get()->getEventLoop().postEventInlineOrDie(
           reportEventType, data, freeReportEventCallback);
     }
   };
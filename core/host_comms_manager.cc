@@ -22,6 +22,7 @@
 #include "chre/platform/assert.h"
 #include "chre/platform/context.h"
 #include "chre/platform/host_link.h"
+#include "chre/platform/tracing.h"
 #include "chre/util/macros.h"
 
 namespace chre {
@@ -69,6 +70,10 @@ bool HostCommsManager::sendMessageToHostFromNanoapp(
       if (!success) {
         mMessagePool.deallocate(msgToHost);
       } else {
+        CHRE_TRACE_INSTANT_DATA("Send message to host",
+                                "appId:" TRACE_U64 ",size:" TRACE_U32,
+                                msgToHost->appId,
+                                static_cast<uint32_t>(messageSize));
         if (wokeHost) {
           // If message successfully sent and host was suspended before sending
           EventLoopManagerSingleton::get()
@@ -88,10 +93,18 @@ bool HostCommsManager::sendMessageToHostFromNanoapp(
 
 MessageFromHost *HostCommsManager::craftNanoappMessageFromHost(
     uint64_t appId, uint16_t hostEndpoint, uint32_t messageType,
-    const void *messageData, uint32_t messageSize) {
+    const void *messageData, uint32_t messageSize, const void *lentBuffer,
+    HostBufferReleaseFunction *releaseBuffer) {
   MessageFromHost *msgFromHost = mMessagePool.allocate();
   if (msgFromHost == nullptr) {
     LOG_OOM();
+  } else if (releaseBuffer != nullptr) {
+    // The nanoapp only gets a const view of the data, so the lent buffer is
+    // never written to.
+    msgFromHost->message.wrap(
+        static_cast<uint8_t *>(const_cast<void *>(messageData)), messageSize);
+    msgFromHost->lentBuffer = lentBuffer;
+    msgFromHost->lentBufferRelease = releaseBuffer;
   } else if (!msgFromHost->message.copy_array(
                  static_cast<const uint8_t *>(messageData), messageSize)) {
     LOGE("Couldn't allocate %" PRIu32
@@ -100,7 +113,9 @@ MessageFromHost *HostCommsManager::craftNanoappMessageFromHost(
          messageSize, hostEndpoint, messageType);
     mMessagePool.deallocate(msgFromHost);
     msgFromHost = nullptr;
-  } else {
+  }
+
+  if (msgFromHost != nullptr) {
     msgFromHost->appId = appId;
     msgFromHost->fromHostData.messageType = messageType;
     msgFromHost->fromHostData.messageSize = messageSize;
@@ -131,11 +146,14 @@ bool HostCommsManager::deliverNanoappMessageFromHost(
   return nanoappFound;
 }
 
-void HostCommsManager::sendMessageToNanoappFromHost(uint64_t appId,
-                                                    uint32_t messageType,
-                                                    uint16_t hostEndpoint,
-                                                    const void *messageData,
-                                                    size_t messageSize) {
+void HostCommsManager::sendMessageToNanoappFromHost(
+    uint64_t appId, uint32_t messageType, uint16_t hostEndpoint,
+    const void *messageData, size_t messageSize, const void *lentBuffer,
+    HostBufferReleaseFunction *releaseBuffer) {
+  CHRE_TRACE_INSTANT_DATA("Receive message from host",
+                          "appId:" TRACE_U64 ",size:" TRACE_U32, appId,
+                          static_cast<uint32_t>(messageSize));
+  bool rejected = true;
   if (hostEndpoint == kHostEndpointBroadcast) {
     LOGE("Received invalid message from host from broadcast endpoint");
   } else if (messageSize > ((UINT32_MAX))) {
@@ -146,12 +164,18 @@ void HostCommsManager::sendMessageToNanoappFromHost(uint64_t appId,
   } else {
     MessageFromHost *craftedMessage = craftNanoappMessageFromHost(
         appId, hostEndpoint, messageType, messageData,
-        static_cast<uint32_t>(messageSize));
+        static_cast<uint32_t>(messageSize), lentBuffer, releaseBuffer);
     if (craftedMessage == nullptr) {
       LOGE("Out of memory - rejecting message to app ID 0x%016" PRIx64
            "(size %zu)",
            appId, messageSize);
-    } else if (!deliverNanoappMessageFromHost(craftedMessage)) {
+    } else {
+      // From here on the message owns the lent buffer, if any.
+      rejected = false;
+    }
+
+    if (craftedMessage != nullptr &&
+        !deliverNanoappMessageFromHost(craftedMessage)) {
       LOGV("Deferring message; destination app ID 0x%016" PRIx64
            " not found at this time",
            appId);
@@ -165,10 +189,14 @@ void HostCommsManager::sendMessageToNanoappFromHost(uint64_t appId,
       if (!EventLoopManagerSingleton::get()->deferCallback(
               SystemCallbackType::DeferredMessageToNanoappFromHost,
               craftedMessage, callback)) {
-        mMessagePool.deallocate(craftedMessage);
+        freeMessageFromHost(craftedMessage);
       }
     }
   }
+
+  if (rejected && releaseBuffer != nullptr) {
+    releaseBuffer(lentBuffer);
+  }
 }
 
 void HostCommsManager::sendDeferredMessageToNanoappFromHost(
@@ -180,7 +208,7 @@ void HostCommsManager::sendDeferredMessageToNanoappFromHost(
     LOGE("Dropping deferred message; destination app ID 0x%016" PRIx64
          " still not found",
          craftedMessage->appId);
-    mMessagePool.deallocate(craftedMessage);
+    freeMessageFromHost(craftedMessage);
   } else {
     LOGD("Deferred message to app ID 0x%016" PRIx64 " delivered",
          craftedMessage->appId);
@@ -192,6 +220,8 @@ void HostCommsManager::resetBlameForNanoappHostWakeup() {
 }
 
 void HostCommsManager::onMessageToHostComplete(const MessageToHost *message) {
+  CHRE_TRACE_INSTANT_DATA("Message to host complete", "appId:" TRACE_U64,
+                          message->appId);
   // Removing const on message since we own the memory and will deallocate it;
   // the caller (HostLink) only gets a const pointer
   auto *msgToHost = const_cast<MessageToHost *>(message);
@@ -231,6 +261,15 @@ void HostCommsManager::freeMessageToHost(MessageToHost *msgToHost) {
   mMessagePool.deallocate(msgToHost);
 }
 
+void HostCommsManager::freeMessageFromHost(MessageFromHost *msgFromHost) {
+  HostBufferReleaseFunction *releaseBuffer = msgFromHost->lentBufferRelease;
+  const void *lentBuffer = msgFromHost->lentBuffer;
+  mMessagePool.deallocate(msgFromHost);
+  if (releaseBuffer != nullptr) {
+    releaseBuffer(lentBuffer);
+  }
+}
+
 void HostCommsManager::freeMessageFromHostCallback(uint16_t /*type*/,
                                                    void *data) {
   // We pass the chreMessageFromHostData structure to the nanoapp as the event's
@@ -247,7 +286,7 @@ void HostCommsManager::freeMessageFromHostCallback(uint16_t /*type*/,
   auto *eventData = static_cast<chreMessageFromHostData *>(data);
   auto *msgFromHost = reinterpret_cast<MessageFromHost *>(eventData);
   auto &hostCommsMgr = EventLoopManagerSingleton::get()->getHostCommsManager();
-  hostCommsMgr.mMessagePool.deallocate(msgFromHost);
+  hostCommsMgr.freeMessageFromHost(msgFromHost);
 }
 
 }  // namespace chre
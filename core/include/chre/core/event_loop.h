@@ -21,6 +21,7 @@
 #include "chre/core/nanoapp.h"
 #include "chre/core/timer_pool.h"
 #include "chre/platform/atomic.h"
+#include "chre/platform/condition_variable.h"
 #include "chre/platform/mutex.h"
 #include "chre/platform/platform_nanoapp.h"
 #include "chre/platform/power_control_manager.h"
@@ -59,6 +60,15 @@
 
 #endif
 
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+#include "chre/util/blocking_segmented_queue.h"
+
+// This default value can be overridden in the variant-specific makefile.
+#ifndef CHRE_MAX_EVENT_LOOP_SHARDS
+#define CHRE_MAX_EVENT_LOOP_SHARDS 8
+#endif
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
+
 namespace chre {
 
 /**
@@ -77,6 +87,25 @@ class EventLoop : public NonCopyable {
         mRunning(true) {
   }
 
+  /**
+   * Held by code accessing the state of the system (e.g. the CHRE API
+   * implementations) that may run in the context of a nanoapp on an event loop
+   * shard, to serialize it with the event loop thread and the other shards. It
+   * can be nested. A no-op on any other thread, and unless
+   * CHRE_EVENT_LOOP_SHARDS_ENABLED is defined.
+   *
+   * @see setNumShards
+   */
+  class SystemLockGuard : public NonCopyable {
+   public:
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+    SystemLockGuard();
+    ~SystemLockGuard();
+#else
+    SystemLockGuard() {}
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
+  };
+
   /**
    * Synchronous callback used with forEachNanoapp
    */
@@ -172,6 +201,46 @@ class EventLoop : public NonCopyable {
    */
   void stop();
 
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+  //! The maximum number of shards the nanoapps can be assigned to.
+  static constexpr size_t kMaxShardCount = CHRE_MAX_EVENT_LOOP_SHARDS;
+
+  /**
+   * Assigns the nanoapps to numShards event loop shards, by instance ID, so
+   * nanoapps on different shards process their events in parallel. Each shard
+   * delivers events to its nanoapps from its own queue and thread, while the
+   * thread calling run() distributes them and runs the system. The code of a
+   * nanoapp only ever runs on one thread at a time.
+   *
+   * Events sent by a nanoapp to another one go straight to the queue of the
+   * shard of its target, while the other events are distributed from the
+   * inbound queue. Events are freed once processed by the shards of all their
+   * recipients.
+   *
+   * Must be called before run() and before any nanoapp is started. The
+   * platform must then call runShard() from a dedicated thread for each shard.
+   *
+   * @param numShards The number of shards, up to kMaxShardCount. With 0, the
+   *        default, nanoapps run on the thread calling run().
+   */
+  void setNumShards(size_t numShards);
+
+  /**
+   * @return the number of shards set with setNumShards().
+   */
+  size_t getNumShards() const {
+    return mNumShards;
+  }
+
+  /**
+   * Executes the loop delivering events to the nanoapps assigned to a shard.
+   * Only returns once run() is about to return.
+   *
+   * @param shardIndex The index of the shard, below getNumShards()
+   */
+  void runShard(size_t shardIndex);
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
+
   /**
    * Posts an event to a nanoapp that is currently running (or all nanoapps if
    * the target instance ID is kBroadcastInstanceId). A senderInstanceId cannot
@@ -199,6 +268,29 @@ class EventLoop : public NonCopyable {
                       uint16_t targetInstanceId = kBroadcastInstanceId,
                       uint16_t targetGroupMask = kDefaultTargetGroupMask);
 
+  /**
+   * Variant of postEventOrDie for the system callbacks that hand data received
+   * from another thread, and deferred with EventLoopManager::deferCallback, to
+   * nanoapps. When called from such a callback, the event is distributed to
+   * nanoapps as soon as the callback returns and its event is released, within
+   * the same iteration of the event loop, instead of going through the inbound
+   * queue a second time and taking a second event from the pool.
+   *
+   * To keep the events the system posts to nanoapps in order, e.g. a scan
+   * result after the async result of its request, it behaves like
+   * postEventOrDie while any such event is in the inbound queue, as well as
+   * when called from another thread, a nanoapp context, or once
+   * kMaxInlineEventCount events are pending. Events sent by nanoapps may be
+   * overtaken.
+   *
+   * @see postEventOrDie
+   */
+  void postEventInlineOrDie(
+      uint16_t eventType, void *eventData,
+      chreEventCompleteFunction *freeCallback,
+      uint16_t targetInstanceId = kBroadcastInstanceId,
+      uint16_t targetGroupMask = kDefaultTargetGroupMask);
+
   /**
    * Posts an event to a nanoapp that is currently running (or all nanoapps if
    * the target instance ID is kBroadcastInstanceId). If the event fails to
@@ -255,14 +347,34 @@ class EventLoop : public NonCopyable {
   /**
    * Returns a pointer to the currently executing Nanoapp, or nullptr if none is
    * currently executing. Must only be called from within the thread context
-   * associated with this EventLoop.
+   * associated with this EventLoop, or of one of its shards.
    *
    * @return the currently executing nanoapp, or nullptr
    */
   Nanoapp *getCurrentNanoapp() const {
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+    if (tCurrentShard != nullptr) {
+      return tCurrentShard->currentApp;
+    }
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
     return mCurrentApp;
   }
 
+  /**
+   * Returns the event the current nanoapp is handling, or nullptr if it isn't
+   * in nanoappHandleEvent(). Same calling context as getCurrentNanoapp().
+   *
+   * @return the event being handled, or nullptr
+   */
+  const Event *getCurrentEvent() const {
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+    if (tCurrentShard != nullptr) {
+      return tCurrentShard->currentEvent;
+    }
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
+    return mCurrentEvent;
+  }
+
   /**
    * Gets the number of nanoapps currently associated with this event loop. Must
    * only be called within the context of this EventLoop.
@@ -346,6 +458,13 @@ class EventLoop : public NonCopyable {
     return mNumDroppedLowPriEvents;
   }
 
+  /**
+   * @return the number of events allocated from the event pool, i.e. pending
+   *         in the inbound queue or being distributed. Safe to call from any
+   *         thread.
+   */
+  size_t getNumEventsAllocated();
+
  private:
 #ifdef CHRE_STATIC_EVENT_LOOP
   //! The maximum number of events that can be active in the system.
@@ -410,9 +529,38 @@ class EventLoop : public NonCopyable {
   //! into the nanoapp's entry points or callbacks
   Nanoapp *mCurrentApp = nullptr;
 
+  //! The event mCurrentApp is handling, if any.
+  const Event *mCurrentEvent = nullptr;
+
   //! Set to the nanoapp we are in the process of unloading in unloadNanoapp()
   Nanoapp *mStoppingNanoapp = nullptr;
 
+  //! The maximum number of events postEventInlineOrDie can hold until the
+  //! system callback posting them returns.
+  static constexpr size_t kMaxInlineEventCount = 4;
+
+  //! An event posted with postEventInlineOrDie, pending distribution.
+  struct InlineEvent {
+    uint16_t eventType;
+    uint16_t targetInstanceId;
+    uint16_t targetGroupMask;
+    void *eventData;
+    chreEventCompleteFunction *freeCallback;
+  };
+
+  //! The number of events posted with postEventOrDie in the inbound queue,
+  //! which postEventInlineOrDie must not overtake.
+  AtomicUint32 mNumQueuedEventsFromSystem{0};
+
+  //! True while the callback of a system event is running, i.e. when
+  //! postEventInlineOrDie can hold its event until the callback returns.
+  bool mInSystemCallback = false;
+
+  //! The events posted with postEventInlineOrDie by the running system
+  //! callbacks, in the order they were posted.
+  InlineEvent mInlineEvents[kMaxInlineEventCount];
+  size_t mNumInlineEvents = 0;
+
   //! The object which manages power related controls.
   PowerControlManager mPowerControlManager;
 
@@ -422,6 +570,112 @@ class EventLoop : public NonCopyable {
   //! The number of events dropped due to capacity limits
   uint32_t mNumDroppedLowPriEvents = 0;
 
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+  //! The number of items a block of the queue of a shard can hold.
+  static constexpr size_t kShardItemsPerBlock = 16;
+
+  //! The maximum number of blocks the queue of a shard can hold.
+  static constexpr size_t kMaxShardItemBlocks = 32;
+
+  //! A request to a shard, processed in the context of one of its nanoapps.
+  struct ShardItem {
+    enum class Type : uint8_t {
+      //! Deliver event to nanoapp, then release event if it was its last
+      //! recipient.
+      DeliverEvent,
+      //! Invoke the free callback of event, sent by nanoapp, and deallocate it.
+      FreeEvent,
+      //! Invoke messageFreeFunction on behalf of nanoapp.
+      FreeMessage,
+      //! Signal mShardBarrierCondition, see waitForShards().
+      Barrier,
+      //! Return from runShard().
+      Stop,
+    };
+
+    Type type;
+    Nanoapp *nanoapp;
+    Event *event;
+    chreMessageFreeFunction *messageFreeFunction;
+    void *message;
+    size_t messageSize;
+  };
+
+  struct Shard {
+    Shard() : items(kMaxShardItemBlocks) {}
+
+    //! The requests pending processing by the shard, posted from any thread.
+    BlockingSegmentedQueue<ShardItem, kShardItemsPerBlock> items;
+
+    //! The nanoapp the shard is running the code of, if any.
+    Nanoapp *currentApp = nullptr;
+
+    //! The event currentApp is handling, if any.
+    const Event *currentEvent = nullptr;
+
+    //! The nesting depth of SystemLockGuard on the thread of the shard.
+    uint32_t systemLockDepth = 0;
+  };
+
+  //! The shards, of which the first mNumShards are used.
+  Shard mShards[kMaxShardCount];
+  size_t mNumShards = 0;
+
+  //! Held by the thread calling run() while it isn't waiting for events, and
+  //! by the shards as per SystemLockGuard, if there are shards.
+  Mutex mSystemLock;
+
+  //! Notified when the last shard processes its ShardItem::Type::Barrier.
+  ConditionVariable mShardBarrierCondition;
+  size_t mNumPendingShardBarriers = 0;
+
+  //! The shard running on the current thread, if any.
+  static thread_local Shard *tCurrentShard;
+
+  /**
+   * @return the shard the given nanoapp is assigned to.
+   */
+  Shard &getShard(const Nanoapp &nanoapp) {
+    return mShards[nanoapp.getInstanceId() % mNumShards];
+  }
+
+  /**
+   * Posts a request to a shard, raising a fatal error if its queue is full.
+   */
+  void pushShardItem(Shard &shard, const ShardItem &item);
+
+  /**
+   * Posts an event sent by a nanoapp on a shard to a single other nanoapp to
+   * the shard of its target, instead of the inbound queue.
+   *
+   * @return true if the event was posted, false if it must go through the
+   *         inbound queue, e.g. as it is broadcast or its target is stopping
+   */
+  bool postEventToTargetShard(Event *event);
+
+  /**
+   * Frees an event distributed to the shards once processed by all its
+   * recipients, invoking its free callback from the shard of the nanoapp that
+   * sent it if any. The system lock must be held.
+   *
+   * @param event The unreferenced event
+   */
+  void releaseShardedEvent(Event *event);
+
+  /**
+   * Processes a request in the context of a shard.
+   */
+  void processShardItem(Shard &shard, const ShardItem &item);
+
+  /**
+   * Waits until the shards have processed their requests, including the
+   * free callbacks posted by the events they were delivering, so no event sent
+   * by a stopping nanoapp remains. Must be called from the thread calling
+   * run(), as the system lock is released while waiting.
+   */
+  void waitForShards();
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
+
   /**
    * Modifies the run loop state so it no longer iterates on new events. This
    * should only be invoked by the event loop when it is ready to stop
@@ -459,7 +713,8 @@ class EventLoop : public NonCopyable {
   bool hasNoSpaceForHighPriorityEvent();
 
   /**
-   * Delivers the next event pending to the Nanoapp.
+   * Delivers the next event pending to the Nanoapp, or posts it to the shard
+   * of the nanoapp if there are shards.
    */
   void deliverNextEvent(const UniquePtr<Nanoapp> &app, Event *event);
 
@@ -472,6 +727,22 @@ class EventLoop : public NonCopyable {
    */
   void distributeEvent(Event *event);
 
+  /**
+   * Delivers an event to all Nanoapps that should receive it, without freeing
+   * it.
+   *
+   * @param event The Event to deliver to Nanoapps
+   */
+  void deliverEvent(Event *event);
+
+  /**
+   * Distributes the events posted with postEventInlineOrDie from index
+   * firstIndex of mInlineEvents, and removes them.
+   *
+   * @param firstIndex The index of the first event to distribute
+   */
+  void distributeInlineEvents(size_t firstIndex);
+
   /**
    * Distribute all events pending in the inbound event queue. Note that this
    * function only guarantees that any events in the inbound queue at the time
@@ -483,12 +754,23 @@ class EventLoop : public NonCopyable {
 
   /**
    * Call after when an Event has been delivered to all intended recipients.
-   * Invokes the event's free callback (if given) and releases resources.
+   * Invokes the event's free callback (if given) and releases resources, then
+   * distributes the events the callback of a system event posted with
+   * postEventInlineOrDie. Events posted to shards are released once processed
+   * by the last of them instead.
    *
    * @param event The event to be freed
    */
   void freeEvent(Event *event);
 
+  /**
+   * Invokes the free callback of an event in the context of the nanoapp that
+   * sent it, or its callback if it is a system event.
+   *
+   * @param event The event whose callback is invoked
+   */
+  void invokeEventFreeCallback(Event *event);
+
   /**
    * Finds a Nanoapp with the given 64-bit appId.
    *
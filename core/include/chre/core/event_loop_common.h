@@ -73,6 +73,9 @@ enum class SystemCallbackType : uint16_t {
   BleFlushComplete,
   BleFlushTimeout,
   PulseResponse,
+  SensorSynchronizedBatchTimeout,
+  WwanCellInfoCacheExpired,
+  SensorSynchronizedBatchData,
 };
 
 //! Deferred/delayed callbacks use the event subsystem but are invariably sent
@@ -82,6 +85,11 @@ enum class SystemCallbackType : uint16_t {
 using SystemEventCallbackFunction = void(uint16_t type, void *data,
                                          void *extraData);
 
+//! Returns a receive buffer that the host transport lent to a message from the
+//! host once the message no longer references it.
+//! @see HostCommsManager::sendMessageToNanoappFromHost
+using HostBufferReleaseFunction = void(const void *buffer);
+
 }  // namespace chre
 
 #endif  // CHRE_CORE_EVENT_LOOP_COMMON_H_
@@ -20,6 +20,7 @@
 #include "chre/core/debug_dump_manager.h"
 #include "chre/core/event_loop.h"
 #include "chre/core/event_loop_common.h"
+#include "chre/core/event_payload_arena.h"
 #include "chre/core/host_comms_manager.h"
 #include "chre/core/host_endpoint_manager.h"
 #include "chre/core/settings.h"
@@ -314,6 +315,14 @@ class EventLoopManager : public NonCopyable {
     return mMemoryManager;
   }
 
+  /**
+   * @return A reference to the event payload arena, from which the system
+   *         allocates the event payloads nanoapps can retain.
+   */
+  EventPayloadArena &getEventPayloadArena() {
+    return mEventPayloadArena;
+  }
+
   /**
    * @return A reference to the debug dump manager. This allows central control
    *         of the debug dump process.
@@ -403,6 +412,9 @@ class EventLoopManager : public NonCopyable {
   //! controls upper limits on the heap allocation amount.
   MemoryManager mMemoryManager;
 
+  //! The EventPayloadArena that allocates refcounted event payloads.
+  EventPayloadArena mEventPayloadArena;
+
   //! The DebugDumpManager that handles the debug dump process.
   DebugDumpManager mDebugDumpManager;
 
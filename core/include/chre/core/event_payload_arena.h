@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_CORE_EVENT_PAYLOAD_ARENA_H_
+#define CHRE_CORE_EVENT_PAYLOAD_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "chre/core/event.h"
+#include "chre/core/nanoapp.h"
+#include "chre/platform/assert.h"
+#include "chre/platform/mutex.h"
+#include "chre/util/dynamic_vector.h"
+#include "chre/util/memory_pool.h"
+#include "chre/util/non_copyable.h"
+#include "chre/util/system/debug_dump.h"
+
+// The number of blocks of each size class. They default to none, so that all
+// payloads come from the heap, and can be overridden in the variant-specific
+// makefile.
+#ifndef CHRE_EVENT_PAYLOAD_ARENA_SMALL_COUNT
+#define CHRE_EVENT_PAYLOAD_ARENA_SMALL_COUNT 0
+#endif
+
+#ifndef CHRE_EVENT_PAYLOAD_ARENA_MEDIUM_COUNT
+#define CHRE_EVENT_PAYLOAD_ARENA_MEDIUM_COUNT 0
+#endif
+
+#ifndef CHRE_EVENT_PAYLOAD_ARENA_LARGE_COUNT
+#define CHRE_EVENT_PAYLOAD_ARENA_LARGE_COUNT 0
+#endif
+
+namespace chre {
+
+/**
+ * Allocates the payloads of the events posted by the system and counts their
+ * references, so that the same payload can be posted in several events and
+ * retained by nanoapps past nanoappHandleEvent() through chreEventDataRetain()
+ * rather than copied.
+ *
+ * Payloads are allocated from the pools of a few size classes the variant
+ * configures, or from the heap if larger than the largest class or the pools
+ * are exhausted, and freed once their last reference is released. This class
+ * is thread-safe.
+ */
+class EventPayloadArena : public NonCopyable {
+ public:
+  //! The payload size of each size class.
+  static constexpr size_t kSmallPayloadSize = 64;
+  static constexpr size_t kMediumPayloadSize = 256;
+  static constexpr size_t kLargePayloadSize = 1024;
+
+  /**
+   * Allocates a payload, referenced once by the caller.
+   *
+   * @param size The size of the payload in bytes.
+   * @return The payload, aligned for any type, or nullptr if the allocation
+   *         failed.
+   */
+  void *allocate(size_t size);
+
+  /**
+   * Adds a reference to a payload, e.g. before posting it in another event.
+   *
+   * @param payload A payload allocated from this arena.
+   * @return false if the payload is not allocated from this arena.
+   */
+  bool addReference(const void *payload);
+
+  /**
+   * Releases a reference to a payload, freeing it if this was the last one.
+   *
+   * @param payload A payload allocated from this arena.
+   */
+  void release(const void *payload);
+
+  /**
+   * Free callback of the events whose data is a payload of the arena, which
+   * releases the reference held by the event. Posting such an event hands
+   * over one reference to the event loop.
+   */
+  static void freeEventCallback(uint16_t eventType, void *eventData);
+
+  /**
+   * Adds a reference to a payload held by a nanoapp, as requested through
+   * chreEventDataRetain(). Only the data of the event the nanoapp is handling
+   * can be retained, so that a nanoapp can't keep the payloads of the events
+   * of others alive.
+   *
+   * @param app The nanoapp retaining the payload.
+   * @param currentEvent The event the nanoapp is handling, or nullptr if none.
+   * @param payload The payload to retain.
+   * @return false if the payload is not the data of currentEvent or not
+   *         allocated from this arena, or the reference could not be
+   *         recorded.
+   */
+  bool nanoappRetain(Nanoapp *app, const Event *currentEvent,
+                     const void *payload);
+
+  /**
+   * Releases a reference held by a nanoapp, as requested through
+   * chreEventDataRelease().
+   *
+   * @param app The nanoapp releasing the payload.
+   * @param payload The payload to release.
+   * @return false if the nanoapp does not hold a reference to the payload.
+   */
+  bool nanoappRelease(Nanoapp *app, const void *payload);
+
+  /**
+   * Releases all the references held by a nanoapp.
+   *
+   * @param app The nanoapp being unloaded.
+   * @return The number of references released.
+   */
+  uint32_t nanoappReleaseAll(Nanoapp *app);
+
+  /**
+   * @return The number of payloads currently allocated.
+   */
+  size_t getPayloadCount() const;
+
+  /**
+   * Prints state in a string buffer.
+   *
+   * @param debugDump The debug dump wrapper where a string can be printed into
+   *    one of the buffers.
+   */
+  void logStateToBuffer(DebugDumpWrapper &debugDump) const;
+
+ private:
+  enum class SizeClass : uint8_t {
+    Small,
+    Medium,
+    Large,
+    Heap,
+  };
+
+  //! Immediately precedes each payload.
+  struct PayloadHeader {
+    uint32_t refCount;
+    SizeClass sizeClass;
+  };
+
+  //! The offset of the payloads in their blocks, which keeps them aligned for
+  //! any type. It leaves room before the header for the free list index the
+  //! pools store at the start of the free blocks, so that the reference count
+  //! of a freed payload stays 0.
+  static constexpr size_t kPayloadAlignment = alignof(std::max_align_t);
+  static constexpr size_t kHeaderSize =
+      (sizeof(size_t) + sizeof(PayloadHeader) + kPayloadAlignment - 1) &
+      ~(kPayloadAlignment - 1);
+
+  template <size_t kPayloadSize>
+  struct alignas(kPayloadAlignment) Block {
+    //! Leaves the storage uninitialized.
+    Block() {}
+
+    uint8_t storage[kHeaderSize + kPayloadSize];
+  };
+
+  using SmallBlock = Block<kSmallPayloadSize>;
+  using MediumBlock = Block<kMediumPayloadSize>;
+  using LargeBlock = Block<kLargePayloadSize>;
+
+  //! Stands for the pool of a size class configured with no blocks.
+  template <typename BlockType>
+  struct EmptyPool {
+    BlockType *allocate() {
+      return nullptr;
+    }
+
+    void deallocate(BlockType * /*block*/) {
+      CHRE_ASSERT(false);
+    }
+
+    bool containsAddress(BlockType * /*block*/) {
+      return false;
+    }
+  };
+
+  template <typename BlockType, size_t kCount>
+  using Pool = typename std::conditional<kCount == 0, EmptyPool<BlockType>,
+                                         MemoryPool<BlockType, kCount>>::type;
+
+  //! A reference held by a nanoapp.
+  struct Retention {
+    uint16_t instanceId;
+    const void *payload;
+  };
+
+  /**
+   * @return true if a pointer is a payload allocated from this arena and not
+   *         freed. The mutex must be held.
+   */
+  bool isPayloadLocked(const void *payload);
+
+  /**
+   * Releases a reference to a payload, freeing it if this was the last one.
+   * The mutex must be held.
+   */
+  void releaseLocked(const void *payload);
+
+  static PayloadHeader *getHeader(const void *payload) {
+    return reinterpret_cast<PayloadHeader *>(
+        reinterpret_cast<uintptr_t>(payload) - sizeof(PayloadHeader));
+  }
+
+  static uintptr_t getBlockAddress(const void *payload) {
+    return reinterpret_cast<uintptr_t>(payload) - kHeaderSize;
+  }
+
+  //! Guards the state of the arena.
+  mutable Mutex mMutex;
+
+  Pool<SmallBlock, CHRE_EVENT_PAYLOAD_ARENA_SMALL_COUNT> mSmallPool;
+  Pool<MediumBlock, CHRE_EVENT_PAYLOAD_ARENA_MEDIUM_COUNT> mMediumPool;
+  Pool<LargeBlock, CHRE_EVENT_PAYLOAD_ARENA_LARGE_COUNT> mLargePool;
+
+  //! The payloads allocated from the heap.
+  DynamicVector<const void *> mHeapPayloads;
+
+  //! The references held by nanoapps.
+  DynamicVector<Retention> mRetentions;
+
+  size_t mPayloadCount = 0;
+  size_t mPeakPayloadCount = 0;
+  uint32_t mNumHeapAllocations = 0;
+};
+
+}  // namespace chre
+
+#endif  // CHRE_CORE_EVENT_PAYLOAD_ARENA_H_
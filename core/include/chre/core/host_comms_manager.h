@@ -82,6 +82,12 @@ struct HostMessage : public NonCopyable {
 
   //! Application-defined message data
   Buffer<uint8_t> message;
+
+  //! Only set for messages from the host whose data points into a receive
+  //! buffer lent by the host transport rather than a copy: the buffer and the
+  //! function returning it to the transport once the message is freed.
+  const void *lentBuffer = nullptr;
+  HostBufferReleaseFunction *lentBufferRelease = nullptr;
 };
 
 typedef HostMessage MessageFromHost;
@@ -132,6 +138,11 @@ class HostCommsManager : public HostLink {
    * Makes a copy of the supplied message data and posts it to the queue for
    * later delivery to the addressed nanoapp.
    *
+   * Transports that can keep the buffer a message was received in until the
+   * nanoapp has consumed it can lend that buffer instead by supplying
+   * releaseBuffer, in which case the nanoapp receives a pointer into
+   * lentBuffer and no copy is made.
+   *
    * This function is safe to call from any thread.
    *
    * @param appId Identifier for the destination nanoapp
@@ -141,11 +152,18 @@ class HostCommsManager : public HostLink {
    * @param messageData Buffer containing application-specific message data; can
    *        be null if messageSize is 0
    * @param messageSize Size of messageData, in bytes
+   * @param lentBuffer The transport buffer messageData points into, only used
+   *        if releaseBuffer is not null
+   * @param releaseBuffer Optional function returning lentBuffer to the
+   *        transport. It is invoked exactly once, either before this function
+   *        returns if the message is rejected, or from the event loop thread
+   *        once the message has been consumed or dropped.
    */
-  void sendMessageToNanoappFromHost(uint64_t appId, uint32_t messageType,
-                                    uint16_t hostEndpoint,
-                                    const void *messageData,
-                                    size_t messageSize);
+  void sendMessageToNanoappFromHost(
+      uint64_t appId, uint32_t messageType, uint16_t hostEndpoint,
+      const void *messageData, size_t messageSize,
+      const void *lentBuffer = nullptr,
+      HostBufferReleaseFunction *releaseBuffer = nullptr);
 
   /**
    * This function is used by sendMessageToNanoappFromHost() for sending
@@ -204,11 +222,10 @@ class HostCommsManager : public HostLink {
    *
    * @see sendMessageToNanoappFromHost
    */
-  MessageFromHost *craftNanoappMessageFromHost(uint64_t appId,
-                                               uint16_t hostEndpoint,
-                                               uint32_t messageType,
-                                               const void *messageData,
-                                               uint32_t messageSize);
+  MessageFromHost *craftNanoappMessageFromHost(
+      uint64_t appId, uint16_t hostEndpoint, uint32_t messageType,
+      const void *messageData, uint32_t messageSize, const void *lentBuffer,
+      HostBufferReleaseFunction *releaseBuffer);
 
   /**
    * Posts a crafted event, craftedMessage, to a nanoapp for processing, and
@@ -235,6 +252,14 @@ class HostCommsManager : public HostLink {
    */
   void freeMessageToHost(MessageToHost *msgToHost);
 
+  /**
+   * Releases memory associated with a message from the host, returning the
+   * buffer its data points into to the transport if it was lent.
+   *
+   * @param msgFromHost The message to free
+   */
+  void freeMessageFromHost(MessageFromHost *msgFromHost);
+
   /**
    * Event free callback used to release memory allocated to deliver a message
    * to a nanoapp from the host.
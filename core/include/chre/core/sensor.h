@@ -44,7 +44,7 @@ class Sensor : public PlatformSensor {
    *
    * @see PlatformSensorManager::getSensors
    */
-  Sensor() : mFlushRequestPending(false) {}
+  Sensor() : mFlushRequestPending(false), mSynchronizedBatchGrouped(false) {}
 
   Sensor(Sensor &&other);
   Sensor &operator=(Sensor &&other);
@@ -177,6 +177,26 @@ class Sensor : public PlatformSensor {
     return mFlushRequestPending;
   }
 
+  /**
+   * Sets whether a nanoapp groups this sensor in synchronized batches, in
+   * which case its data events are handed to the CHRE thread before being
+   * posted.
+   *
+   * @param grouped true if the sensor is part of a group.
+   */
+  void setSynchronizedBatchGrouped(bool grouped) {
+    mSynchronizedBatchGrouped = grouped;
+  }
+
+  /**
+   * Note: This method is called on a thread other than the main event loop.
+   *
+   * @return true if a nanoapp groups this sensor in synchronized batches.
+   */
+  bool isSynchronizedBatchGrouped() const {
+    return mSynchronizedBatchGrouped;
+  }
+
   /**
    * @return Pointer to this sensor's last data event. It returns a nullptr if
    *         the sensor doesn't provide it.
@@ -254,6 +274,9 @@ class Sensor : public PlatformSensor {
 
   //! True if a flush request is pending for this sensor.
   AtomicBool mFlushRequestPending;
+
+  //! True if a nanoapp groups this sensor in synchronized batches.
+  AtomicBool mSynchronizedBatchGrouped;
 };
 
 }  // namespace chre
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_CORE_SENSOR_BATCH_SYNCHRONIZER_H_
+#define CHRE_CORE_SENSOR_BATCH_SYNCHRONIZER_H_
+
+#include <cstdint>
+
+#include "chre/core/sensor.h"
+#include "chre/core/timer_pool.h"
+#include "chre/util/dynamic_vector.h"
+#include "chre/util/non_copyable.h"
+#include "chre/util/system/debug_dump.h"
+#include "chre/util/time.h"
+#include "chre_api/chre/sensor.h"
+
+//! How long the first data event of a synchronized batch waits for the other
+//! sensors of the group before the batch is delivered without them.
+#ifndef CHRE_SENSOR_SYNCHRONIZED_BATCH_WINDOW_NS
+#define CHRE_SENSOR_SYNCHRONIZED_BATCH_WINDOW_NS \
+  (20 * chre::kOneMillisecondInNanoseconds)
+#endif
+
+namespace chre {
+
+/**
+ * Merges the data events of groups of sensors configured through
+ * chreSensorConfigureSynchronizedBatch() into one
+ * CHRE_EVENT_SENSOR_SYNCHRONIZED_BATCH event per batch.
+ *
+ * Data events of grouped sensors are handed to the synchronizer on the CHRE
+ * thread before they are posted. Each group copies the data into its current
+ * batch, so the platform buffer can be released right away, and the batch
+ * event owns the copies. A batch is delivered as soon as each sensor of its
+ * group has delivered data, when a sensor delivers a second event for the
+ * same batch, or CHRE_SENSOR_SYNCHRONIZED_BATCH_WINDOW_NS after the first
+ * event of the batch.
+ *
+ * All methods must be called from the context of the main CHRE thread.
+ */
+class SensorBatchSynchronizer : public NonCopyable {
+ public:
+  ~SensorBatchSynchronizer();
+
+  /**
+   * Replaces the group of a nanoapp. The data held for the previous group of
+   * the nanoapp is delivered first.
+   *
+   * @param instanceId The instance ID of the nanoapp.
+   * @param sensorHandles The distinct handles of the continuous sensors to
+   *     group, validated by the caller.
+   * @param sensorCount The number of sensors, 0 to remove the group.
+   * @return false if the group could not be allocated.
+   */
+  bool setGroup(uint16_t instanceId, const uint32_t *sensorHandles,
+                uint8_t sensorCount);
+
+  /**
+   * @return true if the sensor is part of the group of the nanoapp.
+   */
+  bool isGrouped(uint16_t instanceId, uint32_t sensorHandle) const;
+
+  /**
+   * @return true if the sensor is part of the group of any nanoapp.
+   */
+  bool isGroupedByAnyNanoapp(uint32_t sensorHandle) const;
+
+  /**
+   * Copies a data event into the current batch of the groups that include its
+   * sensor, for the nanoapps that have a request for the sensor. The event is
+   * not referenced once this returns.
+   *
+   * @param sensorHandle The handle of the sensor the data is from.
+   * @param sensor The sensor the data is from.
+   * @param eventData The data event.
+   */
+  void addDataEvent(uint32_t sensorHandle, const Sensor &sensor,
+                    const ChreSensorData *eventData);
+
+  /**
+   * Delivers the batch of a nanoapp once its window has expired.
+   *
+   * @param instanceId The instance ID of the nanoapp.
+   * @param batchSequence The sequence number of the batch the timer was
+   *     started for, ignored if that batch has already been delivered.
+   */
+  void onBatchTimeout(uint16_t instanceId, uint16_t batchSequence);
+
+  /**
+   * Prints state in a string buffer.
+   *
+   * @param debugDump The debug dump wrapper where a string can be printed
+   *     into one of the buffers.
+   */
+  void logStateToBuffer(DebugDumpWrapper &debugDump) const;
+
+ private:
+  //! The sensors grouped by a nanoapp and the data of its current batch.
+  struct Group {
+    uint16_t instanceId;
+    uint8_t sensorCount;
+    uint32_t sensorHandles[CHRE_SENSOR_SYNCHRONIZED_BATCH_MAX_SENSORS];
+    //! batch[i] is a copy of the data received for sensorHandles[i], or
+    //! nullptr.
+    ChreSensorData *batch[CHRE_SENSOR_SYNCHRONIZED_BATCH_MAX_SENSORS];
+    //! The timer delivering the batch when its window expires.
+    TimerHandle timerHandle;
+    //! Incremented with each batch, as a timer may expire after its batch
+    //! has been delivered.
+    uint16_t batchSequence;
+  };
+
+  /**
+   * @return the index of the group of the nanoapp, or mGroups.size().
+   */
+  size_t findGroup(uint16_t instanceId) const;
+
+  /**
+   * Posts the batch of a group to its nanoapp, if it has any data, and starts
+   * a new batch.
+   *
+   * @param group The group to deliver the batch of.
+   */
+  void dispatchBatch(Group &group);
+
+  DynamicVector<Group> mGroups;
+
+  //! The number of batch events delivered.
+  uint32_t mNumBatchesDelivered = 0;
+  //! The number of batch events delivered without data for some sensor.
+  uint32_t mNumPartialBatchesDelivered = 0;
+};
+
+}  // namespace chre
+
+#endif  // CHRE_CORE_SENSOR_BATCH_SYNCHRONIZER_H_
@@ -18,6 +18,7 @@
 #define CHRE_CORE_SENSOR_REQUEST_MANAGER_H_
 
 #include "chre/core/sensor.h"
+#include "chre/core/sensor_batch_synchronizer.h"
 #include "chre/core/sensor_request.h"
 #include "chre/core/sensor_request_multiplexer.h"
 #include "chre/platform/fatal_error.h"
@@ -259,6 +260,32 @@ class SensorRequestManager : public NonCopyable {
    */
   void releaseSensorDataEvent(uint16_t eventType, void *eventData);
 
+  /**
+   * Configures the group of sensors whose data is delivered to a nanoapp as
+   * CHRE_EVENT_SENSOR_SYNCHRONIZED_BATCH events. Must only be called from the
+   * context of the main CHRE thread.
+   *
+   * @see chreSensorConfigureSynchronizedBatch
+   *
+   * @param nanoapp A non-null pointer to the nanoapp.
+   * @param sensorHandles The handles of the sensors to group.
+   * @param sensorCount The number of sensors, 0 to remove the group.
+   * @return true if the group was configured.
+   */
+  bool configureSynchronizedBatch(Nanoapp *nanoapp,
+                                  const uint32_t *sensorHandles,
+                                  uint8_t sensorCount);
+
+  /**
+   * Delivers a synchronized batch whose window has expired.
+   *
+   * @see SensorBatchSynchronizer::onBatchTimeout
+   */
+  void handleSynchronizedBatchTimeout(uint16_t instanceId,
+                                      uint16_t batchSequence) {
+    mBatchSynchronizer.onBatchTimeout(instanceId, batchSequence);
+  }
+
   /**
    * Releases the bias data back to the platform.
    *
@@ -345,6 +372,9 @@ class SensorRequestManager : public NonCopyable {
 
   PlatformSensorManager mPlatformSensorManager;
 
+  //! Merges the data of the sensors grouped by nanoapps into batch events.
+  SensorBatchSynchronizer mBatchSynchronizer;
+
   /**
    * Makes a specified flush request, and sets the timeout timer appropriately.
    * If there already is a pending flush request for the sensor specified in
@@ -473,6 +503,30 @@ class SensorRequestManager : public NonCopyable {
   void cancelFlushRequests(uint32_t sensorHandle,
                            uint32_t nanoappInstanceId = kSystemInstanceId);
 
+  /**
+   * Hands a data event of a sensor grouped in synchronized batches to the CHRE
+   * thread. Called from the thread delivering the data.
+   *
+   * @param sensorHandle The handle of the sensor the data is from.
+   * @param event The data event.
+   */
+  void deferGroupedSensorDataEvent(uint32_t sensorHandle, void *event);
+
+  /**
+   * Copies a data event into the synchronized batches of its sensor, then
+   * posts it to the nanoapps that do not group the sensor or releases it to
+   * the platform if there are none.
+   *
+   * @param sensorHandle The handle of the sensor the data is from.
+   * @param event The data event.
+   */
+  void handleGroupedSensorDataEvent(uint32_t sensorHandle, void *event);
+
+  /**
+   * Marks the sensors grouped by a nanoapp after its group changed.
+   */
+  void updateSynchronizedBatchGrouping();
+
   /**
    * Adds a request log to the list of logs possibly pushing latest log
    * off if full.
@@ -17,6 +17,7 @@
 #ifndef CHRE_CORE_SENSOR_TYPE_HELPERS_H_
 #define CHRE_CORE_SENSOR_TYPE_HELPERS_H_
 
+#include <cstddef>
 #include <cstring>
 
 #include "chre/core/sensor_type.h"
@@ -92,6 +93,16 @@ class SensorTypeHelpers : public PlatformSensorTypeHelpers {
    */
   static size_t getLastEventSize(uint8_t sensorType);
 
+  /**
+   * Determines the size of a data event of a sensor, e.g. to copy it.
+   *
+   * @param sensorType The sensorType of the sensor.
+   * @param readingCount The number of samples of the event.
+   * @return the size of the event, 0 if it is unknown, e.g. for vendor
+   *     sensors.
+   */
+  static size_t getDataEventSize(uint8_t sensorType, uint16_t readingCount);
+
   /**
    * @param sensorType The sensor type to obtain a string for.
    * @return A string representation of the sensor type.
@@ -130,6 +141,16 @@ class SensorTypeHelpers : public PlatformSensorTypeHelpers {
   template <typename SensorDataType>
   static void copyLastSample(const SensorDataType *newEvent,
                              SensorDataType *lastEvent);
+
+  /**
+   * @param readingCount The number of samples of the event.
+   * @return the size of a data event of type SensorDataType.
+   */
+  template <typename SensorDataType>
+  static size_t getDataEventSize(uint16_t readingCount) {
+    return offsetof(SensorDataType, readings) +
+           readingCount * sizeof(SensorDataType::readings[0]);
+  }
 };
 
 template <typename SensorDataType>
@@ -21,6 +21,7 @@
 #include "chre/core/nanoapp.h"
 #include "chre/core/settings.h"
 #include "chre/core/timer_pool.h"
+#include "chre/core/wifi_scan_request.h"
 #include "chre/platform/platform_wifi.h"
 #include "chre/util/buffer.h"
 #include "chre/util/non_copyable.h"
@@ -29,6 +30,14 @@
 #include "chre/util/time.h"
 #include "chre_api/chre/wifi.h"
 
+//! The maximum number of results of the last on-demand scan kept by the
+//! WifiRequestManager to answer later scan requests whose maxScanAgeMs allows
+//! it. Scans with more results are not cached. A value of zero disables the
+//! cache.
+#ifndef CHRE_WIFI_SCAN_CACHE_MAX_RESULTS
+#define CHRE_WIFI_SCAN_CACHE_MAX_RESULTS 64
+#endif
+
 namespace chre {
 
 /**
@@ -36,6 +45,12 @@ namespace chre {
  * This includes multiplexing multiple requests into one for the platform to
  * handle.
  *
+ * Compatible on-demand scan requests (see CoalescedWifiScanParams) queued
+ * behind each other are merged into a single platform scan, and a request
+ * that is covered by a scan in flight joins it if no result of that scan has
+ * been delivered yet. Requests covered by the most recent on-demand scan and
+ * whose maxScanAgeMs allows it are answered from its results.
+ *
  * This class is effectively a singleton as there can only be one instance of
  * the PlatformWifi instance.
  */
@@ -401,6 +416,35 @@ class WifiRequestManager : public NonCopyable {
   //! This is set to true if the results of an active scan request are pending.
   bool mScanRequestResultsArePending = false;
 
+  //! The number of requests at the front of mPendingScanRequests served by the
+  //! platform scan in flight, or zero if no scan has been dispatched.
+  size_t mInFlightScanRequestCount = 0;
+
+  //! The parameters of the platform scan in flight.
+  CoalescedWifiScanParams mInFlightScanParams;
+
+  //! Set when a scan event is posted while a scan is in flight, after which
+  //! new requests can no longer join that scan.
+  bool mInFlightScanEventPosted = false;
+
+  //! The complete results of the most recent on-demand scan, in a single
+  //! event allocated from the EventPayloadArena and posted as is to the
+  //! nanoapps it is served to, along with the parameters of that scan.
+  chreWifiScanEvent *mCachedScanEvent = nullptr;
+  CoalescedWifiScanParams mCachedScanParams;
+  Nanoseconds mCachedScanTime;
+
+  //! The event the results of the scan in flight are copied into, with room
+  //! for the resultTotal of its first event, or nullptr if they are not being
+  //! cached.
+  chreWifiScanEvent *mCachingScanEvent = nullptr;
+
+  //! The number of scan requests merged into another platform scan.
+  uint32_t mNumCoalescedScanRequests = 0;
+
+  //! The number of scan requests answered from the cached results.
+  uint32_t mNumCachedScanRequests = 0;
+
   //! Accumulates the number of scan event results to determine when the last
   //! in a scan event stream has been received.
   uint8_t mScanEventResultCountAccumulator = 0;
@@ -705,13 +749,66 @@ class WifiRequestManager : public NonCopyable {
 
   /**
    * Issues the pending scan requests to the platform in queued order until one
-   * dispatched successfully or the queue is empty.
+   * dispatched successfully or the queue is empty. Compatible requests queued
+   * right behind the first one are merged into the same platform scan.
    *
    * @param postAsyncResult if a dispatch failure should post a async result.
    * @return true if successfully dispatched one request.
    */
   bool dispatchQueuedScanRequests(bool postAsyncResult);
 
+  /**
+   * Merges the compatible requests at the front of the queue into
+   * mInFlightScanParams.
+   *
+   * @return the number of requests merged, or zero if memory could not be
+   *         allocated for the first one.
+   */
+  size_t coalesceQueuedScanRequests();
+
+  /**
+   * @return the number of requests at the front of the queue that the last
+   *         scan response or scan result applies to.
+   */
+  size_t getScanRequestGroupSize() const;
+
+  /**
+   * Removes the requests served by the last platform scan from the queue.
+   */
+  void popScanRequestGroup();
+
+  /**
+   * Adds the last queued request to the scan in flight if that scan covers it
+   * and none of its results have been delivered yet.
+   *
+   * @return true if the request joined the scan in flight.
+   */
+  bool joinInFlightScanRequest();
+
+  /**
+   * Answers a scan request from the cached scan results if they cover it and
+   * are recent enough.
+   *
+   * @param nanoappInstanceId The instance ID of the requesting nanoapp.
+   * @param params The parameters of the request.
+   * @param cookie The cookie of the request.
+   * @return true if the request was answered from the cache.
+   */
+  bool postCachedScanResults(uint16_t nanoappInstanceId,
+                             const struct chreWifiScanParams &params,
+                             const void *cookie);
+
+  /**
+   * Copies the results of a scan event of the scan in flight into the event
+   * cached once the scan completes.
+   *
+   * @param scanEvent The scan event to cache.
+   * @param isFirstEvent true if this is the first event of the scan.
+   * @param isLastEvent true if this is the last event of the scan.
+   */
+  void cacheScanEvent(const chreWifiScanEvent *scanEvent, bool isFirstEvent,
+                      bool isLastEvent);
+
   /**
    * Issues the next pending ranging request to the platform.
    *
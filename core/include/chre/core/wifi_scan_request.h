@@ -21,6 +21,7 @@
 
 #include "chre/util/dynamic_vector.h"
 #include "chre/util/fixed_size_vector.h"
+#include "chre/util/non_copyable.h"
 #include "chre/util/time.h"
 #include "chre_api/chre/wifi.h"
 
@@ -117,6 +118,96 @@ class WifiScanRequest {
   DynamicVector<WifiSsid> mSsids;
 };
 
+/**
+ * Accumulates compatible on-demand scan parameters from several nanoapps into
+ * one set of parameters that can be issued to the platform as a single scan.
+ *
+ * Requests are compatible when they share the scan type, radio chain
+ * preference and channel set. Their frequency and SSID lists are merged, with
+ * an empty frequency list meaning that all frequencies are scanned, and the
+ * smallest maximum scan age is used.
+ */
+class CoalescedWifiScanParams : public NonCopyable {
+ public:
+  /**
+   * Resets the accumulated parameters to the ones of a single request.
+   *
+   * @param params The parameters of the request.
+   * @return false if memory could not be allocated for the lists, in which
+   *         case the parameters are cleared.
+   */
+  bool reset(const struct chreWifiScanParams &params);
+
+  /**
+   * Clears the accumulated parameters.
+   */
+  void clear();
+
+  /**
+   * @return true if no parameters have been accumulated.
+   */
+  bool empty() const {
+    return mEmpty;
+  }
+
+  /**
+   * @param params The parameters of a request.
+   * @return true if the request can be merged into the accumulated parameters.
+   */
+  bool isCompatible(const struct chreWifiScanParams &params) const;
+
+  /**
+   * @param params The parameters of a request.
+   * @return true if a scan performed with the accumulated parameters scans at
+   *         least every frequency and SSID the request asks for.
+   */
+  bool covers(const struct chreWifiScanParams &params) const;
+
+  /**
+   * Merges the parameters of a compatible request. The accumulated parameters
+   * are left unchanged on failure.
+   *
+   * @param params The parameters of the request to merge.
+   * @return false if the request is not compatible, the merged SSID list
+   *         would exceed CHRE_WIFI_SSID_LIST_MAX_LEN or memory could not be
+   *         allocated.
+   */
+  bool merge(const struct chreWifiScanParams &params);
+
+  /**
+   * Populates scan parameters for the platform. The list pointers remain valid
+   * until this object is next modified.
+   *
+   * @param params Populated with the accumulated parameters.
+   */
+  void getParams(struct chreWifiScanParams *params) const;
+
+ private:
+  //! True if no parameters have been accumulated.
+  bool mEmpty = true;
+
+  uint8_t mScanType = CHRE_WIFI_SCAN_TYPE_NO_PREFERENCE;
+  uint8_t mRadioChainPref = CHRE_WIFI_RADIO_CHAIN_PREF_DEFAULT;
+  uint8_t mChannelSet = CHRE_WIFI_CHANNEL_SET_NON_DFS;
+  uint32_t mMaxScanAgeMs = 0;
+
+  //! The frequencies to scan, or empty if all frequencies are scanned.
+  DynamicVector<uint32_t> mFrequencies;
+
+  //! The SSIDs to scan for, or empty if the scan is not limited to any SSIDs.
+  DynamicVector<struct chreWifiSsidListItem> mSsids;
+
+  /**
+   * @return true if the frequency is scanned by the accumulated parameters.
+   */
+  bool coversFrequency(uint32_t frequency) const;
+
+  /**
+   * @return true if the SSID is scanned for by the accumulated parameters.
+   */
+  bool coversSsid(const struct chreWifiSsidListItem &ssid) const;
+};
+
 }  // namespace chre
 
 #endif  // CHRE_CORE_WIFI_SCAN_REQUEST_H_
@@ -20,10 +20,19 @@
 #include <cstdint>
 
 #include "chre/core/nanoapp.h"
+#include "chre/core/timer_pool.h"
 #include "chre/platform/platform_wwan.h"
+#include "chre/util/dynamic_vector.h"
 #include "chre/util/non_copyable.h"
-#include "chre/util/optional.h"
 #include "chre/util/system/debug_dump.h"
+#include "chre/util/time.h"
+
+//! The maximum age of a cached cell info result that can be used to answer a
+//! new request without querying the modem again. A value of zero disables
+//! serving requests from the cache.
+#ifndef CHRE_WWAN_CELL_INFO_CACHE_MAX_AGE_NS
+#define CHRE_WWAN_CELL_INFO_CACHE_MAX_AGE_NS (2 * chre::kOneSecondInNanoseconds)
+#endif
 
 namespace chre {
 
@@ -31,6 +40,13 @@ namespace chre {
  * The WwanRequestManager handles requests from nanoapps for WWAN data. This
  * includes multiplexing multiple requests into one for the platform to handle.
  *
+ * Cell info requests made while a platform request is in flight join that
+ * request, and requests made shortly after a successful result are answered
+ * from the cached result (see CHRE_WWAN_CELL_INFO_CACHE_MAX_AGE_NS). A single
+ * platform result is shared by all the nanoapps it is delivered to and is
+ * released back to the platform once the last reference to it is dropped. The
+ * cache drops its reference on a timer once the result expires.
+ *
  * This class is effectively a singleton as there can only be one instance of
  * the PlatformWwan instance.
  */
@@ -64,6 +80,18 @@ class WwanRequestManager : public NonCopyable {
    */
   void handleCellInfoResult(chreWwanCellInfoResult *result);
 
+  /**
+   * Overrides the maximum age of the cached cell info result, which is
+   * CHRE_WWAN_CELL_INFO_CACHE_MAX_AGE_NS by default. Applies to the results
+   * received afterwards. Must only be called from the context of the main
+   * CHRE thread.
+   *
+   * @param maxAge The new maximum age, zero disabling the cache.
+   */
+  void setCellInfoCacheMaxAge(Nanoseconds maxAge) {
+    mCellInfoCacheMaxAge = maxAge;
+  }
+
   /**
    * Prints state in a string buffer. Must only be called from the context of
    * the main CHRE thread.
@@ -74,19 +102,97 @@ class WwanRequestManager : public NonCopyable {
   void logStateToBuffer(DebugDumpWrapper &debugDump) const;
 
  private:
+  //! A nanoapp waiting for the result of the in-flight cell info request.
+  struct CellInfoRequest {
+    uint16_t instanceId;
+    const void *cookie;
+  };
+
+  //! A cell info result from the platform shared between all the nanoapps it
+  //! is delivered to. The cache holds one reference to the result while it is
+  //! fresh, and each delivered event holds one more.
+  struct SharedCellInfoResult {
+    chreWwanCellInfoResult *result;
+    Nanoseconds receivedTime;
+    uint32_t refCount;
+  };
+
+  //! The per-nanoapp view of a shared result which is posted as event data.
+  //! The result must be the first member as the event free callback receives
+  //! a pointer to it.
+  struct CellInfoResultEvent {
+    chreWwanCellInfoResult result;
+    SharedCellInfoResult *shared;
+    uint16_t instanceId;
+  };
+
   //! The instance of the platform WWAN interface.
   PlatformWwan mPlatformWwan;
 
-  // TODO: Support multiple requests for cell info by enqueuing them and
-  // requesting one after another.
-  //! The nanoapp that is currently requesting cell info. At this time only one
-  //! nanoapp can have a pending request for cell info.
-  Optional<uint16_t> mCellInfoRequestingNanoappInstanceId;
+  //! True while a request for cell info is pending at the platform.
+  bool mCellInfoRequestInFlight = false;
+
+  //! The nanoapps waiting for the result of the in-flight request.
+  DynamicVector<CellInfoRequest> mPendingCellInfoRequests;
+
+  //! The instance IDs of the nanoapps that have been posted a cell info result
+  //! which has not been freed yet. May contain duplicates.
+  DynamicVector<uint16_t> mCellInfoResultRecipients;
+
+  //! The most recent successful result, or nullptr if there is none or it has
+  //! been dropped from the cache.
+  SharedCellInfoResult *mCachedCellInfoResult = nullptr;
+
+  //! The timer dropping the cached result once it expires.
+  TimerHandle mCachedCellInfoExpiryTimerHandle = CHRE_TIMER_INVALID;
+
+  //! The maximum age of the cached result.
+  Nanoseconds mCellInfoCacheMaxAge =
+      Nanoseconds(CHRE_WWAN_CELL_INFO_CACHE_MAX_AGE_NS);
+
+  //! The number of platform requests issued, for debug dumps.
+  uint32_t mNumPlatformCellInfoRequests = 0;
+
+  //! The number of nanoapp requests served without a new platform request,
+  //! either from the cache or by joining an in-flight request.
+  uint32_t mNumCoalescedCellInfoRequests = 0;
+
+  /**
+   * Caches a result until it expires, taking over a reference to it.
+   */
+  void cacheCellInfoResult(SharedCellInfoResult *shared);
+
+  /**
+   * Drops the reference held by the cache, if any, and cancels its expiry
+   * timer.
+   */
+  void clearCachedCellInfoResult();
+
+  /**
+   * Drops the cached result once its expiry timer fires.
+   */
+  void handleCellInfoCacheExpired();
+
+  /**
+   * Posts a shared cell info result to a nanoapp, taking a reference to it.
+   *
+   * @param shared The result to post.
+   * @param request The nanoapp and cookie to deliver the result to.
+   * @return true if the event was posted.
+   */
+  bool postCellInfoResult(SharedCellInfoResult *shared,
+                          const CellInfoRequest &request);
+
+  /**
+   * Drops a reference to a shared result, releasing it to the platform when it
+   * is no longer referenced.
+   */
+  void releaseSharedCellInfoResult(SharedCellInfoResult *shared);
 
-  //! The cookie passed in by a nanoapp making a request for cell info. Note
-  //! that this will only be valid if the mCellInfoRequestingNanoappInstanceId
-  //! is set.
-  const void *mCellInfoRequestingNanoappCookie;
+  /**
+   * @return true if the nanoapp still waits for or holds a cell info result.
+   */
+  bool isCellInfoRecipient(uint16_t instanceId) const;
 
   /**
    * Handles the result of a request for cell info. See handleCellInfoResult
@@ -98,12 +204,13 @@ class WwanRequestManager : public NonCopyable {
   void handleCellInfoResultSync(chreWwanCellInfoResult *result);
 
   /**
-   * Handles the releasing of a WWAN cell info result and unsubscribes the
-   * nanoapp who made the request for cell info from cell info events.
+   * Handles the releasing of a WWAN cell info result event and unsubscribes
+   * the nanoapp who made the request for cell info from cell info events if it
+   * has no other outstanding result.
    *
-   * @param result The cell info result to release.
+   * @param event The cell info result event to release.
    */
-  void handleFreeCellInfoResult(chreWwanCellInfoResult *result);
+  void handleFreeCellInfoResult(CellInfoResultEvent *event);
 
   /**
    * Releases a cell info result after nanoapps have consumed it.
@@ -46,11 +46,12 @@ Nanoapp::Nanoapp(uint16_t instanceId) {
 }
 
 bool Nanoapp::start() {
-  // TODO(b/294116163): update trace with nanoapp instance id and nanoapp name
-  CHRE_TRACE_INSTANT("Nanoapp start");
+  // TODO(b/294116163): update trace with nanoapp name
+  CHRE_TRACE_START("Nanoapp start", "nanoapp", getInstanceId());
   mIsInNanoappStart = true;
   bool success = PlatformNanoapp::start();
   mIsInNanoappStart = false;
+  CHRE_TRACE_END("Nanoapp start", "nanoapp", getInstanceId());
   return success;
 }
 
@@ -152,6 +153,9 @@ void Nanoapp::processEvent(Event *event) {
   Nanoseconds eventProcessTime =
       SystemTime::getMonotonicTime() - eventStartTime;
   uint64_t eventTimeMs = Milliseconds(eventProcessTime).getMilliseconds();
+
+  // The stats are also updated and read by the system.
+  EventLoop::SystemLockGuard lock;
   if (Milliseconds(eventProcessTime) >= Milliseconds(100)) {
     LOGE("Nanoapp 0x%" PRIx64 " took %" PRIu64
          " ms to process event type 0x%" PRIx16,
@@ -23,7 +23,9 @@ namespace chre {
 Mutex Sensor::mSamplingStatusMutex;
 
 Sensor::Sensor(Sensor &&other)
-    : PlatformSensor(std::move(other)), mFlushRequestPending(false) {
+    : PlatformSensor(std::move(other)),
+      mFlushRequestPending(false),
+      mSynchronizedBatchGrouped(false) {
   *this = std::move(other);
 }
 
@@ -38,6 +40,9 @@ Sensor &Sensor::operator=(Sensor &&other) {
   mFlushRequestPending = other.mFlushRequestPending.load();
   other.mFlushRequestPending = false;
 
+  mSynchronizedBatchGrouped = other.mSynchronizedBatchGrouped.load();
+  other.mSynchronizedBatchGrouped = false;
+
   mLastEvent = other.mLastEvent;
   other.mLastEvent = nullptr;
 
@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre/core/sensor_batch_synchronizer.h"
+
+#include <cinttypes>
+
+#include "chre/core/event_loop_manager.h"
+#include "chre/core/sensor_type_helpers.h"
+#include "chre/platform/assert.h"
+#include "chre/platform/log.h"
+#include "chre/platform/memory.h"
+#include "chre/util/nested_data_ptr.h"
+
+namespace chre {
+
+namespace {
+
+bool hasRequest(const Sensor &sensor, uint16_t instanceId) {
+  for (const SensorRequest &request : sensor.getRequests()) {
+    if (request.getInstanceId() == instanceId) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//! Frees the data copies owned by a batch and the batch itself.
+void synchronizedBatchEventFree(uint16_t /* eventType */, void *eventData) {
+  auto *event = static_cast<chreSensorSynchronizedBatchEvent *>(eventData);
+  for (uint8_t i = 0; i < event->sensorCount; i++) {
+    memoryFree(const_cast<void *>(event->sensorData[i]));
+  }
+  memoryFree(event);
+}
+
+//! @return a copy of a data event of the sensor, or nullptr on failure.
+ChreSensorData *copyDataEvent(const Sensor &sensor,
+                              const ChreSensorData *eventData) {
+  size_t size = SensorTypeHelpers::getDataEventSize(
+      sensor.getSensorType(), eventData->header.readingCount);
+  auto *copy = static_cast<ChreSensorData *>(memoryAlloc(size));
+  if (copy == nullptr) {
+    LOG_OOM();
+  } else {
+    memcpy(copy, eventData, size);
+  }
+  return copy;
+}
+
+void batchTimeoutCallback(uint16_t /* type */, void *data,
+                          void * /* extraData */) {
+  uint32_t timerData = NestedDataPtr<uint32_t>(data);
+  EventLoopManagerSingleton::get()
+      ->getSensorRequestManager()
+      .handleSynchronizedBatchTimeout(static_cast<uint16_t>(timerData),
+                                      static_cast<uint16_t>(timerData >> 16));
+}
+
+}  // anonymous namespace
+
+SensorBatchSynchronizer::~SensorBatchSynchronizer() {
+  for (Group &group : mGroups) {
+    for (uint8_t i = 0; i < group.sensorCount; i++) {
+      memoryFree(group.batch[i]);
+    }
+  }
+}
+
+bool SensorBatchSynchronizer::setGroup(uint16_t instanceId,
+                                       const uint32_t *sensorHandles,
+                                       uint8_t sensorCount) {
+  CHRE_ASSERT(sensorCount <= CHRE_SENSOR_SYNCHRONIZED_BATCH_MAX_SENSORS);
+
+  size_t index = findGroup(instanceId);
+  if (index < mGroups.size()) {
+    dispatchBatch(mGroups[index]);
+    if (sensorCount == 0) {
+      mGroups.erase(index);
+    }
+  } else if (sensorCount > 0) {
+    if (!mGroups.emplace_back()) {
+      LOG_OOM();
+      return false;
+    }
+    index = mGroups.size() - 1;
+  }
+
+  if (sensorCount > 0) {
+    Group &group = mGroups[index];
+    group.instanceId = instanceId;
+    group.sensorCount = sensorCount;
+    group.timerHandle = CHRE_TIMER_INVALID;
+    group.batchSequence = 0;
+    for (uint8_t i = 0; i < sensorCount; i++) {
+      group.sensorHandles[i] = sensorHandles[i];
+      group.batch[i] = nullptr;
+    }
+  }
+  return true;
+}
+
+bool SensorBatchSynchronizer::isGrouped(uint16_t instanceId,
+                                        uint32_t sensorHandle) const {
+  size_t index = findGroup(instanceId);
+  if (index < mGroups.size()) {
+    const Group &group = mGroups[index];
+    for (uint8_t i = 0; i < group.sensorCount; i++) {
+      if (group.sensorHandles[i] == sensorHandle) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool SensorBatchSynchronizer::isGroupedByAnyNanoapp(
+    uint32_t sensorHandle) const {
+  for (const Group &group : mGroups) {
+    if (isGrouped(group.instanceId, sensorHandle)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void SensorBatchSynchronizer::addDataEvent(uint32_t sensorHandle,
+                                           const Sensor &sensor,
+                                           const ChreSensorData *eventData) {
+  for (Group &group : mGroups) {
+    uint8_t slot = group.sensorCount;
+    for (uint8_t i = 0; i < group.sensorCount; i++) {
+      if (group.sensorHandles[i] == sensorHandle) {
+        slot = i;
+        break;
+      }
+    }
+    if (slot == group.sensorCount || !hasRequest(sensor, group.instanceId)) {
+      continue;
+    }
+
+    // A sensor running ahead of the others starts a new batch rather than
+    // replacing the data of the current one.
+    if (group.batch[slot] != nullptr) {
+      dispatchBatch(group);
+    }
+    group.batch[slot] = copyDataEvent(sensor, eventData);
+    if (group.batch[slot] == nullptr) {
+      continue;
+    }
+
+    bool complete = true;
+    bool first = true;
+    for (uint8_t i = 0; i < group.sensorCount; i++) {
+      if (group.batch[i] == nullptr) {
+        complete = false;
+      } else if (i != slot) {
+        first = false;
+      }
+    }
+
+    if (complete) {
+      dispatchBatch(group);
+    } else if (first) {
+      uint32_t timerData = (static_cast<uint32_t>(group.batchSequence) << 16) |
+                           group.instanceId;
+      group.timerHandle = EventLoopManagerSingleton::get()->setDelayedCallback(
+          SystemCallbackType::SensorSynchronizedBatchTimeout,
+          NestedDataPtr<uint32_t>(timerData), batchTimeoutCallback,
+          Nanoseconds(CHRE_SENSOR_SYNCHRONIZED_BATCH_WINDOW_NS));
+      if (group.timerHandle == CHRE_TIMER_INVALID) {
+        LOGE("Failed to start the synchronized batch timer");
+        dispatchBatch(group);
+      }
+    }
+  }
+}
+
+void SensorBatchSynchronizer::onBatchTimeout(uint16_t instanceId,
+                                             uint16_t batchSequence) {
+  size_t index = findGroup(instanceId);
+  if (index < mGroups.size() &&
+      mGroups[index].batchSequence == batchSequence) {
+    mGroups[index].timerHandle = CHRE_TIMER_INVALID;
+    dispatchBatch(mGroups[index]);
+  }
+}
+
+void SensorBatchSynchronizer::logStateToBuffer(
+    DebugDumpWrapper &debugDump) const {
+  debugDump.print("\nSynchronized sensor batches: %" PRIu32
+                  " delivered, %" PRIu32 " partial\n",
+                  mNumBatchesDelivered, mNumPartialBatchesDelivered);
+  for (const Group &group : mGroups) {
+    debugDump.print(" appId=%" PRIu16 " sensors=", group.instanceId);
+    for (uint8_t i = 0; i < group.sensorCount; i++) {
+      debugDump.print("%s%" PRIu32, (i == 0) ? "" : ",",
+                      group.sensorHandles[i]);
+    }
+    debugDump.print("\n");
+  }
+}
+
+size_t SensorBatchSynchronizer::findGroup(uint16_t instanceId) const {
+  for (size_t i = 0; i < mGroups.size(); i++) {
+    if (mGroups[i].instanceId == instanceId) {
+      return i;
+    }
+  }
+  return mGroups.size();
+}
+
+void SensorBatchSynchronizer::dispatchBatch(Group &group) {
+  if (group.timerHandle != CHRE_TIMER_INVALID) {
+    EventLoopManagerSingleton::get()->cancelDelayedCallback(group.timerHandle);
+    group.timerHandle = CHRE_TIMER_INVALID;
+  }
+
+  chreSensorSynchronizedBatchEvent batch = {};
+  bool empty = true;
+  bool partial = false;
+  batch.sensorCount = group.sensorCount;
+  for (uint8_t i = 0; i < group.sensorCount; i++) {
+    batch.sensorData[i] = group.batch[i];
+    group.batch[i] = nullptr;
+    if (batch.sensorData[i] == nullptr) {
+      partial = true;
+    } else {
+      empty = false;
+    }
+  }
+  if (empty) {
+    return;
+  }
+  group.batchSequence++;
+
+  auto *event = memoryAlloc<chreSensorSynchronizedBatchEvent>();
+  if (event == nullptr) {
+    LOG_OOM();
+    for (uint8_t i = 0; i < batch.sensorCount; i++) {
+      memoryFree(const_cast<void *>(batch.sensorData[i]));
+    }
+    return;
+  }
+
+  *event = batch;
+  mNumBatchesDelivered++;
+  if (partial) {
+    mNumPartialBatchesDelivered++;
+  }
+  EventLoopManagerSingleton::get()->getEventLoop().postLowPriorityEventOrFree(
+      CHRE_EVENT_SENSOR_SYNCHRONIZED_BATCH, event, synchronizedBatchEventFree,
+      kSystemInstanceId, group.instanceId);
+}
+
+}  // namespace chre
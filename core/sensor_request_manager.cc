@@ -235,8 +235,12 @@ bool SensorRequestManager::setSensorRequest(
 
         success = addRequest(sensor, request, &requestChanged);
         if (success) {
-          nanoapp->registerForBroadcastEvent(eventType,
-                                             sensor.getTargetGroupMask());
+          // Data of grouped sensors is delivered in synchronized batches.
+          if (!mBatchSynchronizer.isGrouped(nanoapp->getInstanceId(),
+                                            sensorHandle)) {
+            nanoapp->registerForBroadcastEvent(eventType,
+                                               sensor.getTargetGroupMask());
+          }
 
           if (request.getBiasUpdatesRequested()) {
             nanoapp->registerForBroadcastEvent(biasEventType,
@@ -449,6 +453,70 @@ void SensorRequestManager::releaseSensorDataEvent(uint16_t eventType,
   }
 }
 
+bool SensorRequestManager::configureSynchronizedBatch(
+    Nanoapp *nanoapp, const uint32_t *sensorHandles, uint8_t sensorCount) {
+  CHRE_ASSERT(nanoapp);
+
+  if (sensorCount > CHRE_SENSOR_SYNCHRONIZED_BATCH_MAX_SENSORS ||
+      (sensorCount > 0 && sensorHandles == nullptr)) {
+    LOGE("Invalid synchronized batch of %" PRIu8 " sensors", sensorCount);
+    return false;
+  }
+  for (uint8_t i = 0; i < sensorCount; i++) {
+    if (sensorHandles[i] >= mSensors.size()) {
+      LOG_INVALID_HANDLE(sensorHandles[i]);
+      return false;
+    }
+    const Sensor &sensor = mSensors[sensorHandles[i]];
+    if (!sensor.isContinuous() ||
+        SensorTypeHelpers::getDataEventSize(sensor.getSensorType(),
+                                            1 /*readingCount*/) == 0) {
+      LOGE("Sensor %" PRIu32 " can't be grouped", sensorHandles[i]);
+      return false;
+    }
+    for (uint8_t j = 0; j < i; j++) {
+      if (sensorHandles[j] == sensorHandles[i]) {
+        LOGE("Sensor %" PRIu32 " grouped twice", sensorHandles[i]);
+        return false;
+      }
+    }
+  }
+
+  // Collect the sensors leaving the group before it is replaced.
+  uint16_t instanceId = nanoapp->getInstanceId();
+  uint32_t ungroupedHandles[CHRE_SENSOR_SYNCHRONIZED_BATCH_MAX_SENSORS];
+  uint8_t ungroupedCount = 0;
+  for (uint32_t handle = 0; handle < mSensors.size(); handle++) {
+    if (mBatchSynchronizer.isGrouped(instanceId, handle)) {
+      ungroupedHandles[ungroupedCount++] = handle;
+    }
+  }
+
+  if (!mBatchSynchronizer.setGroup(instanceId, sensorHandles, sensorCount)) {
+    return false;
+  }
+  updateSynchronizedBatchGrouping();
+
+  for (uint8_t i = 0; i < ungroupedCount; i++) {
+    Sensor &sensor = mSensors[ungroupedHandles[i]];
+    if (!mBatchSynchronizer.isGrouped(instanceId, ungroupedHandles[i]) &&
+        sensor.getRequestMultiplexer().findRequest(
+            instanceId, nullptr /*index*/) != nullptr) {
+      nanoapp->registerForBroadcastEvent(
+          getSampleEventTypeForSensorType(sensor.getSensorType()),
+          sensor.getTargetGroupMask());
+    }
+  }
+  for (uint8_t i = 0; i < sensorCount; i++) {
+    Sensor &sensor = mSensors[sensorHandles[i]];
+    nanoapp->unregisterForBroadcastEvent(
+        getSampleEventTypeForSensorType(sensor.getSensorType()),
+        sensor.getTargetGroupMask());
+  }
+
+  return true;
+}
+
 void SensorRequestManager::handleFlushCompleteEvent(uint32_t sensorHandle,
                                                     uint32_t flushRequestId,
                                                     uint8_t errorCode) {
@@ -492,7 +560,9 @@ void SensorRequestManager::handleSensorDataEvent(uint32_t sensorHandle,
 
     // Only allow dropping continuous sensor events since losing one-shot or
     // on-change events could result in nanoapps stuck in a bad state.
-    if (sensor.isContinuous()) {
+    if (sensor.isSynchronizedBatchGrouped()) {
+      deferGroupedSensorDataEvent(sensorHandle, event);
+    } else if (sensor.isContinuous()) {
       EventLoopManagerSingleton::get()
           ->getEventLoop()
           .postLowPriorityEventOrFree(eventType, event, sensorDataEventFree,
@@ -506,6 +576,54 @@ void SensorRequestManager::handleSensorDataEvent(uint32_t sensorHandle,
   }
 }
 
+void SensorRequestManager::deferGroupedSensorDataEvent(uint32_t sensorHandle,
+                                                       void *event) {
+  auto callback = [](uint16_t /*type*/, void *data, void *extraData) {
+    uint32_t sensorHandle = NestedDataPtr<uint32_t>(extraData);
+    EventLoopManagerSingleton::get()
+        ->getSensorRequestManager()
+        .handleGroupedSensorDataEvent(sensorHandle, data);
+  };
+
+  if (!EventLoopManagerSingleton::get()->deferCallback(
+          SystemCallbackType::SensorSynchronizedBatchData, event, callback,
+          NestedDataPtr<uint32_t>(sensorHandle))) {
+    mPlatformSensorManager.releaseSensorDataEvent(event);
+  }
+}
+
+void SensorRequestManager::handleGroupedSensorDataEvent(uint32_t sensorHandle,
+                                                        void *event) {
+  Sensor &sensor = mSensors[sensorHandle];
+  mBatchSynchronizer.addDataEvent(sensorHandle, sensor,
+                                  static_cast<ChreSensorData *>(event));
+
+  // Only nanoapps that do not group the sensor receive the data event.
+  bool hasUngroupedRequest = false;
+  for (const SensorRequest &request : sensor.getRequests()) {
+    if (!mBatchSynchronizer.isGrouped(request.getInstanceId(), sensorHandle)) {
+      hasUngroupedRequest = true;
+      break;
+    }
+  }
+
+  if (hasUngroupedRequest) {
+    EventLoopManagerSingleton::get()->getEventLoop().postLowPriorityEventOrFree(
+        getSampleEventTypeForSensorType(sensor.getSensorType()), event,
+        sensorDataEventFree, kSystemInstanceId, kBroadcastInstanceId,
+        sensor.getTargetGroupMask());
+  } else {
+    mPlatformSensorManager.releaseSensorDataEvent(event);
+  }
+}
+
+void SensorRequestManager::updateSynchronizedBatchGrouping() {
+  for (uint32_t handle = 0; handle < mSensors.size(); handle++) {
+    mSensors[handle].setSynchronizedBatchGrouped(
+        mBatchSynchronizer.isGroupedByAnyNanoapp(handle));
+  }
+}
+
 void SensorRequestManager::handleSamplingStatusUpdate(
     uint32_t sensorHandle, struct chreSensorSamplingStatus *status) {
   Sensor *sensor =
@@ -595,11 +713,17 @@ void SensorRequestManager::logStateToBuffer(DebugDumpWrapper &debugDump) const {
     }
     debugDump.print("\n");
   }
+
+  mBatchSynchronizer.logStateToBuffer(debugDump);
 }
 
 uint32_t SensorRequestManager::disableAllSubscriptions(Nanoapp *nanoapp) {
   uint32_t numDisabledSubscriptions = 0;
 
+  mBatchSynchronizer.setGroup(nanoapp->getInstanceId(),
+                              nullptr /*sensorHandles*/, 0 /*sensorCount*/);
+  updateSynchronizedBatchGrouping();
+
   const uint32_t numSensors = static_cast<uint32_t>(mSensors.size());
   for (uint32_t handle = 0; handle < numSensors; handle++) {
     Sensor &sensor = mSensors[handle];
@@ -129,6 +129,40 @@ size_t SensorTypeHelpers::getLastEventSize(uint8_t sensorType) {
   return 0;
 }
 
+size_t SensorTypeHelpers::getDataEventSize(uint8_t sensorType,
+                                           uint16_t readingCount) {
+  if (isVendorSensorType(sensorType)) {
+    return 0;
+  }
+
+  switch (sensorType) {
+    case CHRE_SENSOR_TYPE_ACCELEROMETER:
+    case CHRE_SENSOR_TYPE_GYROSCOPE:
+    case CHRE_SENSOR_TYPE_GEOMAGNETIC_FIELD:
+    case CHRE_SENSOR_TYPE_UNCALIBRATED_ACCELEROMETER:
+    case CHRE_SENSOR_TYPE_UNCALIBRATED_GYROSCOPE:
+    case CHRE_SENSOR_TYPE_UNCALIBRATED_GEOMAGNETIC_FIELD:
+      return getDataEventSize<chreSensorThreeAxisData>(readingCount);
+    case CHRE_SENSOR_TYPE_PRESSURE:
+    case CHRE_SENSOR_TYPE_LIGHT:
+    case CHRE_SENSOR_TYPE_ACCELEROMETER_TEMPERATURE:
+    case CHRE_SENSOR_TYPE_GYROSCOPE_TEMPERATURE:
+    case CHRE_SENSOR_TYPE_GEOMAGNETIC_FIELD_TEMPERATURE:
+    case CHRE_SENSOR_TYPE_HINGE_ANGLE:
+      return getDataEventSize<chreSensorFloatData>(readingCount);
+    case CHRE_SENSOR_TYPE_INSTANT_MOTION_DETECT:
+    case CHRE_SENSOR_TYPE_STATIONARY_DETECT:
+    case CHRE_SENSOR_TYPE_STEP_DETECT:
+      return getDataEventSize<chreSensorOccurrenceData>(readingCount);
+    case CHRE_SENSOR_TYPE_PROXIMITY:
+      return getDataEventSize<chreSensorByteData>(readingCount);
+    case CHRE_SENSOR_TYPE_STEP_COUNTER:
+      return getDataEventSize<chreSensorUint64Data>(readingCount);
+    default:
+      return 0;
+  }
+}
+
 const char *SensorTypeHelpers::getSensorTypeName(uint8_t sensorType) {
   if (isVendorSensorType(sensorType)) {
     return getVendorSensorTypeName(sensorType);
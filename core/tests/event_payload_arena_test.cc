@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "chre/core/event.h"
+#include "chre/core/event_payload_arena.h"
+#include "chre/core/nanoapp.h"
+
+using chre::Event;
+using chre::EventPayloadArena;
+using chre::Nanoapp;
+
+namespace {
+
+bool isAligned(const void *payload) {
+  return reinterpret_cast<uintptr_t>(payload) % alignof(std::max_align_t) ==
+         0;
+}
+
+}  // namespace
+
+TEST(EventPayloadArena, AllocatesAlignedPayloadsOfAllSizes) {
+  EventPayloadArena arena;
+  const size_t sizes[] = {1, EventPayloadArena::kSmallPayloadSize,
+                          EventPayloadArena::kMediumPayloadSize,
+                          EventPayloadArena::kLargePayloadSize,
+                          EventPayloadArena::kLargePayloadSize + 1};
+  void *payloads[sizeof(sizes) / sizeof(sizes[0])];
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    payloads[i] = arena.allocate(sizes[i]);
+    ASSERT_NE(payloads[i], nullptr);
+    EXPECT_TRUE(isAligned(payloads[i]));
+    memset(payloads[i], 0xA5, sizes[i]);
+  }
+  EXPECT_EQ(arena.getPayloadCount(), 5);
+
+  for (void *payload : payloads) {
+    arena.release(payload);
+  }
+  EXPECT_EQ(arena.getPayloadCount(), 0);
+}
+
+TEST(EventPayloadArena, ExhaustedSizeClassFallsBackToLargerOnes) {
+  // Only the heap is left when the variant configures no blocks, the default.
+  EventPayloadArena arena;
+  constexpr size_t kNumPayloads = CHRE_EVENT_PAYLOAD_ARENA_SMALL_COUNT +
+                                  CHRE_EVENT_PAYLOAD_ARENA_MEDIUM_COUNT +
+                                  CHRE_EVENT_PAYLOAD_ARENA_LARGE_COUNT + 2;
+  void *payloads[kNumPayloads];
+  for (size_t i = 0; i < kNumPayloads; i++) {
+    payloads[i] = arena.allocate(sizeof(uint32_t));
+    ASSERT_NE(payloads[i], nullptr);
+    *static_cast<uint32_t *>(payloads[i]) = i;
+  }
+  for (size_t i = 0; i < kNumPayloads; i++) {
+    EXPECT_EQ(*static_cast<uint32_t *>(payloads[i]), i);
+    arena.release(payloads[i]);
+  }
+  EXPECT_EQ(arena.getPayloadCount(), 0);
+}
+
+TEST(EventPayloadArena, PayloadIsFreedWithItsLastReference) {
+  EventPayloadArena arena;
+  void *payload = arena.allocate(16);
+  ASSERT_NE(payload, nullptr);
+  EXPECT_TRUE(arena.addReference(payload));
+
+  arena.release(payload);
+  EXPECT_EQ(arena.getPayloadCount(), 1);
+  arena.release(payload);
+  EXPECT_EQ(arena.getPayloadCount(), 0);
+  EXPECT_FALSE(arena.addReference(payload));
+}
+
+TEST(EventPayloadArena, OnlyArenaPayloadsCanBeRetained) {
+  EventPayloadArena arena;
+  Nanoapp app(1);
+  uint32_t notAPayload = 0;
+  Event event(/* eventType= */ 0, &notAPayload, /* freeCallback= */ nullptr,
+              /* isLowPriority= */ false);
+  EXPECT_FALSE(arena.nanoappRetain(&app, &event, &notAPayload));
+  EXPECT_FALSE(arena.nanoappRetain(&app, &event, nullptr));
+  EXPECT_FALSE(arena.nanoappRelease(&app, &notAPayload));
+}
+
+TEST(EventPayloadArena, OnlyTheDataOfTheCurrentEventCanBeRetained) {
+  EventPayloadArena arena;
+  Nanoapp app(1);
+  void *payload = arena.allocate(EventPayloadArena::kSmallPayloadSize);
+  void *otherPayload = arena.allocate(EventPayloadArena::kSmallPayloadSize);
+  ASSERT_NE(payload, nullptr);
+  ASSERT_NE(otherPayload, nullptr);
+  Event event(/* eventType= */ 0, payload, /* freeCallback= */ nullptr,
+              /* isLowPriority= */ false);
+
+  // E.g. the payload of an event delivered to another nanoapp.
+  EXPECT_FALSE(arena.nanoappRetain(&app, &event, otherPayload));
+  EXPECT_FALSE(arena.nanoappRetain(&app, /* currentEvent= */ nullptr,
+                                   payload));
+  EXPECT_TRUE(arena.nanoappRetain(&app, &event, payload));
+
+  EXPECT_EQ(arena.nanoappReleaseAll(&app), 1);
+  arena.release(payload);
+  arena.release(otherPayload);
+  EXPECT_EQ(arena.getPayloadCount(), 0);
+}
+
+TEST(EventPayloadArena, NanoappReferencesOutliveTheEvent) {
+  EventPayloadArena arena;
+  Nanoapp appOne(1);
+  Nanoapp appTwo(2);
+  void *payload = arena.allocate(EventPayloadArena::kLargePayloadSize * 2);
+  ASSERT_NE(payload, nullptr);
+  Event event(/* eventType= */ 0, payload, /* freeCallback= */ nullptr,
+              /* isLowPriority= */ false);
+  EXPECT_TRUE(arena.nanoappRetain(&appOne, &event, payload));
+  EXPECT_TRUE(arena.nanoappRetain(&appOne, &event, payload));
+  EXPECT_TRUE(arena.nanoappRetain(&appTwo, &event, payload));
+
+  // The reference of the event.
+  arena.release(payload);
+  EXPECT_EQ(arena.getPayloadCount(), 1);
+
+  EXPECT_TRUE(arena.nanoappRelease(&appTwo, payload));
+  EXPECT_FALSE(arena.nanoappRelease(&appTwo, payload));
+  EXPECT_EQ(arena.getPayloadCount(), 1);
+
+  EXPECT_EQ(arena.nanoappReleaseAll(&appOne), 2);
+  EXPECT_EQ(arena.getPayloadCount(), 0);
+}
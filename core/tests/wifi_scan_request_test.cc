@@ -18,6 +18,7 @@
 
 #include "chre/core/wifi_scan_request.h"
 
+using chre::CoalescedWifiScanParams;
 using chre::WifiScanRequest;
 using chre::WifiScanType;
 
@@ -27,3 +28,129 @@ TEST(WifiScanRequest, DefaultWithMinimalPriority) {
   EXPECT_EQ(request.getFrequencies().size(), 0u);
   EXPECT_EQ(request.getSsids().size(), 0u);
 }
+
+namespace {
+
+chreWifiScanParams makeScanParams(const uint32_t *frequencies,
+                                  uint16_t frequencyCount,
+                                  uint32_t maxScanAgeMs = 5000) {
+  return chreWifiScanParams{
+      .scanType = CHRE_WIFI_SCAN_TYPE_ACTIVE,
+      .maxScanAgeMs = maxScanAgeMs,
+      .frequencyListLen = frequencyCount,
+      .frequencyList = frequencies,
+      .ssidListLen = 0,
+      .ssidList = nullptr,
+      .radioChainPref = CHRE_WIFI_RADIO_CHAIN_PREF_DEFAULT,
+      .channelSet = CHRE_WIFI_CHANNEL_SET_NON_DFS,
+  };
+}
+
+}  // namespace
+
+TEST(CoalescedWifiScanParams, MergesFrequencyListsAndKeepsMinimumAge) {
+  const uint32_t kFrequenciesA[] = {2412, 2437};
+  const uint32_t kFrequenciesB[] = {2437, 5180};
+  CoalescedWifiScanParams coalesced;
+  ASSERT_TRUE(coalesced.reset(makeScanParams(kFrequenciesA, 2, 5000)));
+  ASSERT_TRUE(coalesced.merge(makeScanParams(kFrequenciesB, 2, 1000)));
+
+  chreWifiScanParams params;
+  coalesced.getParams(&params);
+  ASSERT_EQ(params.frequencyListLen, 3u);
+  EXPECT_EQ(params.frequencyList[0], 2412u);
+  EXPECT_EQ(params.frequencyList[1], 2437u);
+  EXPECT_EQ(params.frequencyList[2], 5180u);
+  EXPECT_EQ(params.maxScanAgeMs, 1000u);
+  EXPECT_TRUE(coalesced.covers(makeScanParams(kFrequenciesB, 2)));
+}
+
+TEST(CoalescedWifiScanParams, EmptyFrequencyListScansAllFrequencies) {
+  const uint32_t kFrequencies[] = {2412};
+  CoalescedWifiScanParams coalesced;
+  ASSERT_TRUE(coalesced.reset(makeScanParams(kFrequencies, 1)));
+  EXPECT_FALSE(coalesced.covers(makeScanParams(nullptr, 0)));
+
+  ASSERT_TRUE(coalesced.merge(makeScanParams(nullptr, 0)));
+  chreWifiScanParams params;
+  coalesced.getParams(&params);
+  EXPECT_EQ(params.frequencyListLen, 0u);
+  EXPECT_TRUE(coalesced.covers(makeScanParams(kFrequencies, 1)));
+}
+
+TEST(CoalescedWifiScanParams, IncompatibleRequestIsNotMerged) {
+  CoalescedWifiScanParams coalesced;
+  ASSERT_TRUE(coalesced.reset(makeScanParams(nullptr, 0)));
+
+  chreWifiScanParams passive = makeScanParams(nullptr, 0);
+  passive.scanType = CHRE_WIFI_SCAN_TYPE_PASSIVE;
+  EXPECT_FALSE(coalesced.isCompatible(passive));
+  EXPECT_FALSE(coalesced.merge(passive));
+  EXPECT_FALSE(coalesced.covers(passive));
+
+  coalesced.clear();
+  EXPECT_TRUE(coalesced.empty());
+}
+
+TEST(CoalescedWifiScanParams, SsidListIsBoundedByApiMaximum) {
+  chreWifiSsidListItem ssids[CHRE_WIFI_SSID_LIST_MAX_LEN + 1] = {};
+  for (size_t i = 0; i < CHRE_WIFI_SSID_LIST_MAX_LEN + 1; i++) {
+    ssids[i].ssidLen = 1;
+    ssids[i].ssid[0] = static_cast<uint8_t>(i);
+  }
+
+  chreWifiScanParams first = makeScanParams(nullptr, 0);
+  first.ssidList = ssids;
+  first.ssidListLen = CHRE_WIFI_SSID_LIST_MAX_LEN;
+  chreWifiScanParams second = makeScanParams(nullptr, 0);
+  second.ssidList = &ssids[CHRE_WIFI_SSID_LIST_MAX_LEN];
+  second.ssidListLen = 1;
+
+  CoalescedWifiScanParams coalesced;
+  ASSERT_TRUE(coalesced.reset(first));
+  EXPECT_FALSE(coalesced.merge(second));
+
+  // A failed merge leaves the accumulated parameters unchanged.
+  chreWifiScanParams params;
+  coalesced.getParams(&params);
+  EXPECT_EQ(params.ssidListLen, CHRE_WIFI_SSID_LIST_MAX_LEN);
+  EXPECT_TRUE(coalesced.covers(first));
+}
+
+TEST(CoalescedWifiScanParams, DirectedScanDoesNotCoverWildcardRequest) {
+  chreWifiSsidListItem ssid = {.ssidLen = 1, .ssid = {'a'}};
+  chreWifiScanParams directed = makeScanParams(nullptr, 0);
+  directed.ssidList = &ssid;
+  directed.ssidListLen = 1;
+
+  CoalescedWifiScanParams coalesced;
+  ASSERT_TRUE(coalesced.reset(directed));
+  EXPECT_TRUE(coalesced.covers(directed));
+  EXPECT_FALSE(coalesced.covers(makeScanParams(nullptr, 0)));
+
+  // A wildcard scan covers any directed request.
+  ASSERT_TRUE(coalesced.reset(makeScanParams(nullptr, 0)));
+  EXPECT_TRUE(coalesced.covers(directed));
+}
+
+TEST(CoalescedWifiScanParams, MergingWildcardRequestScansAllSsids) {
+  chreWifiSsidListItem ssid = {.ssidLen = 1, .ssid = {'a'}};
+  chreWifiScanParams directed = makeScanParams(nullptr, 0);
+  directed.ssidList = &ssid;
+  directed.ssidListLen = 1;
+
+  CoalescedWifiScanParams coalesced;
+  ASSERT_TRUE(coalesced.reset(directed));
+  ASSERT_TRUE(coalesced.merge(makeScanParams(nullptr, 0)));
+  chreWifiScanParams params;
+  coalesced.getParams(&params);
+  EXPECT_EQ(params.ssidListLen, 0u);
+  EXPECT_EQ(params.ssidList, nullptr);
+
+  // Merging a directed request keeps the scan unrestricted.
+  ASSERT_TRUE(coalesced.merge(directed));
+  coalesced.getParams(&params);
+  EXPECT_EQ(params.ssidListLen, 0u);
+  EXPECT_TRUE(coalesced.covers(makeScanParams(nullptr, 0)));
+  EXPECT_TRUE(coalesced.covers(directed));
+}
@@ -19,6 +19,7 @@
 #include "chre/core/event_loop_manager.h"
 #include "chre/platform/fatal_error.h"
 #include "chre/platform/system_time.h"
+#include "chre/platform/tracing.h"
 #include "chre/util/lock_guard.h"
 
 namespace chre {
@@ -251,6 +252,10 @@ bool TimerPool::handleExpiredTimersAndScheduleNextLocked() {
     if (currentTime >= currentTimerRequest.expirationTime) {
       // This timer has expired, so post an event if it is a nanoapp timer, or
       // submit a deferred callback if it's a system timer.
+      CHRE_TRACE_INSTANT_DATA("Timer expired",
+                              "handle:" TRACE_U32 ",instance:" TRACE_U16,
+                              currentTimerRequest.timerHandle,
+                              currentTimerRequest.instanceId);
       if (currentTimerRequest.instanceId == kSystemInstanceId) {
         EventLoopManagerSingleton::get()->deferCallback(
             currentTimerRequest.callbackType,
@@ -60,6 +60,21 @@ static_assert(CHRE_TEST_WIFI_SCAN_RESULT_TIMEOUT_NS <=
 
 namespace chre {
 
+namespace {
+
+/**
+ * Releases the reference of the WiFi scan cache to a scan event payload, if
+ * any, and clears it.
+ */
+void releaseScanEventPayload(chreWifiScanEvent **event) {
+  if (*event != nullptr) {
+    EventLoopManagerSingleton::get()->getEventPayloadArena().release(*event);
+    *event = nullptr;
+  }
+}
+
+}  // anonymous namespace
+
 WifiRequestManager::WifiRequestManager() {
   // Reserve space for at least one scan monitoring nanoapp. This ensures that
   // the first asynchronous push_back will succeed. Future push_backs will be
@@ -313,7 +328,7 @@ void WifiRequestManager::handleScanRequestTimeout() {
   } else {
     EventLoopManagerSingleton::get()->getSystemHealthMonitor().onFailure(
         HealthCheckId::WifiScanResponseTimeout);
-    mPendingScanRequests.pop();
+    popScanRequestGroup();
     dispatchQueuedScanRequests(true /* postAsyncResult */);
   }
 }
@@ -358,15 +373,19 @@ bool WifiRequestManager::requestScan(Nanoapp *nanoapp,
 
   bool success = false;
   uint16_t nanoappInstanceId = nanoapp->getInstanceId();
+  bool wifiAvailable = EventLoopManagerSingleton::get()
+                           ->getSettingManager()
+                           .getSettingEnabled(Setting::WIFI_AVAILABLE);
   if (nanoappHasPendingScanRequest(nanoappInstanceId)) {
     LOGE("Can't issue new scan request: nanoapp: %" PRIx64
          " already has a pending request",
          nanoapp->getAppId());
+  } else if (wifiAvailable &&
+             postCachedScanResults(nanoappInstanceId, *params, cookie)) {
+    success = true;
   } else if (!mPendingScanRequests.emplace(nanoappInstanceId, cookie, params)) {
     LOG_OOM();
-  } else if (!EventLoopManagerSingleton::get()
-                  ->getSettingManager()
-                  .getSettingEnabled(Setting::WIFI_AVAILABLE)) {
+  } else if (!wifiAvailable) {
     // Treat as success, but send an async failure per API contract.
     success = true;
     handleScanResponse(false /* pending */, CHRE_ERROR_FUNCTION_DISABLED);
@@ -375,6 +394,7 @@ bool WifiRequestManager::requestScan(Nanoapp *nanoapp,
       success = dispatchQueuedScanRequests(false /* postAsyncResult */);
     } else {
       success = true;
+      joinInFlightScanRequest();
     }
   }
 
@@ -676,6 +696,19 @@ void WifiRequestManager::logStateToBuffer(DebugDumpWrapper &debugDump) const {
     for (const auto &request : mPendingScanRequests) {
       debugDump.print(" nappId=%" PRIu16, request.nanoappInstanceId);
     }
+    debugDump.print("\n Requests served by scan in flight: %zu\n",
+                    mInFlightScanRequestCount);
+  }
+
+  debugDump.print(" Wifi scans saved: coalesced=%" PRIu32 " cached=%" PRIu32
+                  "\n",
+                  mNumCoalescedScanRequests, mNumCachedScanRequests);
+  if (mCachedScanEvent != nullptr) {
+    debugDump.print(" Cached scan: results=%" PRIu8 " age(ms)=%" PRIu64 "\n",
+                    mCachedScanEvent->resultCount,
+                    Milliseconds(SystemTime::getMonotonicTime() -
+                                 mCachedScanTime)
+                        .getMilliseconds());
   }
 
   if (!mPendingScanMonitorRequests.empty()) {
@@ -909,7 +942,10 @@ void WifiRequestManager::postScanRequestAsyncResultEventFatal(
 
 void WifiRequestManager::postScanEventFatal(chreWifiScanEvent *event) {
   mLastScanEventTime = Milliseconds(SystemTime::getMonotonicTime());
-  EventLoopManagerSingleton::get()->getEventLoop().postEventOrDie(
+  if (mInFlightScanRequestCount > 0) {
+    mInFlightScanEventPosted = true;
+  }
+  EventLoopManagerSingleton::get()->getEventLoop().postEventInlineOrDie(
       CHRE_EVENT_WIFI_SCAN_RESULT, event, freeWifiScanEventCallback);
 }
 
@@ -990,29 +1026,35 @@ void WifiRequestManager::handleScanResponseSync(bool pending,
       LOGW("Wifi scan request failed: pending %d, errorCode %" PRIu8, pending,
            errorCode);
     }
-    PendingScanRequest &currentScanRequest = mPendingScanRequests.front();
-    postScanRequestAsyncResultEventFatal(currentScanRequest.nanoappInstanceId,
-                                         success, errorCode,
-                                         currentScanRequest.cookie);
-
     // Set a flag to indicate that results may be pending.
     mScanRequestResultsArePending = pending;
 
-    if (pending) {
-      Nanoapp *nanoapp =
-          EventLoopManagerSingleton::get()
-              ->getEventLoop()
-              .findNanoappByInstanceId(currentScanRequest.nanoappInstanceId);
-      if (nanoapp == nullptr) {
-        LOGW("Received WiFi scan response for unknown nanoapp");
-      } else {
-        nanoapp->registerForBroadcastEvent(CHRE_EVENT_WIFI_SCAN_RESULT);
+    // The response applies to every request merged into the platform scan.
+    size_t groupSize = getScanRequestGroupSize();
+    for (size_t i = 0; i < groupSize; i++) {
+      const PendingScanRequest &currentScanRequest = mPendingScanRequests[i];
+      postScanRequestAsyncResultEventFatal(currentScanRequest.nanoappInstanceId,
+                                           success, errorCode,
+                                           currentScanRequest.cookie);
+
+      if (pending) {
+        Nanoapp *nanoapp =
+            EventLoopManagerSingleton::get()
+                ->getEventLoop()
+                .findNanoappByInstanceId(currentScanRequest.nanoappInstanceId);
+        if (nanoapp == nullptr) {
+          LOGW("Received WiFi scan response for unknown nanoapp");
+        } else {
+          nanoapp->registerForBroadcastEvent(CHRE_EVENT_WIFI_SCAN_RESULT);
+        }
       }
-    } else {
-      // If the scan results are not pending, pop the first event since it's no
+    }
+
+    if (!pending) {
+      // If the scan results are not pending, pop the requests since they're no
       // longer waiting for anything. Otherwise, wait for the results to be
-      // delivered and then pop the first request.
-      mPendingScanRequests.pop();
+      // delivered and then pop the requests.
+      popScanRequestGroup();
       dispatchQueuedScanRequests(true /* postAsyncResult */);
     }
   }
@@ -1103,31 +1145,206 @@ void WifiRequestManager::dispatchQueuedNanSubscribeRequestWithRetry() {
 bool WifiRequestManager::dispatchQueuedScanRequests(bool postAsyncResult) {
   while (!mPendingScanRequests.empty()) {
     uint8_t asyncError = CHRE_ERROR_NONE;
-    const PendingScanRequest &currentScanRequest = mPendingScanRequests.front();
+    size_t requestCount = 1;
 
     if (!EventLoopManagerSingleton::get()
              ->getSettingManager()
              .getSettingEnabled(Setting::WIFI_AVAILABLE)) {
       asyncError = CHRE_ERROR_FUNCTION_DISABLED;
-    } else if (!mPlatformWifi.requestScan(&currentScanRequest.scanParams)) {
-      asyncError = CHRE_ERROR;
+    } else if ((requestCount = coalesceQueuedScanRequests()) == 0) {
+      requestCount = 1;
+      asyncError = CHRE_ERROR_NO_MEMORY;
     } else {
-      mScanRequestTimeoutHandle = setScanRequestTimer();
-      return true;
+      struct chreWifiScanParams scanParams;
+      mInFlightScanParams.getParams(&scanParams);
+      if (!mPlatformWifi.requestScan(&scanParams)) {
+        asyncError = CHRE_ERROR;
+      } else {
+        mInFlightScanRequestCount = requestCount;
+        mInFlightScanEventPosted = false;
+        mNumCoalescedScanRequests += requestCount - 1;
+        mScanRequestTimeoutHandle = setScanRequestTimer();
+        return true;
+      }
     }
 
-    if (postAsyncResult) {
-      postScanRequestAsyncResultEvent(currentScanRequest.nanoappInstanceId,
-                                      false /*success*/, asyncError,
-                                      currentScanRequest.cookie);
-    } else {
-      LOGE("Wifi scan request failed");
+    for (size_t i = 0; i < requestCount; i++) {
+      const PendingScanRequest &currentScanRequest =
+          mPendingScanRequests.front();
+      if (postAsyncResult) {
+        postScanRequestAsyncResultEvent(currentScanRequest.nanoappInstanceId,
+                                        false /*success*/, asyncError,
+                                        currentScanRequest.cookie);
+      } else {
+        LOGE("Wifi scan request failed");
+      }
+      mPendingScanRequests.pop();
     }
-    mPendingScanRequests.pop();
+    mInFlightScanParams.clear();
   }
   return false;
 }
 
+size_t WifiRequestManager::coalesceQueuedScanRequests() {
+  if (!mInFlightScanParams.reset(mPendingScanRequests.front().scanParams)) {
+    LOG_OOM();
+    return 0;
+  }
+
+  size_t requestCount = 1;
+  while (requestCount < mPendingScanRequests.size() &&
+         mInFlightScanParams.merge(
+             mPendingScanRequests[requestCount].scanParams)) {
+    requestCount++;
+  }
+  return requestCount;
+}
+
+size_t WifiRequestManager::getScanRequestGroupSize() const {
+  // A response without a scan in flight (e.g. WiFi disabled) only applies to
+  // the request at the front.
+  size_t groupSize =
+      (mInFlightScanRequestCount > 0) ? mInFlightScanRequestCount : 1;
+  size_t queueSize = mPendingScanRequests.size();
+  return (groupSize < queueSize) ? groupSize : queueSize;
+}
+
+void WifiRequestManager::popScanRequestGroup() {
+  size_t groupSize = getScanRequestGroupSize();
+  for (size_t i = 0; i < groupSize; i++) {
+    mPendingScanRequests.pop();
+  }
+  mInFlightScanRequestCount = 0;
+  mInFlightScanEventPosted = false;
+  mInFlightScanParams.clear();
+}
+
+bool WifiRequestManager::joinInFlightScanRequest() {
+  // Only the request queued right behind the scan in flight can join it, and
+  // only if it would not miss any of its results.
+  if (mInFlightScanRequestCount == 0 || mInFlightScanEventPosted ||
+      mInFlightScanRequestCount + 1 != mPendingScanRequests.size()) {
+    return false;
+  }
+
+  const PendingScanRequest &request = mPendingScanRequests.back();
+  struct chreWifiScanParams inFlightParams;
+  mInFlightScanParams.getParams(&inFlightParams);
+  if (request.scanParams.maxScanAgeMs < inFlightParams.maxScanAgeMs ||
+      !mInFlightScanParams.covers(request.scanParams)) {
+    return false;
+  }
+
+  mInFlightScanRequestCount++;
+  mNumCoalescedScanRequests++;
+
+  // If the platform already accepted the scan, the response for this request
+  // will not come from handleScanResponseSync.
+  if (mScanRequestResultsArePending) {
+    postScanRequestAsyncResultEventFatal(request.nanoappInstanceId,
+                                         true /* success */, CHRE_ERROR_NONE,
+                                         request.cookie);
+    Nanoapp *nanoapp = EventLoopManagerSingleton::get()
+                           ->getEventLoop()
+                           .findNanoappByInstanceId(request.nanoappInstanceId);
+    if (nanoapp != nullptr) {
+      nanoapp->registerForBroadcastEvent(CHRE_EVENT_WIFI_SCAN_RESULT);
+    }
+  }
+
+  return true;
+}
+
+bool WifiRequestManager::postCachedScanResults(
+    uint16_t nanoappInstanceId, const struct chreWifiScanParams &params,
+    const void *cookie) {
+  if (mCachedScanEvent == nullptr ||
+      SystemTime::getMonotonicTime() - mCachedScanTime >
+          Nanoseconds(Milliseconds(params.maxScanAgeMs)) ||
+      !mCachedScanParams.covers(params)) {
+    return false;
+  }
+
+  // The nanoapp is sent the cached event itself, which the event references
+  // so that it outlives a replacement of the cache.
+  EventLoopManagerSingleton::get()->getEventPayloadArena().addReference(
+      mCachedScanEvent);
+  postScanRequestAsyncResultEventFatal(nanoappInstanceId, true /* success */,
+                                       CHRE_ERROR_NONE, cookie);
+  EventLoopManagerSingleton::get()->getEventLoop().postEventOrDie(
+      CHRE_EVENT_WIFI_SCAN_RESULT, mCachedScanEvent,
+      EventPayloadArena::freeEventCallback, nanoappInstanceId);
+  mNumCachedScanRequests++;
+  return true;
+}
+
+void WifiRequestManager::cacheScanEvent(const chreWifiScanEvent *scanEvent,
+                                        bool isFirstEvent, bool isLastEvent) {
+  if (CHRE_WIFI_SCAN_CACHE_MAX_RESULTS == 0) {
+    return;
+  }
+
+  if (isFirstEvent) {
+    releaseScanEventPayload(&mCachedScanEvent);
+    releaseScanEventPayload(&mCachingScanEvent);
+    mCachedScanTime = SystemTime::getMonotonicTime();
+
+    struct chreWifiScanParams scanParams;
+    mInFlightScanParams.getParams(&scanParams);
+    uint8_t resultTotal = scanEvent->resultTotal;
+    if (!mInFlightScanParams.empty() &&
+        resultTotal <= CHRE_WIFI_SCAN_CACHE_MAX_RESULTS &&
+        mCachedScanParams.reset(scanParams)) {
+      // The results and the frequencies follow the event in its payload, so
+      // that nanoapps retaining the event retain them as well. There is room
+      // for the total announced by the first event, kept in resultTotal until
+      // the last event.
+      uint16_t freqCount = scanEvent->scannedFreqListLen;
+      size_t size = sizeof(chreWifiScanEvent) +
+                    resultTotal * sizeof(chreWifiScanResult) +
+                    freqCount * sizeof(uint32_t);
+      mCachingScanEvent = static_cast<chreWifiScanEvent *>(
+          EventLoopManagerSingleton::get()->getEventPayloadArena().allocate(
+              size));
+      if (mCachingScanEvent != nullptr) {
+        auto *results =
+            reinterpret_cast<chreWifiScanResult *>(mCachingScanEvent + 1);
+        auto *freqs = reinterpret_cast<uint32_t *>(results + resultTotal);
+        if (freqCount > 0) {
+          memcpy(freqs, scanEvent->scannedFreqList,
+                 freqCount * sizeof(uint32_t));
+        }
+        *mCachingScanEvent = *scanEvent;
+        mCachingScanEvent->resultCount = 0;
+        mCachingScanEvent->results = results;
+        mCachingScanEvent->scannedFreqList =
+            (freqCount > 0) ? freqs : nullptr;
+      }
+    }
+  }
+
+  if (mCachingScanEvent != nullptr) {
+    uint8_t resultCount = mCachingScanEvent->resultCount;
+    if (resultCount + scanEvent->resultCount >
+        mCachingScanEvent->resultTotal) {
+      releaseScanEventPayload(&mCachingScanEvent);
+    } else if (scanEvent->resultCount > 0) {
+      auto *results =
+          const_cast<chreWifiScanResult *>(mCachingScanEvent->results);
+      memcpy(&results[resultCount], scanEvent->results,
+             scanEvent->resultCount * sizeof(chreWifiScanResult));
+      mCachingScanEvent->resultCount += scanEvent->resultCount;
+    }
+  }
+
+  if (isLastEvent && mCachingScanEvent != nullptr) {
+    mCachingScanEvent->resultTotal = mCachingScanEvent->resultCount;
+    mCachingScanEvent->eventIndex = 0;
+    mCachedScanEvent = mCachingScanEvent;
+    mCachingScanEvent = nullptr;
+  }
+}
+
 void WifiRequestManager::handleRangingEventSync(
     uint8_t errorCode, struct chreWifiRangingEvent *event) {
   if (!areRequiredSettingsEnabled()) {
@@ -1158,24 +1375,32 @@ void WifiRequestManager::handleFreeWifiScanEvent(chreWifiScanEvent *scanEvent) {
   if (mScanRequestResultsArePending) {
     // Reset the event distribution logic once an entire scan event has been
     // received and processed by the nanoapp requesting the scan event.
+    bool isFirstEvent = (mScanEventResultCountAccumulator == 0);
     mScanEventResultCountAccumulator += scanEvent->resultCount;
     if (mScanEventResultCountAccumulator >= scanEvent->resultTotal) {
       mScanEventResultCountAccumulator = 0;
       mScanRequestResultsArePending = false;
     }
+    cacheScanEvent(scanEvent, isFirstEvent,
+                   !mScanRequestResultsArePending /* isLastEvent */);
 
     if (!mScanRequestResultsArePending && !mPendingScanRequests.empty()) {
-      uint16_t pendingNanoappInstanceId =
-          mPendingScanRequests.front().nanoappInstanceId;
-      Nanoapp *nanoapp = EventLoopManagerSingleton::get()
-                             ->getEventLoop()
-                             .findNanoappByInstanceId(pendingNanoappInstanceId);
-      if (nanoapp == nullptr) {
-        LOGW("Attempted to unsubscribe unknown nanoapp from WiFi scan events");
-      } else if (!nanoappHasScanMonitorRequest(pendingNanoappInstanceId)) {
-        nanoapp->unregisterForBroadcastEvent(CHRE_EVENT_WIFI_SCAN_RESULT);
+      size_t groupSize = getScanRequestGroupSize();
+      for (size_t i = 0; i < groupSize; i++) {
+        uint16_t pendingNanoappInstanceId =
+            mPendingScanRequests[i].nanoappInstanceId;
+        Nanoapp *nanoapp =
+            EventLoopManagerSingleton::get()
+                ->getEventLoop()
+                .findNanoappByInstanceId(pendingNanoappInstanceId);
+        if (nanoapp == nullptr) {
+          LOGW(
+              "Attempted to unsubscribe unknown nanoapp from WiFi scan events");
+        } else if (!nanoappHasScanMonitorRequest(pendingNanoappInstanceId)) {
+          nanoapp->unregisterForBroadcastEvent(CHRE_EVENT_WIFI_SCAN_RESULT);
+        }
       }
-      mPendingScanRequests.pop();
+      popScanRequestGroup();
       dispatchQueuedScanRequests(true /* postAsyncResult */);
     }
   }
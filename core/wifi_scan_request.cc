@@ -16,6 +16,8 @@
 
 #include "chre/core/wifi_scan_request.h"
 
+#include <cstring>
+
 namespace chre {
 
 WifiScanType getWifiScanTypeForEnum(enum chreWifiScanType enumWifiScanType) {
@@ -62,4 +64,171 @@ const DynamicVector<WifiSsid> &WifiScanRequest::getSsids() const {
   return mSsids;
 }
 
+bool CoalescedWifiScanParams::reset(const struct chreWifiScanParams &params) {
+  clear();
+  mScanType = params.scanType;
+  mRadioChainPref = params.radioChainPref;
+  mChannelSet = params.channelSet;
+  mMaxScanAgeMs = params.maxScanAgeMs;
+
+  bool success = true;
+  if (params.frequencyListLen > 0) {
+    success = mFrequencies.reserve(params.frequencyListLen);
+    for (uint16_t i = 0; success && i < params.frequencyListLen; i++) {
+      mFrequencies.push_back(params.frequencyList[i]);
+    }
+  }
+
+  if (success && params.ssidListLen > 0) {
+    success = mSsids.reserve(params.ssidListLen);
+    for (uint8_t i = 0; success && i < params.ssidListLen; i++) {
+      mSsids.push_back(params.ssidList[i]);
+    }
+  }
+
+  if (success) {
+    mEmpty = false;
+  } else {
+    clear();
+  }
+  return success;
+}
+
+void CoalescedWifiScanParams::clear() {
+  mEmpty = true;
+  mFrequencies.clear();
+  mSsids.clear();
+}
+
+bool CoalescedWifiScanParams::isCompatible(
+    const struct chreWifiScanParams &params) const {
+  return !mEmpty && params.scanType == mScanType &&
+         params.radioChainPref == mRadioChainPref &&
+         params.channelSet == mChannelSet;
+}
+
+bool CoalescedWifiScanParams::covers(
+    const struct chreWifiScanParams &params) const {
+  if (!isCompatible(params)) {
+    return false;
+  }
+
+  if (params.frequencyListLen == 0) {
+    if (!mFrequencies.empty()) {
+      return false;
+    }
+  } else {
+    for (uint16_t i = 0; i < params.frequencyListLen; i++) {
+      if (!coversFrequency(params.frequencyList[i])) {
+        return false;
+      }
+    }
+  }
+
+  if (params.ssidListLen == 0) {
+    if (!mSsids.empty()) {
+      return false;
+    }
+  } else {
+    for (uint8_t i = 0; i < params.ssidListLen; i++) {
+      if (!coversSsid(params.ssidList[i])) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool CoalescedWifiScanParams::merge(const struct chreWifiScanParams &params) {
+  if (!isCompatible(params)) {
+    return false;
+  }
+
+  // Count the new entries first so that the merge either fully succeeds or
+  // leaves the accumulated parameters unchanged.
+  bool scanAllFrequencies =
+      (mFrequencies.empty() || params.frequencyListLen == 0);
+  size_t newFrequencyCount = 0;
+  if (!scanAllFrequencies) {
+    for (uint16_t i = 0; i < params.frequencyListLen; i++) {
+      if (!coversFrequency(params.frequencyList[i])) {
+        newFrequencyCount++;
+      }
+    }
+  }
+
+  bool scanAllSsids = (mSsids.empty() || params.ssidListLen == 0);
+  size_t newSsidCount = 0;
+  if (!scanAllSsids) {
+    for (uint8_t i = 0; i < params.ssidListLen; i++) {
+      if (!coversSsid(params.ssidList[i])) {
+        newSsidCount++;
+      }
+    }
+  }
+
+  if (mSsids.size() + newSsidCount > CHRE_WIFI_SSID_LIST_MAX_LEN ||
+      !mFrequencies.reserve(mFrequencies.size() + newFrequencyCount) ||
+      !mSsids.reserve(mSsids.size() + newSsidCount)) {
+    return false;
+  }
+
+  if (scanAllFrequencies) {
+    mFrequencies.clear();
+  } else {
+    for (uint16_t i = 0; i < params.frequencyListLen; i++) {
+      if (!coversFrequency(params.frequencyList[i])) {
+        mFrequencies.push_back(params.frequencyList[i]);
+      }
+    }
+  }
+
+  if (scanAllSsids) {
+    mSsids.clear();
+  } else {
+    for (uint8_t i = 0; i < params.ssidListLen; i++) {
+      if (!coversSsid(params.ssidList[i])) {
+        mSsids.push_back(params.ssidList[i]);
+      }
+    }
+  }
+
+  if (params.maxScanAgeMs < mMaxScanAgeMs) {
+    mMaxScanAgeMs = params.maxScanAgeMs;
+  }
+  return true;
+}
+
+void CoalescedWifiScanParams::getParams(
+    struct chreWifiScanParams *params) const {
+  params->scanType = mScanType;
+  params->maxScanAgeMs = mMaxScanAgeMs;
+  params->frequencyListLen = static_cast<uint16_t>(mFrequencies.size());
+  params->frequencyList = mFrequencies.empty() ? nullptr : mFrequencies.data();
+  params->ssidListLen = static_cast<uint8_t>(mSsids.size());
+  params->ssidList = mSsids.empty() ? nullptr : mSsids.data();
+  params->radioChainPref = mRadioChainPref;
+  params->channelSet = mChannelSet;
+}
+
+bool CoalescedWifiScanParams::coversFrequency(uint32_t frequency) const {
+  return mFrequencies.empty() ||
+         mFrequencies.find(frequency) < mFrequencies.size();
+}
+
+bool CoalescedWifiScanParams::coversSsid(
+    const struct chreWifiSsidListItem &ssid) const {
+  if (mSsids.empty()) {
+    return true;
+  }
+  for (const struct chreWifiSsidListItem &item : mSsids) {
+    if (item.ssidLen == ssid.ssidLen &&
+        memcmp(item.ssid, ssid.ssid, ssid.ssidLen) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace chre
@@ -16,9 +16,13 @@
 
 #include "chre/core/wwan_request_manager.h"
 
+#include <utility>
+
 #include "chre/core/event_loop_manager.h"
 #include "chre/platform/fatal_error.h"
 #include "chre/platform/log.h"
+#include "chre/platform/system_time.h"
+#include "chre/util/memory.h"
 #include "chre/util/system/debug_dump.h"
 
 namespace chre {
@@ -35,15 +39,29 @@ bool WwanRequestManager::requestCellInfo(Nanoapp *nanoapp, const void *cookie) {
   CHRE_ASSERT(nanoapp);
 
   bool success = false;
-  if (!mCellInfoRequestingNanoappInstanceId.has_value()) {
-    success = mPlatformWwan.requestCellInfo();
+  CellInfoRequest request = {nanoapp->getInstanceId(), cookie};
+  if (mCachedCellInfoResult != nullptr) {
+    success = postCellInfoResult(mCachedCellInfoResult, request);
     if (success) {
-      nanoapp->registerForBroadcastEvent(CHRE_EVENT_WWAN_CELL_INFO_RESULT);
-      mCellInfoRequestingNanoappInstanceId = nanoapp->getInstanceId();
-      mCellInfoRequestingNanoappCookie = cookie;
+      mNumCoalescedCellInfoRequests++;
     }
+  } else if (!mPendingCellInfoRequests.push_back(request)) {
+    LOG_OOM();
+  } else if (mCellInfoRequestInFlight) {
+    success = true;
+    mNumCoalescedCellInfoRequests++;
   } else {
-    LOGE("Cell info request made while a request is in flight");
+    success = mPlatformWwan.requestCellInfo();
+    if (success) {
+      mCellInfoRequestInFlight = true;
+      mNumPlatformCellInfoRequests++;
+    } else {
+      mPendingCellInfoRequests.pop_back();
+    }
+  }
+
+  if (success) {
+    nanoapp->registerForBroadcastEvent(CHRE_EVENT_WWAN_CELL_INFO_RESULT);
   }
 
   return success;
@@ -64,53 +82,194 @@ void WwanRequestManager::handleCellInfoResult(
 
 void WwanRequestManager::handleCellInfoResultSync(
     chreWwanCellInfoResult *result) {
-  if (mCellInfoRequestingNanoappInstanceId.has_value()) {
-    result->cookie = mCellInfoRequestingNanoappCookie;
-    EventLoopManagerSingleton::get()->getEventLoop().postEventOrDie(
-        CHRE_EVENT_WWAN_CELL_INFO_RESULT, result, freeCellInfoResultCallback,
-        mCellInfoRequestingNanoappInstanceId.value());
-  } else {
+  if (!mCellInfoRequestInFlight) {
     LOGE("Cell info results received unexpectedly");
+    mPlatformWwan.releaseCellInfoResult(result);
+    return;
+  }
+
+  mCellInfoRequestInFlight = false;
+  auto *shared = memoryAlloc<SharedCellInfoResult>();
+  if (shared == nullptr) {
+    FATAL_ERROR_OOM();
+  }
+
+  // Hold a reference during the fan-out so the result can't be released by a
+  // failed post before every waiter has been handled.
+  shared->result = result;
+  shared->receivedTime = SystemTime::getMonotonicTime();
+  shared->refCount = 1;
+
+  for (const CellInfoRequest &request : mPendingCellInfoRequests) {
+    postCellInfoResult(shared, request);
+  }
+
+  // Drop registrations of waiters that could not be posted a result.
+  DynamicVector<CellInfoRequest> requests(std::move(mPendingCellInfoRequests));
+  for (const CellInfoRequest &request : requests) {
+    if (!isCellInfoRecipient(request.instanceId)) {
+      Nanoapp *nanoapp = EventLoopManagerSingleton::get()
+                             ->getEventLoop()
+                             .findNanoappByInstanceId(request.instanceId);
+      if (nanoapp != nullptr) {
+        nanoapp->unregisterForBroadcastEvent(CHRE_EVENT_WWAN_CELL_INFO_RESULT);
+      }
+    }
+  }
+
+  clearCachedCellInfoResult();
+  if (result->errorCode == CHRE_ERROR_NONE &&
+      mCellInfoCacheMaxAge > Nanoseconds(0)) {
+    // The cache takes over the fan-out reference.
+    cacheCellInfoResult(shared);
+  } else {
+    releaseSharedCellInfoResult(shared);
   }
 }
 
 void WwanRequestManager::logStateToBuffer(DebugDumpWrapper &debugDump) const {
   debugDump.print("\nWWAN:\n");
-  if (mCellInfoRequestingNanoappInstanceId.has_value()) {
-    debugDump.print(" WWAN request pending nanoappId=%" PRIu16 "\n",
-                    mCellInfoRequestingNanoappInstanceId.value());
+  if (mCellInfoRequestInFlight) {
+    debugDump.print(" WWAN request pending, waiters=%zu\n",
+                    mPendingCellInfoRequests.size());
+    for (const CellInfoRequest &request : mPendingCellInfoRequests) {
+      debugDump.print("  nanoappId=%" PRIu16 "\n", request.instanceId);
+    }
   }
+
+  if (mCachedCellInfoResult != nullptr) {
+    Nanoseconds age =
+        SystemTime::getMonotonicTime() - mCachedCellInfoResult->receivedTime;
+    debugDump.print(" Cached cell info age=%" PRIu64 "ms refs=%" PRIu32 "\n",
+                    Milliseconds(age).getMilliseconds(),
+                    mCachedCellInfoResult->refCount);
+  }
+
+  debugDump.print(" Cell info requests: platform=%" PRIu32
+                  " coalesced=%" PRIu32 "\n",
+                  mNumPlatformCellInfoRequests, mNumCoalescedCellInfoRequests);
 }
 
-void WwanRequestManager::handleFreeCellInfoResult(
-    chreWwanCellInfoResult *result) {
-  if (mCellInfoRequestingNanoappInstanceId.has_value()) {
-    Nanoapp *nanoapp =
-        EventLoopManagerSingleton::get()
-            ->getEventLoop()
-            .findNanoappByInstanceId(*mCellInfoRequestingNanoappInstanceId);
+void WwanRequestManager::cacheCellInfoResult(SharedCellInfoResult *shared) {
+  auto callback = [](uint16_t /*type*/, void * /*data*/, void * /*extraData*/) {
+    EventLoopManagerSingleton::get()
+        ->getWwanRequestManager()
+        .handleCellInfoCacheExpired();
+  };
+
+  mCachedCellInfoExpiryTimerHandle =
+      EventLoopManagerSingleton::get()->setDelayedCallback(
+          SystemCallbackType::WwanCellInfoCacheExpired, /* data= */ nullptr,
+          callback, mCellInfoCacheMaxAge);
+  if (mCachedCellInfoExpiryTimerHandle == CHRE_TIMER_INVALID) {
+    // Without a timer the result would be pinned indefinitely.
+    LOGE("Failed to set the cell info cache expiry timer");
+    releaseSharedCellInfoResult(shared);
+  } else {
+    mCachedCellInfoResult = shared;
+  }
+}
+
+void WwanRequestManager::clearCachedCellInfoResult() {
+  if (mCachedCellInfoExpiryTimerHandle != CHRE_TIMER_INVALID) {
+    EventLoopManagerSingleton::get()->cancelDelayedCallback(
+        mCachedCellInfoExpiryTimerHandle);
+    mCachedCellInfoExpiryTimerHandle = CHRE_TIMER_INVALID;
+  }
+
+  if (mCachedCellInfoResult != nullptr) {
+    SharedCellInfoResult *shared = mCachedCellInfoResult;
+    mCachedCellInfoResult = nullptr;
+    releaseSharedCellInfoResult(shared);
+  }
+}
+
+void WwanRequestManager::handleCellInfoCacheExpired() {
+  mCachedCellInfoExpiryTimerHandle = CHRE_TIMER_INVALID;
+  clearCachedCellInfoResult();
+}
+
+bool WwanRequestManager::postCellInfoResult(SharedCellInfoResult *shared,
+                                            const CellInfoRequest &request) {
+  bool success = false;
+  auto *event = memoryAlloc<CellInfoResultEvent>();
+  if (event == nullptr) {
+    LOG_OOM();
+  } else if (!mCellInfoResultRecipients.push_back(request.instanceId)) {
+    LOG_OOM();
+    memoryFree(event);
+  } else {
+    event->result = *shared->result;
+    event->result.cookie = request.cookie;
+    event->shared = shared;
+    event->instanceId = request.instanceId;
+    shared->refCount++;
+
+    EventLoopManagerSingleton::get()->getEventLoop().postEventInlineOrDie(
+        CHRE_EVENT_WWAN_CELL_INFO_RESULT, &event->result,
+        freeCellInfoResultCallback, request.instanceId);
+    success = true;
+  }
+
+  return success;
+}
+
+void WwanRequestManager::releaseSharedCellInfoResult(
+    SharedCellInfoResult *shared) {
+  CHRE_ASSERT(shared->refCount > 0);
+  if (--shared->refCount == 0) {
+    mPlatformWwan.releaseCellInfoResult(shared->result);
+    memoryFree(shared);
+  }
+}
+
+bool WwanRequestManager::isCellInfoRecipient(uint16_t instanceId) const {
+  if (mCellInfoResultRecipients.find(instanceId) <
+      mCellInfoResultRecipients.size()) {
+    return true;
+  }
+
+  for (const CellInfoRequest &request : mPendingCellInfoRequests) {
+    if (request.instanceId == instanceId) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void WwanRequestManager::handleFreeCellInfoResult(CellInfoResultEvent *event) {
+  size_t index = mCellInfoResultRecipients.find(event->instanceId);
+  if (index < mCellInfoResultRecipients.size()) {
+    mCellInfoResultRecipients.erase(index);
+  } else {
+    LOGE("Cell info released with no pending request");
+  }
+
+  if (!isCellInfoRecipient(event->instanceId)) {
+    Nanoapp *nanoapp = EventLoopManagerSingleton::get()
+                           ->getEventLoop()
+                           .findNanoappByInstanceId(event->instanceId);
     if (nanoapp != nullptr) {
       nanoapp->unregisterForBroadcastEvent(CHRE_EVENT_WWAN_CELL_INFO_RESULT);
     } else {
       LOGE("Freeing cell info for non-existent nanoapp");
     }
-
-    mCellInfoRequestingNanoappInstanceId.reset();
-  } else {
-    LOGE("Cell info released with no pending request");
   }
 
-  mPlatformWwan.releaseCellInfoResult(result);
+  releaseSharedCellInfoResult(event->shared);
+  memoryFree(event);
 }
 
 void WwanRequestManager::freeCellInfoResultCallback(uint16_t eventType,
                                                     void *eventData) {
   UNUSED_VAR(eventType);
 
-  auto *result = static_cast<chreWwanCellInfoResult *>(eventData);
+  // The result is the first member of the event, see CellInfoResultEvent.
+  auto *event = reinterpret_cast<CellInfoResultEvent *>(eventData);
   EventLoopManagerSingleton::get()
       ->getWwanRequestManager()
-      .handleFreeCellInfoResult(result);
+      .handleFreeCellInfoResult(event);
 }
 
 }  // namespace chre
@@ -16,16 +16,17 @@
 
 #include "chre_host/bt_snoop_log_parser.h"
 
+#include <arpa/inet.h>
 #include <endian.h>
 #include <string.h>
 #include <unistd.h>
+#include <bitset>
+#include <cerrno>
+#include <chrono>
 #include <fstream>
+#include <utility>
 
-#include "chre/util/time.h"
-#include "chre_host/daemon_base.h"
-#include "chre_host/file_stream.h"
 #include "chre_host/log.h"
-#include "chre_host/log_message_parser.h"
 
 namespace android {
 namespace chre {
@@ -39,11 +40,14 @@ namespace {
 using HciPacket = std::vector<uint8_t>;
 
 constexpr char kSnoopLogFilePath[] = "/data/vendor/chre/chre_btsnoop_hci.log";
-constexpr char kLastSnoopLogFilePath[] =
-    "/data/vendor/chre/chre_btsnoop_hci.log.last";
+constexpr char kLastSnoopLogFileSuffix[] = ".last";
 
 constexpr size_t kDefaultBtSnoopMaxPacketsPerFile = 0xffff;
 
+//! Fits a few hundred packets, which the writer should drain well before the
+//! parser fills it.
+constexpr size_t kDefaultBufferSize = 64 * 1024;
+
 const size_t PACKET_TYPE_LENGTH = 1;
 
 constexpr uint32_t kBytesToTest = 0x12345678;
@@ -79,6 +83,32 @@ uint64_t htonll(uint64_t ll) {
 
 }  // namespace
 
+BtSnoopLogParser::BtSnoopLogParser()
+    : BtSnoopLogParser(kSnoopLogFilePath, kDefaultBtSnoopMaxPacketsPerFile,
+                       kDefaultBufferSize) {}
+
+BtSnoopLogParser::BtSnoopLogParser(std::string filePath,
+                                   uint32_t maxPacketsPerFile,
+                                   size_t bufferSize)
+    : mFilePath(std::move(filePath)),
+      mLastFilePath(mFilePath + kLastSnoopLogFileSuffix),
+      mMaxPacketsPerFile(maxPacketsPerFile),
+      mBufferSize(bufferSize) {
+  mFillBuffer.data.reserve(mBufferSize);
+  mWriteBuffer.data.reserve(mBufferSize);
+}
+
+BtSnoopLogParser::~BtSnoopLogParser() {
+  if (mWriterThread.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStopWriter = true;
+    }
+    mCondVar.notify_all();
+    mWriterThread.join();
+  }
+}
+
 size_t BtSnoopLogParser::log(const char *buffer) {
   const auto *message = reinterpret_cast<const BtSnoopLog *>(buffer);
   capture(message->packet, static_cast<size_t>(message->packetSize),
@@ -119,23 +149,99 @@ void BtSnoopLogParser::capture(const uint8_t *packet, size_t packetSize,
     header.length_captured = htonl(length);
   }
 
-  mPacketCounter++;
-  if (mPacketCounter > kDefaultBtSnoopMaxPacketsPerFile) {
-    openNextSnoopLogFile();
+  if (!mWriterThread.joinable()) {
+    mWriterThread = std::thread(&BtSnoopLogParser::writerThreadEntry, this);
+  }
+
+  bool rotated = false;
+  uint32_t newlyDroppedPackets = 0;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::vector<uint8_t> &data = mFillBuffer.data;
+    if (data.size() + sizeof(PacketHeaderType) + packetSize > mBufferSize) {
+      mDroppedPacketCount++;
+      return;
+    }
+    newlyDroppedPackets = mDroppedPacketCount - mReportedDroppedPacketCount;
+    mReportedDroppedPacketCount = mDroppedPacketCount;
+    header.dropped_packets = htonl(mDroppedPacketCount);
+
+    mPacketCounter++;
+    if (mPacketCounter > mMaxPacketsPerFile) {
+      mFillBuffer.rotationOffsets.push_back(data.size());
+      mPacketCounter = 1;
+      rotated = true;
+    }
+
+    const auto *headerBytes = reinterpret_cast<const uint8_t *>(&header);
+    data.insert(data.end(), headerBytes, headerBytes + sizeof(header));
+    data.insert(data.end(), packet, packet + packetSize);
+  }
+  mCondVar.notify_all();
+
+  if (newlyDroppedPackets > 0) {
+    LOGW("Dropped %" PRIu32 " BT snoop packets as the writer fell behind",
+         newlyDroppedPackets);
+  }
+  if (rotated) {
     LOGW("Snoop Log file reached maximum size");
   }
-  if (ensureSnoopLogFileIsOpen()) {
-    if (!mBtSnoopOstream.write(reinterpret_cast<const char *>(&header),
-                               sizeof(PacketHeaderType))) {
-      LOGE("Failed to write packet header for btsnoop, error: \"%s\"",
-           strerror(errno));
+}
+
+void BtSnoopLogParser::flush() {
+  std::unique_lock<std::mutex> lock(mMutex);
+  mCondVar.wait(lock,
+                [this] { return mFillBuffer.data.empty() && !mWriting; });
+}
+
+uint32_t BtSnoopLogParser::getDroppedPacketCount() {
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mDroppedPacketCount;
+}
+
+void BtSnoopLogParser::writerThreadEntry() {
+  std::unique_lock<std::mutex> lock(mMutex);
+  while (true) {
+    mCondVar.wait(
+        lock, [this] { return !mFillBuffer.data.empty() || mStopWriter; });
+    if (mFillBuffer.data.empty()) {
+      break;
     }
-    if (!mBtSnoopOstream.write(reinterpret_cast<const char *>(packet),
-                               length - 1)) {
-      LOGE("Failed to write packet payload for btsnoop, error: \"%s\"",
+
+    // The parser keeps filling the other buffer while this one is written.
+    std::swap(mFillBuffer, mWriteBuffer);
+    mWriting = true;
+    lock.unlock();
+
+    writeBuffer(mWriteBuffer);
+    mWriteBuffer.data.clear();
+    mWriteBuffer.rotationOffsets.clear();
+
+    lock.lock();
+    mWriting = false;
+    mCondVar.notify_all();
+  }
+  lock.unlock();
+  closeSnoopLogFile();
+}
+
+void BtSnoopLogParser::writeBuffer(const PacketBuffer &buffer) {
+  auto write = [this](const uint8_t *data, size_t size) {
+    if (size > 0 && ensureSnoopLogFileIsOpen() &&
+        !mBtSnoopOstream.write(reinterpret_cast<const char *>(data), size)) {
+      LOGE("Failed to write packets for btsnoop, error: \"%s\"",
            strerror(errno));
     }
+  };
+
+  size_t start = 0;
+  for (size_t offset : buffer.rotationOffsets) {
+    write(&buffer.data[start], offset - start);
+    openNextSnoopLogFile();
+    start = offset;
   }
+  write(&buffer.data[start], buffer.data.size() - start);
+  mBtSnoopOstream.flush();
 }
 
 bool BtSnoopLogParser::ensureSnoopLogFileIsOpen() {
@@ -147,21 +253,20 @@ bool BtSnoopLogParser::ensureSnoopLogFileIsOpen() {
 
 bool BtSnoopLogParser::openNextSnoopLogFile() {
   closeSnoopLogFile();
-  if (access(kSnoopLogFilePath, F_OK) == 0 &&
-      std::rename(kSnoopLogFilePath, kLastSnoopLogFilePath) != 0) {
+  if (access(mFilePath.c_str(), F_OK) == 0 &&
+      std::rename(mFilePath.c_str(), mLastFilePath.c_str()) != 0) {
     LOGE("Unable to rename existing snoop log, error: \"%s\"", strerror(errno));
   }
 
   bool success = false;
-  mBtSnoopOstream.open(kSnoopLogFilePath, std::ios::binary | std::ios::out);
-  mBtSnoopOstream.setf(std::ios::unitbuf);
+  mBtSnoopOstream.open(mFilePath, std::ios::binary | std::ios::out);
   if (mBtSnoopOstream.fail()) {
     LOGE("Fail to create snoop log file, error: \"%s\"", strerror(errno));
   } else if (!mBtSnoopOstream.write(
                  reinterpret_cast<const char *>(&kBtSnoopFileHeader),
                  sizeof(FileHeaderType))) {
     LOGE("Unable to write file header to \"%s\", error: \"%s\"",
-         kSnoopLogFilePath, strerror(errno));
+         mFilePath.c_str(), strerror(errno));
   } else {
     success = true;
   }
@@ -172,7 +277,6 @@ void BtSnoopLogParser::closeSnoopLogFile() {
   if (mBtSnoopOstream.is_open()) {
     mBtSnoopOstream.close();
   }
-  mPacketCounter = 0;
 }
 
 }  // namespace chre
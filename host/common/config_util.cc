@@ -18,6 +18,7 @@
 #include "chre_host/log.h"
 
 #include <json/json.h>
+#include <algorithm>
 #include <fstream>
 
 namespace android {
@@ -43,10 +44,29 @@ bool getPreloadedNanoappsFromConfigFile(const std::string &configFilePath,
   }
 
   outDirectory = config["source_dir"].asString();
+  std::vector<std::string> nanoapps;
   for (Json::ArrayIndex i = 0; i < config["nanoapps"].size(); ++i) {
     const std::string &nanoappName = config["nanoapps"][i].asString();
-    outNanoapps.push_back(nanoappName);
+    nanoapps.push_back(nanoappName);
   }
+
+  const Json::Value &priorities = config["priorities"];
+  if (!priorities.isNull() && !priorities.isObject()) {
+    LOGE("Malformed preloaded nanoapp priorities");
+    return false;
+  }
+  auto getPriority = [&](const std::string &nanoappName) {
+    if (priorities.isNull()) {
+      return 0;
+    }
+    const Json::Value &priority = priorities[nanoappName];
+    return priority.isInt() ? priority.asInt() : 0;
+  };
+  std::stable_sort(nanoapps.begin(), nanoapps.end(),
+                   [&](const std::string &lhs, const std::string &rhs) {
+                     return getPriority(lhs) > getPriority(rhs);
+                   });
+  outNanoapps.insert(outNanoapps.end(), nanoapps.begin(), nanoapps.end());
   return true;
 }
 
@@ -25,6 +25,7 @@
 #include "chre_host/napp_header.h"
 
 #include <json/json.h>
+#include <utils/SystemClock.h>
 
 #ifdef CHRE_DAEMON_METRIC_ENABLED
 #include <aidl/android/frameworks/stats/IStats.h>
@@ -78,8 +79,16 @@ bool FbsDaemonBase::sendTimeSync(bool logOnError) {
   int64_t timeOffset = getTimeOffset(&success);
 
   if (success) {
+    TimeSyncEstimator::Estimate estimate;
+    {
+      std::lock_guard<std::mutex> lock(mTimeSyncMutex);
+      estimate =
+          mTimeSyncEstimator.addSample(elapsedRealtimeNano(), timeOffset);
+    }
     flatbuffers::FlatBufferBuilder builder(64);
-    HostProtocolHost::encodeTimeSyncMessage(builder, timeOffset);
+    HostProtocolHost::encodeTimeSyncMessage(builder, estimate.offsetNs,
+                                            estimate.driftPpb,
+                                            estimate.nextSyncDelayNs);
     success = sendMessageToChre(kHostClientIdDaemon, builder.GetBufferPointer(),
                                 builder.GetSize());
 
@@ -46,6 +46,28 @@ std::unique_ptr<HalClient> HalClient::create(
   return halClient;
 }
 
+HalClient::~HalClient() {
+  {
+    std::lock_guard<std::mutex> lock(mSendQueueLock);
+    mStopSender = true;
+  }
+  mSendQueueCondVar.notify_one();
+  if (mSenderThread.joinable()) {
+    mSenderThread.join();
+  }
+
+  ScopedAStatus status = fromHalError(HalError::BINDER_DISCONNECTED);
+  for (const auto &[endpointId, queue] : mSendQueues) {
+    LOGW("Dropping %zu queued messages of endpoint %" PRIu16, queue.size(),
+         endpointId);
+    for (const PendingMessage &pending : queue) {
+      if (pending.callback != nullptr) {
+        pending.callback(pending.message, status);
+      }
+    }
+  }
+}
+
 HalError HalClient::initConnection() {
   std::lock_guard<std::shared_mutex> lockGuard{mConnectionLock};
 
@@ -158,6 +180,84 @@ ScopedAStatus HalClient::sendMessage(const ContextHubMessage &message) {
       [&]() { return mContextHub->sendMessageToHub(mContextHubId, message); });
 }
 
+ScopedAStatus HalClient::sendMessageAsync(const ContextHubMessage &message,
+                                          MessageSentCallback callback) {
+  uint16_t hostEndpointId = message.hostEndPoint;
+  if (!isEndpointConnected(hostEndpointId)) {
+    // For now this is still allowed but in the future
+    // HalError::UNEXPECTED_ENDPOINT_STATE will be returned.
+    LOGW("Endpoint id %" PRIu16
+         " is unknown or disconnected. Message sending will be skipped in the "
+         "future.",
+         hostEndpointId);
+  }
+
+  std::lock_guard<std::mutex> lock(mSendQueueLock);
+  std::deque<PendingMessage> &queue = mSendQueues[hostEndpointId];
+  if (queue.size() >= mMaxQueuedMessagesPerEndpoint) {
+    LOGE("Send queue of endpoint id %" PRIu16 " is full (%zu messages)",
+         hostEndpointId, queue.size());
+    return fromHalError(HalError::SEND_QUEUE_FULL);
+  }
+  if (queue.empty()) {
+    mEndpointsToServe.push_back(hostEndpointId);
+  }
+  queue.push_back({message, std::move(callback)});
+  if (!mSenderThread.joinable()) {
+    mSenderThread = std::thread(&HalClient::sendQueuedMessages, this);
+  }
+  mSendQueueCondVar.notify_one();
+  return ScopedAStatus::ok();
+}
+
+void HalClient::sendQueuedMessages() {
+  std::unique_lock<std::mutex> lock(mSendQueueLock);
+  while (true) {
+    mSendQueueCondVar.wait(
+        lock, [this]() { return mStopSender || !mEndpointsToServe.empty(); });
+    if (mStopSender) {
+      break;
+    }
+
+    // Take all the messages of the endpoint so that the ones queued while they
+    // are sent are served after the other endpoints.
+    HostEndpointId endpointId = mEndpointsToServe.front();
+    mEndpointsToServe.pop_front();
+    auto node = mSendQueues.extract(endpointId);
+    lock.unlock();
+    sendMessageBatch(node.mapped());
+    lock.lock();
+  }
+}
+
+void HalClient::sendMessageBatch(const std::deque<PendingMessage> &batch) {
+  std::vector<ScopedAStatus> results;
+  results.reserve(batch.size());
+  {
+    // Holds the connection once for the whole batch.
+    std::shared_lock<std::shared_mutex> sharedLock(mConnectionLock);
+    for (const PendingMessage &pending : batch) {
+      results.push_back(
+          mContextHub == nullptr
+              ? fromHalError(HalError::BINDER_DISCONNECTED)
+              : mContextHub->sendMessageToHub(mContextHubId, pending.message));
+    }
+  }
+
+  // Callbacks are notified without holding the connection so that they can
+  // use this client.
+  for (size_t i = 0; i < batch.size(); i++) {
+    const PendingMessage &pending = batch[i];
+    if (!results[i].isOk()) {
+      LOGE("Failed to send a queued message of endpoint id %" PRIu16 ": %s",
+           pending.message.hostEndPoint, results[i].getDescription().c_str());
+    }
+    if (pending.callback != nullptr) {
+      pending.callback(pending.message, results[i]);
+    }
+  }
+}
+
 void HalClient::tryReconnectEndpoints(HalClient *halClient) {
   std::lock_guard<std::shared_mutex> lock(halClient->mStateLock);
   for (const auto &[endpointId, endpointInfo] :
@@ -134,8 +134,10 @@ void HostProtocolHost::encodeUnloadNanoappRequest(
 }
 
 void HostProtocolHost::encodeTimeSyncMessage(FlatBufferBuilder &builder,
-                                             int64_t offset) {
-  auto request = fbs::CreateTimeSyncMessage(builder, offset);
+                                             int64_t offset, int32_t driftPpb,
+                                             uint64_t nextSyncDelayNs) {
+  auto request =
+      fbs::CreateTimeSyncMessage(builder, offset, driftPpb, nextSyncDelayNs);
   finalize(builder, fbs::ChreMessage::TimeSyncMessage, request.Union());
 }
 
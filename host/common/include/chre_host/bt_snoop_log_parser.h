@@ -18,16 +18,45 @@
 #define CHRE_BT_SNOOP_LOG_PARSER_H_
 
 #include <cinttypes>
+#include <condition_variable>
 #include <fstream>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "chre/platform/shared/bt_snoop_log.h"
 
 namespace android {
 namespace chre {
 
+/**
+ * Writes the BT snoop logs received from CHRE to a btsnoop file.
+ *
+ * Packets are encoded into one of two buffers by the thread parsing the logs,
+ * while a background thread writes the other one to the file and rotates it, so
+ * that file I/O never stalls log delivery. A packet that doesn't fit in the
+ * buffer being filled is dropped, and the total number of dropped packets is
+ * reported in the header of the packets that follow.
+ */
 class BtSnoopLogParser {
  public:
+  BtSnoopLogParser();
+
+  /**
+   * @param filePath Path of the snoop log file. The previous file is kept
+   *        with a ".last" suffix when a new one is started.
+   * @param maxPacketsPerFile Number of packets after which a new file is
+   *        started.
+   * @param bufferSize Size of each of the two buffers packets are encoded
+   *        into, in bytes.
+   */
+  BtSnoopLogParser(std::string filePath, uint32_t maxPacketsPerFile,
+                   size_t bufferSize);
+
+  ~BtSnoopLogParser();
+
   /**
    * Add a BT event to the snoop log file.
    *
@@ -35,6 +64,16 @@ class BtSnoopLogParser {
    */
   size_t log(const char *buffer);
 
+  /**
+   * Blocks until all the packets logged so far have been written to the file.
+   */
+  void flush();
+
+  /**
+   * @return The number of packets dropped because the writer fell behind.
+   */
+  uint32_t getDroppedPacketCount();
+
  private:
   enum class PacketType : uint8_t {
     CMD = 1,
@@ -61,6 +100,12 @@ class BtSnoopLogParser {
     PacketType type;
   } __attribute__((packed));
 
+  //! Packets encoded for the writer, and where a new file starts among them.
+  struct PacketBuffer {
+    std::vector<uint8_t> data;
+    std::vector<size_t> rotationOffsets;
+  };
+
   bool ensureSnoopLogFileIsOpen();
 
   void closeSnoopLogFile();
@@ -68,7 +113,7 @@ class BtSnoopLogParser {
   bool openNextSnoopLogFile();
 
   /**
-   * Write BT event to the snoop log file.
+   * Encode a BT event for the writer thread.
    *
    * @param packet The BT event packet.
    * @param packetSize Size of the packet.
@@ -77,11 +122,51 @@ class BtSnoopLogParser {
   void capture(const uint8_t *packet, size_t packetSize,
                BtSnoopDirection direction);
 
-  //! File stream used to write the log file.
+  //! Entry point of the writer thread.
+  void writerThreadEntry();
+
+  /**
+   * Write a buffer to the snoop log files, starting a new file at each of its
+   * rotation offsets. Only called from the writer thread.
+   */
+  void writeBuffer(const PacketBuffer &buffer);
+
+  const std::string mFilePath;
+  const std::string mLastFilePath;
+  const uint32_t mMaxPacketsPerFile;
+  const size_t mBufferSize;
+
+  //! File stream used to write the log file, only used by the writer thread.
   std::ofstream mBtSnoopOstream;
 
-  //! Number of BT packtets in the log file.
+  //! Number of BT packtets in the log file, counted by the parser thread.
   uint32_t mPacketCounter = 0;
+
+  //! Started with the first packet.
+  std::thread mWriterThread;
+
+  //! Protects the members below.
+  std::mutex mMutex;
+
+  //! Notified when mFillBuffer has data or mStopWriter is set, and when the
+  //! writer is done with a buffer.
+  std::condition_variable mCondVar;
+
+  //! The buffer the parser encodes packets into.
+  PacketBuffer mFillBuffer;
+
+  //! The buffer being written by the writer thread.
+  PacketBuffer mWriteBuffer;
+
+  //! Whether the writer thread is writing mWriteBuffer.
+  bool mWriting = false;
+
+  bool mStopWriter = false;
+
+  uint32_t mDroppedPacketCount = 0;
+
+  //! The number of drops already reported in the log.
+  uint32_t mReportedDroppedPacketCount = 0;
 };
 
 }  // namespace chre
@@ -18,6 +18,7 @@
 #define CHRE_HOST_CONFIG_UTIL_H_
 
 #include <functional>
+#include <string>
 #include <vector>
 
 namespace android {
@@ -26,6 +27,12 @@ namespace chre {
 /**
  * Gets the preloaded nanoapps from the config file at path: configFilePath.
  *
+ * The config may map nanoapp names to an integer priority under the optional
+ * "priorities" key, e.g. { "priorities": { "critical_nanoapp": 10 } }. The
+ * nanoapps are returned by decreasing priority, so that the critical ones are
+ * loaded first, and in their config order within a priority. A nanoapp without
+ * a priority has priority 0.
+ *
  * @param configFilePath        the file path of the config file on the device
  * @param outDirectory          (out) the directory that contains the nanoapps
  *                              on the device
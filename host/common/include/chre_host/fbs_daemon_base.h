@@ -23,8 +23,11 @@
  * flatbuffers as the codec scheme for communicating with CHRE.
  */
 
+#include <mutex>
+
 #include "chre_host/daemon_base.h"
 #include "chre_host/host_protocol_host.h"
+#include "chre_host/time_sync_estimator.h"
 
 namespace android {
 namespace chre {
@@ -70,7 +73,8 @@ class FbsDaemonBase : public ChreDaemonBase {
                        uint32_t transactionId) override;
 
   /**
-   * Send a time sync message to CHRE
+   * Send a time sync message to CHRE, with the offset and drift estimated from
+   * the previous time syncs.
    *
    * @param logOnError If true, logs an error message on failure.
    *
@@ -106,6 +110,10 @@ class FbsDaemonBase : public ChreDaemonBase {
   //! Contains a set of transaction IDs and app IDs used to load the preloaded
   //! nanoapps. The IDs are stored in the order they are sent.
   std::queue<Transaction> mPreloadedNanoappPendingTransactions;
+
+  //! Estimates the drift of the time offset across time syncs.
+  std::mutex mTimeSyncMutex;
+  TimeSyncEstimator mTimeSyncEstimator;
 };
 
 }  // namespace chre
@@ -2407,8 +2407,12 @@ flatbuffers::Offset<LogMessage> CreateLogMessage(flatbuffers::FlatBufferBuilder
 struct TimeSyncMessageT : public flatbuffers::NativeTable {
   typedef TimeSyncMessage TableType;
   int64_t offset;
+  int32_t drift_ppb;
+  uint64_t next_sync_delay_ns;
   TimeSyncMessageT()
-      : offset(0) {
+      : offset(0),
+        drift_ppb(0),
+        next_sync_delay_ns(0) {
   }
 };
 
@@ -2417,7 +2421,9 @@ struct TimeSyncMessage FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   typedef TimeSyncMessageT NativeTableType;
   typedef TimeSyncMessageBuilder Builder;
   enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
-    VT_OFFSET = 4
+    VT_OFFSET = 4,
+    VT_DRIFT_PPB = 6,
+    VT_NEXT_SYNC_DELAY_NS = 8
   };
   /// Offset between AP and CHRE timestamp
   int64_t offset() const {
@@ -2426,9 +2432,27 @@ struct TimeSyncMessage FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   bool mutate_offset(int64_t _offset) {
     return SetField<int64_t>(VT_OFFSET, _offset, 0);
   }
+  /// Estimated rate at which the offset drifts, in nanoseconds per second of
+  /// CHRE time (parts per billion). 0 if unknown.
+  int32_t drift_ppb() const {
+    return GetField<int32_t>(VT_DRIFT_PPB, 0);
+  }
+  bool mutate_drift_ppb(int32_t _drift_ppb) {
+    return SetField<int32_t>(VT_DRIFT_PPB, _drift_ppb, 0);
+  }
+  /// Delay after which CHRE should request the next time sync, in
+  /// nanoseconds. 0 to use the default delay of the platform.
+  uint64_t next_sync_delay_ns() const {
+    return GetField<uint64_t>(VT_NEXT_SYNC_DELAY_NS, 0);
+  }
+  bool mutate_next_sync_delay_ns(uint64_t _next_sync_delay_ns) {
+    return SetField<uint64_t>(VT_NEXT_SYNC_DELAY_NS, _next_sync_delay_ns, 0);
+  }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyField<int64_t>(verifier, VT_OFFSET) &&
+           VerifyField<int32_t>(verifier, VT_DRIFT_PPB) &&
+           VerifyField<uint64_t>(verifier, VT_NEXT_SYNC_DELAY_NS) &&
            verifier.EndTable();
   }
   TimeSyncMessageT *UnPack(const flatbuffers::resolver_function_t *_resolver = nullptr) const;
@@ -2443,6 +2467,12 @@ struct TimeSyncMessageBuilder {
   void add_offset(int64_t offset) {
     fbb_.AddElement<int64_t>(TimeSyncMessage::VT_OFFSET, offset, 0);
   }
+  void add_drift_ppb(int32_t drift_ppb) {
+    fbb_.AddElement<int32_t>(TimeSyncMessage::VT_DRIFT_PPB, drift_ppb, 0);
+  }
+  void add_next_sync_delay_ns(uint64_t next_sync_delay_ns) {
+    fbb_.AddElement<uint64_t>(TimeSyncMessage::VT_NEXT_SYNC_DELAY_NS, next_sync_delay_ns, 0);
+  }
   explicit TimeSyncMessageBuilder(flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -2457,9 +2487,13 @@ struct TimeSyncMessageBuilder {
 
 inline flatbuffers::Offset<TimeSyncMessage> CreateTimeSyncMessage(
     flatbuffers::FlatBufferBuilder &_fbb,
-    int64_t offset = 0) {
+    int64_t offset = 0,
+    int32_t drift_ppb = 0,
+    uint64_t next_sync_delay_ns = 0) {
   TimeSyncMessageBuilder builder_(_fbb);
+  builder_.add_next_sync_delay_ns(next_sync_delay_ns);
   builder_.add_offset(offset);
+  builder_.add_drift_ppb(drift_ppb);
   return builder_.Finish();
 }
 
@@ -4472,6 +4506,8 @@ inline void TimeSyncMessage::UnPackTo(TimeSyncMessageT *_o, const flatbuffers::r
   (void)_o;
   (void)_resolver;
   { auto _e = offset(); _o->offset = _e; }
+  { auto _e = drift_ppb(); _o->drift_ppb = _e; }
+  { auto _e = next_sync_delay_ns(); _o->next_sync_delay_ns = _e; }
 }
 
 inline flatbuffers::Offset<TimeSyncMessage> TimeSyncMessage::Pack(flatbuffers::FlatBufferBuilder &_fbb, const TimeSyncMessageT* _o, const flatbuffers::rehasher_function_t *_rehasher) {
@@ -4483,9 +4519,13 @@ inline flatbuffers::Offset<TimeSyncMessage> CreateTimeSyncMessage(flatbuffers::F
   (void)_o;
   struct _VectorArgs { flatbuffers::FlatBufferBuilder *__fbb; const TimeSyncMessageT* __o; const flatbuffers::rehasher_function_t *__rehasher; } _va = { &_fbb, _o, _rehasher}; (void)_va;
   auto _offset = _o->offset;
+  auto _drift_ppb = _o->drift_ppb;
+  auto _next_sync_delay_ns = _o->next_sync_delay_ns;
   return chre::fbs::CreateTimeSyncMessage(
       _fbb,
-      _offset);
+      _offset,
+      _drift_ppb,
+      _next_sync_delay_ns);
 }
 
 inline DebugDumpRequestT *DebugDumpRequest::UnPack(const flatbuffers::resolver_function_t *_resolver) const {
@@ -18,8 +18,13 @@
 #define CHRE_HOST_HAL_CLIENT_H_
 
 #include <cinttypes>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <shared_mutex>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -66,6 +71,10 @@ using ::ndk::ScopedAStatus;
  * a client should rely on IContextHubCallback.handleContextHubAsyncEvent() to
  * handle the RESTARTED event which is a signal that CHRE is up running.
  *
+ * <p>Messages can either be sent synchronously with sendMessage(), or queued
+ * with sendMessageAsync() to be sent from a background thread so that a client
+ * sending many messages doesn't wait for each binder transaction.
+ *
  * TODO(b/297912356): The name of this class is the same as an internal struct
  *   used by HalClientManager. Consider rename the latter one to avoid confusion
  *
@@ -74,6 +83,18 @@ class HalClient {
  public:
   static constexpr int32_t kDefaultContextHubId = 0;
 
+  /** The default max number of messages queued for an endpoint. */
+  static constexpr size_t kDefaultMaxQueuedMessagesPerEndpoint = 32;
+
+  /**
+   * The callback notified of the result of sending a message queued by
+   * sendMessageAsync(), invoked from the thread sending the queued messages.
+   */
+  using MessageSentCallback = std::function<void(
+      const ContextHubMessage &message, const ScopedAStatus &status)>;
+
+  ~HalClient();
+
   /**
    * Create a HalClient unique pointer used to communicate with CHRE HAL.
    *
@@ -93,6 +114,28 @@ class HalClient {
 
   ScopedAStatus sendMessage(const ContextHubMessage &message);
 
+  /**
+   * Queues a message to be sent to CHRE HAL from a background thread.
+   *
+   * <p>Messages queued for the same endpoint are sent in the order they are
+   * queued, but may be reordered with the ones sent by sendMessage(). Each time
+   * the background thread serves an endpoint it sends all the messages queued
+   * for it at once, then moves on to the next endpoint with queued messages, so
+   * that a chatty endpoint doesn't starve the others.
+   *
+   * <p>Messages still queued when the HalClient is destroyed are dropped, and
+   * their callbacks are notified with HalError::BINDER_DISCONNECTED.
+   *
+   * @param message the message to send.
+   * @param callback an optional callback notified of the result of sending the
+   * message.
+   *
+   * @return ok if the message is queued, or HalError::SEND_QUEUE_FULL if the
+   * endpoint of the message already has the max number of messages queued.
+   */
+  ScopedAStatus sendMessageAsync(const ContextHubMessage &message,
+                                 MessageSentCallback callback = nullptr);
+
   ScopedAStatus connectEndpoint(const HostEndpointInfo &hostEndpointInfo);
 
   ScopedAStatus disconnectEndpoint(char16_t hostEndpointId);
@@ -208,6 +251,18 @@ class HalClient {
     mConnectedEndpoints.clear();
   }
 
+  /** A message queued by sendMessageAsync(). */
+  struct PendingMessage {
+    ContextHubMessage message;
+    MessageSentCallback callback;
+  };
+
+  /** The loop of the thread sending the queued messages. */
+  void sendQueuedMessages();
+
+  /** Sends the messages queued for an endpoint and notifies their callbacks. */
+  void sendMessageBatch(const std::deque<PendingMessage> &batch);
+
   static ScopedAStatus fromHalError(HalError errorCode) {
     return errorCode == HalError::SUCCESS
                ? ScopedAStatus::ok()
@@ -230,6 +285,20 @@ class HalClient {
   ndk::ScopedAIBinder_DeathRecipient mDeathRecipient;
 
   std::shared_ptr<HalClientCallback> mCallback;
+
+  // The max number of messages queued for an endpoint, not counting the ones
+  // being sent.
+  size_t mMaxQueuedMessagesPerEndpoint = kDefaultMaxQueuedMessagesPerEndpoint;
+
+  // The lock guarding the send queues and the sender thread.
+  std::mutex mSendQueueLock;
+  std::condition_variable mSendQueueCondVar;
+  std::unordered_map<HostEndpointId, std::deque<PendingMessage>> mSendQueues{};
+  // The endpoints with messages in mSendQueues, in the order they are served.
+  std::deque<HostEndpointId> mEndpointsToServe{};
+  // Started when the first message is queued.
+  std::thread mSenderThread;
+  bool mStopSender = false;
 };
 
 }  // namespace android::chre
@@ -168,9 +168,14 @@ class HostProtocolHost : public ::chre::HostProtocolCommon {
    * @param builder A newly constructed FlatBufferBuilder that will be used to
    *        construct the message
    * @param offset The AP to SLPI offset in nanoseconds
+   * @param driftPpb The estimated drift rate of the offset in nanoseconds per
+   *        second, or 0 if unknown
+   * @param nextSyncDelayNs The delay after which CHRE should request the next
+   *        time sync in nanoseconds, or 0 to use the default of the platform
    */
   static void encodeTimeSyncMessage(flatbuffers::FlatBufferBuilder &builder,
-                                    int64_t offset);
+                                    int64_t offset, int32_t driftPpb = 0,
+                                    uint64_t nextSyncDelayNs = 0);
 
   /**
    * Encodes a message requesting debugging information from CHRE
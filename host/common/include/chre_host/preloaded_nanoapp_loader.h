@@ -19,12 +19,14 @@
 
 #include <android/binder_to_string.h>
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <mutex>
 #include <optional>
 #include <string>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "chre_connection.h"
 #include "chre_host/generated/host_messages_generated.h"
@@ -43,6 +45,10 @@ using namespace ::android::hardware::contexthub::common::implementation;
  * image and are loaded when CHRE starts. These are known as preloaded nanoapps.
  * A HAL implementation should use this class to load preloaded nanoapps before
  * exposing API to HAL clients.
+ *
+ * The loading is pipelined: a worker thread reads and validates the header and
+ * the binary of the next nanoapps while CHRE loads the current one, holding at
+ * most kMaxPrefetchedNanoapps of them in memory.
  */
 class PreloadedNanoappLoader {
  public:
@@ -61,7 +67,8 @@ class PreloadedNanoappLoader {
    *     "/path/to/nanoapp_2"
    * ]}
    *
-   * The napp_header and so files will both be used.
+   * The napp_header and so files will both be used. The nanoapps are loaded in
+   * the order of their priorities, see getPreloadedNanoappsFromConfigFile().
    *
    * @param selectedNanoappIds only nanoapp ids in this set will be loaded if it
    * is set. Otherwise the default value means every preloaded nanoapp will be
@@ -82,7 +89,49 @@ class PreloadedNanoappLoader {
     return mIsPreloadingOngoing;
   }
 
+  /** The time spent in each stage of loading a preloaded nanoapp. */
+  struct NanoappLoadTiming {
+    std::string name;
+    uint64_t appId;
+    //! Reading and validating the header and the binary on the worker thread.
+    std::chrono::microseconds prefetch;
+    //! Waiting for the prefetch to complete before loading the nanoapp.
+    std::chrono::microseconds stall;
+    //! Sending the fragments and waiting for the responses from CHRE.
+    std::chrono::microseconds load;
+    bool success;
+  };
+
+  /** Returns the timings of the nanoapps handled by the last preloading. */
+  std::vector<NanoappLoadTiming> getLastPreloadTimings() {
+    std::lock_guard<std::mutex> lock(mPreloadedNanoappsMutex);
+    return mLastPreloadTimings;
+  }
+
  private:
+  /** A nanoapp read from the files by the prefetching worker. */
+  struct PrefetchedNanoapp {
+    std::string name;
+    uint32_t transactionId;
+    std::vector<uint8_t> headerBuffer;
+    std::vector<uint8_t> binary;
+    //! False if the files can't be read or are malformed.
+    bool isValid;
+    //! True if the nanoapp is not among the selected ones.
+    bool isSkipped;
+    std::chrono::microseconds prefetchTime;
+  };
+
+  /** The max number of nanoapps read ahead of the one being loaded. */
+  static constexpr size_t kMaxPrefetchedNanoapps = 2;
+
+  /** Reads and validates the files of a nanoapp. */
+  static PrefetchedNanoapp prefetchNanoapp(
+      const std::string &directory, const std::string &name,
+      uint32_t transactionId,
+      const std::optional<const std::unordered_set<uint64_t>>
+          &selectedNanoappIds);
+
   /** Tracks the transaction state of the ongoing nanoapp loading */
   struct Transaction {
     uint32_t transactionId;
@@ -96,12 +145,12 @@ class PreloadedNanoappLoader {
    * Loads a preloaded nanoapp.
    *
    * @param appHeader The nanoapp header binary blob.
-   * @param nanoappFileName The nanoapp binary file name.
+   * @param binary The nanoapp binary.
    * @param transactionId The transaction ID identifying this load transaction.
    * @return true if successful, false otherwise.
    */
   bool loadNanoapp(const NanoAppBinaryHeader *appHeader,
-                   const std::string &nanoappFileName, uint32_t transactionId);
+                   const std::vector<uint8_t> &binary, uint32_t transactionId);
 
   /**
    * Chunks the nanoapp binary into fragments and load each fragment
@@ -109,7 +158,7 @@ class PreloadedNanoappLoader {
    */
   bool sendFragmentedLoadAndWaitForEachResponse(
       uint64_t appId, uint32_t appVersion, uint32_t appFlags,
-      uint32_t appTargetApiVersion, const uint8_t *appBinary, size_t appSize,
+      uint32_t appTargetApiVersion, const std::vector<uint8_t> &binary,
       uint32_t transactionId);
 
   /** Sends the FragmentedLoadRequest to CHRE. */
@@ -134,6 +183,8 @@ class PreloadedNanoappLoader {
 
   std::atomic_bool mIsPreloadingOngoing = false;
 
+  std::vector<NanoappLoadTiming> mLastPreloadTimings;
+
   ChreConnection *mConnection;
   std::string mConfigPath;
 };
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_HOST_TIME_SYNC_ESTIMATOR_H_
+#define CHRE_HOST_TIME_SYNC_ESTIMATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+namespace android::chre {
+
+/**
+ * Estimates how the offset between the host and CHRE time drifts, from the
+ * offsets measured at each time sync.
+ *
+ * The drift rate is the slope of a linear regression over the last samples,
+ * which lets CHRE extrapolate the offset between time syncs. The delay until
+ * the next time sync starts at kMinSyncDelayNs and doubles each time a sample
+ * lands within kMaxPredictionErrorNs of the offset predicted from the previous
+ * ones, up to kMaxSyncDelayNs. A sample missing the prediction means the drift
+ * changed: the older samples are discarded and the delay is reset.
+ *
+ * This class is not thread-safe.
+ */
+class TimeSyncEstimator {
+ public:
+  static constexpr int64_t kOneMinuteInNs = 60000000000;
+
+  /** The number of samples the regression is computed over. */
+  static constexpr size_t kMaxSamples = 8;
+
+  /** The bounds of the delay until the next time sync. */
+  static constexpr uint64_t kMinSyncDelayNs = 15 * kOneMinuteInNs;
+  static constexpr uint64_t kMaxSyncDelayNs = 24 * 60 * kOneMinuteInNs;
+
+  /**
+   * Samples measured closer than this to the previous one replace it, since
+   * they are too close to tell the drift from the measurement noise.
+   */
+  static constexpr int64_t kMinSampleSpacingNs = kOneMinuteInNs;
+
+  /** The error tolerated between a measured offset and its prediction. */
+  static constexpr int64_t kMaxPredictionErrorNs = 1000000;  // 1 ms
+
+  /**
+   * The error beyond which a measured offset is considered a step of the
+   * clocks, e.g. after CHRE restarts, after which no previous sample is kept.
+   */
+  static constexpr int64_t kMaxDriftErrorNs = 100000000;  // 100 ms
+
+  /** The estimate sent to CHRE after a time sync. */
+  struct Estimate {
+    //! The offset (host time - CHRE time) at the time of the last sample.
+    int64_t offsetNs;
+
+    //! The drift rate of the offset in nanoseconds per second, 0 if unknown.
+    int32_t driftPpb;
+
+    //! The delay after which the next time sync should happen.
+    uint64_t nextSyncDelayNs;
+  };
+
+  /**
+   * Adds an offset measured by a time sync.
+   *
+   * @param hostTimeNs the host time at which the offset is measured.
+   * @param offsetNs the measured offset, host time - CHRE time.
+   *
+   * @return the estimate to send to CHRE.
+   */
+  Estimate addSample(int64_t hostTimeNs, int64_t offsetNs);
+
+  /** Discards all the samples, e.g. when CHRE restarts. */
+  void reset();
+
+  size_t getSampleCount() const {
+    return mSamples.size();
+  }
+
+ private:
+  struct Sample {
+    int64_t hostTimeNs;
+    int64_t offsetNs;
+  };
+
+  /**
+   * Fits a line to the samples, relative to the last one.
+   *
+   * @param interceptNs the fitted offset at the last sample minus the
+   * measured one.
+   * @param slopePpb the drift rate of the offset.
+   */
+  void fit(double *interceptNs, double *slopePpb) const;
+
+  /** @return the offset at hostTimeNs predicted from the samples. */
+  int64_t predictOffset(int64_t hostTimeNs) const;
+
+  std::deque<Sample> mSamples;
+  uint64_t mNextSyncDelayNs = kMinSyncDelayNs;
+};
+
+}  // namespace android::chre
+
+#endif  // CHRE_HOST_TIME_SYNC_ESTIMATOR_H_
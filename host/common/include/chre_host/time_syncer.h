@@ -21,6 +21,7 @@
 #include <string>
 
 #include "chre_connection.h"
+#include "chre_host/time_sync_estimator.h"
 
 namespace android::chre {
 
@@ -36,11 +37,15 @@ class TimeSyncer final {
    * If the platform doesn't require the time sync the request will be ignored
    * and true is returned.
    *
+   * @param estimator optional estimator of the offset drift, which is fed the
+   * measured offsets and whose estimates are sent instead of them.
+   *
    * @return true if success, false otherwise.
    */
   static bool sendTimeSyncWithRetry(ChreConnection *connection,
                                     size_t numOfRetries,
-                                    useconds_t retryDelayUs);
+                                    useconds_t retryDelayUs,
+                                    TimeSyncEstimator *estimator = nullptr);
 
   /**
    * Sends a time sync message to Context hub for once.
@@ -48,9 +53,13 @@ class TimeSyncer final {
    * If the platform doesn't require the time sync the request will be ignored
    * and true is returned.
    *
+   * @param estimator optional estimator of the offset drift, which is fed the
+   * measured offset and whose estimate is sent instead of it.
+   *
    * @return true if success, false otherwise.
    */
-  static bool sendTimeSync(ChreConnection *connection);
+  static bool sendTimeSync(ChreConnection *connection,
+                           TimeSyncEstimator *estimator = nullptr);
 
  private:
   TimeSyncer() = default;
@@ -16,7 +16,11 @@
 
 #include "chre_host/preloaded_nanoapp_loader.h"
 #include <chre_host/host_protocol_host.h>
+#include <cinttypes>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
+#include <thread>
 #include "chre_host/config_util.h"
 #include "chre_host/file_stream.h"
 #include "chre_host/fragmented_load_transaction.h"
@@ -30,6 +34,9 @@ using android::hardware::contexthub::common::implementation::kHalId;
 
 namespace {
 
+//! The magic number of a nanoapp header, "NANO" in little endian.
+constexpr uint32_t kNanoappHeaderMagic = 0x4f4e414e;
+
 bool getNanoappHeaderFromFile(const char *headerFileName,
                               std::vector<uint8_t> &headerBuffer) {
   if (!readFileContents(headerFileName, headerBuffer)) {
@@ -86,59 +93,136 @@ bool PreloadedNanoappLoader::loadPreloadedNanoapps(
     LOGE("Preloading is ongoing. A new request shouldn't happen.");
     return false;
   }
+
+  // The nanoapps prefetched by the worker, in the loading order.
+  std::mutex prefetchMutex;
+  std::condition_variable prefetchCondVar;
+  std::deque<PrefetchedNanoapp> prefetchedNanoapps;
+  std::thread prefetcher([&]() {
+    for (uint32_t i = 0; i < nanoapps.size(); ++i) {
+      {
+        std::unique_lock<std::mutex> lock(prefetchMutex);
+        prefetchCondVar.wait(lock, [&]() {
+          return prefetchedNanoapps.size() < kMaxPrefetchedNanoapps;
+        });
+      }
+      PrefetchedNanoapp nanoapp =
+          prefetchNanoapp(directory, nanoapps[i], i, selectedNanoappIds);
+      std::lock_guard<std::mutex> lock(prefetchMutex);
+      prefetchedNanoapps.push_back(std::move(nanoapp));
+      prefetchCondVar.notify_all();
+    }
+  });
+
   bool success = true;
-  for (uint32_t i = 0; i < nanoapps.size(); ++i) {
-    std::string headerFilename = directory + "/" + nanoapps[i] + ".napp_header";
-    std::string nanoappFilename = directory + "/" + nanoapps[i] + ".so";
-    // parse the header
-    std::vector<uint8_t> headerBuffer;
-    if (!getNanoappHeaderFromFile(headerFilename.c_str(), headerBuffer)) {
-      LOGE("Failed to parse the nanoapp header for %s",
-           nanoappFilename.c_str());
-      success = false;
-      continue;
+  std::vector<NanoappLoadTiming> timings;
+  for (size_t i = 0; i < nanoapps.size(); ++i) {
+    auto stallStart = std::chrono::steady_clock::now();
+    PrefetchedNanoapp nanoapp;
+    {
+      std::unique_lock<std::mutex> lock(prefetchMutex);
+      prefetchCondVar.wait(lock, [&]() { return !prefetchedNanoapps.empty(); });
+      nanoapp = std::move(prefetchedNanoapps.front());
+      prefetchedNanoapps.pop_front();
+      prefetchCondVar.notify_all();
     }
-    const auto header =
-        reinterpret_cast<const NanoAppBinaryHeader *>(headerBuffer.data());
-    // check if the app should be skipped
-    if (shouldSkipNanoapp(selectedNanoappIds, header->appId)) {
-      LOGI("Loading of %s is skipped.", headerFilename.c_str());
+    auto loadStart = std::chrono::steady_clock::now();
+    if (nanoapp.isSkipped) {
+      LOGI("Loading of %s is skipped.", nanoapp.name.c_str());
       continue;
     }
-    // load the binary
-    if (!loadNanoapp(header, nanoappFilename, i)) {
-      success = false;
+    NanoappLoadTiming timing = {
+        .name = nanoapp.name,
+        .appId = 0,
+        .prefetch = nanoapp.prefetchTime,
+        .stall = std::chrono::duration_cast<std::chrono::microseconds>(
+            loadStart - stallStart),
+        .load = std::chrono::microseconds(0),
+        .success = false,
+    };
+    if (nanoapp.isValid) {
+      const auto header = reinterpret_cast<const NanoAppBinaryHeader *>(
+          nanoapp.headerBuffer.data());
+      timing.appId = header->appId;
+      timing.success =
+          loadNanoapp(header, nanoapp.binary, nanoapp.transactionId);
+      timing.load = std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - loadStart);
     }
+    LOGI("Preloading nanoapp %s 0x%016" PRIx64
+         " %s: prefetch %lld us, stall %lld us, load %lld us",
+         timing.name.c_str(), timing.appId,
+         timing.success ? "succeeded" : "failed",
+         static_cast<long long>(timing.prefetch.count()),
+         static_cast<long long>(timing.stall.count()),
+         static_cast<long long>(timing.load.count()));
+    success &= timing.success;
+    timings.push_back(std::move(timing));
+  }
+  prefetcher.join();
+
+  {
+    std::lock_guard<std::mutex> lock(mPreloadedNanoappsMutex);
+    mLastPreloadTimings = std::move(timings);
   }
   mIsPreloadingOngoing.store(false);
   return success;
 }
 
+PreloadedNanoappLoader::PrefetchedNanoapp
+PreloadedNanoappLoader::prefetchNanoapp(
+    const std::string &directory, const std::string &name,
+    uint32_t transactionId,
+    const std::optional<const std::unordered_set<uint64_t>>
+        &selectedNanoappIds) {
+  auto start = std::chrono::steady_clock::now();
+  PrefetchedNanoapp nanoapp = {
+      .name = name,
+      .transactionId = transactionId,
+      .isValid = false,
+      .isSkipped = false,
+  };
+  std::string headerFilename = directory + "/" + name + ".napp_header";
+  std::string nanoappFilename = directory + "/" + name + ".so";
+  // parse the header
+  if (!getNanoappHeaderFromFile(headerFilename.c_str(),
+                                nanoapp.headerBuffer)) {
+    LOGE("Failed to parse the nanoapp header for %s", nanoappFilename.c_str());
+  } else if (const auto header = reinterpret_cast<const NanoAppBinaryHeader *>(
+                 nanoapp.headerBuffer.data());
+             header->magic != kNanoappHeaderMagic) {
+    LOGE("Nanoapp header %s has an invalid magic 0x%" PRIx32,
+         headerFilename.c_str(), header->magic);
+  } else if (shouldSkipNanoapp(selectedNanoappIds, header->appId)) {
+    // check if the app should be skipped before reading its binary
+    nanoapp.isSkipped = true;
+  } else if (!readFileContents(nanoappFilename.c_str(), nanoapp.binary)) {
+    LOGE("Unable to read %s.", nanoappFilename.c_str());
+  } else if (nanoapp.binary.empty()) {
+    LOGE("Nanoapp binary %s is empty.", nanoappFilename.c_str());
+  } else {
+    nanoapp.isValid = true;
+  }
+  nanoapp.prefetchTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  return nanoapp;
+}
+
 bool PreloadedNanoappLoader::loadNanoapp(const NanoAppBinaryHeader *appHeader,
-                                         const std::string &nanoappFileName,
+                                         const std::vector<uint8_t> &binary,
                                          uint32_t transactionId) {
-  // parse the binary
-  std::vector<uint8_t> nanoappBuffer;
-  if (!readFileContents(nanoappFileName.c_str(), nanoappBuffer)) {
-    LOGE("Unable to read %s.", nanoappFileName.c_str());
-    return false;
-  }
   // Build the target API version from major and minor.
   uint32_t targetApiVersion = (appHeader->targetChreApiMajorVersion << 24) |
                               (appHeader->targetChreApiMinorVersion << 16);
   return sendFragmentedLoadAndWaitForEachResponse(
       appHeader->appId, appHeader->appVersion, appHeader->flags,
-      targetApiVersion, nanoappBuffer.data(), nanoappBuffer.size(),
-      transactionId);
+      targetApiVersion, binary, transactionId);
 }
 
 bool PreloadedNanoappLoader::sendFragmentedLoadAndWaitForEachResponse(
     uint64_t appId, uint32_t appVersion, uint32_t appFlags,
-    uint32_t appTargetApiVersion, const uint8_t *appBinary, size_t appSize,
+    uint32_t appTargetApiVersion, const std::vector<uint8_t> &binary,
     uint32_t transactionId) {
-  std::vector<uint8_t> binary(appSize);
-  std::copy(appBinary, appBinary + appSize, binary.begin());
-
   FragmentedLoadTransaction transaction(transactionId, appId, appVersion,
                                         appFlags, appTargetApiVersion, binary);
   while (!transaction.isComplete()) {
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre_host/time_sync_estimator.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+#include "chre_host/log.h"
+
+namespace android::chre {
+
+namespace {
+
+constexpr double kOneSecondInNs = 1e9;
+
+}  // namespace
+
+TimeSyncEstimator::Estimate TimeSyncEstimator::addSample(int64_t hostTimeNs,
+                                                         int64_t offsetNs) {
+  if (!mSamples.empty() &&
+      hostTimeNs - mSamples.back().hostTimeNs < kMinSampleSpacingNs) {
+    // E.g. a retried time sync, or one requested right after another.
+    mSamples.pop_back();
+  } else if (!mSamples.empty()) {
+    int64_t errorNs = std::abs(offsetNs - predictOffset(hostTimeNs));
+    if (errorNs > kMaxDriftErrorNs) {
+      LOGW("Time offset stepped by %" PRId64 " ns. Resetting the drift model",
+           errorNs);
+      mSamples.clear();
+      mNextSyncDelayNs = kMinSyncDelayNs;
+    } else if (mSamples.size() == 1) {
+      // The drift is only known once this sample is added.
+    } else if (errorNs <= kMaxPredictionErrorNs) {
+      mNextSyncDelayNs = std::min(2 * mNextSyncDelayNs, kMaxSyncDelayNs);
+    } else {
+      LOGW("Time offset drifted %" PRId64
+           " ns from its prediction. Re-estimating the drift",
+           errorNs);
+      // Keeps the last sample only, as the drift changed since the others.
+      mSamples.erase(mSamples.begin(), mSamples.end() - 1);
+      mNextSyncDelayNs = kMinSyncDelayNs;
+    }
+  }
+
+  mSamples.push_back({.hostTimeNs = hostTimeNs, .offsetNs = offsetNs});
+  if (mSamples.size() > kMaxSamples) {
+    mSamples.pop_front();
+  }
+
+  double interceptNs;
+  double slopePpb;
+  fit(&interceptNs, &slopePpb);
+  slopePpb = std::clamp<double>(slopePpb, std::numeric_limits<int32_t>::min(),
+                                std::numeric_limits<int32_t>::max());
+  return {
+      .offsetNs = offsetNs + std::llround(interceptNs),
+      .driftPpb = static_cast<int32_t>(std::lround(slopePpb)),
+      .nextSyncDelayNs = mNextSyncDelayNs,
+  };
+}
+
+void TimeSyncEstimator::reset() {
+  mSamples.clear();
+  mNextSyncDelayNs = kMinSyncDelayNs;
+}
+
+void TimeSyncEstimator::fit(double *interceptNs, double *slopePpb) const {
+  *interceptNs = 0;
+  *slopePpb = 0;
+  if (mSamples.size() < 2) {
+    return;
+  }
+
+  // Times and offsets are taken relative to the last sample to keep the
+  // precision of the doubles.
+  const Sample &last = mSamples.back();
+  double meanX = 0;
+  double meanY = 0;
+  for (const Sample &sample : mSamples) {
+    meanX += (sample.hostTimeNs - last.hostTimeNs) / kOneSecondInNs;
+    meanY += sample.offsetNs - last.offsetNs;
+  }
+  meanX /= mSamples.size();
+  meanY /= mSamples.size();
+
+  double sumXX = 0;
+  double sumXY = 0;
+  for (const Sample &sample : mSamples) {
+    double dx = (sample.hostTimeNs - last.hostTimeNs) / kOneSecondInNs - meanX;
+    double dy = (sample.offsetNs - last.offsetNs) - meanY;
+    sumXX += dx * dx;
+    sumXY += dx * dy;
+  }
+  if (sumXX > 0) {
+    *slopePpb = sumXY / sumXX;
+  }
+  *interceptNs = meanY - *slopePpb * meanX;
+}
+
+int64_t TimeSyncEstimator::predictOffset(int64_t hostTimeNs) const {
+  double interceptNs;
+  double slopePpb;
+  fit(&interceptNs, &slopePpb);
+  const Sample &last = mSamples.back();
+  return last.offsetNs +
+         std::llround(interceptNs + slopePpb *
+                                        (hostTimeNs - last.hostTimeNs) /
+                                        kOneSecondInNs);
+}
+
+}  // namespace android::chre
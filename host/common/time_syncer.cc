@@ -16,12 +16,14 @@
 
 #include "chre_host/time_syncer.h"
 #include <chre_host/host_protocol_host.h>
+#include <utils/SystemClock.h>
 #include "chre_host/log.h"
 
 namespace android::chre {
 // TODO(b/247124878): Can we add a static assert to make sure these functions
 //  are not called when connection->isTimeSyncNeeded() returns false?
-bool TimeSyncer::sendTimeSync(ChreConnection *connection) {
+bool TimeSyncer::sendTimeSync(ChreConnection *connection,
+                              TimeSyncEstimator *estimator) {
   if (!connection->isTimeSyncNeeded()) {
     LOGW("Platform doesn't require time sync. Ignore the request.");
     return true;
@@ -33,20 +35,29 @@ bool TimeSyncer::sendTimeSync(ChreConnection *connection) {
   }
   flatbuffers::FlatBufferBuilder builder(64);
   // clientId doesn't matter for time sync request so the default id is used.
-  HostProtocolHost::encodeTimeSyncMessage(builder, timeOffsetUs);
+  if (estimator != nullptr) {
+    TimeSyncEstimator::Estimate estimate = estimator->addSample(
+        ::android::elapsedRealtimeNano(), timeOffsetUs);
+    HostProtocolHost::encodeTimeSyncMessage(builder, estimate.offsetNs,
+                                            estimate.driftPpb,
+                                            estimate.nextSyncDelayNs);
+  } else {
+    HostProtocolHost::encodeTimeSyncMessage(builder, timeOffsetUs);
+  }
   return connection->sendMessage(builder.GetBufferPointer(), builder.GetSize());
 }
 
 bool TimeSyncer::sendTimeSyncWithRetry(ChreConnection *connection,
                                        size_t numOfRetries,
-                                       useconds_t retryDelayUs) {
+                                       useconds_t retryDelayUs,
+                                       TimeSyncEstimator *estimator) {
   if (!connection->isTimeSyncNeeded()) {
     LOGW("Platform doesn't require time sync. Ignore the request.");
     return true;
   }
   bool success = false;
   while (!success && (numOfRetries-- > 0)) {
-    success = sendTimeSync(connection);
+    success = sendTimeSync(connection, estimator);
     if (!success) {
       usleep(retryDelayUs);
     }
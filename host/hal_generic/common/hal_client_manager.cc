@@ -149,7 +149,7 @@ bool HalClientManager::createClientLocked(
 }
 
 HalClientId HalClientManager::getClientId(pid_t pid) {
-  const std::lock_guard<std::mutex> lock(mLock);
+  const std::shared_lock<std::shared_mutex> lock(mClientsLock);
   const HalClient *client = getClientByProcessIdLocked(pid);
   if (client == nullptr) {
     LOGE("Failed to find the client id for pid %d", pid);
@@ -160,7 +160,7 @@ HalClientId HalClientManager::getClientId(pid_t pid) {
 
 std::shared_ptr<IContextHubCallback> HalClientManager::getCallback(
     HalClientId clientId) {
-  const std::lock_guard<std::mutex> lock(mLock);
+  const std::shared_lock<std::shared_mutex> lock(mClientsLock);
   const HalClient *client = getClientByClientIdLocked(clientId);
   if (client == nullptr) {
     LOGE("Failed to find the callback for the client id %" PRIu16, clientId);
@@ -172,7 +172,7 @@ std::shared_ptr<IContextHubCallback> HalClientManager::getCallback(
 bool HalClientManager::registerCallback(
     pid_t pid, const std::shared_ptr<IContextHubCallback> &callback,
     void *deathRecipientCookie) {
-  const std::lock_guard<std::mutex> lock(mLock);
+  const std::unique_lock<std::shared_mutex> lock(mClientsLock);
   HalClient *client = getClientByProcessIdLocked(pid);
   if (client != nullptr) {
     LOGW("The pid %d has already registered. Overriding its callback.", pid);
@@ -212,26 +212,34 @@ bool HalClientManager::registerCallback(
 }
 
 void HalClientManager::handleClientDeath(pid_t pid) {
-  const std::lock_guard<std::mutex> lock(mLock);
-  HalClient *client = getClientByProcessIdLocked(pid);
-  if (client == nullptr) {
-    LOGE("Failed to locate the dead pid %d", pid);
-    return;
-  }
+  HalClientId clientId;
+  {
+    const std::unique_lock<std::shared_mutex> lock(mClientsLock);
+    HalClient *client = getClientByProcessIdLocked(pid);
+    if (client == nullptr) {
+      LOGE("Failed to locate the dead pid %d", pid);
+      return;
+    }
 
-  if (!mDeadClientUnlinker(client->callback, client->deathRecipientCookie)) {
-    LOGE("Unable to unlink the old callback for pid %d in death handler", pid);
+    if (!mDeadClientUnlinker(client->callback, client->deathRecipientCookie)) {
+      LOGE("Unable to unlink the old callback for pid %d in death handler",
+           pid);
+    }
+    client->reset(/* processId= */ HalClient::PID_UNSET,
+                  /* contextHubCallback= */ nullptr, /* cookie= */ nullptr);
+    clientId = client->clientId;
   }
-  client->reset(/* processId= */ HalClient::PID_UNSET,
-                /* contextHubCallback= */ nullptr, /* cookie= */ nullptr);
 
-  if (mPendingLoadTransaction.has_value() &&
-      mPendingLoadTransaction->clientId == client->clientId) {
-    mPendingLoadTransaction.reset();
-  }
-  if (mPendingUnloadTransaction.has_value() &&
-      mPendingUnloadTransaction->clientId == client->clientId) {
-    mPendingLoadTransaction.reset();
+  {
+    const std::lock_guard<std::mutex> lock(mTransactionLock);
+    if (mPendingLoadTransaction.has_value() &&
+        mPendingLoadTransaction->clientId == clientId) {
+      mPendingLoadTransaction.reset();
+    }
+    if (mPendingUnloadTransaction.has_value() &&
+        mPendingUnloadTransaction->clientId == clientId) {
+      mPendingLoadTransaction.reset();
+    }
   }
   LOGI("Process %" PRIu32 " is disconnected from HAL.", pid);
 }
@@ -243,24 +251,24 @@ bool HalClientManager::registerPendingLoadTransaction(
     return false;
   }
 
-  const std::lock_guard<std::mutex> lock(mLock);
-  const HalClient *client = getClientByProcessIdLocked(pid);
-  if (client == nullptr) {
+  HalClientId clientId = getClientId(pid);
+  if (clientId == ::chre::kHostClientIdUnspecified) {
     LOGE("Unknown HAL client when registering its pending load transaction.");
     return false;
   }
-  if (!isNewTransactionAllowedLocked(client->clientId)) {
+  const std::lock_guard<std::mutex> lock(mTransactionLock);
+  if (!isNewTransactionAllowedLocked(clientId)) {
     return false;
   }
   mPendingLoadTransaction.emplace(
-      client->clientId, /* registeredTimeMs= */ android::elapsedRealtime(),
+      clientId, /* registeredTimeMs= */ android::elapsedRealtime(),
       /* currentFragmentId= */ 0, std::move(transaction));
   return true;
 }
 
 std::optional<chre::FragmentedLoadRequest>
 HalClientManager::getNextFragmentedLoadRequest() {
-  const std::lock_guard<std::mutex> lock(mLock);
+  const std::lock_guard<std::mutex> lock(mTransactionLock);
   if (mPendingLoadTransaction->transaction->isComplete()) {
     LOGI("Pending load transaction %" PRIu32
          " is finished with client %" PRIu16,
@@ -278,17 +286,17 @@ HalClientManager::getNextFragmentedLoadRequest() {
 
 bool HalClientManager::registerPendingUnloadTransaction(
     pid_t pid, uint32_t transactionId) {
-  const std::lock_guard<std::mutex> lock(mLock);
-  const HalClient *client = getClientByProcessIdLocked(pid);
-  if (client == nullptr) {
+  HalClientId clientId = getClientId(pid);
+  if (clientId == ::chre::kHostClientIdUnspecified) {
     LOGE("Unknown HAL client when registering its pending unload transaction.");
     return false;
   }
-  if (!isNewTransactionAllowedLocked(client->clientId)) {
+  const std::lock_guard<std::mutex> lock(mTransactionLock);
+  if (!isNewTransactionAllowedLocked(clientId)) {
     return false;
   }
   mPendingUnloadTransaction.emplace(
-      client->clientId, transactionId,
+      clientId, transactionId,
       /* registeredTimeMs= */ android::elapsedRealtime());
   return true;
 }
@@ -343,7 +351,7 @@ bool HalClientManager::isNewTransactionAllowedLocked(HalClientId clientId) {
 
 bool HalClientManager::registerEndpointId(pid_t pid,
                                           const HostEndpointId &endpointId) {
-  const std::lock_guard<std::mutex> lock(mLock);
+  const std::unique_lock<std::shared_mutex> lock(mClientsLock);
   HalClient *client = getClientByProcessIdLocked(pid);
   if (client == nullptr) {
     LOGE(
@@ -369,7 +377,7 @@ bool HalClientManager::registerEndpointId(pid_t pid,
 
 bool HalClientManager::removeEndpointId(pid_t pid,
                                         const HostEndpointId &endpointId) {
-  const std::lock_guard<std::mutex> lock(mLock);
+  const std::unique_lock<std::shared_mutex> lock(mClientsLock);
   HalClient *client = getClientByProcessIdLocked(pid);
   if (client == nullptr) {
     LOGE(
@@ -395,7 +403,7 @@ bool HalClientManager::removeEndpointId(pid_t pid,
 
 std::shared_ptr<IContextHubCallback> HalClientManager::getCallbackForEndpoint(
     const HostEndpointId mutatedEndpointId) {
-  const std::lock_guard<std::mutex> lock(mLock);
+  const std::shared_lock<std::shared_mutex> lock(mClientsLock);
   HalClient *client;
   if (mutatedEndpointId & kVendorEndpointIdBitMask) {
     HalClientId clientId =
@@ -422,31 +430,41 @@ std::shared_ptr<IContextHubCallback> HalClientManager::getCallbackForEndpoint(
   return client->callback;
 }
 
+std::vector<std::shared_ptr<IContextHubCallback>>
+HalClientManager::getAllCallbacks() {
+  const std::shared_lock<std::shared_mutex> lock(mClientsLock);
+  std::vector<std::shared_ptr<IContextHubCallback>> callbacks;
+  callbacks.reserve(mClients.size());
+  for (const HalClient &client : mClients) {
+    if (client.callback != nullptr) {
+      callbacks.push_back(client.callback);
+    }
+  }
+  return callbacks;
+}
+
 void HalClientManager::sendMessageForAllCallbacks(
     const ContextHubMessage &message,
     const std::vector<std::string> &messageParams) {
-  const std::lock_guard<std::mutex> lock(mLock);
-  for (const auto &client : mClients) {
-    if (client.callback != nullptr) {
-      client.callback->handleContextHubMessage(message, messageParams);
-    }
+  for (const auto &callback : getAllCallbacks()) {
+    callback->handleContextHubMessage(message, messageParams);
   }
 }
 
-const std::unordered_set<HostEndpointId>
-    *HalClientManager::getAllConnectedEndpoints(pid_t pid) {
-  const std::lock_guard<std::mutex> lock(mLock);
+std::optional<std::unordered_set<HostEndpointId>>
+HalClientManager::getAllConnectedEndpoints(pid_t pid) {
+  const std::shared_lock<std::shared_mutex> lock(mClientsLock);
   const HalClient *client = getClientByProcessIdLocked(pid);
   if (client == nullptr) {
     LOGE("Unknown HAL client with pid %d", pid);
-    return nullptr;
+    return std::nullopt;
   }
-  return &(client->endpointIds);
+  return client->endpointIds;
 }
 
 bool HalClientManager::mutateEndpointIdFromHostIfNeeded(
     pid_t pid, HostEndpointId &endpointId) {
-  const std::lock_guard<std::mutex> lock(mLock);
+  const std::shared_lock<std::shared_mutex> lock(mClientsLock);
   const HalClient *client = getClientByProcessIdLocked(pid);
   if (client == nullptr) {
     LOGE("Unknown HAL client with pid %d", pid);
@@ -525,13 +543,13 @@ bool HalClientManager::isPendingLoadTransactionMatchedLocked(
 }
 
 void HalClientManager::resetPendingLoadTransaction() {
-  const std::lock_guard<std::mutex> lock(mLock);
+  const std::lock_guard<std::mutex> lock(mTransactionLock);
   mPendingLoadTransaction.reset();
 }
 
 bool HalClientManager::resetPendingUnloadTransaction(HalClientId clientId,
                                                      uint32_t transactionId) {
-  const std::lock_guard<std::mutex> lock(mLock);
+  const std::lock_guard<std::mutex> lock(mTransactionLock);
   // Only clear a pending transaction when the client id and the transaction id
   // are both matched
   if (isPendingTransactionMatchedLocked(clientId, transactionId,
@@ -550,18 +568,19 @@ bool HalClientManager::resetPendingUnloadTransaction(HalClientId clientId,
 
 void HalClientManager::handleChreRestart() {
   {
-    const std::lock_guard<std::mutex> lock(mLock);
+    const std::lock_guard<std::mutex> lock(mTransactionLock);
     mPendingLoadTransaction.reset();
     mPendingUnloadTransaction.reset();
+  }
+  {
+    const std::unique_lock<std::shared_mutex> lock(mClientsLock);
     for (HalClient &client : mClients) {
       client.endpointIds.clear();
     }
   }
   // Incurs callbacks without holding the lock to avoid deadlocks.
-  for (const HalClient &client : mClients) {
-    if (client.callback != nullptr) {
-      client.callback->handleContextHubAsyncEvent(AsyncEventType::RESTARTED);
-    }
+  for (const auto &callback : getAllCallbacks()) {
+    callback->handleContextHubAsyncEvent(AsyncEventType::RESTARTED);
   }
 }
 }  // namespace android::hardware::contexthub::common::implementation
\ No newline at end of file
@@ -24,6 +24,9 @@
 
 #include <sys/types.h>
 #include <cstddef>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -50,6 +53,12 @@ namespace android::hardware::contexthub::common::implementation {
  *     HalClient;
  *   - to track the ongoing load/unload transactions
  *
+ * The client states and the pending transactions are guarded by separate
+ * locks. The client states are read for every message between CHRE and the HAL
+ * clients but rarely change, so they are behind a shared lock that concurrent
+ * lookups don't contend on. Callbacks are never invoked while holding either
+ * lock.
+ *
  * There are 3 types of ids HalClientManager will track: client uuid, HAL client
  * id and host endpoint id.
  *   - A uuid uniquely identifies a client when it registers its callback.
@@ -200,7 +209,7 @@ class HalClientManager {
   bool isPendingLoadTransactionExpected(HalClientId clientId,
                                         uint32_t transactionId,
                                         uint32_t currentFragmentId) {
-    const std::lock_guard<std::mutex> lock(mLock);
+    const std::lock_guard<std::mutex> lock(mTransactionLock);
     return isPendingLoadTransactionMatchedLocked(clientId, transactionId,
                                                  currentFragmentId);
   }
@@ -288,10 +297,11 @@ class HalClientManager {
   /**
    * Gets all the connected endpoints for the client identified by the @p pid.
    *
-   * @return the pointer to the endpoint id set if the client is identifiable,
-   * otherwise nullptr.
+   * @return a copy of the endpoint id set if the client is identifiable,
+   * otherwise std::nullopt.
    */
-  const std::unordered_set<HostEndpointId> *getAllConnectedEndpoints(pid_t pid);
+  std::optional<std::unordered_set<HostEndpointId>> getAllConnectedEndpoints(
+      pid_t pid);
 
   /** Sends a message to every connected endpoints. */
   void sendMessageForAllCallbacks(
@@ -365,7 +375,7 @@ class HalClientManager {
    * and client ids so that if a client has connected to HAL before the same
    * client id is always assigned to it.
    *
-   * mLock must be held when this function is called.
+   * mClientsLock must be held exclusively when this function is called.
    *
    */
   bool createClientLocked(const std::string &uuid, pid_t pid,
@@ -375,6 +385,8 @@ class HalClientManager {
   /**
    * Update @p mNextClientId to be the next available one.
    *
+   * mClientsLock must be held exclusively when this function is called.
+   *
    * @return true if success, otherwise false.
    */
   bool updateNextClientIdLocked();
@@ -383,7 +395,7 @@ class HalClientManager {
    * Returns true if @p clientId and @p transactionId match the
    * corresponding values in @p transaction.
    *
-   * mLock must be held when this function is called.
+   * mTransactionLock must be held when this function is called.
    */
   static bool isPendingTransactionMatchedLocked(
       HalClientId clientId, uint32_t transactionId,
@@ -395,7 +407,7 @@ class HalClientManager {
   /**
    * Returns true if the load transaction is expected.
    *
-   * mLock must be held when this function is called.
+   * mTransactionLock must be held when this function is called.
    */
   bool isPendingLoadTransactionMatchedLocked(HalClientId clientId,
                                              uint32_t transactionId,
@@ -411,7 +423,7 @@ class HalClientManager {
    * However, every transaction is guaranteed to have up to
    * kTransactionTimeoutThresholdMs to finish.
    *
-   * mLock must be held when this function is called.
+   * mTransactionLock must be held when this function is called.
    *
    * @param clientId id of the client trying to register the transaction
    *
@@ -438,6 +450,14 @@ class HalClientManager {
                                            : kSystemServerUuid;
   }
 
+  /**
+   * Returns the callbacks of all the clients that registered one, so that they
+   * can be invoked without holding mClientsLock.
+   */
+  std::vector<std::shared_ptr<IContextHubCallback>> getAllCallbacks();
+
+  // The getClientBy*Locked() functions require mClientsLock to be held, shared
+  // or exclusively.
   HalClient *getClientByField(
       const std::function<bool(const HalClient &client)> &fieldMatcher);
 
@@ -457,11 +477,16 @@ class HalClientManager {
   // reserved client ids that will not be used
   std::unordered_set<HalClientId> mReservedClientIds;
 
-  // The lock guarding the access to clients' states and pending transactions
-  std::mutex mLock;
+  // The lock guarding the access to clients' states, held shared for lookups
+  // and exclusively when a client or its endpoints change
+  std::shared_mutex mClientsLock;
 
   std::vector<HalClient> mClients;
 
+  // The lock guarding the access to pending transactions. It is never acquired
+  // while holding mClientsLock, or the other way around.
+  std::mutex mTransactionLock;
+
   // States tracking pending transactions
   std::optional<PendingLoadTransaction> mPendingLoadTransaction = std::nullopt;
   std::optional<PendingTransaction> mPendingUnloadTransaction = std::nullopt;
@@ -36,6 +36,7 @@ enum class HalError {
   LINK_DEATH_RECIPIENT_FAILED = -103,
   CALLBACK_REGISTRATION_FAILED = -104,
   UNEXPECTED_ENDPOINT_STATE = -105,
+  SEND_QUEUE_FULL = -106,
 };
 
 }  // namespace android::chre
@@ -278,12 +278,27 @@ ScopedAStatus MultiClientContextHubBase::queryNanoapps(int32_t contextHubId) {
   if (!isValidContextHubId(contextHubId)) {
     return ScopedAStatus::fromExceptionCode(EX_ILLEGAL_ARGUMENT);
   }
+  HalClientId clientId =
+      mHalClientManager->getClientId(AIBinder_getCallingPid());
+  std::vector<NanoappInfo> appInfoList;
+  switch (mNanoappListCache.query(clientId, &appInfoList)) {
+    case NanoappListCache::Result::CACHED:
+      deliverNanoappList({clientId}, appInfoList);
+      return ScopedAStatus::ok();
+    case NanoappListCache::Result::PENDING:
+      return ScopedAStatus::ok();
+    case NanoappListCache::Result::SEND_FAILED:
+      break;
+  }
+  return fromResult(false);
+}
+
+bool MultiClientContextHubBase::sendNanoappListRequest(HalClientId clientId) {
   flatbuffers::FlatBufferBuilder builder(64);
   HostProtocolHost::encodeNanoappListRequest(builder);
-  HostProtocolHost::mutateHostClientId(
-      builder.GetBufferPointer(), builder.GetSize(),
-      mHalClientManager->getClientId(AIBinder_getCallingPid()));
-  return fromResult(mConnection->sendMessage(builder));
+  HostProtocolHost::mutateHostClientId(builder.GetBufferPointer(),
+                                       builder.GetSize(), clientId);
+  return mConnection->sendMessage(builder);
 }
 
 ScopedAStatus MultiClientContextHubBase::getPreloadedNanoappIds(
@@ -423,14 +438,29 @@ bool MultiClientContextHubBase::enableTestMode() {
   if (mIsTestModeEnabled) {
     return true;
   }
+  // The cached list is used directly, as delivering it through
+  // deliverNanoappList() would take mTestModeMutex again.
   mTestModeNanoapps.reset();
-  if (!queryNanoapps(kDefaultHubId).isOk()) {
-    LOGE("Failed to get a list of loaded nanoapps.");
-    mTestModeNanoapps.emplace();
-    return false;
+  std::vector<NanoappInfo> appInfoList;
+  switch (mNanoappListCache.query(
+      mHalClientManager->getClientId(AIBinder_getCallingPid()),
+      &appInfoList)) {
+    case NanoappListCache::Result::CACHED:
+      mTestModeNanoapps.emplace();
+      for (const auto &appInfo : appInfoList) {
+        mTestModeNanoapps->insert(appInfo.nanoappId);
+      }
+      break;
+    case NanoappListCache::Result::PENDING:
+      mEnableTestModeCv.wait_for(
+          lock, ktestModeTimeOut,
+          [&]() { return mTestModeNanoapps.has_value(); });
+      break;
+    case NanoappListCache::Result::SEND_FAILED:
+      LOGE("Failed to get a list of loaded nanoapps.");
+      mTestModeNanoapps.emplace();
+      return false;
   }
-  mEnableTestModeCv.wait_for(lock, ktestModeTimeOut,
-                             [&]() { return mTestModeNanoapps.has_value(); });
   for (const auto &appId : *mTestModeNanoapps) {
     if (!unloadNanoapp(kDefaultHubId, appId, mTestModeTransactionId).isOk()) {
       LOGE("Failed to unload nanoapp 0x%" PRIx64 " to enable the test mode.",
@@ -494,7 +524,8 @@ void MultiClientContextHubBase::handleMessageFromChre(
     }
     case fbs::ChreMessage::TimeSyncRequest: {
       if (mConnection->isTimeSyncNeeded()) {
-        TimeSyncer::sendTimeSync(mConnection.get());
+        std::lock_guard<std::mutex> lock(mTimeSyncMutex);
+        TimeSyncer::sendTimeSync(mConnection.get(), &mTimeSyncEstimator);
       } else {
         LOGW("Received an unexpected time sync request from CHRE.");
       }
@@ -566,11 +597,6 @@ void MultiClientContextHubBase::onDebugDumpComplete(
 
 void MultiClientContextHubBase::onNanoappListResponse(
     const fbs::NanoappListResponseT &response, HalClientId clientId) {
-  std::shared_ptr<IContextHubCallback> callback =
-      mHalClientManager->getCallback(clientId);
-  if (callback == nullptr) {
-    return;
-  }
   std::vector<NanoappInfo> appInfoList;
   for (const auto &nanoapp : response.nanoapps) {
     if (nanoapp == nullptr || nanoapp->is_system) {
@@ -592,6 +618,18 @@ void MultiClientContextHubBase::onNanoappListResponse(
     appInfo.rpcServices = rpcServices;
     appInfoList.push_back(appInfo);
   }
+  std::vector<HalClientId> clientIds =
+      mNanoappListCache.onResponse(appInfoList);
+  if (clientIds.empty()) {
+    // Not a response to a request sent by the cache.
+    clientIds.push_back(clientId);
+  }
+  deliverNanoappList(clientIds, appInfoList);
+}
+
+void MultiClientContextHubBase::deliverNanoappList(
+    const std::vector<HalClientId> &clientIds,
+    const std::vector<NanoappInfo> &appInfoList) {
   {
     std::unique_lock<std::mutex> lock(mTestModeMutex);
     if (!mTestModeNanoapps.has_value()) {
@@ -603,7 +641,12 @@ void MultiClientContextHubBase::onNanoappListResponse(
     }
   }
 
-  callback->handleNanoappInfo(appInfoList);
+  for (HalClientId clientId : clientIds) {
+    if (auto callback = mHalClientManager->getCallback(clientId);
+        callback != nullptr) {
+      callback->handleNanoappInfo(appInfoList);
+    }
+  }
 }
 
 void MultiClientContextHubBase::onNanoappLoadResponse(
@@ -611,6 +654,8 @@ void MultiClientContextHubBase::onNanoappLoadResponse(
   LOGD("Received nanoapp load response for client %" PRIu16
        " transaction %" PRIu32 " fragment %" PRIu32,
        clientId, response.transaction_id, response.fragment_id);
+  // Any fragment may have changed the loaded nanoapps, even a failed one.
+  mNanoappListCache.invalidate();
   if (mPreloadedNanoappLoader->isPreloadOngoing()) {
     mPreloadedNanoappLoader->onLoadNanoappResponse(response, clientId);
     return;
@@ -655,6 +700,7 @@ void MultiClientContextHubBase::onNanoappLoadResponse(
 
 void MultiClientContextHubBase::onNanoappUnloadResponse(
     const fbs::UnloadNanoappResponseT &response, HalClientId clientId) {
+  mNanoappListCache.invalidate();
   if (mHalClientManager->resetPendingUnloadTransaction(
           clientId, response.transaction_id)) {
     {
@@ -721,6 +767,11 @@ void MultiClientContextHubBase::handleClientDeath(pid_t clientPid) {
 
 void MultiClientContextHubBase::onChreRestarted() {
   mIsWifiAvailable.reset();
+  mNanoappListCache.invalidate();
+  {
+    std::lock_guard<std::mutex> lock(mTimeSyncMutex);
+    mTimeSyncEstimator.reset();
+  }
   mEventLogger.logContextHubRestart();
   mHalClientManager->handleChreRestart();
 }
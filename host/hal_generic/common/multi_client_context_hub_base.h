@@ -28,6 +28,7 @@
 #include "event_logger.h"
 #include "hal_client_id.h"
 #include "hal_client_manager.h"
+#include "nanoapp_list_cache.h"
 
 namespace android::hardware::contexthub::common::implementation {
 
@@ -107,14 +108,22 @@ class MultiClientContextHubBase
 
   void tryTimeSync(size_t numOfRetries, useconds_t retryDelayUs) {
     if (mConnection->isTimeSyncNeeded()) {
+      std::lock_guard<std::mutex> lock(mTimeSyncMutex);
       TimeSyncer::sendTimeSyncWithRetry(mConnection.get(), numOfRetries,
-                                        retryDelayUs);
+                                        retryDelayUs, &mTimeSyncEstimator);
     }
   }
 
   bool sendFragmentedLoadRequest(HalClientId clientId,
                                  FragmentedLoadRequest &fragmentedLoadRequest);
 
+  // Sends a NanoappListRequest whose response is addressed to clientId.
+  bool sendNanoappListRequest(HalClientId clientId);
+
+  // Delivers a nanoapp list to the clients who queried it.
+  void deliverNanoappList(const std::vector<HalClientId> &clientIds,
+                          const std::vector<NanoappInfo> &appInfoList);
+
   // Functions handling various types of messages
   void handleHubInfoResponse(const ::chre::fbs::HubInfoResponseT &message);
   void onNanoappListResponse(const ::chre::fbs::NanoappListResponseT &response,
@@ -163,6 +172,16 @@ class MultiClientContextHubBase
   std::optional<bool> mIsWifiAvailable;
   std::optional<bool> mIsBleAvailable;
 
+  // Serves the nanoapp queries from the last list reported by CHRE, which is
+  // invalidated by the nanoapp load/unload responses and CHRE restarts.
+  NanoappListCache mNanoappListCache{[this](HalClientId clientId) {
+    return sendNanoappListRequest(clientId);
+  }};
+
+  // Estimates the drift of the time offset sent to CHRE across time syncs.
+  std::mutex mTimeSyncMutex;
+  TimeSyncEstimator mTimeSyncEstimator;
+
   // A mutex to synchronize access to the list of preloaded nanoapp IDs.
   std::mutex mPreloadedNanoappIdsMutex;
   std::optional<std::vector<uint64_t>> mPreloadedNanoappIds{};
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "nanoapp_list_cache.h"
+
+#include <algorithm>
+#include <cinttypes>
+
+#include "chre_host/log.h"
+
+namespace android::hardware::contexthub::common::implementation {
+
+NanoappListCache::Result NanoappListCache::query(
+    HalClientId clientId, std::vector<NanoappInfo> *nanoapps) {
+  std::lock_guard<std::mutex> lock(mLock);
+  if (mNanoapps.has_value() && Clock::now() - mCachedTime > mMaxAge) {
+    LOGD("Cached nanoapp list of version %" PRIu64 " expired", mVersion);
+    mNanoapps.reset();
+  }
+  if (mNanoapps.has_value()) {
+    mStats.hits++;
+    *nanoapps = *mNanoapps;
+    return Result::CACHED;
+  }
+
+  if (mPendingRequest.has_value()) {
+    if (Clock::now() - mPendingRequest->sentTime > mRequestTimeout) {
+      LOGW("Nanoapp list request sent for version %" PRIu64
+           " timed out. Sending a new one",
+           mPendingRequest->version);
+      std::vector<HalClientId> waiters = std::move(mPendingRequest->waiters);
+      for (HalClientId waiter : mNextWaiters) {
+        addWaiter(waiters, waiter);
+      }
+      addWaiter(waiters, clientId);
+      mNextWaiters.clear();
+      mPendingRequest.reset();
+      return sendRequestLocked(std::move(waiters), /* cacheable= */ false,
+                               clientId)
+                 ? Result::PENDING
+                 : Result::SEND_FAILED;
+    }
+    mStats.coalesced++;
+    addWaiter(mPendingRequest->version == mVersion ? mPendingRequest->waiters
+                                                   : mNextWaiters,
+              clientId);
+    return Result::PENDING;
+  }
+
+  // The clients queued after a failed request are sent for again.
+  std::vector<HalClientId> waiters = std::move(mNextWaiters);
+  mNextWaiters.clear();
+  addWaiter(waiters, clientId);
+  return sendRequestLocked(std::move(waiters), mNextRequestCacheable, clientId)
+             ? Result::PENDING
+             : Result::SEND_FAILED;
+}
+
+std::vector<HalClientId> NanoappListCache::onResponse(
+    const std::vector<NanoappInfo> &nanoapps) {
+  std::lock_guard<std::mutex> lock(mLock);
+  if (!mPendingRequest.has_value()) {
+    return {};
+  }
+  if (mPendingRequest->cacheable && mPendingRequest->version == mVersion) {
+    mNanoapps = nanoapps;
+    mCachedTime = Clock::now();
+  }
+  std::vector<HalClientId> waiters = std::move(mPendingRequest->waiters);
+  mPendingRequest.reset();
+
+  if (!mNextWaiters.empty()) {
+    std::vector<HalClientId> nextWaiters = std::move(mNextWaiters);
+    mNextWaiters.clear();
+    if (!sendRequestLocked(std::move(nextWaiters), /* cacheable= */ true,
+                           /* clientId= */ std::nullopt)) {
+      LOGE("Failed to send the nanoapp list request for version %" PRIu64
+           ". Retrying on the next query",
+           mVersion);
+    }
+  }
+  return waiters;
+}
+
+void NanoappListCache::invalidate() {
+  std::lock_guard<std::mutex> lock(mLock);
+  mVersion++;
+  mNanoapps.reset();
+}
+
+bool NanoappListCache::sendRequestLocked(std::vector<HalClientId> &&waiters,
+                                         bool cacheable,
+                                         std::optional<HalClientId> clientId) {
+  mStats.requests++;
+  // The response is addressed to the first waiter. The others are routed to
+  // by the cache.
+  if (!mSender(waiters.front())) {
+    for (HalClientId waiter : waiters) {
+      if (waiter != clientId) {
+        addWaiter(mNextWaiters, waiter);
+      }
+    }
+    mNextRequestCacheable = mNextRequestCacheable && cacheable;
+    return false;
+  }
+  mNextRequestCacheable = true;
+  mPendingRequest = Request{
+      .version = mVersion,
+      .sentTime = Clock::now(),
+      .waiters = std::move(waiters),
+      .cacheable = cacheable,
+  };
+  return true;
+}
+
+void NanoappListCache::addWaiter(std::vector<HalClientId> &waiters,
+                                 HalClientId clientId) {
+  if (std::find(waiters.begin(), waiters.end(), clientId) == waiters.end()) {
+    waiters.push_back(clientId);
+  }
+}
+
+}  // namespace android::hardware::contexthub::common::implementation
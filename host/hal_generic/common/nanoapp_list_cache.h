@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_HARDWARE_CONTEXTHUB_COMMON_NANOAPP_LIST_CACHE_H_
+#define ANDROID_HARDWARE_CONTEXTHUB_COMMON_NANOAPP_LIST_CACHE_H_
+
+#include "hal_client_id.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <aidl/android/hardware/contexthub/IContextHub.h>
+
+namespace android::hardware::contexthub::common::implementation {
+
+using aidl::android::hardware::contexthub::NanoappInfo;
+
+/**
+ * A versioned cache of the nanoapp list reported by CHRE.
+ *
+ * Queries are answered from the cached list when it is valid. Otherwise at
+ * most one NanoappListRequest is in flight at a time, and the clients querying
+ * while it is pending are answered by its response.
+ *
+ * Every event changing the set of loaded nanoapps, i.e. a load/unload response
+ * or a CHRE restart, must call invalidate(), which bumps the version of the
+ * cache. A response is only cached if the version didn't change since its
+ * request was sent, as it may not reflect the change otherwise. The clients
+ * querying after an invalidation while a request is still in flight wait for a
+ * new request, sent once the pending one is answered.
+ *
+ * A request unanswered for requestTimeout is considered lost, e.g. because
+ * CHRE restarted, and the next query sends a new one for all its waiters.
+ *
+ * If a request for other clients than the querying one can't be sent, these
+ * clients stay queued and the next query sends a request for them too.
+ *
+ * CHRE doesn't notify the host of every change of the loaded nanoapps, e.g.
+ * when a nanoapp aborts, so the cached list also expires after maxAge.
+ *
+ * This class is thread-safe. The requests are sent while holding its lock so
+ * that their order matches the order of the responses.
+ */
+class NanoappListCache {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * Sends a NanoappListRequest on behalf of a client.
+   *
+   * @return true if the request is sent.
+   */
+  using RequestSender = std::function<bool(HalClientId clientId)>;
+
+  static constexpr auto kRequestTimeout = std::chrono::seconds(5);
+  static constexpr auto kDefaultMaxAge = std::chrono::seconds(60);
+
+  enum class Result {
+    //! The query is answered from the cache.
+    CACHED,
+    //! The client is answered when the pending request gets its response.
+    PENDING,
+    //! The request could not be sent.
+    SEND_FAILED,
+  };
+
+  explicit NanoappListCache(RequestSender sender,
+                            Clock::duration maxAge = kDefaultMaxAge,
+                            Clock::duration requestTimeout = kRequestTimeout)
+      : mSender(std::move(sender)),
+        mMaxAge(maxAge),
+        mRequestTimeout(requestTimeout) {}
+
+  /**
+   * Queries the nanoapp list for a client.
+   *
+   * @param clientId the client querying the list.
+   * @param nanoapps filled with the cached list if the result is CACHED.
+   *
+   * @return SEND_FAILED if the request can't be sent. Only the querying
+   * client must be told, the other clients it was sent for stay queued.
+   */
+  Result query(HalClientId clientId, std::vector<NanoappInfo> *nanoapps);
+
+  /**
+   * Handles a NanoappListResponse from CHRE.
+   *
+   * @return the clients waiting for the response, or an empty vector if it
+   * doesn't answer a request sent by the cache.
+   */
+  std::vector<HalClientId> onResponse(const std::vector<NanoappInfo> &nanoapps);
+
+  /** Discards the cached list as the loaded nanoapps changed. */
+  void invalidate();
+
+  uint64_t getVersion() {
+    std::lock_guard<std::mutex> lock(mLock);
+    return mVersion;
+  }
+
+  /** The counters of how the queries are served. */
+  struct Stats {
+    size_t hits = 0;
+    size_t coalesced = 0;
+    size_t requests = 0;
+  };
+
+  Stats getStats() {
+    std::lock_guard<std::mutex> lock(mLock);
+    return mStats;
+  }
+
+ private:
+  struct Request {
+    //! The version of the cache when the request was sent.
+    uint64_t version;
+    Clock::time_point sentTime;
+    std::vector<HalClientId> waiters;
+
+    //! False if the request replaces a lost one, whose response may still
+    //! arrive late and be taken for the response to this one.
+    bool cacheable;
+  };
+
+  /**
+   * Sends a request for the waiters, or queues them for the next one if it
+   * can't be sent. Must be called with mLock held.
+   *
+   * @param clientId the querying client, which isn't queued as it is told
+   *        about the failure, or nullopt if there is none.
+   */
+  bool sendRequestLocked(std::vector<HalClientId> &&waiters, bool cacheable,
+                         std::optional<HalClientId> clientId);
+
+  static void addWaiter(std::vector<HalClientId> &waiters,
+                        HalClientId clientId);
+
+  RequestSender mSender;
+  const Clock::duration mMaxAge;
+  const Clock::duration mRequestTimeout;
+
+  std::mutex mLock;
+  uint64_t mVersion = 0;
+  std::optional<std::vector<NanoappInfo>> mNanoapps;
+  Clock::time_point mCachedTime;
+  std::optional<Request> mPendingRequest;
+
+  //! The clients waiting for the request sent after the pending one, or by
+  //! the next query if there is none.
+  std::vector<HalClientId> mNextWaiters;
+
+  //! False if the next request replaces a lost one, see Request::cacheable.
+  bool mNextRequestCacheable = true;
+
+  Stats mStats;
+};
+
+}  // namespace android::hardware::contexthub::common::implementation
+
+#endif  // ANDROID_HARDWARE_CONTEXTHUB_COMMON_NANOAPP_LIST_CACHE_H_
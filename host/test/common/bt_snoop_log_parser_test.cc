@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre_host/bt_snoop_log_parser.h"
+
+#include <arpa/inet.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace android::chre {
+
+namespace {
+
+//! Size of the btsnoop file header and of each packet record header.
+constexpr size_t kFileHeaderSize = 16;
+constexpr size_t kRecordHeaderSize = 25;
+
+//! Flag set on the packets received from the controller.
+constexpr uint32_t kIncomingFlag = 0x1;
+
+//! A packet as stored in a btsnoop file.
+struct Record {
+  bool incoming;
+  uint32_t droppedPackets;
+  std::vector<uint8_t> payload;
+};
+
+uint32_t readBigEndian32(const uint8_t *data) {
+  uint32_t value;
+  memcpy(&value, data, sizeof(value));
+  return ntohl(value);
+}
+
+//! Reads the packets of a btsnoop file, without the packet type byte.
+std::vector<Record> readCapture(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+  std::vector<Record> records;
+  size_t offset = kFileHeaderSize;
+  while (offset + kRecordHeaderSize <= data.size()) {
+    const uint8_t *header = &data[offset];
+    uint32_t length = readBigEndian32(header);
+    offset += kRecordHeaderSize;
+    if (length == 0 || offset + length - 1 > data.size()) {
+      ADD_FAILURE() << "Truncated record in " << path;
+      break;
+    }
+    records.push_back({
+        .incoming = (readBigEndian32(header + 8) & kIncomingFlag) != 0,
+        .droppedPackets = readBigEndian32(header + 12),
+        .payload = std::vector<uint8_t>(&data[offset],
+                                        &data[offset] + length - 1),
+    });
+    offset += length - 1;
+  }
+  return records;
+}
+
+/**
+ * @return A synthetic capture of BLE scanning: mostly advertising report
+ * events, each payload starting with its 32-bit index in the capture.
+ */
+std::vector<Record> makeScanCapture(size_t numPackets) {
+  std::vector<Record> capture;
+  for (uint32_t i = 0; i < numPackets; i++) {
+    bool incoming = (i % 16) != 0;
+    std::vector<uint8_t> payload(incoming ? 40 + (i % 200) : 12);
+    memcpy(payload.data(), &i, sizeof(i));
+    for (size_t j = sizeof(i); j < payload.size(); j++) {
+      payload[j] = static_cast<uint8_t>(i + j);
+    }
+    capture.push_back({incoming, 0, std::move(payload)});
+  }
+  return capture;
+}
+
+uint32_t getIndex(const Record &record) {
+  uint32_t index;
+  memcpy(&index, record.payload.data(), sizeof(index));
+  return index;
+}
+
+//! Logs a packet the way LogMessageParser hands it to the parser.
+void logPacket(BtSnoopLogParser &parser, const Record &record) {
+  std::vector<char> message(2 + record.payload.size());
+  message[0] = static_cast<char>(
+      record.incoming ? BtSnoopDirection::INCOMING_FROM_BT_CONTROLLER
+                      : BtSnoopDirection::OUTGOING_TO_ARBITER);
+  message[1] = static_cast<char>(record.payload.size());
+  memcpy(&message[2], record.payload.data(), record.payload.size());
+  EXPECT_EQ(parser.log(message.data()), message.size());
+}
+
+class BtSnoopLogParserTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    mFilePath = ::testing::TempDir() + "chre_btsnoop_test.log";
+    std::remove(mFilePath.c_str());
+    std::remove((mFilePath + ".last").c_str());
+  }
+
+  void TearDown() override {
+    std::remove(mFilePath.c_str());
+    std::remove((mFilePath + ".last").c_str());
+  }
+
+  std::string mFilePath;
+};
+
+}  // namespace
+
+TEST_F(BtSnoopLogParserTest, RotatesFilesWithoutLosingPackets) {
+  constexpr uint32_t kMaxPacketsPerFile = 10;
+  std::vector<Record> capture = makeScanCapture(25);
+
+  BtSnoopLogParser parser(mFilePath, kMaxPacketsPerFile, 64 * 1024);
+  for (const Record &record : capture) {
+    logPacket(parser, record);
+  }
+  parser.flush();
+
+  std::vector<Record> last = readCapture(mFilePath + ".last");
+  std::vector<Record> current = readCapture(mFilePath);
+  ASSERT_EQ(last.size(), kMaxPacketsPerFile);
+  ASSERT_EQ(current.size(), 5);
+  EXPECT_EQ(getIndex(last.front()), 10);
+  EXPECT_EQ(getIndex(current.front()), 20);
+  EXPECT_EQ(current.back().payload, capture.back().payload);
+  EXPECT_EQ(current.back().incoming, capture.back().incoming);
+  EXPECT_EQ(parser.getDroppedPacketCount(), 0);
+}
+
+TEST_F(BtSnoopLogParserTest, ReportsPacketsDroppedWhenWriterFallsBehind) {
+  constexpr size_t kNumPackets = 2000;
+  std::vector<Record> capture = makeScanCapture(kNumPackets + 1);
+
+  // Each buffer only fits one packet, so the parser outpaces the writer.
+  BtSnoopLogParser parser(mFilePath, UINT32_MAX, kRecordHeaderSize + 255);
+  for (size_t i = 0; i < kNumPackets; i++) {
+    logPacket(parser, capture[i]);
+  }
+  parser.flush();
+
+  // Nothing is pending once flushed, so the next packet is always written and
+  // carries the total.
+  uint32_t droppedPackets = parser.getDroppedPacketCount();
+  logPacket(parser, capture.back());
+  parser.flush();
+
+  std::vector<Record> records = readCapture(mFilePath);
+  ASSERT_EQ(records.size() + droppedPackets, kNumPackets + 1);
+  for (size_t i = 0; i < records.size(); i++) {
+    // Every packet not in the file before this one was reported as dropped.
+    EXPECT_EQ(records[i].droppedPackets, getIndex(records[i]) - i);
+  }
+  EXPECT_EQ(records.back().droppedPackets, droppedPackets);
+}
+
+TEST_F(BtSnoopLogParserTest, ReplaysCaptureInOrder) {
+  std::vector<Record> capture = makeScanCapture(1000);
+
+  BtSnoopLogParser parser(mFilePath, UINT32_MAX, 64 * 1024);
+  for (const Record &record : capture) {
+    logPacket(parser, record);
+  }
+  parser.flush();
+
+  std::vector<Record> records = readCapture(mFilePath);
+  ASSERT_EQ(records.size() + parser.getDroppedPacketCount(), capture.size());
+  uint32_t previousIndex = 0;
+  for (size_t i = 0; i < records.size(); i++) {
+    uint32_t index = getIndex(records[i]);
+    ASSERT_LT(index, capture.size());
+    if (i > 0) {
+      EXPECT_GT(index, previousIndex);
+    }
+    EXPECT_EQ(records[i].payload, capture[index].payload);
+    EXPECT_EQ(records[i].incoming, capture[index].incoming);
+    previousIndex = index;
+  }
+}
+
+}  // namespace android::chre
@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre_host/host_protocol_host.h"
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace android::chre {
+
+namespace {
+
+using ::chre::HostProtocolCommon;
+using ::chre::fbs::NanoappMessageT;
+
+constexpr uint64_t kAppId = 0x0123456789abcdef;
+constexpr uint32_t kMessageType = 0x87654321;
+constexpr uint16_t kHostEndpoint = 0x1234;
+constexpr uint32_t kPermissions = 0x5;
+constexpr uint32_t kMessagePermissions = 0x4;
+
+class NanoappMessageHandler : public IChreMessageHandlers {
+ public:
+  void handleNanoappMessage(const NanoappMessageT &message) override {
+    mMessage = message;
+  }
+
+  std::optional<NanoappMessageT> mMessage;
+};
+
+std::vector<uint8_t> makePayload(size_t size) {
+  std::vector<uint8_t> payload(size);
+  for (size_t i = 0; i < size; i++) {
+    payload[i] = static_cast<uint8_t>(i * 7 + 3);
+  }
+  return payload;
+}
+
+std::optional<NanoappMessageT> decode(const void *message, size_t messageLen) {
+  NanoappMessageHandler handler;
+  if (!HostProtocolHost::decodeMessageFromChre(message, messageLen, handler)) {
+    return std::nullopt;
+  }
+  return handler.mMessage;
+}
+
+std::optional<NanoappMessageT> encodeInPlaceAndDecode(
+    const std::vector<uint8_t> &payload, bool wokeHost) {
+  alignas(8) uint8_t buffer[HostProtocolCommon::kNanoappMessagePayloadOffset +
+                            256];
+  size_t size = HostProtocolCommon::encodeNanoappMessageInPlace(
+      buffer, sizeof(buffer), kAppId, kMessageType, kHostEndpoint,
+      payload.data(), payload.size(), kPermissions, kMessagePermissions,
+      wokeHost);
+  EXPECT_EQ(size,
+            HostProtocolCommon::kNanoappMessagePayloadOffset + payload.size());
+  return decode(buffer, size);
+}
+
+void expectMessage(const std::optional<NanoappMessageT> &message,
+                   const std::vector<uint8_t> &payload, bool wokeHost) {
+  ASSERT_TRUE(message.has_value());
+  EXPECT_EQ(message->app_id, kAppId);
+  EXPECT_EQ(message->message_type, kMessageType);
+  EXPECT_EQ(message->host_endpoint, kHostEndpoint);
+  EXPECT_EQ(message->message, payload);
+  EXPECT_EQ(message->permissions, kPermissions);
+  EXPECT_EQ(message->message_permissions, kMessagePermissions);
+  EXPECT_EQ(message->woke_host, wokeHost);
+}
+
+}  // namespace
+
+TEST(HostProtocolHostTest, InPlaceNanoappMessageRoundTrips) {
+  for (size_t size : {0, 1, 3, 8, 255}) {
+    std::vector<uint8_t> payload = makePayload(size);
+    expectMessage(encodeInPlaceAndDecode(payload, /* wokeHost= */ false),
+                  payload, /* wokeHost= */ false);
+    expectMessage(encodeInPlaceAndDecode(payload, /* wokeHost= */ true),
+                  payload, /* wokeHost= */ true);
+  }
+}
+
+TEST(HostProtocolHostTest, InPlaceNanoappMessageMatchesBuilderEncoding) {
+  std::vector<uint8_t> payload = makePayload(100);
+
+  flatbuffers::FlatBufferBuilder builder;
+  HostProtocolCommon::encodeNanoappMessage(
+      builder, kAppId, kMessageType, kHostEndpoint, payload.data(),
+      payload.size(), kPermissions, kMessagePermissions, /* wokeHost= */ true);
+  std::optional<NanoappMessageT> expected =
+      decode(builder.GetBufferPointer(), builder.GetSize());
+  ASSERT_TRUE(expected.has_value());
+
+  std::optional<NanoappMessageT> actual =
+      encodeInPlaceAndDecode(payload, /* wokeHost= */ true);
+  ASSERT_TRUE(actual.has_value());
+  EXPECT_EQ(actual->app_id, expected->app_id);
+  EXPECT_EQ(actual->message_type, expected->message_type);
+  EXPECT_EQ(actual->host_endpoint, expected->host_endpoint);
+  EXPECT_EQ(actual->message, expected->message);
+  EXPECT_EQ(actual->permissions, expected->permissions);
+  EXPECT_EQ(actual->message_permissions, expected->message_permissions);
+  EXPECT_EQ(actual->woke_host, expected->woke_host);
+}
+
+TEST(HostProtocolHostTest, InPlaceNanoappMessageCanBeFilledAfterEncoding) {
+  std::vector<uint8_t> payload = makePayload(32);
+  alignas(8) uint8_t buffer[HostProtocolCommon::kNanoappMessagePayloadOffset +
+                            32];
+
+  size_t size = HostProtocolCommon::encodeNanoappMessageInPlace(
+      buffer, sizeof(buffer), kAppId, kMessageType, kHostEndpoint,
+      /* messageData= */ nullptr, payload.size(), kPermissions,
+      kMessagePermissions);
+  ASSERT_EQ(size, sizeof(buffer));
+  memcpy(&buffer[HostProtocolCommon::kNanoappMessagePayloadOffset],
+         payload.data(), payload.size());
+
+  expectMessage(decode(buffer, size), payload, /* wokeHost= */ false);
+}
+
+TEST(HostProtocolHostTest, InPlaceNanoappMessageHostClientIdIsMutable) {
+  constexpr uint16_t kHostClientId = 42;
+  std::vector<uint8_t> payload = makePayload(16);
+  alignas(8) uint8_t buffer[HostProtocolCommon::kNanoappMessagePayloadOffset +
+                            16];
+  size_t size = HostProtocolCommon::encodeNanoappMessageInPlace(
+      buffer, sizeof(buffer), kAppId, kMessageType, kHostEndpoint,
+      payload.data(), payload.size());
+
+  uint16_t hostClientId;
+  ::chre::fbs::ChreMessage messageType;
+  ASSERT_TRUE(HostProtocolHost::extractHostClientIdAndType(
+      buffer, size, &hostClientId, &messageType));
+  EXPECT_EQ(hostClientId, ::chre::kHostClientIdUnspecified);
+  EXPECT_EQ(messageType, ::chre::fbs::ChreMessage::NanoappMessage);
+
+  ASSERT_TRUE(
+      HostProtocolHost::mutateHostClientId(buffer, size, kHostClientId));
+  ASSERT_TRUE(HostProtocolHost::extractHostClientIdAndType(
+      buffer, size, &hostClientId, &messageType));
+  EXPECT_EQ(hostClientId, kHostClientId);
+}
+
+TEST(HostProtocolHostTest, InPlaceNanoappMessageFailsIfBufferIsTooSmall) {
+  std::vector<uint8_t> payload = makePayload(16);
+  alignas(8) uint8_t buffer[HostProtocolCommon::kNanoappMessagePayloadOffset +
+                            16];
+
+  EXPECT_EQ(HostProtocolCommon::encodeNanoappMessageInPlace(
+                buffer, sizeof(buffer) - 1, kAppId, kMessageType,
+                kHostEndpoint, payload.data(), payload.size()),
+            0);
+  EXPECT_EQ(HostProtocolCommon::encodeNanoappMessageInPlace(
+                buffer, HostProtocolCommon::kNanoappMessagePayloadOffset - 1,
+                kAppId, kMessageType, kHostEndpoint, nullptr, 0),
+            0);
+}
+
+}  // namespace android::chre
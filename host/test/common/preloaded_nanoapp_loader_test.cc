@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre_host/preloaded_nanoapp_loader.h"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace android::chre {
+
+namespace {
+
+using ::testing::ElementsAre;
+
+constexpr uint32_t kNanoappHeaderMagic = 0x4f4e414e;
+constexpr uint64_t kBaseAppId = 0x476f6f676c000000;
+
+/**
+ * A connection answering each load fragment from a CHRE thread after a delay,
+ * recording the ids of the nanoapps loaded.
+ */
+class FakeChreConnection : public ChreConnection {
+ public:
+  explicit FakeChreConnection(std::chrono::microseconds fragmentDelay)
+      : mFragmentDelay(fragmentDelay),
+        mChreThread([this]() { handleRequests(); }) {}
+
+  ~FakeChreConnection() override {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStopped = true;
+    }
+    mCondVar.notify_all();
+    mChreThread.join();
+  }
+
+  void setLoader(PreloadedNanoappLoader *loader) {
+    mLoader = loader;
+  }
+
+  bool init() override {
+    return true;
+  }
+
+  bool sendMessage(void *data, size_t /* length */) override {
+    const auto *container = ::chre::fbs::GetMessageContainer(data);
+    const auto *request = container->message_as_LoadNanoappRequest();
+    if (request == nullptr) {
+      return false;
+    }
+    ::chre::fbs::LoadNanoappResponseT response;
+    response.transaction_id = request->transaction_id();
+    response.fragment_id = request->fragment_id();
+    response.success = true;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (request->fragment_id() <= 1) {
+      mLoadedAppIds.push_back(request->app_id());
+    }
+    mResponses.push_back(response);
+    mCondVar.notify_all();
+    return true;
+  }
+
+  std::vector<uint64_t> getLoadedAppIds() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mLoadedAppIds;
+  }
+
+ private:
+  void handleRequests() {
+    while (true) {
+      ::chre::fbs::LoadNanoappResponseT response;
+      {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCondVar.wait(lock,
+                      [this]() { return mStopped || !mResponses.empty(); });
+        if (mStopped) {
+          return;
+        }
+        response = mResponses.front();
+        mResponses.pop_front();
+      }
+      std::this_thread::sleep_for(mFragmentDelay);
+      mLoader->onLoadNanoappResponse(response, kHalId);
+    }
+  }
+
+  std::chrono::microseconds mFragmentDelay;
+  PreloadedNanoappLoader *mLoader = nullptr;
+
+  std::mutex mMutex;
+  std::condition_variable mCondVar;
+  std::deque<::chre::fbs::LoadNanoappResponseT> mResponses;
+  std::vector<uint64_t> mLoadedAppIds;
+  bool mStopped = false;
+  std::thread mChreThread;
+};
+
+class PreloadedNanoappLoaderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    mDirectory = std::filesystem::temp_directory_path() /
+                 ("preloaded_nanoapp_loader_test_" + std::to_string(getpid()));
+    std::filesystem::create_directories(mDirectory);
+  }
+
+  void TearDown() override {
+    std::filesystem::remove_all(mDirectory);
+  }
+
+  void writeNanoapp(const std::string &name, uint64_t appId,
+                    size_t binarySize,
+                    uint32_t magic = kNanoappHeaderMagic) {
+    NanoAppBinaryHeader header{};
+    header.headerVersion = 1;
+    header.magic = magic;
+    header.appId = appId;
+    header.appVersion = 1;
+    header.targetChreApiMajorVersion = 1;
+    header.targetChreApiMinorVersion = 9;
+    std::ofstream headerFile(mDirectory / (name + ".napp_header"),
+                             std::ios::binary);
+    headerFile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    std::vector<char> binary(binarySize, static_cast<char>(appId));
+    std::ofstream binaryFile(mDirectory / (name + ".so"), std::ios::binary);
+    binaryFile.write(binary.data(), binary.size());
+  }
+
+  /** Writes the config listing the nanoapps, with an optional priority map. */
+  std::string writeConfig(const std::vector<std::string> &names,
+                          const std::string &priorities = "") {
+    std::string config =
+        "{\"source_dir\": \"" + mDirectory.string() + "\", \"nanoapps\": [";
+    for (size_t i = 0; i < names.size(); i++) {
+      config += (i > 0 ? ", \"" : "\"") + names[i] + "\"";
+    }
+    config += "]";
+    if (!priorities.empty()) {
+      config += ", \"priorities\": " + priorities;
+    }
+    config += "}";
+    std::filesystem::path configPath = mDirectory / "preloaded_nanoapps.json";
+    std::ofstream(configPath) << config;
+    return configPath.string();
+  }
+
+  std::filesystem::path mDirectory;
+};
+
+}  // namespace
+
+TEST_F(PreloadedNanoappLoaderTest, LoadsNanoappsByPriority) {
+  writeNanoapp("a", kBaseAppId + 1, /* binarySize= */ 1000);
+  writeNanoapp("b", kBaseAppId + 2, /* binarySize= */ 1000);
+  writeNanoapp("c", kBaseAppId + 3, /* binarySize= */ 1000);
+  writeNanoapp("d", kBaseAppId + 4, /* binarySize= */ 1000);
+  std::string configPath =
+      writeConfig({"a", "b", "c", "d"}, R"({"c": 10, "b": 5, "d": 5})");
+
+  FakeChreConnection connection(std::chrono::microseconds(0));
+  PreloadedNanoappLoader loader(&connection, configPath);
+  connection.setLoader(&loader);
+
+  EXPECT_TRUE(loader.loadPreloadedNanoapps());
+  EXPECT_THAT(connection.getLoadedAppIds(),
+              ElementsAre(kBaseAppId + 3, kBaseAppId + 2, kBaseAppId + 4,
+                          kBaseAppId + 1));
+}
+
+TEST_F(PreloadedNanoappLoaderTest, InvalidNanoappDoesNotStopTheOthers) {
+  writeNanoapp("a", kBaseAppId + 1, /* binarySize= */ 1000);
+  writeNanoapp("bad_magic", kBaseAppId + 2, /* binarySize= */ 1000,
+               /* magic= */ 0x12345678);
+  writeNanoapp("empty", kBaseAppId + 3, /* binarySize= */ 0);
+  writeNanoapp("d", kBaseAppId + 4, /* binarySize= */ 1000);
+  std::string configPath =
+      writeConfig({"a", "bad_magic", "missing", "empty", "d"});
+
+  FakeChreConnection connection(std::chrono::microseconds(0));
+  PreloadedNanoappLoader loader(&connection, configPath);
+  connection.setLoader(&loader);
+
+  EXPECT_FALSE(loader.loadPreloadedNanoapps());
+  EXPECT_THAT(connection.getLoadedAppIds(),
+              ElementsAre(kBaseAppId + 1, kBaseAppId + 4));
+
+  std::vector<PreloadedNanoappLoader::NanoappLoadTiming> timings =
+      loader.getLastPreloadTimings();
+  ASSERT_EQ(timings.size(), 5);
+  EXPECT_TRUE(timings[0].success);
+  EXPECT_FALSE(timings[1].success);
+  EXPECT_FALSE(timings[2].success);
+  EXPECT_FALSE(timings[3].success);
+  EXPECT_TRUE(timings[4].success);
+}
+
+TEST_F(PreloadedNanoappLoaderTest, SelectedNanoappsOnly) {
+  writeNanoapp("a", kBaseAppId + 1, /* binarySize= */ 1000);
+  writeNanoapp("b", kBaseAppId + 2, /* binarySize= */ 1000);
+  std::string configPath = writeConfig({"a", "b"});
+
+  FakeChreConnection connection(std::chrono::microseconds(0));
+  PreloadedNanoappLoader loader(&connection, configPath);
+  connection.setLoader(&loader);
+
+  EXPECT_TRUE(loader.loadPreloadedNanoapps(
+      std::unordered_set<uint64_t>{kBaseAppId + 2}));
+  EXPECT_THAT(connection.getLoadedAppIds(), ElementsAre(kBaseAppId + 2));
+  EXPECT_EQ(loader.getLastPreloadTimings().size(), 1);
+}
+
+TEST_F(PreloadedNanoappLoaderTest, PrefetchOverlapsLoading) {
+  constexpr size_t kNumOfNanoapps = 6;
+  constexpr size_t kBinarySize = 4 * CHRE_HOST_DEFAULT_FRAGMENT_SIZE;
+  std::vector<std::string> names;
+  for (size_t i = 0; i < kNumOfNanoapps; i++) {
+    names.push_back("nanoapp_" + std::to_string(i));
+    writeNanoapp(names.back(), kBaseAppId + i, kBinarySize);
+  }
+  std::string configPath = writeConfig(names);
+
+  FakeChreConnection connection(std::chrono::milliseconds(5));
+  PreloadedNanoappLoader loader(&connection, configPath);
+  connection.setLoader(&loader);
+
+  EXPECT_TRUE(loader.loadPreloadedNanoapps());
+  std::vector<PreloadedNanoappLoader::NanoappLoadTiming> timings =
+      loader.getLastPreloadTimings();
+  ASSERT_EQ(timings.size(), kNumOfNanoapps);
+
+  // Except for the first nanoapp, the files are read while CHRE loads the
+  // previous one, so the loading doesn't wait for them.
+  std::chrono::microseconds prefetch(0);
+  std::chrono::microseconds stall(0);
+  std::chrono::microseconds load(0);
+  for (size_t i = 1; i < kNumOfNanoapps; i++) {
+    EXPECT_TRUE(timings[i].success);
+    prefetch += timings[i].prefetch;
+    stall += timings[i].stall;
+    load += timings[i].load;
+  }
+  printf("Preloading %zu nanoapps of %zu bytes: prefetch %lld us, stall %lld "
+         "us, load %lld us\n",
+         kNumOfNanoapps - 1, kBinarySize,
+         static_cast<long long>(prefetch.count()),
+         static_cast<long long>(stall.count()),
+         static_cast<long long>(load.count()));
+  EXPECT_LT(stall, load / 10);
+}
+
+}  // namespace android::chre
@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre_host/time_sync_estimator.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace android::chre {
+
+namespace {
+
+constexpr int64_t kOneSecondInNs = 1000000000;
+constexpr int64_t kOneMinuteInNs = 60 * kOneSecondInNs;
+constexpr int64_t kOneHourInNs = 60 * kOneMinuteInNs;
+constexpr int64_t kOneDayInNs = 24 * kOneHourInNs;
+
+//! The fixed period of the time syncs sending the measured offset only.
+constexpr int64_t kFixedSyncPeriodNs = kOneHourInNs;
+
+//! The max jitter of an offset measurement.
+constexpr int64_t kMaxJitterNs = 20000;
+
+/**
+ * A CHRE clock drifting from the host clock at a rate changing at given host
+ * times, e.g. with the temperature.
+ */
+class DriftingClock {
+ public:
+  DriftingClock(int64_t initialOffsetNs, int64_t driftPpb)
+      : mInitialOffsetNs(initialOffsetNs) {
+    mSegments.push_back({.startNs = 0, .driftPpb = driftPpb});
+  }
+
+  void changeDrift(int64_t hostTimeNs, int64_t driftPpb) {
+    mSegments.push_back({.startNs = hostTimeNs, .driftPpb = driftPpb});
+  }
+
+  /** @return the offset (host time - CHRE time) at a host time. */
+  int64_t getOffset(int64_t hostTimeNs) const {
+    int64_t offsetNs = mInitialOffsetNs;
+    for (size_t i = 0; i < mSegments.size(); i++) {
+      int64_t endNs = (i + 1 < mSegments.size()) ? mSegments[i + 1].startNs
+                                                 : hostTimeNs;
+      endNs = std::min(endNs, hostTimeNs);
+      if (endNs <= mSegments[i].startNs) {
+        break;
+      }
+      offsetNs += (endNs - mSegments[i].startNs) / kOneSecondInNs *
+                      mSegments[i].driftPpb +
+                  (endNs - mSegments[i].startNs) % kOneSecondInNs *
+                      mSegments[i].driftPpb / kOneSecondInNs;
+    }
+    return offsetNs;
+  }
+
+  /** @return the offset at a host time, as measured by a time sync. */
+  int64_t measureOffset(int64_t hostTimeNs) {
+    // A deterministic jitter within [-kMaxJitterNs, kMaxJitterNs].
+    mJitterState = mJitterState * 6364136223846793005ull + 1442695040888963407;
+    int64_t jitterNs =
+        static_cast<int64_t>((mJitterState >> 33) % (2 * kMaxJitterNs + 1)) -
+        kMaxJitterNs;
+    return getOffset(hostTimeNs) + jitterNs;
+  }
+
+ private:
+  struct Segment {
+    int64_t startNs;
+    int64_t driftPpb;
+  };
+
+  int64_t mInitialOffsetNs;
+  std::vector<Segment> mSegments;
+  uint64_t mJitterState = 1;
+};
+
+struct Sync {
+  int64_t hostTimeNs;
+  uint64_t nextSyncDelayNs;
+};
+
+struct SimulationResult {
+  std::vector<Sync> syncs;
+
+  //! The error of the offset extrapolated by CHRE, checked every minute.
+  std::vector<int64_t> errorsNs;
+
+  /** @return the max error between two host times. */
+  int64_t getMaxErrorNs(int64_t fromNs, int64_t toNs) const {
+    int64_t maxErrorNs = 0;
+    for (int64_t t = fromNs; t < toNs; t += kOneMinuteInNs) {
+      maxErrorNs = std::max(maxErrorNs, errorsNs[t / kOneMinuteInNs]);
+    }
+    return maxErrorNs;
+  }
+};
+
+/**
+ * Simulates the time syncs over a duration, with CHRE extrapolating the offset
+ * from the drift it is sent between them.
+ *
+ * @param estimator the estimator of the drift, or nullptr to sync the measured
+ *        offset every kFixedSyncPeriodNs.
+ */
+SimulationResult simulate(DriftingClock &clock, int64_t durationNs,
+                          TimeSyncEstimator *estimator) {
+  SimulationResult result;
+  result.errorsNs.resize(durationNs / kOneMinuteInNs);
+  int64_t syncTimeNs = 0;
+  while (syncTimeNs < durationNs) {
+    TimeSyncEstimator::Estimate estimate = {
+        .offsetNs = clock.measureOffset(syncTimeNs),
+        .driftPpb = 0,
+        .nextSyncDelayNs = kFixedSyncPeriodNs,
+    };
+    if (estimator != nullptr) {
+      estimate = estimator->addSample(syncTimeNs, estimate.offsetNs);
+    }
+    result.syncs.push_back({syncTimeNs, estimate.nextSyncDelayNs});
+
+    int64_t nextSyncTimeNs =
+        std::min<int64_t>(syncTimeNs + estimate.nextSyncDelayNs, durationNs);
+    // Syncs happen on minute boundaries, as the delays are whole minutes.
+    for (int64_t t = syncTimeNs; t < nextSyncTimeNs; t += kOneMinuteInNs) {
+      int64_t extrapolatedNs =
+          estimate.offsetNs + (t - syncTimeNs) / kOneSecondInNs *
+                                  estimate.driftPpb;
+      result.errorsNs[t / kOneMinuteInNs] =
+          std::abs(extrapolatedNs - clock.getOffset(t));
+    }
+    syncTimeNs = nextSyncTimeNs;
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(TimeSyncEstimatorTest, FirstSampleHasNoDrift) {
+  TimeSyncEstimator estimator;
+  TimeSyncEstimator::Estimate estimate =
+      estimator.addSample(kOneHourInNs, 123456);
+
+  EXPECT_EQ(estimate.offsetNs, 123456);
+  EXPECT_EQ(estimate.driftPpb, 0);
+  EXPECT_EQ(estimate.nextSyncDelayNs, TimeSyncEstimator::kMinSyncDelayNs);
+}
+
+TEST(TimeSyncEstimatorTest, CloseSamplesReplaceEachOther) {
+  TimeSyncEstimator estimator;
+  estimator.addSample(kOneHourInNs, 0);
+  TimeSyncEstimator::Estimate estimate =
+      estimator.addSample(kOneHourInNs + 50 * 1000000, 10000);
+
+  EXPECT_EQ(estimator.getSampleCount(), 1);
+  EXPECT_EQ(estimate.offsetNs, 10000);
+  EXPECT_EQ(estimate.driftPpb, 0);
+}
+
+TEST(TimeSyncEstimatorTest, OffsetStepDiscardsSamples) {
+  constexpr int64_t kDriftPpb = 20000;
+  TimeSyncEstimator estimator;
+  for (int64_t i = 0; i < 4; i++) {
+    estimator.addSample(i * kOneHourInNs, i * 3600 * kDriftPpb);
+  }
+  EXPECT_EQ(estimator.getSampleCount(), 4);
+
+  // E.g. CHRE restarted and its clock started over.
+  TimeSyncEstimator::Estimate estimate =
+      estimator.addSample(4 * kOneHourInNs, 1000 * kOneSecondInNs);
+  EXPECT_EQ(estimator.getSampleCount(), 1);
+  EXPECT_EQ(estimate.offsetNs, 1000 * kOneSecondInNs);
+  EXPECT_EQ(estimate.driftPpb, 0);
+  EXPECT_EQ(estimate.nextSyncDelayNs, TimeSyncEstimator::kMinSyncDelayNs);
+}
+
+TEST(TimeSyncEstimatorTest, ConstantDriftBacksOffAndStaysAccurate) {
+  constexpr int64_t kDurationNs = 7 * kOneDayInNs;
+
+  DriftingClock fixedClock(/* initialOffsetNs= */ 5 * kOneSecondInNs,
+                           /* driftPpb= */ 20000);
+  SimulationResult fixed = simulate(fixedClock, kDurationNs, nullptr);
+
+  DriftingClock clock(/* initialOffsetNs= */ 5 * kOneSecondInNs,
+                      /* driftPpb= */ 20000);
+  TimeSyncEstimator estimator;
+  SimulationResult adaptive = simulate(clock, kDurationNs, &estimator);
+
+  int64_t fixedErrorNs = fixed.getMaxErrorNs(kOneDayInNs, kDurationNs);
+  int64_t adaptiveErrorNs = adaptive.getMaxErrorNs(kOneDayInNs, kDurationNs);
+  printf("7 days at 20 ppm: %zu syncs with max error %" PRId64
+         " us at a fixed period, %zu syncs with max error %" PRId64
+         " us with the drift estimate\n",
+         fixed.syncs.size(), fixedErrorNs / 1000, adaptive.syncs.size(),
+         adaptiveErrorNs / 1000);
+
+  EXPECT_LT(adaptiveErrorNs, TimeSyncEstimator::kMaxPredictionErrorNs);
+  EXPECT_LT(adaptiveErrorNs, fixedErrorNs);
+  EXPECT_LT(adaptive.syncs.size(), fixed.syncs.size() / 4);
+  EXPECT_EQ(adaptive.syncs.back().nextSyncDelayNs,
+            TimeSyncEstimator::kMaxSyncDelayNs);
+}
+
+TEST(TimeSyncEstimatorTest, DriftChangeResetsTheInterval) {
+  constexpr int64_t kDurationNs = 7 * kOneDayInNs;
+  constexpr int64_t kDriftChangeNs = 3 * kOneDayInNs;
+
+  DriftingClock clock(/* initialOffsetNs= */ 0, /* driftPpb= */ 20000);
+  clock.changeDrift(kDriftChangeNs, 20500);
+  TimeSyncEstimator estimator;
+  SimulationResult result = simulate(clock, kDurationNs, &estimator);
+
+  // The first sync after the change resets the delay.
+  auto sync = std::find_if(
+      result.syncs.begin(), result.syncs.end(),
+      [&](const Sync &sync) { return sync.hostTimeNs > kDriftChangeNs; });
+  ASSERT_NE(sync, result.syncs.end());
+  EXPECT_EQ(sync->nextSyncDelayNs, TimeSyncEstimator::kMinSyncDelayNs);
+
+  // The estimate converges back to the new drift.
+  EXPECT_LT(result.getMaxErrorNs(kDurationNs - 2 * kOneDayInNs, kDurationNs),
+            TimeSyncEstimator::kMaxPredictionErrorNs);
+  EXPECT_EQ(result.syncs.back().nextSyncDelayNs,
+            TimeSyncEstimator::kMaxSyncDelayNs);
+}
+
+}  // namespace android::chre
@@ -15,10 +15,12 @@
  */
 
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <cstdlib>
 #include <fstream>
 #include <thread>
+#include <vector>
 
 #include <json/json.h>
 
@@ -118,6 +120,22 @@ class ContextHubCallbackForTest : public BnContextHubCallback {
   std::array<uint8_t, 16> mUuid{};
 };
 
+//! A stand-in for the callback of a HAL client that only counts the messages
+//! delivered to it.
+class CountingContextHubCallback : public ContextHubCallbackForTest {
+ public:
+  using ContextHubCallbackForTest::ContextHubCallbackForTest;
+
+  ScopedAStatus handleContextHubMessage(
+      const ContextHubMessage & /*message*/,
+      const std::vector<std::string> & /*msgContentPerms*/) override {
+    mNumMessages.fetch_add(1, std::memory_order_relaxed);
+    return ScopedAStatus::ok();
+  }
+
+  std::atomic<uint64_t> mNumMessages{0};
+};
+
 class HalClientManagerForTest : public HalClientManager {
  public:
   HalClientManagerForTest(
@@ -136,6 +154,12 @@ class HalClientManagerForTest : public HalClientManager {
     std::shared_ptr<ContextHubCallbackForTest> callback =
         ContextHubCallbackForTest::make<ContextHubCallbackForTest>(
             kSystemServerUuid);
+    return createClientForTest(uuid, pid, callback);
+  }
+
+  bool createClientForTest(
+      const std::string &uuid, pid_t pid,
+      const std::shared_ptr<IContextHubCallback> &callback) {
     return createClientLocked(uuid, pid, callback,
                               /* deathRecipientCookie= */ nullptr);
   }
@@ -548,5 +572,73 @@ TEST_F(HalClientManagerTest, handleChreRestartForConnectedClientsOnly) {
   halClientManager->handleChreRestart();
 }
 
+/**
+ * Delivers messages from several threads to several vendor clients, each
+ * taking the path of a message from a client to CHRE (endpoint id mutation)
+ * and back (callback retrieval by endpoint).
+ */
+TEST_F(HalClientManagerTest, ConcurrentMessageDelivery) {
+  constexpr int kNumClients = 4;
+  constexpr HostEndpointId kNumEndpointsPerClient = 4;
+  constexpr int kNumThreads = 4;
+  constexpr int kNumMessagesPerThread = 500;
+
+  auto halClientManager = std::make_unique<HalClientManagerForTest>(
+      mockDeadClientUnlinker, kClientIdMappingFilePath);
+  std::vector<std::shared_ptr<CountingContextHubCallback>> callbacks;
+  for (int i = 0; i < kNumClients; i++) {
+    pid_t pid = kVendorPid + i;
+    callbacks.push_back(
+        ContextHubCallbackForTest::make<CountingContextHubCallback>(
+            kVendorUuid));
+    ASSERT_TRUE(halClientManager->createClientForTest(std::to_string(i + 1),
+                                                      pid, callbacks.back()));
+    for (HostEndpointId endpointId = 0; endpointId < kNumEndpointsPerClient;
+         endpointId++) {
+      ASSERT_TRUE(halClientManager->registerEndpointId(pid, endpointId));
+    }
+  }
+
+  ContextHubMessage message;
+  message.nanoappId = 0x476f6f676cabcdef;
+  message.messageType = 1;
+  message.messageBody = std::vector<uint8_t>(32);
+  std::atomic<int> numFailures{0};
+  auto deliverMessages = [&](int threadIndex) {
+    for (int i = 0; i < kNumMessagesPerThread; i++) {
+      pid_t pid = kVendorPid + (threadIndex + i) % kNumClients;
+      HostEndpointId endpointId = i % kNumEndpointsPerClient;
+      std::shared_ptr<IContextHubCallback> callback;
+      if (!halClientManager->mutateEndpointIdFromHostIfNeeded(pid,
+                                                              endpointId) ||
+          (callback = halClientManager->getCallbackForEndpoint(endpointId)) ==
+              nullptr) {
+        numFailures++;
+        continue;
+      }
+      callback->handleContextHubMessage(message, /* msgContentPerms= */ {});
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back(deliverMessages, t);
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(numFailures.load(), 0);
+  for (int i = 0; i < kNumClients; i++) {
+    int expectedMessages = 0;
+    for (int t = 0; t < kNumThreads; t++) {
+      for (int m = 0; m < kNumMessagesPerThread; m++) {
+        expectedMessages += (t + m) % kNumClients == i;
+      }
+    }
+    EXPECT_EQ(callbacks[i]->mNumMessages.load(),
+              static_cast<uint64_t>(expectedMessages));
+  }
+}
+
 }  // namespace
 }  // namespace android::hardware::contexthub::common::implementation
@@ -16,7 +16,12 @@
 #include "chre_host/hal_client.h"
 #include "host/hal_generic/common/hal_error.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <unordered_set>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -36,6 +41,7 @@ using ::ndk::ScopedAStatus;
 
 using ::testing::_;
 using ::testing::ByMove;
+using ::testing::ElementsAre;
 using ::testing::Field;
 using ::testing::IsEmpty;
 using ::testing::Return;
@@ -68,6 +74,10 @@ class HalClientForTest : public HalClient {
   HalClientCallback *getClientCallback() {
     return mCallback.get();
   }
+
+  void setMaxQueuedMessagesPerEndpoint(size_t maxQueuedMessages) {
+    mMaxQueuedMessagesPerEndpoint = maxQueuedMessages;
+  }
 };
 
 class MockContextHub : public IContextHubDefault {
@@ -83,6 +93,52 @@ class MockContextHub : public IContextHubDefault {
               (override));
 };
 
+/** A fake HAL recording the messages sent to it, which can hold them. */
+class FakeContextHub : public IContextHubDefault {
+ public:
+  ScopedAStatus sendMessageToHub(int32_t /* contextHubId */,
+                                 const ContextHubMessage &message) override {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mMessages.push_back(message);
+    mCondVar.notify_all();
+    mCondVar.wait(lock, [this]() { return !mHoldMessages; });
+    return ScopedAStatus::ok();
+  }
+
+  /** Makes sendMessageToHub() block until the messages are no longer held. */
+  void holdMessages(bool hold) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mHoldMessages = hold;
+    mCondVar.notify_all();
+  }
+
+  /** @return the messages received once there are at least numMessages. */
+  std::vector<ContextHubMessage> waitForMessages(size_t numMessages) {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondVar.wait_for(lock, std::chrono::seconds(5), [&]() {
+      return mMessages.size() >= numMessages;
+    });
+    return mMessages;
+  }
+
+ private:
+  std::mutex mMutex;
+  std::condition_variable mCondVar;
+  std::vector<ContextHubMessage> mMessages;
+  bool mHoldMessages = false;
+};
+
+ContextHubMessage createMessage(HostEndpointId endpointId,
+                                int32_t messageType) {
+  return {
+      .nanoappId = 0xbeef,
+      .hostEndPoint = endpointId,
+      .messageType = messageType,
+      .messageBody = {},
+      .permissions = {},
+  };
+}
+
 }  // namespace
 
 TEST(HalClientTest, EndpointConnectionBasic) {
@@ -209,4 +265,92 @@ TEST(HalClientTest, HandleChreRestart) {
   EXPECT_THAT(halClient->getConnectedEndpointIds(),
               UnorderedElementsAre(kEndpointId, kEndpointId + 1));
 }
+
+TEST(HalClientTest, SendMessageAsyncKeepsOrderPerEndpoint) {
+  constexpr int32_t kNumMessagesPerEndpoint = 5;
+  auto fakeContextHub = ndk::SharedRefBase::make<FakeContextHub>();
+  auto halClient = std::make_unique<HalClientForTest>(
+      fakeContextHub,
+      std::vector<HostEndpointId>{kEndpointId, kEndpointId + 1});
+
+  std::atomic<int32_t> numMessagesSent = 0;
+  auto callback = [&](const ContextHubMessage & /* message */,
+                      const ScopedAStatus &status) {
+    if (status.isOk()) {
+      numMessagesSent++;
+    }
+  };
+  for (int32_t i = 0; i < kNumMessagesPerEndpoint; i++) {
+    EXPECT_TRUE(
+        halClient->sendMessageAsync(createMessage(kEndpointId, i), callback)
+            .isOk());
+    EXPECT_TRUE(halClient
+                    ->sendMessageAsync(createMessage(kEndpointId + 1, i),
+                                       callback)
+                    .isOk());
+  }
+
+  std::vector<int32_t> messageTypes[2];
+  for (const ContextHubMessage &message :
+       fakeContextHub->waitForMessages(2 * kNumMessagesPerEndpoint)) {
+    messageTypes[message.hostEndPoint - kEndpointId].push_back(
+        message.messageType);
+  }
+  EXPECT_THAT(messageTypes[0], ElementsAre(0, 1, 2, 3, 4));
+  EXPECT_THAT(messageTypes[1], ElementsAre(0, 1, 2, 3, 4));
+
+  // All the messages are being sent, so the callbacks are all notified once
+  // the sender thread is joined.
+  halClient.reset();
+  EXPECT_EQ(numMessagesSent.load(), 2 * kNumMessagesPerEndpoint);
+}
+
+TEST(HalClientTest, SendMessageAsyncQueueIsBounded) {
+  constexpr size_t kMaxQueuedMessages = 3;
+  auto fakeContextHub = ndk::SharedRefBase::make<FakeContextHub>();
+  auto halClient = std::make_unique<HalClientForTest>(
+      fakeContextHub,
+      std::vector<HostEndpointId>{kEndpointId, kEndpointId + 1});
+  halClient->setMaxQueuedMessagesPerEndpoint(kMaxQueuedMessages);
+
+  // The first message is held by the HAL and no longer counts as queued.
+  fakeContextHub->holdMessages(true);
+  EXPECT_TRUE(
+      halClient->sendMessageAsync(createMessage(kEndpointId, 0)).isOk());
+  ASSERT_EQ(fakeContextHub->waitForMessages(1).size(), 1);
+
+  for (size_t i = 0; i < kMaxQueuedMessages; i++) {
+    EXPECT_TRUE(
+        halClient->sendMessageAsync(createMessage(kEndpointId, i + 1)).isOk());
+  }
+  ScopedAStatus status =
+      halClient->sendMessageAsync(createMessage(kEndpointId, 0));
+  EXPECT_EQ(status.getServiceSpecificError(),
+            static_cast<int32_t>(HalError::SEND_QUEUE_FULL));
+
+  // Other endpoints have their own queue.
+  EXPECT_TRUE(
+      halClient->sendMessageAsync(createMessage(kEndpointId + 1, 0)).isOk());
+
+  fakeContextHub->holdMessages(false);
+  EXPECT_EQ(fakeContextHub->waitForMessages(kMaxQueuedMessages + 2).size(),
+            kMaxQueuedMessages + 2);
+}
+
+TEST(HalClientTest, SendMessageAsyncWhenDisconnected) {
+  auto halClient = std::make_unique<HalClientForTest>(
+      /* contextHub= */ nullptr, std::vector<HostEndpointId>{kEndpointId});
+
+  std::atomic<int32_t> error = 0;
+  auto callback = [&](const ContextHubMessage & /* message */,
+                      const ScopedAStatus &status) {
+    error = status.getServiceSpecificError();
+  };
+  EXPECT_TRUE(
+      halClient->sendMessageAsync(createMessage(kEndpointId, 0), callback)
+          .isOk());
+
+  halClient.reset();
+  EXPECT_EQ(error.load(), static_cast<int32_t>(HalError::BINDER_DISCONNECTED));
+}
 }  // namespace android::chre
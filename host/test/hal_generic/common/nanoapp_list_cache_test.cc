@@ -0,0 +1,373 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "nanoapp_list_cache.h"
+
+namespace android::hardware::contexthub::common::implementation {
+
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+
+using Result = NanoappListCache::Result;
+
+std::vector<NanoappInfo> createNanoappList(size_t numOfNanoapps) {
+  std::vector<NanoappInfo> nanoapps(numOfNanoapps);
+  for (size_t i = 0; i < numOfNanoapps; i++) {
+    nanoapps[i].nanoappId = static_cast<int64_t>(0x476f6f676c000000 + i);
+  }
+  return nanoapps;
+}
+
+/** Records the requests instead of sending them. */
+class NanoappListCacheTest : public ::testing::Test {
+ protected:
+  NanoappListCache mCache{[this](HalClientId clientId) {
+    mRequests.push_back(clientId);
+    return mSendResult;
+  }};
+  std::vector<HalClientId> mRequests;
+  bool mSendResult = true;
+};
+
+/**
+ * A stand-in for CHRE on the other end of a local socket, answering each
+ * request, i.e. the id of the client it is sent for, after a processing delay.
+ */
+class SocketChre {
+ public:
+  static constexpr auto kProcessingDelay = std::chrono::milliseconds(2);
+
+  SocketChre() {
+    EXPECT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, mSockets), 0);
+    mChreThread = std::thread([this]() {
+      HalClientId clientId;
+      while (recv(mSockets[1], &clientId, sizeof(clientId), 0) ==
+             sizeof(clientId)) {
+        std::this_thread::sleep_for(kProcessingDelay);
+        send(mSockets[1], &clientId, sizeof(clientId), 0);
+      }
+    });
+  }
+
+  ~SocketChre() {
+    stop();
+    close(mSockets[0]);
+    close(mSockets[1]);
+  }
+
+  /** Closes the connection, which ends receiveResponse() on the host side. */
+  void stop() {
+    shutdown(mSockets[0], SHUT_RDWR);
+    if (mChreThread.joinable()) {
+      mChreThread.join();
+    }
+  }
+
+  bool sendRequest(HalClientId clientId) {
+    mRequestCount++;
+    return send(mSockets[0], &clientId, sizeof(clientId), 0) ==
+           sizeof(clientId);
+  }
+
+  /** @return the client a response is addressed to, or nullopt if closed. */
+  std::optional<HalClientId> receiveResponse() {
+    HalClientId clientId;
+    if (recv(mSockets[0], &clientId, sizeof(clientId), 0) !=
+        sizeof(clientId)) {
+      return std::nullopt;
+    }
+    return clientId;
+  }
+
+  size_t getRequestCount() const {
+    return mRequestCount;
+  }
+
+ private:
+  int mSockets[2];
+  std::thread mChreThread;
+  std::atomic<size_t> mRequestCount = 0;
+};
+
+/** Tracks the number of nanoapp lists delivered to each client. */
+class Deliveries {
+ public:
+  void deliver(HalClientId clientId) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCounts[clientId]++;
+    mCondVar.notify_all();
+  }
+
+  size_t get(HalClientId clientId) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mCounts[clientId];
+  }
+
+  void waitFor(HalClientId clientId, size_t count) {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondVar.wait(lock, [&]() { return mCounts[clientId] >= count; });
+  }
+
+ private:
+  std::mutex mMutex;
+  std::condition_variable mCondVar;
+  std::unordered_map<HalClientId, size_t> mCounts;
+};
+
+struct LatencyResult {
+  std::chrono::microseconds meanLatency;
+  size_t requestCount;
+};
+
+/**
+ * Measures the latency of the nanoapp queries of concurrent clients, each
+ * querying kQueriesPerClient times. A nanoapp is loaded every kLoadPeriod
+ * queries of the first client.
+ *
+ * @param useCache whether the queries go through a NanoappListCache, or send a
+ *        request each as the HAL did before.
+ */
+LatencyResult measureQueryLatency(bool useCache) {
+  constexpr HalClientId kNumOfClients = 4;
+  constexpr size_t kQueriesPerClient = 50;
+  constexpr size_t kLoadPeriod = 10;
+
+  SocketChre chre;
+  Deliveries deliveries;
+  NanoappListCache cache([&](HalClientId clientId) {
+    return chre.sendRequest(clientId);
+  });
+  std::vector<NanoappInfo> nanoapps = createNanoappList(8);
+
+  std::thread receiver([&]() {
+    while (std::optional<HalClientId> clientId = chre.receiveResponse()) {
+      std::vector<HalClientId> clientIds;
+      if (useCache) {
+        clientIds = cache.onResponse(nanoapps);
+      }
+      if (clientIds.empty()) {
+        clientIds.push_back(*clientId);
+      }
+      for (HalClientId id : clientIds) {
+        deliveries.deliver(id);
+      }
+    }
+  });
+
+  std::atomic<int64_t> totalLatencyUs = 0;
+  std::vector<std::thread> clients;
+  for (HalClientId clientId = 1; clientId <= kNumOfClients; clientId++) {
+    clients.emplace_back([&, clientId]() {
+      std::vector<NanoappInfo> cached;
+      for (size_t i = 0; i < kQueriesPerClient; i++) {
+        if (clientId == 1 && i % kLoadPeriod == 0) {
+          cache.invalidate();
+        }
+        auto start = std::chrono::steady_clock::now();
+        size_t count = deliveries.get(clientId);
+        if (!useCache) {
+          EXPECT_TRUE(chre.sendRequest(clientId));
+          deliveries.waitFor(clientId, count + 1);
+        } else if (cache.query(clientId, &cached) == Result::PENDING) {
+          deliveries.waitFor(clientId, count + 1);
+        }
+        totalLatencyUs += std::chrono::duration_cast<std::chrono::microseconds>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+      }
+    });
+  }
+  for (auto &client : clients) {
+    client.join();
+  }
+  chre.stop();
+  receiver.join();
+  return {std::chrono::microseconds(totalLatencyUs /
+                                    (kNumOfClients * kQueriesPerClient)),
+          chre.getRequestCount()};
+}
+
+}  // namespace
+
+TEST_F(NanoappListCacheTest, QueryIsServedFromTheCacheAfterResponse) {
+  std::vector<NanoappInfo> nanoapps;
+  EXPECT_EQ(mCache.query(/* clientId= */ 1, &nanoapps), Result::PENDING);
+  EXPECT_THAT(mRequests, ElementsAre(1));
+
+  EXPECT_THAT(mCache.onResponse(createNanoappList(3)), ElementsAre(1));
+
+  EXPECT_EQ(mCache.query(/* clientId= */ 2, &nanoapps), Result::CACHED);
+  EXPECT_EQ(nanoapps.size(), 3);
+  EXPECT_THAT(mRequests, ElementsAre(1));
+  EXPECT_EQ(mCache.getStats().hits, 1);
+}
+
+TEST_F(NanoappListCacheTest, ConcurrentQueriesAreCoalesced) {
+  std::vector<NanoappInfo> nanoapps;
+  EXPECT_EQ(mCache.query(/* clientId= */ 1, &nanoapps), Result::PENDING);
+  EXPECT_EQ(mCache.query(/* clientId= */ 2, &nanoapps), Result::PENDING);
+  EXPECT_EQ(mCache.query(/* clientId= */ 3, &nanoapps), Result::PENDING);
+  EXPECT_EQ(mCache.query(/* clientId= */ 2, &nanoapps), Result::PENDING);
+
+  EXPECT_THAT(mRequests, ElementsAre(1));
+  EXPECT_THAT(mCache.onResponse(createNanoappList(1)),
+              UnorderedElementsAre(1, 2, 3));
+  EXPECT_EQ(mCache.getStats().coalesced, 3);
+}
+
+TEST_F(NanoappListCacheTest, InvalidationDiscardsTheCachedList) {
+  std::vector<NanoappInfo> nanoapps;
+  mCache.query(/* clientId= */ 1, &nanoapps);
+  mCache.onResponse(createNanoappList(1));
+
+  mCache.invalidate();
+  EXPECT_EQ(mCache.getVersion(), 1);
+  EXPECT_EQ(mCache.query(/* clientId= */ 1, &nanoapps), Result::PENDING);
+  EXPECT_THAT(mRequests, ElementsAre(1, 1));
+}
+
+TEST_F(NanoappListCacheTest, ExpiredListIsRequestedAgain) {
+  constexpr auto kMaxAge = std::chrono::milliseconds(10);
+  NanoappListCache cache(
+      [this](HalClientId clientId) {
+        mRequests.push_back(clientId);
+        return true;
+      },
+      kMaxAge);
+  std::vector<NanoappInfo> nanoapps;
+  cache.query(/* clientId= */ 1, &nanoapps);
+  cache.onResponse(createNanoappList(1));
+  EXPECT_EQ(cache.query(/* clientId= */ 1, &nanoapps), Result::CACHED);
+
+  std::this_thread::sleep_for(2 * kMaxAge);
+  EXPECT_EQ(cache.query(/* clientId= */ 2, &nanoapps), Result::PENDING);
+  EXPECT_THAT(mRequests, ElementsAre(1, 2));
+  EXPECT_THAT(cache.onResponse(createNanoappList(2)), ElementsAre(2));
+  EXPECT_EQ(cache.query(/* clientId= */ 1, &nanoapps), Result::CACHED);
+  EXPECT_EQ(nanoapps.size(), 2);
+}
+
+TEST_F(NanoappListCacheTest, ResponseToStaleRequestIsNotCached) {
+  std::vector<NanoappInfo> nanoapps;
+  EXPECT_EQ(mCache.query(/* clientId= */ 1, &nanoapps), Result::PENDING);
+
+  // A nanoapp is loaded while the request is in flight. The next client waits
+  // for a new request instead of joining the stale one.
+  mCache.invalidate();
+  EXPECT_EQ(mCache.query(/* clientId= */ 2, &nanoapps), Result::PENDING);
+  EXPECT_THAT(mRequests, ElementsAre(1));
+
+  EXPECT_THAT(mCache.onResponse(createNanoappList(1)), ElementsAre(1));
+  EXPECT_THAT(mRequests, ElementsAre(1, 2));
+  EXPECT_EQ(mCache.query(/* clientId= */ 3, &nanoapps), Result::PENDING);
+
+  EXPECT_THAT(mCache.onResponse(createNanoappList(2)), ElementsAre(2, 3));
+  EXPECT_EQ(mCache.query(/* clientId= */ 1, &nanoapps), Result::CACHED);
+  EXPECT_EQ(nanoapps.size(), 2);
+}
+
+TEST_F(NanoappListCacheTest, UnsolicitedResponseIsNotCached) {
+  std::vector<NanoappInfo> nanoapps;
+  EXPECT_THAT(mCache.onResponse(createNanoappList(1)), IsEmpty());
+  EXPECT_EQ(mCache.query(/* clientId= */ 1, &nanoapps), Result::PENDING);
+}
+
+TEST_F(NanoappListCacheTest, SendFailureIsReported) {
+  std::vector<NanoappInfo> nanoapps;
+  mSendResult = false;
+  EXPECT_EQ(mCache.query(/* clientId= */ 1, &nanoapps), Result::SEND_FAILED);
+
+  mSendResult = true;
+  EXPECT_EQ(mCache.query(/* clientId= */ 1, &nanoapps), Result::PENDING);
+  EXPECT_THAT(mRequests, ElementsAre(1, 1));
+}
+
+TEST_F(NanoappListCacheTest, WaitersOfAFailedRequestAreQueued) {
+  std::vector<NanoappInfo> nanoapps;
+  mCache.query(/* clientId= */ 1, &nanoapps);
+  mCache.invalidate();
+  EXPECT_EQ(mCache.query(/* clientId= */ 2, &nanoapps), Result::PENDING);
+
+  // The request for the next waiters fails, so they wait for the next query.
+  mSendResult = false;
+  EXPECT_THAT(mCache.onResponse(createNanoappList(1)), ElementsAre(1));
+  EXPECT_THAT(mRequests, ElementsAre(1, 2));
+
+  mSendResult = true;
+  EXPECT_EQ(mCache.query(/* clientId= */ 3, &nanoapps), Result::PENDING);
+  EXPECT_THAT(mRequests, ElementsAre(1, 2, 2));
+  EXPECT_THAT(mCache.onResponse(createNanoappList(2)), ElementsAre(2, 3));
+  EXPECT_EQ(mCache.query(/* clientId= */ 1, &nanoapps), Result::CACHED);
+}
+
+TEST_F(NanoappListCacheTest, WaitersOfATimedOutRequestAreQueuedOnFailure) {
+  constexpr auto kRequestTimeout = std::chrono::milliseconds(10);
+  NanoappListCache cache(
+      [this](HalClientId clientId) {
+        mRequests.push_back(clientId);
+        return mSendResult;
+      },
+      NanoappListCache::kDefaultMaxAge, kRequestTimeout);
+  std::vector<NanoappInfo> nanoapps;
+  cache.query(/* clientId= */ 1, &nanoapps);
+  cache.query(/* clientId= */ 2, &nanoapps);
+
+  std::this_thread::sleep_for(2 * kRequestTimeout);
+  mSendResult = false;
+  EXPECT_EQ(cache.query(/* clientId= */ 3, &nanoapps), Result::SEND_FAILED);
+
+  mSendResult = true;
+  EXPECT_EQ(cache.query(/* clientId= */ 4, &nanoapps), Result::PENDING);
+  EXPECT_THAT(mRequests, ElementsAre(1, 1, 1));
+  EXPECT_THAT(cache.onResponse(createNanoappList(1)), ElementsAre(1, 2, 4));
+
+  // The response may be the late one of the lost request, so isn't cached.
+  EXPECT_EQ(cache.query(/* clientId= */ 1, &nanoapps), Result::PENDING);
+}
+
+TEST(NanoappListCacheLatencyTest, CacheReducesQueryLatency) {
+  LatencyResult uncached = measureQueryLatency(/* useCache= */ false);
+  LatencyResult cached = measureQueryLatency(/* useCache= */ true);
+  printf("Nanoapp query latency over a local socket: %lld us with %zu "
+         "requests uncached, %lld us with %zu requests cached\n",
+         static_cast<long long>(uncached.meanLatency.count()),
+         uncached.requestCount,
+         static_cast<long long>(cached.meanLatency.count()),
+         cached.requestCount);
+
+  EXPECT_LT(cached.requestCount, uncached.requestCount / 4);
+  EXPECT_LT(cached.meanLatency, uncached.meanLatency);
+}
+
+}  // namespace android::hardware::contexthub::common::implementation
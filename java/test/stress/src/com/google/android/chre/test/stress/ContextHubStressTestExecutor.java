@@ -73,6 +73,9 @@ public class ContextHubStressTestExecutor extends ContextHubClientCallback {
 
     private ChreStressTest.Capabilities mCapabilities;
 
+    private final AtomicReference<ChreStressTest.LoadReport> mLoadReport =
+            new AtomicReference<>();
+
     // Set to true to have the test suite only load the nanoapp and start the test.
     // This can be useful for long-running stress tests, where we do not want to wait a fixed
     // time to wait for successful completion.
@@ -121,6 +124,20 @@ public class ContextHubStressTestExecutor extends ContextHubClientCallback {
                     }
                     break;
                 }
+                case ChreStressTest.MessageType.LOAD_REPORT_VALUE: {
+                    try {
+                        mLoadReport.set(
+                                ChreStressTest.LoadReport.parseFrom(message.getMessageBody()));
+                        valid = true;
+                    } catch (InvalidProtocolBufferException e) {
+                        Log.e(TAG, "Failed to parse message: " + e.getMessage());
+                    }
+                    break;
+                }
+                case ChreStressTest.MessageType.LOAD_MESSAGE_VALUE: {
+                    // Only sent to load the host link, see LoadProfile.
+                    break;
+                }
                 default: {
                     Log.e(TAG, "Unknown message type " + message.getMessageType());
                 }
@@ -219,6 +236,41 @@ public class ContextHubStressTestExecutor extends ContextHubClientCallback {
         sendTestMessage(ChreStressTest.TestCommand.Feature.WIFI_SCAN_MONITOR, true /* start */);
     }
 
+    /**
+     * Sets the load generated by the features started after this call.
+     *
+     * @param profile The load profile, unset fields keep the default load of the nanoapp.
+     */
+    public void setLoadProfile(ChreStressTest.LoadProfile profile) {
+        NanoAppMessage message = NanoAppMessage.createMessageToNanoApp(
+                mNanoAppId, ChreStressTest.MessageType.SET_LOAD_PROFILE_VALUE,
+                profile.toByteArray());
+        sendMessageToNanoApp(message);
+    }
+
+    /**
+     * Requests the delivery statistics gathered by the nanoapp since the previous request.
+     *
+     * @return The latency histograms and drop counts of the sources that delivered events.
+     */
+    public ChreStressTest.LoadReport getLoadReport() throws InterruptedException {
+        mLoadReport.set(null);
+        mCountDownLatch = new CountDownLatch(1);
+        NanoAppMessage message = NanoAppMessage.createMessageToNanoApp(
+                mNanoAppId, ChreStressTest.MessageType.GET_LOAD_REPORT_VALUE,
+                new byte[0]);
+        sendMessageToNanoApp(message);
+
+        boolean success = mCountDownLatch.await(30, TimeUnit.SECONDS);
+        Assert.assertTrue("Timeout waiting for signal: load report", success);
+        for (ChreStressTest.SourceStats stats : mLoadReport.get().getSourcesList()) {
+            Log.i(TAG, stats.getSource() + ": " + stats.getEventCount() + " events, "
+                    + stats.getDropCount() + " drops, max latency "
+                    + stats.getMaxLatencyNs() + " ns");
+        }
+        return mLoadReport.get();
+    }
+
     /**
      * A test to verify whether a scan monitor request persists through WLAN restarts.
      *
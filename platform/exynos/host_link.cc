@@ -179,7 +179,8 @@ void HostMessageHandlers::handleUnloadNanoappRequest(
   // TODO(b/230134803): Implement this.
 }
 
-void HostMessageHandlers::handleTimeSyncMessage(int64_t offset) {
+void HostMessageHandlers::handleTimeSyncMessage(
+    int64_t offset, int32_t /* driftPpb */, uint64_t /* nextSyncDelayNs */) {
   LOGD("Time sync msg received with offset %" PRId64, offset);
 
   SystemTime::setEstimatedHostTimeOffset(offset);
@@ -92,6 +92,20 @@ class HostLinkBase {
     // Implement this.
   }
 
+  /**
+   * Enqueues a V2 log message to be sent to the host, with the logs drained
+   * from a log buffer straight into it.
+   *
+   * @param logBuffer The log buffer to drain
+   *
+   * @param numLogsDropped Non-null pointer to the number of logs dropped since
+   * CHRE started, which is incremented by the logs dropped by logBuffer
+   */
+  void sendLogMessageV2(LogBuffer & /*logBuffer*/,
+                        size_t * /*numLogsDropped*/) {
+    // Implement this.
+  }
+
  private:
   static constexpr uint32_t kMsgBufferSize = CHRE_MESSAGE_TO_HOST_MAX_SIZE;
   uint8_t mMsgBuffer[kMsgBufferSize] = {0};
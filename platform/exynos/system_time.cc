@@ -30,7 +30,8 @@ int64_t SystemTime::getEstimatedHostTimeOffset() {
   return gEstimatedHostTimeOffset;
 }
 
-void SystemTime::setEstimatedHostTimeOffset(int64_t offset) {
+void SystemTime::setEstimatedHostTimeOffset(int64_t offset,
+                                            int32_t /* driftPpb */) {
   gEstimatedHostTimeOffset = offset;
 }
 
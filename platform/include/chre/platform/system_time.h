@@ -59,9 +59,15 @@ class SystemTime {
    * Sets the estimated offset between the host and CHRE time. The offset can
    * be queried using the 'SystemTime::getEstimatedHostTimeOffset' method.
    *
+   * Platforms may extrapolate the offset returned by
+   * getEstimatedHostTimeOffset() from the drift rate, which is otherwise
+   * ignored.
+   *
    * @param offset Time offset (Host time - CHRE time)
+   * @param driftPpb Estimated drift rate of the offset, in nanoseconds per
+   *        second of CHRE time, or 0 if unknown
    */
-  static void setEstimatedHostTimeOffset(int64_t offset);
+  static void setEstimatedHostTimeOffset(int64_t offset, int32_t driftPpb = 0);
 };
 
 }  // namespace chre
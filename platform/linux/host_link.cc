@@ -31,6 +31,17 @@ bool HostLink::sendMessage(const MessageToHost *message) {
   return true;
 }
 
+void HostLinkBase::receiveMessageFromHost(
+    uint64_t appId, uint32_t messageType, uint16_t hostEndpoint,
+    const void *buffer, const void *messageData, size_t messageSize,
+    HostBufferReleaseFunction *releaseBuffer) {
+  EventLoopManagerSingleton::get()
+      ->getHostCommsManager()
+      .sendMessageToNanoappFromHost(appId, messageType, hostEndpoint,
+                                    messageData, messageSize, buffer,
+                                    releaseBuffer);
+}
+
 void HostLinkBase::sendNanConfiguration(bool enable) {
 #if defined(CHRE_WIFI_SUPPORT_ENABLED) && defined(CHRE_WIFI_NAN_SUPPORT_ENABLED)
   EventLoopManagerSingleton::get()
@@ -22,4 +22,9 @@
  */
 bool chrePalSensorIsSensor0Enabled();
 
+/**
+ * @return whether sensor 1 is active.
+ */
+bool chrePalSensorIsSensor1Enabled();
+
 #endif  // CHRE_PLATFORM_LINUX_PAL_SENSOR_H_
\ No newline at end of file
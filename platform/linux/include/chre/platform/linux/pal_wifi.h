@@ -57,4 +57,10 @@ void chrePalWifiDelayResponse(PalWifiAsyncRequestTypes requestType,
 void chrePalWifiEnableResponse(PalWifiAsyncRequestTypes requestType,
                                bool enableResponse);
 
+/**
+ * @return the number of scan requests received by the PAL since it was last
+ *         opened.
+ */
+uint32_t chrePalWifiGetScanRequestCount();
+
 #endif  // CHRE_PLATFORM_LINUX_PAL_WIFI_H_
\ No newline at end of file
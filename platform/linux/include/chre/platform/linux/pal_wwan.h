@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_PLATFORM_LINUX_PAL_WWAN_H_
+#define CHRE_PLATFORM_LINUX_PAL_WWAN_H_
+
+#include <cstdint>
+
+/**
+ * Delays sending the cell info results until
+ * chrePalWwanStartSendingCellInfoResults is called.
+ *
+ * Use this if you need to control the timing between when CHRE requests cell
+ * info and when the result is delivered.
+ *
+ * The default is to send the result immediately to CHRE.
+ */
+void chrePalWwanDelaySendingCellInfoResults(bool enabled);
+
+/**
+ * Sends the result of the pending cell info request, if any.
+ *
+ * Note: This function must only be called after a call to
+ *       chrePalWwanDelaySendingCellInfoResults with enabled set to true.
+ */
+void chrePalWwanStartSendingCellInfoResults();
+
+/**
+ * @return the number of cell info requests received by the PAL since it was
+ *         last opened.
+ */
+uint32_t chrePalWwanGetCellInfoRequestCount();
+
+/**
+ * @return the number of cell info results released by CHRE since the PAL was
+ *         last opened. May be called from any thread.
+ */
+uint32_t chrePalWwanGetCellInfoReleaseCount();
+
+#endif  // CHRE_PLATFORM_LINUX_PAL_WWAN_H_
@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_PLATFORM_LINUX_SAMPLING_PROFILER_H_
+#define CHRE_PLATFORM_LINUX_SAMPLING_PROFILER_H_
+
+#include <signal.h>
+#include <time.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "chre/util/non_copyable.h"
+
+namespace chre {
+
+class PlatformNanoappBase;
+
+/**
+ * Samples the call stacks of the threads running the nanoapps of the Linux
+ * platform, and exports them as folded stacks, the input of flame graph tools
+ * such as flamegraph.pl or speedscope.
+ *
+ * Each profiled thread gets a SIGPROF every 1 / frequency seconds of the CPU
+ * time it consumes, whose handler records the current nanoapp of the event
+ * loop, its app ID and the return addresses of the stack into a free slot of
+ * a preallocated ring of samples, without taking a lock or allocating memory.
+ * The samples are then folded under a "[nanoapp 0x<app ID>]" root, or
+ * "[system]" outside of the nanoapps, which frees their slots.
+ *
+ * The nanoapps are shared libraries, so their frames are symbolized through
+ * their dynamic symbol table or as an offset in the library, which does not
+ * require rebuilding them. The samples are folded every kFoldingInterval
+ * while profiling, those of a nanoapp when it is unloaded, before its library
+ * is closed, and the others when exporting. A sample is only dropped if its
+ * slot has not been folded since the ring wrapped around.
+ */
+class SamplingProfiler : public NonCopyable {
+ public:
+  //! The default number of samples recorded between two foldings.
+  static constexpr size_t kDefaultMaxSamples = 16384;
+
+  //! The interval at which the samples are folded while profiling.
+  static constexpr std::chrono::milliseconds kFoldingInterval{1000};
+
+  //! The maximum number of frames recorded with a sample. The frames closest
+  //! to the root of deeper stacks are dropped.
+  static constexpr size_t kMaxStackDepth = 32;
+
+  /**
+   * @return the profiler of the process.
+   */
+  static SamplingProfiler &get();
+
+  /**
+   * Starts profiling. The threads to profile then call
+   * profileCurrentThread().
+   *
+   * @param frequencyHz The number of samples per second of CPU time of each
+   *        thread.
+   * @param maxSamples The number of samples that can be recorded between two
+   *        foldings, beyond which they are dropped.
+   * @return true if profiling started.
+   */
+  bool start(uint32_t frequencyHz, size_t maxSamples = kDefaultMaxSamples);
+
+  /**
+   * Samples the calling thread until stop() is called.
+   *
+   * @return true if the thread is profiled.
+   */
+  bool profileCurrentThread();
+
+  /**
+   * Stops profiling. The samples are kept until exported or cleared.
+   */
+  void stop();
+
+  /**
+   * Discards the samples recorded so far. Must not be called while profiling.
+   */
+  void clear();
+
+  /**
+   * Symbolizes and folds the samples recorded while a nanoapp was running,
+   * which must be done before its library is closed.
+   *
+   * @param nanoapp The nanoapp being unloaded.
+   */
+  void onNanoappUnloading(const PlatformNanoappBase *nanoapp);
+
+  /**
+   * Writes the samples recorded so far as folded stacks, one
+   * "<root>;<frame>;...;<leaf frame> <count>" line per distinct stack, then a
+   * "[dropped] <count>" line if samples were dropped.
+   *
+   * @return the number of samples written, not counting the dropped ones.
+   */
+  size_t exportFoldedStacks(FILE *file);
+
+  /**
+   * Writes the samples recorded so far as a folded stacks file.
+   *
+   * @return true if the file is written.
+   */
+  bool exportFoldedStacks(const char *path);
+
+  /**
+   * @return the number of samples dropped because the ring of samples was
+   *         full.
+   */
+  size_t getNumDroppedSamples() const {
+    return mNumDroppedSamples.load(std::memory_order_relaxed);
+  }
+
+ private:
+  enum class SampleState : uint8_t {
+    //! The slot can be claimed by the signal handler.
+    Free,
+    //! The signal handler is recording the sample.
+    Recording,
+    //! The sample is recorded, and the slot is freed once it is folded.
+    Recorded,
+  };
+
+  struct Sample {
+    std::atomic<SampleState> state{SampleState::Free};
+    uint8_t numFrames;
+
+    //! The nanoapp running when the sample was taken, only compared with the
+    //! nanoapp being unloaded as it may have been destroyed since.
+    const PlatformNanoappBase *nanoapp;
+    uint64_t appId;
+
+    void *frames[kMaxStackDepth];
+  };
+
+  SamplingProfiler() = default;
+
+  static void signalHandler(int signal, siginfo_t *info, void *context);
+
+  //! Folds the samples every kFoldingInterval until profiling stops.
+  void foldPeriodically();
+
+  /**
+   * Folds the recorded samples of a nanoapp, or of all the nanoapps still
+   * loaded and the system if nanoapp is nullptr. The mutex must be held.
+   */
+  void foldSamplesLocked(const PlatformNanoappBase *nanoapp);
+
+  //! Guards the members below, which the signal handler does not access.
+  std::mutex mMutex;
+  std::vector<timer_t> mTimers;
+  uint64_t mIntervalNs = 0;
+
+  //! The number of samples of each folded stack.
+  std::map<std::string, uint64_t> mFoldedStacks;
+
+  //! Notified when profiling stops.
+  std::condition_variable mStoppedCondition;
+  std::thread mFoldingThread;
+
+  //! The ring of samples, only reallocated while not profiling.
+  std::unique_ptr<Sample[]> mSamples;
+  size_t mMaxSamples = 0;
+
+  std::atomic<bool> mRunning{false};
+  std::atomic<size_t> mNextSample{0};
+  std::atomic<size_t> mNumDroppedSamples{0};
+};
+
+}  // namespace chre
+
+#endif  // CHRE_PLATFORM_LINUX_SAMPLING_PROFILER_H_
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_PLATFORM_LINUX_TRACE_RECORDER_H_
+#define CHRE_PLATFORM_LINUX_TRACE_RECORDER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "chre/platform/tracing.h"
+#include "chre/util/non_copyable.h"
+
+namespace chre {
+
+enum class TracePhase : uint8_t {
+  INSTANT,
+  START,
+  END,
+};
+
+/**
+ * Records the CHRE_TRACE_* events of the Linux platform and exports them in
+ * the Chrome trace event JSON format, which can be opened with Perfetto
+ * (ui.perfetto.dev) or chrome://tracing.
+ *
+ * Each thread records into its own ring buffer of kEventsPerThread events
+ * without taking a lock, overwriting its oldest events when full. A buffer is
+ * only allocated by the first event of a thread, and is kept after the thread
+ * exits so its events can still be exported.
+ *
+ * Exporting copies the events of every buffer and drops the ones overwritten
+ * while copying, so it may run while other threads are tracing.
+ */
+class TraceRecorder : public NonCopyable {
+ public:
+  //! The number of events kept for each thread.
+  static constexpr size_t kEventsPerThread = 4096;
+
+  //! The maximum number of data values recorded with an event. The extra
+  //! values are dropped.
+  static constexpr size_t kMaxTraceArgs = 4;
+
+  //! The trace ID of events without one.
+  static constexpr uint32_t kNoTraceId = UINT32_MAX;
+
+  /**
+   * @return the recorder of the process.
+   */
+  static TraceRecorder &get();
+
+  /**
+   * Records an event of the calling thread.
+   *
+   * @param phase The phase of the event.
+   * @param label A string literal describing the event.
+   * @param group An optional string literal grouping events together.
+   * @param traceId An optional ID matching the start and end of events of the
+   *        same group, which may then be on different threads.
+   */
+  void record(TracePhase phase, const char *label,
+              const char *group = nullptr, uint32_t traceId = kNoTraceId) {
+    beginEvent(phase, label, group, traceId, /* dataFmt= */ nullptr);
+    endEvent();
+  }
+
+  /**
+   * Records an event of the calling thread with data values.
+   *
+   * @param dataFmt A string literal naming the values and their types, in the
+   *        "<name>:<TRACE_X>,..." format of the CHRE_TRACE_*_DATA macros.
+   * @param args The values, which may be integers, bools, chars, pointers or
+   *        null-terminated strings truncated to CHRE_TRACE_MAX_STRING_SIZE.
+   */
+  template <typename... Args>
+  void recordWithData(TracePhase phase, const char *label, const char *group,
+                      uint32_t traceId, const char *dataFmt, Args... args) {
+    TraceEvent &event = beginEvent(phase, label, group, traceId, dataFmt);
+    setArgs(event, 0, args...);
+    endEvent();
+  }
+
+  /**
+   * Discards the events recorded so far.
+   */
+  void clear();
+
+  /**
+   * Writes the events recorded so far as a Chrome trace JSON object.
+   *
+   * @return the number of events written.
+   */
+  size_t exportChromeTrace(FILE *file);
+
+  /**
+   * Writes the events recorded so far as a Chrome trace JSON file.
+   *
+   * @return true if the file is written.
+   */
+  bool exportChromeTrace(const char *path);
+
+ private:
+  struct TraceArg {
+    uint64_t value;
+    char str[CHRE_TRACE_STR_BUFFER_SIZE];
+  };
+
+  struct TraceEvent {
+    uint64_t timestampNs;
+    const char *label;
+    const char *group;
+    const char *dataFmt;
+    uint32_t traceId;
+    TracePhase phase;
+    uint8_t numArgs;
+    TraceArg args[kMaxTraceArgs];
+  };
+
+  //! The events of a thread. Only the thread writes mEvents and mNextIndex.
+  struct ThreadBuffer {
+    std::unique_ptr<TraceEvent[]> events{new TraceEvent[kEventsPerThread]};
+
+    //! The index of the next event, counting from the first event of the
+    //! thread, so the event is at nextIndex % kEventsPerThread.
+    std::atomic<uint64_t> nextIndex{0};
+
+    //! The index of the first event not discarded by clear().
+    std::atomic<uint64_t> firstIndex{0};
+
+    uint32_t tid;
+    char name[16];
+  };
+
+  TraceRecorder() = default;
+
+  TraceEvent &beginEvent(TracePhase phase, const char *label,
+                         const char *group, uint32_t traceId,
+                         const char *dataFmt);
+
+  void endEvent() {
+    ThreadBuffer *buffer = tThreadBuffer;
+    buffer->nextIndex.store(
+        buffer->nextIndex.load(std::memory_order_relaxed) + 1,
+        std::memory_order_release);
+  }
+
+  /** Allocates and registers the buffer of the calling thread. */
+  ThreadBuffer *registerThread();
+
+  static void setArgs(TraceEvent &event, size_t index) {
+    event.numArgs = static_cast<uint8_t>(index);
+  }
+
+  template <typename T, typename... Args>
+  static void setArgs(TraceEvent &event, size_t index, T arg, Args... args) {
+    if (index == kMaxTraceArgs) {
+      setArgs(event, index);
+    } else {
+      setArg(event.args[index], arg);
+      setArgs(event, index + 1, args...);
+    }
+  }
+
+  template <typename T>
+  static void setArg(TraceArg &traceArg, T arg) {
+    if constexpr (std::is_same_v<std::decay_t<T>, const char *> ||
+                  std::is_same_v<std::decay_t<T>, char *>) {
+      strncpy(traceArg.str, arg, CHRE_TRACE_MAX_STRING_SIZE);
+      traceArg.str[CHRE_TRACE_MAX_STRING_SIZE] = '\0';
+    } else if constexpr (std::is_pointer_v<T>) {
+      traceArg.value = reinterpret_cast<uintptr_t>(arg);
+    } else {
+      static_assert(std::is_integral_v<T> || std::is_enum_v<T>,
+                    "Unsupported trace data type");
+      traceArg.value = static_cast<uint64_t>(arg);
+    }
+  }
+
+  static void writeEvent(FILE *file, const TraceEvent &event, uint32_t tid,
+                         bool *first);
+
+  static void writeArgs(FILE *file, const TraceEvent &event);
+
+  static thread_local ThreadBuffer *tThreadBuffer;
+
+  //! Guards mBuffers, which is only updated by the first event of a thread.
+  std::mutex mMutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> mBuffers;
+};
+
+}  // namespace chre
+
+#endif  // CHRE_PLATFORM_LINUX_TRACE_RECORDER_H_
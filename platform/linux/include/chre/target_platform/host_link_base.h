@@ -17,10 +17,38 @@
 #ifndef CHRE_PLATFORM_LINUX_HOST_LINK_BASE_H_
 #define CHRE_PLATFORM_LINUX_HOST_LINK_BASE_H_
 
+#include <cstddef>
+#include <cstdint>
+
+#include "chre/core/event_loop_common.h"
+
 namespace chre {
 
 class HostLinkBase {
  public:
+  /**
+   * Receives a message from the simulated host for a nanoapp. Unlike the
+   * transports that reuse their receive buffer, the simulated one lends it,
+   * so the nanoapp reads the message in place rather than a copy.
+   *
+   * @param appId Identifier for the destination nanoapp
+   * @param messageType Some message type defined by the app
+   * @param hostEndpoint An identifier for the endpoint on the host that sent
+   *        the message
+   * @param buffer The receive buffer, which must stay valid and unchanged
+   *        until releaseBuffer is invoked with it
+   * @param messageData The message data, within buffer
+   * @param messageSize Size of messageData, in bytes
+   * @param releaseBuffer Returns buffer to the simulated host, exactly once
+   *
+   * @see HostCommsManager::sendMessageToNanoappFromHost
+   */
+  static void receiveMessageFromHost(uint64_t appId, uint32_t messageType,
+                                     uint16_t hostEndpoint, const void *buffer,
+                                     const void *messageData,
+                                     size_t messageSize,
+                                     HostBufferReleaseFunction *releaseBuffer);
+
   /**
    * Enqueues a NAN configuration request to be sent to the host.
    * For Linux, the request is simply echoed back via a NAN configuration
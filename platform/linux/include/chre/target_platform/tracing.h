@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_PLATFORM_LINUX_TRACING_H_
+#define CHRE_PLATFORM_LINUX_TRACING_H_
+
+#include "chre/platform/linux/trace_recorder.h"
+#include "chre/util/macros.h"
+
+/**
+ * The tracing macros of the Linux platform, recording the events in the
+ * TraceRecorder. They take the same parameters as the ones of the pw_trace
+ * backend in platform/shared/pw_trace:
+ *
+ * CHRE_TRACE_INSTANT(label, [group, [trace_id]])
+ * CHRE_TRACE_START(label, [group, [trace_id]])
+ * CHRE_TRACE_END(label, [group, [trace_id]])
+ * CHRE_TRACE_*_DATA(label, dataFmtString, firstData, ...)
+ * CHRE_TRACE_*_DATA_GROUP(label, group, dataFmtString, firstData, ...)
+ * CHRE_TRACE_*_DATA_TRACE_ID(label, group, trace_id, dataFmtString,
+ *                            firstData, ...)
+ *
+ * A START must be paired with an END of the same label, group and trace_id.
+ */
+
+#define CHRE_TRACE_INSTANT(label, ...)                                    \
+  ::chre::TraceRecorder::get().record(::chre::TracePhase::INSTANT, label, \
+                                      ##__VA_ARGS__)
+
+#define CHRE_TRACE_START(label, ...)                                    \
+  ::chre::TraceRecorder::get().record(::chre::TracePhase::START, label, \
+                                      ##__VA_ARGS__)
+
+#define CHRE_TRACE_END(label, ...)                                    \
+  ::chre::TraceRecorder::get().record(::chre::TracePhase::END, label, \
+                                      ##__VA_ARGS__)
+
+#define CHRE_TRACE_LINUX_DATA(phase, label, group, trace_id, dataFmtString, \
+                              firstData, ...)                               \
+  ::chre::TraceRecorder::get().recordWithData(                              \
+      ::chre::TracePhase::phase, label, group, trace_id, dataFmtString,     \
+      firstData, ##__VA_ARGS__)
+
+#define CHRE_TRACE_INSTANT_DATA(label, dataFmtString, firstData, ...)       \
+  CHRE_TRACE_LINUX_DATA(INSTANT, label, nullptr,                            \
+                        ::chre::TraceRecorder::kNoTraceId, dataFmtString,   \
+                        firstData, ##__VA_ARGS__)
+
+#define CHRE_TRACE_INSTANT_DATA_GROUP(label, group, dataFmtString, firstData, \
+                                      ...)                                    \
+  CHRE_TRACE_LINUX_DATA(INSTANT, label, group,                                \
+                        ::chre::TraceRecorder::kNoTraceId, dataFmtString,     \
+                        firstData, ##__VA_ARGS__)
+
+#define CHRE_TRACE_INSTANT_DATA_TRACE_ID(label, group, trace_id,            \
+                                         dataFmtString, firstData, ...)     \
+  CHRE_TRACE_LINUX_DATA(INSTANT, label, group, trace_id, dataFmtString,     \
+                        firstData, ##__VA_ARGS__)
+
+#define CHRE_TRACE_START_DATA(label, dataFmtString, firstData, ...)         \
+  CHRE_TRACE_LINUX_DATA(START, label, nullptr,                              \
+                        ::chre::TraceRecorder::kNoTraceId, dataFmtString,   \
+                        firstData, ##__VA_ARGS__)
+
+#define CHRE_TRACE_START_DATA_GROUP(label, group, dataFmtString, firstData, \
+                                    ...)                                    \
+  CHRE_TRACE_LINUX_DATA(START, label, group,                                \
+                        ::chre::TraceRecorder::kNoTraceId, dataFmtString,   \
+                        firstData, ##__VA_ARGS__)
+
+#define CHRE_TRACE_START_DATA_TRACE_ID(label, group, trace_id, dataFmtString, \
+                                       firstData, ...)                        \
+  CHRE_TRACE_LINUX_DATA(START, label, group, trace_id, dataFmtString,         \
+                        firstData, ##__VA_ARGS__)
+
+#define CHRE_TRACE_END_DATA(label, dataFmtString, firstData, ...)           \
+  CHRE_TRACE_LINUX_DATA(END, label, nullptr,                                \
+                        ::chre::TraceRecorder::kNoTraceId, dataFmtString,   \
+                        firstData, ##__VA_ARGS__)
+
+#define CHRE_TRACE_END_DATA_GROUP(label, group, dataFmtString, firstData, ...) \
+  CHRE_TRACE_LINUX_DATA(END, label, group, ::chre::TraceRecorder::kNoTraceId,  \
+                        dataFmtString, firstData, ##__VA_ARGS__)
+
+#define CHRE_TRACE_END_DATA_TRACE_ID(label, group, trace_id, dataFmtString, \
+                                     firstData, ...)                        \
+  CHRE_TRACE_LINUX_DATA(END, label, group, trace_id, dataFmtString,         \
+                        firstData, ##__VA_ARGS__)
+
+#endif  // CHRE_PLATFORM_LINUX_TRACING_H_
@@ -26,7 +26,11 @@
 #include "chre/platform/context.h"
 #include "chre/platform/fatal_error.h"
 #include "chre/platform/linux/platform_log.h"
+#include "chre/platform/linux/sampling_profiler.h"
 #include "chre/platform/linux/task_util/task_manager.h"
+#ifdef CHRE_TRACING_ENABLED
+#include "chre/platform/linux/trace_recorder.h"
+#endif  // CHRE_TRACING_ENABLED
 #include "chre/platform/log.h"
 #include "chre/platform/system_timer.h"
 #include "chre/util/time.h"
@@ -34,6 +38,7 @@
 #include <tclap/CmdLine.h>
 #include <csignal>
 #include <thread>
+#include <vector>
 
 using chre::EventLoopManagerSingleton;
 using chre::Milliseconds;
@@ -77,6 +82,28 @@ int main(int argc, char **argv) {
         "", "max_audio_buf_size", "max buffer size for audio simulation", false,
         10.0, "seconds", cmd);
 #endif  // CHRE_AUDIO_SUPPORT_ENABLED
+#ifdef CHRE_TRACING_ENABLED
+    TCLAP::ValueArg<std::string> traceFileArg(
+        "", "trace_file",
+        "Chrome trace JSON file to write the trace events to on exit", false,
+        "", "path", cmd);
+#endif  // CHRE_TRACING_ENABLED
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+    TCLAP::ValueArg<size_t> eventLoopShardsArg(
+        "", "event_loop_shards",
+        "number of threads running the nanoapps, 0 to run them on the event "
+        "loop thread",
+        false, 0, "count", cmd);
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
+    TCLAP::ValueArg<std::string> profileFileArg(
+        "", "profile_file",
+        "folded stacks file to write the samples of the nanoapp threads to on "
+        "exit, enabling the sampling profiler",
+        false, "", "path", cmd);
+    TCLAP::ValueArg<uint32_t> profileFrequencyArg(
+        "", "profile_frequency_hz",
+        "samples per second of CPU time of the sampling profiler", false, 997,
+        "frequency", cmd);
     cmd.parse(argc, argv);
 
     // Initialize logging.
@@ -104,8 +131,34 @@ int main(int argc, char **argv) {
     // Register a signal handler.
     std::signal(SIGINT, signalHandler);
 
+    bool profiling = !profileFileArg.getValue().empty();
+    if (profiling &&
+        !chre::SamplingProfiler::get().start(profileFrequencyArg.getValue())) {
+      LOGE("Failed to start the sampling profiler");
+      profiling = false;
+    }
+
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+    // Start the threads of the event loop shards, which return once it stops.
+    chre::EventLoop &eventLoop =
+        EventLoopManagerSingleton::get()->getEventLoop();
+    eventLoop.setNumShards(eventLoopShardsArg.getValue());
+    std::vector<std::thread> shardThreads;
+    for (size_t i = 0; i < eventLoop.getNumShards(); i++) {
+      shardThreads.emplace_back([&eventLoop, i, profiling]() {
+        if (profiling) {
+          chre::SamplingProfiler::get().profileCurrentThread();
+        }
+        eventLoop.runShard(i);
+      });
+    }
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
+
     // Load any static nanoapps and start the event loop.
     std::thread chreThread([&]() {
+      if (profiling) {
+        chre::SamplingProfiler::get().profileCurrentThread();
+      }
       EventLoopManagerSingleton::get()->lateInit();
 
       // Load static nanoapps unless they are disabled by a command-line flag.
@@ -125,6 +178,28 @@ int main(int argc, char **argv) {
       EventLoopManagerSingleton::get()->getEventLoop().run();
     });
     chreThread.join();
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+    for (std::thread &shardThread : shardThreads) {
+      shardThread.join();
+    }
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
+
+#ifdef CHRE_TRACING_ENABLED
+    if (!traceFileArg.getValue().empty() &&
+        !chre::TraceRecorder::get().exportChromeTrace(
+            traceFileArg.getValue().c_str())) {
+      LOGE("Failed to write the trace to %s", traceFileArg.getValue().c_str());
+    }
+#endif  // CHRE_TRACING_ENABLED
+
+    if (profiling) {
+      chre::SamplingProfiler::get().stop();
+      if (!chre::SamplingProfiler::get().exportFoldedStacks(
+              profileFileArg.getValue().c_str())) {
+        LOGE("Failed to write the profile to %s",
+             profileFileArg.getValue().c_str());
+      }
+    }
 
     chre::TaskManagerSingleton::deinit();
     chre::deinit();
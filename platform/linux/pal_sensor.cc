@@ -48,21 +48,35 @@ struct chreSensorInfo gSensors[] = {
         .minInterval = 0,
         .sensorIndex = CHRE_SENSOR_INDEX_DEFAULT,
     },
+    // Sensor 1 - Gyroscope.
+    {
+        .sensorName = "Test Gyroscope",
+        .sensorType = CHRE_SENSOR_TYPE_UNCALIBRATED_GYROSCOPE,
+        .isOnChange = 0,
+        .isOneShot = 0,
+        .reportsBiasEvents = 0,
+        .supportsPassiveMode = 0,
+        .minInterval = 0,
+        .sensorIndex = CHRE_SENSOR_INDEX_DEFAULT,
+    },
 };
 
-//! Task to deliver asynchronous sensor data after a CHRE request.
-std::optional<uint32_t> gSensor0TaskId;
-bool gIsSensor0Enabled = false;
+//! Tasks to deliver asynchronous sensor data after a CHRE request.
+std::optional<uint32_t> gSensorTaskIds[ARRAY_SIZE(gSensors)];
+bool gIsSensorEnabled[ARRAY_SIZE(gSensors)] = {};
 
-void stopSensor0Task() {
-  if (gSensor0TaskId.has_value()) {
-    TaskManagerSingleton::get()->cancelTask(gSensor0TaskId.value());
-    gSensor0TaskId.reset();
+void stopSensorTask(uint32_t sensorInfoIndex) {
+  std::optional<uint32_t> &taskId = gSensorTaskIds[sensorInfoIndex];
+  if (taskId.has_value()) {
+    TaskManagerSingleton::get()->cancelTask(taskId.value());
+    taskId.reset();
   }
 }
 
 void chrePalSensorApiClose() {
-  stopSensor0Task();
+  for (uint32_t i = 0; i < ARRAY_SIZE(gSensors); i++) {
+    stopSensorTask(i);
+  }
 }
 
 bool chrePalSensorApiOpen(const struct chrePalSystemApi *systemApi,
@@ -90,24 +104,25 @@ bool chrePalSensorApiGetSensors(const struct chreSensorInfo **sensors,
   return true;
 }
 
-void sendSensor0StatusUpdate(uint64_t intervalNs, bool enabled) {
+void sendSensorStatusUpdate(uint32_t sensorInfoIndex, uint64_t intervalNs,
+                            bool enabled) {
   auto status = chre::MakeUniqueZeroFill<struct chreSensorSamplingStatus>();
   status->interval = intervalNs;
   status->latency = 0;
   status->enabled = enabled;
-  gCallbacks->samplingStatusUpdateCallback(0, status.release());
+  gCallbacks->samplingStatusUpdateCallback(sensorInfoIndex, status.release());
 }
 
-void sendSensor0Events() {
+void sendSensorEvents(uint32_t sensorInfoIndex) {
   auto data = chre::MakeUniqueZeroFill<struct chreSensorThreeAxisData>();
 
   data->header.baseTimestamp = gSystemApi->getCurrentTime();
-  data->header.sensorHandle = 0;
+  data->header.sensorHandle = sensorInfoIndex;
   data->header.readingCount = 1;
   data->header.accuracy = CHRE_SENSOR_ACCURACY_UNRELIABLE;
   data->header.reserved = 0;
 
-  gCallbacks->dataEventCallback(0, data.release());
+  gCallbacks->dataEventCallback(sensorInfoIndex, data.release());
 }
 
 bool chrePalSensorApiConfigureSensor(uint32_t sensorInfoIndex,
@@ -118,24 +133,20 @@ bool chrePalSensorApiConfigureSensor(uint32_t sensorInfoIndex,
     return false;
   }
 
-  if (sensorInfoIndex != 0) {
-    // Only sensor 0 is supported for now.
-    return false;
-  }
-
   if (mode == CHRE_SENSOR_CONFIGURE_MODE_CONTINUOUS) {
-    stopSensor0Task();
-    gIsSensor0Enabled = true;
-    sendSensor0StatusUpdate(intervalNs, true /*enabled*/);
-    gSensor0TaskId = TaskManagerSingleton::get()->addTask(
-        sendSensor0Events, std::chrono::nanoseconds(intervalNs));
-    return gSensor0TaskId.has_value();
+    stopSensorTask(sensorInfoIndex);
+    gIsSensorEnabled[sensorInfoIndex] = true;
+    sendSensorStatusUpdate(sensorInfoIndex, intervalNs, true /*enabled*/);
+    gSensorTaskIds[sensorInfoIndex] = TaskManagerSingleton::get()->addTask(
+        [sensorInfoIndex]() { sendSensorEvents(sensorInfoIndex); },
+        std::chrono::nanoseconds(intervalNs));
+    return gSensorTaskIds[sensorInfoIndex].has_value();
   }
 
   if (mode == CHRE_SENSOR_CONFIGURE_MODE_DONE) {
-    stopSensor0Task();
-    gIsSensor0Enabled = false;
-    sendSensor0StatusUpdate(intervalNs, false /*enabled*/);
+    stopSensorTask(sensorInfoIndex);
+    gIsSensorEnabled[sensorInfoIndex] = false;
+    sendSensorStatusUpdate(sensorInfoIndex, intervalNs, false /*enabled*/);
     return true;
   }
 
@@ -179,7 +190,11 @@ void chrePalSensorApiReleaseBiasEvent(void *bias) {
 }  // namespace
 
 bool chrePalSensorIsSensor0Enabled() {
-  return gIsSensor0Enabled;
+  return gIsSensorEnabled[0];
+}
+
+bool chrePalSensorIsSensor1Enabled() {
+  return gIsSensorEnabled[1];
 }
 
 const chrePalSensorApi *chrePalSensorGetApi(uint32_t requestedApiVersion) {
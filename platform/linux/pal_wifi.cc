@@ -51,6 +51,9 @@ std::atomic_bool gEnableScanMonitorResponse(true);
 //! Whether PAL should respond to scan request.
 std::atomic_bool gEnableScanResponse(true);
 
+//! Number of scan requests received since the PAL was last opened.
+std::atomic_uint32_t gScanRequestCount(0);
+
 //! Thread sync variable for TaskIds.
 std::mutex gRequestScanMutex;
 
@@ -142,6 +145,7 @@ bool chrePalWifiApiRequestScan(const struct chreWifiScanParams * /* params */) {
     LOGE("Requesting scan when existing scan request still in process");
     return false;
   }
+  gScanRequestCount++;
 
   std::optional<uint32_t> requestScanTaskCallbackId =
       TaskManagerSingleton::get()->addTask([]() {
@@ -226,6 +230,7 @@ void chrePalWifiApiClose() {
   stopScanMonitorTask();
   stopRequestScanTask();
   stopRequestRangingTask();
+  gScanRequestCount = 0;
 }
 
 bool chrePalWifiApiOpen(const struct chrePalSystemApi *systemApi,
@@ -278,6 +283,10 @@ void chrePalWifiDelayResponse(PalWifiAsyncRequestTypes requestType,
       std::chrono::duration_cast<std::chrono::nanoseconds>(seconds);
 }
 
+uint32_t chrePalWifiGetScanRequestCount() {
+  return gScanRequestCount;
+}
+
 const struct chrePalWifiApi *chrePalWifiGetApi(uint32_t requestedApiVersion) {
   static const struct chrePalWifiApi kApi = {
       .moduleVersion = CHRE_PAL_WIFI_API_CURRENT_VERSION,
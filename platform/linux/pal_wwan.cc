@@ -16,11 +16,14 @@
 
 #include "chre/pal/wwan.h"
 
+#include "chre/platform/assert.h"
+#include "chre/platform/linux/pal_wwan.h"
 #include "chre/platform/linux/task_util/task_manager.h"
 
 #include "chre/util/memory.h"
 #include "chre/util/unique_ptr.h"
 
+#include <atomic>
 #include <chrono>
 #include <cinttypes>
 
@@ -37,6 +40,12 @@ const struct chrePalWwanCallbacks *gCallbacks = nullptr;
 //! Task to deliver asynchronous WWAN cell info results after a CHRE request.
 std::optional<uint32_t> gCellInfosTaskId;
 
+//! Shared between the threads of CHRE, of the PAL tasks and of the test.
+std::atomic_bool gDelaySendingCellInfoResults(false);
+std::atomic_bool gCellInfoResultPending(false);
+std::atomic_uint32_t gCellInfoRequestCount(0);
+std::atomic_uint32_t gCellInfoReleaseCount(0);
+
 void sendCellInfoResult() {
   auto result = chre::MakeUniqueZeroFill<struct chreWwanCellInfoResult>();
   auto cell = chre::MakeUniqueZeroFill<struct chreWwanCellInfo>();
@@ -57,6 +66,7 @@ void sendCellInfoResult() {
   result->errorCode = CHRE_ERROR_NONE;
   result->cells = cell.release();
 
+  gCellInfoResultPending = false;
   gCallbacks->cellInfoResultCallback(result.release());
 }
 
@@ -72,6 +82,12 @@ uint32_t chrePalWwanGetCapabilities() {
 }
 
 bool chrePalWwanRequestCellInfo() {
+  gCellInfoRequestCount++;
+  gCellInfoResultPending = true;
+  if (gDelaySendingCellInfoResults) {
+    return true;
+  }
+
   stopCellInfoTask();
   gCellInfosTaskId = TaskManagerSingleton::get()->addTask(sendCellInfoResult);
   return gCellInfosTaskId.has_value();
@@ -82,10 +98,14 @@ void chrePalWwanReleaseCellInfoResult(struct chreWwanCellInfoResult *result) {
     chre::memoryFree(const_cast<struct chreWwanCellInfo *>(&result->cells[i]));
   }
   chre::memoryFree(result);
+  gCellInfoReleaseCount++;
 }
 
 void chrePalWwanApiClose() {
   stopCellInfoTask();
+  gCellInfoResultPending = false;
+  gCellInfoRequestCount = 0;
+  gCellInfoReleaseCount = 0;
 }
 
 bool chrePalWwanApiOpen(const struct chrePalSystemApi *systemApi,
@@ -104,6 +124,27 @@ bool chrePalWwanApiOpen(const struct chrePalSystemApi *systemApi,
 
 }  // anonymous namespace
 
+void chrePalWwanDelaySendingCellInfoResults(bool enabled) {
+  gDelaySendingCellInfoResults = enabled;
+}
+
+void chrePalWwanStartSendingCellInfoResults() {
+  CHRE_ASSERT(gDelaySendingCellInfoResults);
+  if (gCellInfoResultPending) {
+    stopCellInfoTask();
+    gCellInfosTaskId =
+        TaskManagerSingleton::get()->addTask(sendCellInfoResult);
+  }
+}
+
+uint32_t chrePalWwanGetCellInfoRequestCount() {
+  return gCellInfoRequestCount;
+}
+
+uint32_t chrePalWwanGetCellInfoReleaseCount() {
+  return gCellInfoReleaseCount;
+}
+
 const struct chrePalWwanApi *chrePalWwanGetApi(uint32_t requestedApiVersion) {
   static const struct chrePalWwanApi kApi = {
       .moduleVersion = CHRE_PAL_WWAN_API_CURRENT_VERSION,
@@ -20,8 +20,10 @@
 #include <cinttypes>
 
 #include "chre/platform/assert.h"
+#include "chre/platform/linux/sampling_profiler.h"
 #include "chre/platform/log.h"
 #include "chre/platform/shared/nanoapp_dso_util.h"
+#include "chre/platform/tracing.h"
 #include "chre/util/system/napp_permissions.h"
 #include "chre_api/chre/version.h"
 
@@ -101,7 +103,9 @@ bool PlatformNanoappBase::openNanoapp() {
   if (mIsStatic) {
     success = true;
   } else if (!mFilename.empty()) {
+    CHRE_TRACE_START("Open nanoapp");
     success = openNanoappFromFile();
+    CHRE_TRACE_END("Open nanoapp");
   } else {
     CHRE_ASSERT(false);
   }
@@ -149,6 +153,10 @@ bool PlatformNanoappBase::openNanoappFromFile() {
 }
 
 void PlatformNanoappBase::closeNanoapp() {
+  // The samples of the nanoapp are symbolized while its library is loaded.
+  if (mAppInfo != nullptr) {
+    SamplingProfiler::get().onNanoappUnloading(this);
+  }
   if (mDsoHandle != nullptr) {
     mAppInfo = nullptr;
     if (dlclose(mDsoHandle) != 0) {
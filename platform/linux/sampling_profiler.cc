@@ -0,0 +1,317 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre/platform/linux/sampling_profiler.h"
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+
+#include "chre/core/event_loop_manager.h"
+#include "chre/platform/log.h"
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+namespace chre {
+
+namespace {
+
+//! The frames of the signal handler and of the signal trampoline, which are
+//! at the top of the stacks it records.
+constexpr int kNumHandlerFrames = 2;
+
+//! Returns the name of the function containing an address, or its offset in
+//! its library if the function is not in the dynamic symbol table.
+std::string symbolize(const void *address) {
+  Dl_info info;
+  char buffer[32];
+  if (dladdr(address, &info) == 0 || info.dli_fname == nullptr) {
+    snprintf(buffer, sizeof(buffer), "%p", address);
+    return buffer;
+  }
+
+  std::string symbol;
+  if (info.dli_sname != nullptr) {
+    int status;
+    char *demangled =
+        abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+    symbol = (status == 0) ? demangled : info.dli_sname;
+    free(demangled);
+  } else {
+    const char *name = strrchr(info.dli_fname, '/');
+    snprintf(buffer, sizeof(buffer), "+0x%" PRIxPTR,
+             reinterpret_cast<uintptr_t>(address) -
+                 reinterpret_cast<uintptr_t>(info.dli_fbase));
+    symbol = std::string((name != nullptr) ? name + 1 : info.dli_fname) +
+             buffer;
+  }
+
+  // The frames of folded stacks are separated by semicolons.
+  std::replace(symbol.begin(), symbol.end(), ';', ':');
+  return symbol;
+}
+
+}  // namespace
+
+SamplingProfiler &SamplingProfiler::get() {
+  // Never destroyed, as profiled threads may still be signaled while the
+  // process exits.
+  static SamplingProfiler *profiler = new SamplingProfiler();
+  return *profiler;
+}
+
+bool SamplingProfiler::start(uint32_t frequencyHz, size_t maxSamples) {
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (frequencyHz == 0 || maxSamples == 0 ||
+      mRunning.load(std::memory_order_relaxed) || mFoldingThread.joinable()) {
+    return false;
+  }
+
+  if (mSamples != nullptr && mMaxSamples != maxSamples) {
+    // The samples recorded so far are folded before the ring is reallocated.
+    foldSamplesLocked(/* nanoapp= */ nullptr);
+    mSamples.reset();
+  }
+  if (mSamples == nullptr) {
+    mSamples.reset(new Sample[maxSamples]);
+    mMaxSamples = maxSamples;
+    mNextSample = 0;
+  }
+
+  // backtrace() loads the unwinder the first time it is called, which must
+  // not happen in the signal handler.
+  void *frame;
+  backtrace(&frame, 1);
+
+  struct sigaction action = {};
+  action.sa_sigaction = signalHandler;
+  action.sa_flags = SA_SIGINFO | SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  if (sigaction(SIGPROF, &action, /* oldact= */ nullptr) != 0) {
+    LOGE("Failed to install the SIGPROF handler: %s", strerror(errno));
+    return false;
+  }
+
+  mIntervalNs = UINT64_C(1000000000) / frequencyHz;
+  mRunning.store(true, std::memory_order_release);
+  mFoldingThread = std::thread(&SamplingProfiler::foldPeriodically, this);
+  return true;
+}
+
+bool SamplingProfiler::profileCurrentThread() {
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (!mRunning.load(std::memory_order_relaxed)) {
+    return false;
+  }
+
+  // Samples the CPU time of the thread only, so a thread waiting for events
+  // is not sampled.
+  clockid_t clockId;
+  struct sigevent event = {};
+  event.sigev_notify = SIGEV_THREAD_ID;
+  event.sigev_signo = SIGPROF;
+  event.sigev_notify_thread_id = static_cast<pid_t>(syscall(SYS_gettid));
+  timer_t timer;
+  if (pthread_getcpuclockid(pthread_self(), &clockId) != 0 ||
+      timer_create(clockId, &event, &timer) != 0) {
+    LOGE("Failed to create the profiling timer: %s", strerror(errno));
+    return false;
+  }
+
+  struct itimerspec spec = {};
+  spec.it_interval.tv_sec = static_cast<time_t>(mIntervalNs / 1000000000);
+  spec.it_interval.tv_nsec = static_cast<long>(mIntervalNs % 1000000000);
+  spec.it_value = spec.it_interval;
+  if (timer_settime(timer, /* flags= */ 0, &spec,
+                    /* old_value= */ nullptr) != 0) {
+    LOGE("Failed to start the profiling timer: %s", strerror(errno));
+    timer_delete(timer);
+    return false;
+  }
+  mTimers.push_back(timer);
+  return true;
+}
+
+void SamplingProfiler::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    // The handler stays installed, as signals may still be pending, and
+    // ignores them from now on.
+    mRunning.store(false, std::memory_order_release);
+    for (timer_t timer : mTimers) {
+      timer_delete(timer);
+    }
+    mTimers.clear();
+  }
+
+  mStoppedCondition.notify_all();
+  if (mFoldingThread.joinable()) {
+    mFoldingThread.join();
+  }
+}
+
+void SamplingProfiler::clear() {
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mSamples != nullptr) {
+    for (size_t i = 0; i < mMaxSamples; i++) {
+      mSamples[i].state.store(SampleState::Free, std::memory_order_relaxed);
+    }
+  }
+  mNextSample = 0;
+  mNumDroppedSamples = 0;
+  mFoldedStacks.clear();
+}
+
+void SamplingProfiler::onNanoappUnloading(const PlatformNanoappBase *nanoapp) {
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mSamples != nullptr) {
+    foldSamplesLocked(nanoapp);
+  }
+}
+
+size_t SamplingProfiler::exportFoldedStacks(FILE *file) {
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mSamples != nullptr) {
+    foldSamplesLocked(/* nanoapp= */ nullptr);
+  }
+
+  size_t numSamples = 0;
+  for (const auto &[stack, count] : mFoldedStacks) {
+    fprintf(file, "%s %" PRIu64 "\n", stack.c_str(), count);
+    numSamples += count;
+  }
+
+  // Reported as a stack of its own, so that the profile shows how much of it
+  // is missing.
+  size_t numDroppedSamples = getNumDroppedSamples();
+  if (numDroppedSamples > 0) {
+    fprintf(file, "[dropped] %zu\n", numDroppedSamples);
+    LOGW("Dropped %zu profiling samples, the ring of %zu samples was full",
+         numDroppedSamples, mMaxSamples);
+  }
+  return numSamples;
+}
+
+bool SamplingProfiler::exportFoldedStacks(const char *path) {
+  FILE *file = fopen(path, "w");
+  if (file == nullptr) {
+    return false;
+  }
+  exportFoldedStacks(file);
+  return fclose(file) == 0;
+}
+
+void SamplingProfiler::signalHandler(int /* signal */, siginfo_t * /* info */,
+                                     void * /* context */) {
+  int savedErrno = errno;
+  SamplingProfiler &profiler = get();
+  if (profiler.mRunning.load(std::memory_order_acquire)) {
+    size_t index =
+        profiler.mNextSample.fetch_add(1, std::memory_order_relaxed) %
+        profiler.mMaxSamples;
+    Sample &sample = profiler.mSamples[index];
+    SampleState freeState = SampleState::Free;
+    if (!sample.state.compare_exchange_strong(freeState,
+                                              SampleState::Recording,
+                                              std::memory_order_acquire)) {
+      profiler.mNumDroppedSamples.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      // The profiled threads may be signaled before CHRE is initialized or
+      // after it is deinitialized. The current nanoapp runs on this thread,
+      // so it is alive.
+      EventLoopManager *manager = EventLoopManagerSingleton::safeGet();
+      Nanoapp *nanoapp = (manager != nullptr)
+                             ? manager->getEventLoop().getCurrentNanoapp()
+                             : nullptr;
+      sample.nanoapp = nanoapp;
+      sample.appId = (nanoapp != nullptr) ? nanoapp->getAppId() : 0;
+
+      void *frames[kMaxStackDepth + kNumHandlerFrames];
+      int numFrames = backtrace(frames, kMaxStackDepth + kNumHandlerFrames);
+      numFrames = std::max(numFrames - kNumHandlerFrames, 0);
+      memcpy(sample.frames, &frames[kNumHandlerFrames],
+             numFrames * sizeof(void *));
+      sample.numFrames = static_cast<uint8_t>(numFrames);
+      sample.state.store(SampleState::Recorded, std::memory_order_release);
+    }
+  }
+  errno = savedErrno;
+}
+
+void SamplingProfiler::foldSamplesLocked(const PlatformNanoappBase *nanoapp) {
+  // Each return address is symbolized once, before the libraries can change.
+  std::unordered_map<const void *, std::string> symbols;
+  auto getSymbol = [&symbols](const void *address) -> const std::string & {
+    auto it = symbols.find(address);
+    if (it == symbols.end()) {
+      it = symbols.emplace(address, symbolize(address)).first;
+    }
+    return it->second;
+  };
+
+  for (size_t i = 0; i < mMaxSamples; i++) {
+    Sample &sample = mSamples[i];
+    if (sample.state.load(std::memory_order_acquire) !=
+            SampleState::Recorded ||
+        (nanoapp != nullptr && sample.nanoapp != nanoapp)) {
+      continue;
+    }
+
+    std::string stack;
+    if (sample.nanoapp == nullptr) {
+      stack = "[system]";
+    } else {
+      char root[32];
+      snprintf(root, sizeof(root), "[nanoapp 0x%016" PRIx64 "]", sample.appId);
+      stack = root;
+    }
+
+    // The frames are recorded from the leaf, whose address is the one of the
+    // interrupted instruction. The others are return addresses, which may be
+    // past the end of their call's function.
+    for (size_t j = sample.numFrames; j > 0; j--) {
+      uintptr_t address = reinterpret_cast<uintptr_t>(sample.frames[j - 1]);
+      stack += ';';
+      stack += getSymbol(reinterpret_cast<const void *>(
+          (j == 1) ? address : address - 1));
+    }
+    mFoldedStacks[stack]++;
+    sample.state.store(SampleState::Free, std::memory_order_release);
+  }
+}
+
+void SamplingProfiler::foldPeriodically() {
+  std::unique_lock<std::mutex> lock(mMutex);
+  while (mRunning.load(std::memory_order_relaxed)) {
+    mStoppedCondition.wait_for(lock, kFoldingInterval, [this]() {
+      return !mRunning.load(std::memory_order_relaxed);
+    });
+    foldSamplesLocked(/* nanoapp= */ nullptr);
+  }
+}
+
+}  // namespace chre
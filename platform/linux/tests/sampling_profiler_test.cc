@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "chre/platform/linux/sampling_profiler.h"
+
+namespace chre {
+namespace {
+
+constexpr uint32_t kFrequencyHz = 1000;
+
+//! Exports the samples of the profiler, counting them in numSamples.
+std::string exportProfile(size_t *numSamples) {
+  char *data = nullptr;
+  size_t size = 0;
+  FILE *file = open_memstream(&data, &size);
+  *numSamples = SamplingProfiler::get().exportFoldedStacks(file);
+  fclose(file);
+  std::string profile(data, size);
+  free(data);
+  return profile;
+}
+
+uint64_t getThreadCpuTimeNs() {
+  struct timespec time;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+  return static_cast<uint64_t>(time.tv_sec) * 1000000000 + time.tv_nsec;
+}
+
+int compareInts(const void *a, const void *b) {
+  return *static_cast<const int *>(a) - *static_cast<const int *>(b);
+}
+
+//! Profiles a thread sorting arrays for a given CPU time.
+void profileSorting(uint64_t durationNs) {
+  std::thread thread([durationNs]() {
+    ASSERT_TRUE(SamplingProfiler::get().profileCurrentThread());
+    constexpr size_t kNumValues = 1024;
+    int values[kNumValues];
+    uint64_t end = getThreadCpuTimeNs() + durationNs;
+    while (getThreadCpuTimeNs() < end) {
+      for (size_t i = 0; i < kNumValues; i++) {
+        values[i] = static_cast<int>((i * 7919) % kNumValues);
+      }
+      qsort(values, kNumValues, sizeof(int), compareInts);
+    }
+  });
+  thread.join();
+}
+
+class SamplingProfilerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    SamplingProfiler::get().clear();
+    ASSERT_TRUE(SamplingProfiler::get().start(kFrequencyHz));
+  }
+
+  void TearDown() override {
+    SamplingProfiler::get().stop();
+    SamplingProfiler::get().clear();
+  }
+};
+
+TEST_F(SamplingProfilerTest, FoldsTheSamplesOfProfiledThreads) {
+  profileSorting(/* durationNs= */ 200000000);
+  SamplingProfiler::get().stop();
+
+  size_t numSamples;
+  std::string profile = exportProfile(&numSamples);
+  // Loose bounds, as the CPU time timers are limited by the kernel tick rate.
+  EXPECT_GE(numSamples, 20);
+  EXPECT_LE(numSamples, 220);
+
+  // The threads of the test run no nanoapp, and the exported functions of the
+  // stacks are symbolized.
+  std::istringstream lines(profile);
+  std::string line;
+  size_t numLineSamples = 0;
+  while (std::getline(lines, line)) {
+    EXPECT_EQ(line.rfind("[system];", 0), 0) << line;
+    size_t space = line.rfind(' ');
+    ASSERT_NE(space, std::string::npos);
+    numLineSamples += std::stoul(line.substr(space + 1));
+  }
+  EXPECT_EQ(numLineSamples, numSamples);
+  EXPECT_NE(profile.find(";qsort"), std::string::npos) << profile;
+}
+
+TEST_F(SamplingProfilerTest, UnprofiledThreadsAreNotSampled) {
+  std::thread thread([]() {
+    uint64_t end = getThreadCpuTimeNs() + 50000000;
+    while (getThreadCpuTimeNs() < end) {
+    }
+  });
+  thread.join();
+
+  size_t numSamples;
+  exportProfile(&numSamples);
+  EXPECT_EQ(numSamples, 0);
+  EXPECT_EQ(SamplingProfiler::get().getNumDroppedSamples(), 0);
+}
+
+TEST_F(SamplingProfilerTest, FoldedSamplesFreeTheirSlots) {
+  constexpr size_t kMaxSamples = 32;
+  SamplingProfiler::get().stop();
+  ASSERT_TRUE(SamplingProfiler::get().start(kFrequencyHz, kMaxSamples));
+
+  // Each round records fewer samples than the ring holds, and exporting folds
+  // them.
+  size_t numSamples = 0;
+  for (int i = 0; i < 20; i++) {
+    profileSorting(/* durationNs= */ 20000000);
+    exportProfile(&numSamples);
+  }
+  EXPECT_GT(numSamples, kMaxSamples);
+  EXPECT_EQ(SamplingProfiler::get().getNumDroppedSamples(), 0);
+}
+
+TEST_F(SamplingProfilerTest, DroppedSamplesAreExported) {
+  SamplingProfiler::get().stop();
+  ASSERT_TRUE(SamplingProfiler::get().start(kFrequencyHz, /* maxSamples= */ 1));
+  profileSorting(/* durationNs= */ 200000000);
+  SamplingProfiler::get().stop();
+
+  size_t numSamples;
+  std::string profile = exportProfile(&numSamples);
+  size_t numDroppedSamples = SamplingProfiler::get().getNumDroppedSamples();
+  EXPECT_GT(numDroppedSamples, 0);
+  EXPECT_NE(profile.find("\n[dropped] " + std::to_string(numDroppedSamples) +
+                         "\n"),
+            std::string::npos)
+      << profile;
+}
+
+TEST_F(SamplingProfilerTest, ClearDiscardsTheSamples) {
+  profileSorting(/* durationNs= */ 20000000);
+  SamplingProfiler::get().stop();
+  SamplingProfiler::get().clear();
+
+  size_t numSamples;
+  EXPECT_TRUE(exportProfile(&numSamples).empty());
+  EXPECT_EQ(numSamples, 0);
+}
+
+}  // namespace
+}  // namespace chre
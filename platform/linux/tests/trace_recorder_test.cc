@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "chre/platform/linux/trace_recorder.h"
+
+namespace chre {
+namespace {
+
+//! Exports the events of the recorder, counting them in numEvents.
+std::string exportTrace(size_t *numEvents) {
+  char *data = nullptr;
+  size_t size = 0;
+  FILE *file = open_memstream(&data, &size);
+  *numEvents = TraceRecorder::get().exportChromeTrace(file);
+  fclose(file);
+  std::string trace(data, size);
+  free(data);
+  return trace;
+}
+
+size_t countOccurrences(const std::string &str, const std::string &pattern) {
+  size_t count = 0;
+  for (size_t pos = str.find(pattern); pos != std::string::npos;
+       pos = str.find(pattern, pos + 1)) {
+    count++;
+  }
+  return count;
+}
+
+class TraceRecorderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    TraceRecorder::get().clear();
+  }
+
+  void TearDown() override {
+    TraceRecorder::get().clear();
+  }
+};
+
+}  // namespace
+
+TEST_F(TraceRecorderTest, ExportsEventsInChromeTraceFormat) {
+  TraceRecorder &recorder = TraceRecorder::get();
+  recorder.record(TracePhase::INSTANT, "Instant");
+  recorder.record(TracePhase::START, "Slice", "group");
+  recorder.record(TracePhase::END, "Slice", "group");
+  recorder.record(TracePhase::START, "Async", "nanoapp", /* traceId= */ 2);
+  recorder.record(TracePhase::END, "Async", "nanoapp", /* traceId= */ 2);
+
+  size_t numEvents;
+  std::string trace = exportTrace(&numEvents);
+  EXPECT_EQ(numEvents, 5);
+  EXPECT_EQ(trace.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0),
+            0);
+  EXPECT_NE(trace.find("\"name\":\"Instant\",\"cat\":\"chre\",\"ph\":\"i\""),
+            std::string::npos);
+  EXPECT_NE(trace.find("\"name\":\"Slice\",\"cat\":\"group\",\"ph\":\"B\""),
+            std::string::npos);
+  EXPECT_NE(trace.find("\"name\":\"Slice\",\"cat\":\"group\",\"ph\":\"E\""),
+            std::string::npos);
+  EXPECT_EQ(countOccurrences(trace, "\"id\":\"0x2\""), 2);
+  EXPECT_EQ(countOccurrences(trace, "\"ph\":\"M\""), 1);
+}
+
+TEST_F(TraceRecorderTest, ExportsDataValues) {
+  TraceRecorder::get().recordWithData(
+      TracePhase::INSTANT, "Data", /* group= */ nullptr,
+      TraceRecorder::kNoTraceId,
+      "type:" TRACE_U16 ",delta:" TRACE_I32 ",ok:" TRACE_BOOL
+      ",name:" TRACE_S,
+      static_cast<uint16_t>(0x1234), -5, true, "a long nanoapp name");
+
+  size_t numEvents;
+  std::string trace = exportTrace(&numEvents);
+  EXPECT_EQ(numEvents, 1);
+  EXPECT_NE(trace.find("\"args\":{\"type\":4660,\"delta\":-5,\"ok\":true,"
+                       "\"name\":\"a long nan\"}"),
+            std::string::npos);
+}
+
+TEST_F(TraceRecorderTest, EachThreadRecordsIntoItsOwnBuffer) {
+  constexpr size_t kNumOfThreads = 4;
+  constexpr size_t kEventsPerThread = 100;
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < kNumOfThreads; i++) {
+    threads.emplace_back([]() {
+      for (size_t j = 0; j < kEventsPerThread; j++) {
+        TraceRecorder::get().record(TracePhase::INSTANT, "Thread event");
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  size_t numEvents;
+  std::string trace = exportTrace(&numEvents);
+  EXPECT_EQ(numEvents, kNumOfThreads * kEventsPerThread);
+  EXPECT_EQ(countOccurrences(trace, "\"name\":\"Thread event\""),
+            kNumOfThreads * kEventsPerThread);
+  EXPECT_EQ(countOccurrences(trace, "\"ph\":\"M\""), kNumOfThreads);
+}
+
+TEST_F(TraceRecorderTest, FullBufferKeepsTheNewestEvents) {
+  TraceRecorder &recorder = TraceRecorder::get();
+  recorder.record(TracePhase::INSTANT, "Oldest");
+  for (size_t i = 0; i < TraceRecorder::kEventsPerThread; i++) {
+    recorder.record(TracePhase::INSTANT, "Newer");
+  }
+
+  size_t numEvents;
+  std::string trace = exportTrace(&numEvents);
+  // The slot of the next event may be in the middle of being overwritten, so
+  // its event isn't exported.
+  EXPECT_EQ(numEvents, TraceRecorder::kEventsPerThread - 1);
+  EXPECT_EQ(trace.find("\"Oldest\""), std::string::npos);
+}
+
+TEST_F(TraceRecorderTest, ClearDiscardsTheEvents) {
+  TraceRecorder::get().record(TracePhase::INSTANT, "Discarded");
+  TraceRecorder::get().clear();
+  TraceRecorder::get().record(TracePhase::INSTANT, "Kept");
+
+  size_t numEvents;
+  std::string trace = exportTrace(&numEvents);
+  EXPECT_EQ(numEvents, 1);
+  EXPECT_EQ(trace.find("\"Discarded\""), std::string::npos);
+  EXPECT_NE(trace.find("\"Kept\""), std::string::npos);
+}
+
+TEST_F(TraceRecorderTest, RecordingIsCheap) {
+  constexpr size_t kNumOfEvents = 1000000;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kNumOfEvents; i++) {
+    TraceRecorder::get().recordWithData(
+        TracePhase::INSTANT, "Benchmark", /* group= */ nullptr,
+        TraceRecorder::kNoTraceId, "index:" TRACE_U32,
+        static_cast<uint32_t>(i));
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start);
+  printf("Recording a trace event with data: %lld ns\n",
+         static_cast<long long>(elapsed.count() / kNumOfEvents));
+  EXPECT_LT(elapsed.count() / kNumOfEvents, 1000);
+}
+
+}  // namespace chre
@@ -0,0 +1,256 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre/platform/linux/trace_recorder.h"
+
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cinttypes>
+#include <ctime>
+
+namespace chre {
+
+namespace {
+
+uint64_t getTimestampNs() {
+  struct timespec timeNow;
+  clock_gettime(CLOCK_MONOTONIC, &timeNow);
+  return static_cast<uint64_t>(timeNow.tv_sec) * 1000000000 +
+         static_cast<uint64_t>(timeNow.tv_nsec);
+}
+
+//! Writes a string as a JSON string, escaping the characters that need to be.
+void writeJsonString(FILE *file, const char *str) {
+  fputc('"', file);
+  for (; *str != '\0'; str++) {
+    auto c = static_cast<unsigned char>(*str);
+    if (c == '"' || c == '\\') {
+      fprintf(file, "\\%c", c);
+    } else if (c < 0x20) {
+      fprintf(file, "\\u%04x", c);
+    } else {
+      fputc(c, file);
+    }
+  }
+  fputc('"', file);
+}
+
+}  // namespace
+
+thread_local TraceRecorder::ThreadBuffer *TraceRecorder::tThreadBuffer =
+    nullptr;
+
+TraceRecorder &TraceRecorder::get() {
+  // Never destroyed, as threads may still trace while the process exits.
+  static TraceRecorder *recorder = new TraceRecorder();
+  return *recorder;
+}
+
+TraceRecorder::TraceEvent &TraceRecorder::beginEvent(TracePhase phase,
+                                                     const char *label,
+                                                     const char *group,
+                                                     uint32_t traceId,
+                                                     const char *dataFmt) {
+  ThreadBuffer *buffer = tThreadBuffer;
+  if (buffer == nullptr) {
+    buffer = registerThread();
+  }
+  uint64_t index = buffer->nextIndex.load(std::memory_order_relaxed);
+  TraceEvent &event = buffer->events[index % kEventsPerThread];
+  event.timestampNs = getTimestampNs();
+  event.label = label;
+  event.group = group;
+  event.dataFmt = dataFmt;
+  event.traceId = traceId;
+  event.phase = phase;
+  event.numArgs = 0;
+  return event;
+}
+
+TraceRecorder::ThreadBuffer *TraceRecorder::registerThread() {
+  auto buffer = std::make_unique<ThreadBuffer>();
+  buffer->tid = static_cast<uint32_t>(syscall(SYS_gettid));
+  if (pthread_getname_np(pthread_self(), buffer->name, sizeof(buffer->name)) !=
+      0) {
+    buffer->name[0] = '\0';
+  }
+  tThreadBuffer = buffer.get();
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  mBuffers.push_back(std::move(buffer));
+  return tThreadBuffer;
+}
+
+void TraceRecorder::clear() {
+  std::lock_guard<std::mutex> lock(mMutex);
+  for (const auto &buffer : mBuffers) {
+    buffer->firstIndex.store(buffer->nextIndex.load(std::memory_order_acquire),
+                             std::memory_order_relaxed);
+  }
+}
+
+size_t TraceRecorder::exportChromeTrace(FILE *file) {
+  // The buffers are never freed, so they can be read without holding the lock.
+  std::vector<ThreadBuffer *> buffers;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (const auto &buffer : mBuffers) {
+      buffers.push_back(buffer.get());
+    }
+  }
+
+  size_t numEvents = 0;
+  bool first = true;
+  std::vector<TraceEvent> events;
+  fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+  for (ThreadBuffer *buffer : buffers) {
+    uint64_t endIndex = buffer->nextIndex.load(std::memory_order_acquire);
+    uint64_t startIndex =
+        std::max(buffer->firstIndex.load(std::memory_order_relaxed),
+                 (endIndex > kEventsPerThread) ? endIndex - kEventsPerThread
+                                               : 0);
+    events.clear();
+    for (uint64_t i = startIndex; i < endIndex; i++) {
+      events.push_back(buffer->events[i % kEventsPerThread]);
+    }
+
+    // Drop the events the thread overwrote while they were copied, including
+    // the one in the slot of its next event, which may be written right now.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t newEndIndex = buffer->nextIndex.load(std::memory_order_relaxed);
+    size_t numOverwritten = 0;
+    if (newEndIndex >= startIndex + kEventsPerThread) {
+      numOverwritten = std::min<uint64_t>(
+          newEndIndex - kEventsPerThread - startIndex + 1, events.size());
+    }
+    if (events.size() == numOverwritten) {
+      continue;
+    }
+
+    fprintf(file,
+            "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,"
+            "\"tid\":%" PRIu32 ",\"args\":{\"name\":",
+            first ? "" : ",", getpid(), buffer->tid);
+    writeJsonString(file, buffer->name);
+    fprintf(file, "}}");
+    first = false;
+    for (size_t i = numOverwritten; i < events.size(); i++) {
+      writeEvent(file, events[i], buffer->tid, &first);
+      numEvents++;
+    }
+  }
+  fprintf(file, "]}\n");
+  return numEvents;
+}
+
+bool TraceRecorder::exportChromeTrace(const char *path) {
+  FILE *file = fopen(path, "w");
+  if (file == nullptr) {
+    return false;
+  }
+  exportChromeTrace(file);
+  return fclose(file) == 0;
+}
+
+void TraceRecorder::writeEvent(FILE *file, const TraceEvent &event,
+                               uint32_t tid, bool *first) {
+  bool hasTraceId = event.traceId != kNoTraceId;
+  const char *phase;
+  switch (event.phase) {
+    case TracePhase::START:
+      phase = hasTraceId ? "b" : "B";
+      break;
+    case TracePhase::END:
+      phase = hasTraceId ? "e" : "E";
+      break;
+    default:
+      phase = hasTraceId ? "n" : "i";
+      break;
+  }
+
+  fprintf(file, "%s{\"name\":", *first ? "" : ",");
+  *first = false;
+  writeJsonString(file, event.label);
+  fprintf(file, ",\"cat\":");
+  writeJsonString(file, (event.group != nullptr) ? event.group : "chre");
+  fprintf(file,
+          ",\"ph\":\"%s\",\"ts\":%" PRIu64 ".%03" PRIu64
+          ",\"pid\":%d,\"tid\":%" PRIu32,
+          phase, event.timestampNs / 1000, event.timestampNs % 1000, getpid(),
+          tid);
+  if (hasTraceId) {
+    fprintf(file, ",\"id\":\"0x%" PRIx32 "\"", event.traceId);
+  } else if (event.phase == TracePhase::INSTANT) {
+    fprintf(file, ",\"s\":\"t\"");
+  }
+  if (event.dataFmt != nullptr && event.numArgs > 0) {
+    writeArgs(file, event);
+  }
+  fprintf(file, "}");
+}
+
+void TraceRecorder::writeArgs(FILE *file, const TraceEvent &event) {
+  fprintf(file, ",\"args\":{");
+  const char *field = event.dataFmt;
+  for (size_t i = 0; i < event.numArgs && *field != '\0'; i++) {
+    // Each field is "<name>:<specifier>", separated by commas.
+    const char *separator = strchr(field, ':');
+    if (separator == nullptr) {
+      break;
+    }
+    const char *specifier = separator + 1;
+    const char *fieldEnd = strchr(specifier, ',');
+    if (fieldEnd == nullptr) {
+      fieldEnd = specifier + strlen(specifier);
+    }
+
+    std::string name(field, separator - field);
+    fprintf(file, "%s", (i > 0) ? "," : "");
+    writeJsonString(file, name.c_str());
+    fputc(':', file);
+
+    const TraceArg &arg = event.args[i];
+    char type = (fieldEnd > specifier) ? *(fieldEnd - 1) : '\0';
+    switch (type) {
+      case 'b':
+      case 'h':
+      case 'l':
+      case 'q':
+        fprintf(file, "%" PRId64, static_cast<int64_t>(arg.value));
+        break;
+      case '?':
+        fprintf(file, "%s", (arg.value != 0) ? "true" : "false");
+        break;
+      case 'c': {
+        char str[2] = {static_cast<char>(arg.value), '\0'};
+        writeJsonString(file, str);
+        break;
+      }
+      case 'p':
+        writeJsonString(file, arg.str);
+        break;
+      default:
+        fprintf(file, "%" PRIu64, arg.value);
+        break;
+    }
+    field = (*fieldEnd == ',') ? fieldEnd + 1 : fieldEnd;
+  }
+  fprintf(file, "}");
+}
+
+}  // namespace chre
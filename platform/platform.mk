@@ -195,6 +195,11 @@ endif
 SIM_CFLAGS += -I$(CHRE_PREFIX)/platform/shared/include
 SIM_CFLAGS += -Iplatform/linux/sim/include
 
+# Experimental sharded event loops, see EventLoop::setNumShards().
+ifeq ($(CHRE_EVENT_LOOP_SHARDS_ENABLED), true)
+SIM_CFLAGS += -DCHRE_EVENT_LOOP_SHARDS_ENABLED
+endif
+
 # Simulator-specific Source Files ##############################################
 
 SIM_SRCS += platform/linux/chre_api_re.cc
@@ -210,8 +215,10 @@ SIM_SRCS += platform/linux/power_control_manager.cc
 SIM_SRCS += platform/linux/system_time.cc
 SIM_SRCS += platform/linux/system_timer.cc
 SIM_SRCS += platform/linux/platform_nanoapp.cc
+SIM_SRCS += platform/linux/sampling_profiler.cc
 SIM_SRCS += platform/linux/task_util/task.cc
 SIM_SRCS += platform/linux/task_util/task_manager.cc
+SIM_SRCS += platform/linux/trace_recorder.cc
 SIM_SRCS += platform/shared/chre_api_audio.cc
 SIM_SRCS += platform/shared/chre_api_ble.cc
 SIM_SRCS += platform/shared/chre_api_core.cc
@@ -349,7 +356,9 @@ GOOGLETEST_COMMON_SRCS += platform/linux/assert.cc
 GOOGLETEST_COMMON_SRCS += platform/linux/sim/audio_source.cc
 GOOGLETEST_COMMON_SRCS += platform/linux/sim/platform_audio.cc
 GOOGLETEST_COMMON_SRCS += platform/linux/tests/task_test.cc
+GOOGLETEST_COMMON_SRCS += platform/linux/tests/sampling_profiler_test.cc
 GOOGLETEST_COMMON_SRCS += platform/linux/tests/task_manager_test.cc
+GOOGLETEST_COMMON_SRCS += platform/linux/tests/trace_recorder_test.cc
 GOOGLETEST_COMMON_SRCS += platform/tests/log_buffer_test.cc
 GOOGLETEST_COMMON_SRCS += platform/tests/trace_test.cc
 GOOGLETEST_COMMON_SRCS += platform/shared/log_buffer.cc
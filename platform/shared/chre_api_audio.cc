@@ -32,6 +32,7 @@ using chre::NanoappPermissions;
 DLL_EXPORT bool chreAudioGetSource(uint32_t handle,
                                    struct chreAudioSource *audioSource) {
 #ifdef CHRE_AUDIO_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   bool success = false;
   if (audioSource != nullptr) {
     success = EventLoopManagerSingleton::get()
@@ -51,6 +52,7 @@ DLL_EXPORT bool chreAudioConfigureSource(uint32_t handle, bool enable,
                                          uint64_t bufferDuration,
                                          uint64_t deliveryInterval) {
 #ifdef CHRE_AUDIO_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return nanoapp->permitPermissionUse(NanoappPermissions::CHRE_PERMS_AUDIO) &&
          EventLoopManagerSingleton::get()
@@ -26,6 +26,7 @@ using chre::NanoappPermissions;
 
 DLL_EXPORT uint32_t chreBleGetCapabilities() {
 #ifdef CHRE_BLE_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   return EventLoopManagerSingleton::get()
       ->getBleRequestManager()
       .getCapabilities();
@@ -36,6 +37,7 @@ DLL_EXPORT uint32_t chreBleGetCapabilities() {
 
 DLL_EXPORT uint32_t chreBleGetFilterCapabilities() {
 #ifdef CHRE_BLE_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   return EventLoopManagerSingleton::get()
       ->getBleRequestManager()
       .getFilterCapabilities();
@@ -46,6 +48,7 @@ DLL_EXPORT uint32_t chreBleGetFilterCapabilities() {
 
 DLL_EXPORT bool chreBleFlushAsync(const void *cookie) {
 #ifdef CHRE_BLE_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return nanoapp->permitPermissionUse(NanoappPermissions::CHRE_PERMS_BLE) &&
          EventLoopManagerSingleton::get()->getBleRequestManager().flushAsync(
@@ -60,6 +63,7 @@ DLL_EXPORT bool chreBleStartScanAsyncV1_9(
     chreBleScanMode mode, uint32_t reportDelayMs,
     const struct chreBleScanFilterV1_9 *filter, const void *cookie) {
 #ifdef CHRE_BLE_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return nanoapp->permitPermissionUse(NanoappPermissions::CHRE_PERMS_BLE) &&
          EventLoopManagerSingleton::get()
@@ -91,6 +95,7 @@ DLL_EXPORT bool chreBleStartScanAsync(chreBleScanMode mode,
 
 DLL_EXPORT bool chreBleStopScanAsyncV1_9(const void *cookie) {
 #ifdef CHRE_BLE_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return nanoapp->permitPermissionUse(NanoappPermissions::CHRE_PERMS_BLE) &&
          EventLoopManagerSingleton::get()->getBleRequestManager().stopScanAsync(
@@ -108,6 +113,7 @@ DLL_EXPORT bool chreBleStopScanAsync() {
 DLL_EXPORT bool chreBleReadRssiAsync(uint16_t connectionHandle,
                                      const void *cookie) {
 #ifdef CHRE_BLE_READ_RSSI_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return nanoapp->permitPermissionUse(NanoappPermissions::CHRE_PERMS_BLE) &&
          EventLoopManagerSingleton::get()->getBleRequestManager().readRssiAsync(
@@ -121,6 +127,7 @@ DLL_EXPORT bool chreBleReadRssiAsync(uint16_t connectionHandle,
 
 DLL_EXPORT bool chreBleGetScanStatus(struct chreBleScanStatus *status) {
 #ifdef CHRE_BLE_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return nanoapp->permitPermissionUse(NanoappPermissions::CHRE_PERMS_BLE) &&
          EventLoopManagerSingleton::get()->getBleRequestManager().getScanStatus(
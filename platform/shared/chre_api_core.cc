@@ -49,6 +49,7 @@ DLL_EXPORT void chreAbort(uint32_t /* abortCode */) {
 DLL_EXPORT bool chreSendEvent(uint16_t eventType, void *eventData,
                               chreEventCompleteFunction *freeCallback,
                               uint32_t targetInstanceId) {
+  chre::EventLoop::SystemLockGuard lock;
   Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
 
   // Prevent an app that is in the process of being unloaded from generating new
@@ -80,6 +81,7 @@ DLL_EXPORT bool chreSendMessageWithPermissions(
     void *message, size_t messageSize, uint32_t messageType,
     uint16_t hostEndpoint, uint32_t messagePermissions,
     chreMessageFreeFunction *freeCallback) {
+  chre::EventLoop::SystemLockGuard lock;
   Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
 
   bool success = false;
@@ -114,6 +116,7 @@ DLL_EXPORT bool chreSendMessageToHostEndpoint(
 
 DLL_EXPORT bool chreGetNanoappInfoByAppId(uint64_t appId,
                                           struct chreNanoappInfo *info) {
+  chre::EventLoop::SystemLockGuard lock;
   return EventLoopManagerSingleton::get()
       ->getEventLoop()
       .populateNanoappInfoForAppId(appId, info);
@@ -121,6 +124,7 @@ DLL_EXPORT bool chreGetNanoappInfoByAppId(uint64_t appId,
 
 DLL_EXPORT bool chreGetNanoappInfoByInstanceId(uint32_t instanceId,
                                                struct chreNanoappInfo *info) {
+  chre::EventLoop::SystemLockGuard lock;
   CHRE_ASSERT(instanceId <= UINT16_MAX);
   if (instanceId <= UINT16_MAX) {
     return EventLoopManagerSingleton::get()
@@ -132,16 +136,19 @@ DLL_EXPORT bool chreGetNanoappInfoByInstanceId(uint32_t instanceId,
 }
 
 DLL_EXPORT void chreConfigureNanoappInfoEvents(bool enable) {
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   nanoapp->configureNanoappInfoEvents(enable);
 }
 
 DLL_EXPORT void chreConfigureHostSleepStateEvents(bool enable) {
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   nanoapp->configureHostSleepEvents(enable);
 }
 
 DLL_EXPORT bool chreIsHostAwake() {
+  chre::EventLoop::SystemLockGuard lock;
   return EventLoopManagerSingleton::get()
       ->getEventLoop()
       .getPowerControlManager()
@@ -149,25 +156,47 @@ DLL_EXPORT bool chreIsHostAwake() {
 }
 
 DLL_EXPORT void chreConfigureDebugDumpEvent(bool enable) {
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   nanoapp->configureDebugDumpEvent(enable);
 }
 
 DLL_EXPORT bool chreConfigureHostEndpointNotifications(uint16_t hostEndpointId,
                                                        bool enable) {
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return nanoapp->configureHostEndpointNotifications(hostEndpointId, enable);
 }
 
 DLL_EXPORT bool chrePublishRpcServices(struct chreNanoappRpcService *services,
                                        size_t numServices) {
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return nanoapp->publishRpcServices(services, numServices);
 }
 
 DLL_EXPORT bool chreGetHostEndpointInfo(uint16_t hostEndpointId,
                                         struct chreHostEndpointInfo *info) {
+  chre::EventLoop::SystemLockGuard lock;
   return EventLoopManagerSingleton::get()
       ->getHostEndpointManager()
       .getHostEndpointInfo(hostEndpointId, info);
 }
+
+DLL_EXPORT bool chreEventDataRetain(const void *eventData) {
+  chre::EventLoop::SystemLockGuard lock;
+  chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
+  const chre::Event *currentEvent =
+      EventLoopManagerSingleton::get()->getEventLoop().getCurrentEvent();
+  return EventLoopManagerSingleton::get()
+      ->getEventPayloadArena()
+      .nanoappRetain(nanoapp, currentEvent, eventData);
+}
+
+DLL_EXPORT bool chreEventDataRelease(const void *eventData) {
+  chre::EventLoop::SystemLockGuard lock;
+  chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
+  return EventLoopManagerSingleton::get()
+      ->getEventPayloadArena()
+      .nanoappRelease(nanoapp, eventData);
+}
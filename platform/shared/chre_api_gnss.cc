@@ -28,6 +28,7 @@ using chre::NanoappPermissions;
 
 DLL_EXPORT uint32_t chreGnssGetCapabilities() {
 #ifdef CHRE_GNSS_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   return chre::EventLoopManagerSingleton::get()
       ->getGnssManager()
       .getCapabilities();
@@ -40,6 +41,7 @@ DLL_EXPORT bool chreGnssLocationSessionStartAsync(uint32_t minIntervalMs,
                                                   uint32_t minTimeToNextFixMs,
                                                   const void *cookie) {
 #ifdef CHRE_GNSS_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return nanoapp->permitPermissionUse(NanoappPermissions::CHRE_PERMS_GNSS) &&
          chre::EventLoopManagerSingleton::get()
@@ -54,6 +56,7 @@ DLL_EXPORT bool chreGnssLocationSessionStartAsync(uint32_t minIntervalMs,
 
 DLL_EXPORT bool chreGnssLocationSessionStopAsync(const void *cookie) {
 #ifdef CHRE_GNSS_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return nanoapp->permitPermissionUse(NanoappPermissions::CHRE_PERMS_GNSS) &&
          chre::EventLoopManagerSingleton::get()
@@ -68,6 +71,7 @@ DLL_EXPORT bool chreGnssLocationSessionStopAsync(const void *cookie) {
 DLL_EXPORT bool chreGnssMeasurementSessionStartAsync(uint32_t minIntervalMs,
                                                      const void *cookie) {
 #ifdef CHRE_GNSS_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return nanoapp->permitPermissionUse(NanoappPermissions::CHRE_PERMS_GNSS) &&
          chre::EventLoopManagerSingleton::get()
@@ -82,6 +86,7 @@ DLL_EXPORT bool chreGnssMeasurementSessionStartAsync(uint32_t minIntervalMs,
 
 DLL_EXPORT bool chreGnssMeasurementSessionStopAsync(const void *cookie) {
 #ifdef CHRE_GNSS_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return nanoapp->permitPermissionUse(NanoappPermissions::CHRE_PERMS_GNSS) &&
          chre::EventLoopManagerSingleton::get()
@@ -95,6 +100,7 @@ DLL_EXPORT bool chreGnssMeasurementSessionStopAsync(const void *cookie) {
 
 DLL_EXPORT bool chreGnssConfigurePassiveLocationListener(bool enable) {
 #ifdef CHRE_GNSS_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return nanoapp->permitPermissionUse(NanoappPermissions::CHRE_PERMS_GNSS) &&
          chre::EventLoopManagerSingleton::get()
@@ -46,6 +46,7 @@ DLL_EXPORT uint32_t chreGetInstanceId(void) {
 
 DLL_EXPORT uint32_t chreTimerSet(uint64_t duration, const void *cookie,
                                  bool oneShot) {
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return EventLoopManagerSingleton::get()
       ->getEventLoop()
@@ -54,6 +55,7 @@ DLL_EXPORT uint32_t chreTimerSet(uint64_t duration, const void *cookie,
 }
 
 DLL_EXPORT bool chreTimerCancel(uint32_t timerId) {
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return EventLoopManagerSingleton::get()
       ->getEventLoop()
@@ -62,6 +64,7 @@ DLL_EXPORT bool chreTimerCancel(uint32_t timerId) {
 }
 
 MALLOC_ATTR DLL_EXPORT void *chreHeapAlloc(uint32_t bytes) {
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return chre::EventLoopManagerSingleton::get()
       ->getMemoryManager()
@@ -69,6 +72,7 @@ MALLOC_ATTR DLL_EXPORT void *chreHeapAlloc(uint32_t bytes) {
 }
 
 DLL_EXPORT void chreHeapFree(void *ptr) {
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   chre::EventLoopManagerSingleton::get()->getMemoryManager().nanoappFree(
       nanoapp, ptr);
@@ -76,6 +80,7 @@ DLL_EXPORT void chreHeapFree(void *ptr) {
 
 DLL_EXPORT void platform_chreDebugDumpVaLog(const char *formatStr,
                                             va_list args) {
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   chre::EventLoopManagerSingleton::get()
       ->getDebugDumpManager()
@@ -36,6 +36,7 @@ DLL_EXPORT bool chreSensorFindDefault(uint8_t sensorType, uint32_t *handle) {
 DLL_EXPORT bool chreSensorFind(uint8_t sensorType, uint8_t sensorIndex,
                                uint32_t *handle) {
 #if CHRE_SENSORS_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return EventLoopManagerSingleton::get()
       ->getSensorRequestManager()
@@ -51,6 +52,7 @@ DLL_EXPORT bool chreSensorFind(uint8_t sensorType, uint8_t sensorIndex,
 DLL_EXPORT bool chreGetSensorInfo(uint32_t sensorHandle,
                                   struct chreSensorInfo *info) {
 #ifdef CHRE_SENSORS_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   CHRE_ASSERT(info);
 
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
@@ -72,6 +74,7 @@ DLL_EXPORT bool chreGetSensorInfo(uint32_t sensorHandle,
 DLL_EXPORT bool chreGetSensorSamplingStatus(
     uint32_t sensorHandle, struct chreSensorSamplingStatus *status) {
 #ifdef CHRE_SENSORS_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   CHRE_ASSERT(status);
 
   bool success = false;
@@ -92,6 +95,7 @@ DLL_EXPORT bool chreSensorConfigure(uint32_t sensorHandle,
                                     enum chreSensorConfigureMode mode,
                                     uint64_t interval, uint64_t latency) {
 #ifdef CHRE_SENSORS_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   SensorMode sensorMode = getSensorModeFromEnum(mode);
   SensorRequest sensorRequest(nanoapp->getInstanceId(), sensorMode,
@@ -111,6 +115,7 @@ DLL_EXPORT bool chreSensorConfigure(uint32_t sensorHandle,
 DLL_EXPORT bool chreSensorConfigureBiasEvents(uint32_t sensorHandle,
                                               bool enable) {
 #ifdef CHRE_SENSORS_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return EventLoopManagerSingleton::get()
       ->getSensorRequestManager()
@@ -125,6 +130,7 @@ DLL_EXPORT bool chreSensorConfigureBiasEvents(uint32_t sensorHandle,
 DLL_EXPORT bool chreSensorGetThreeAxisBias(
     uint32_t sensorHandle, struct chreSensorThreeAxisData *bias) {
 #ifdef CHRE_SENSORS_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   return EventLoopManagerSingleton::get()
       ->getSensorRequestManager()
       .getThreeAxisBias(sensorHandle, bias);
@@ -138,6 +144,7 @@ DLL_EXPORT bool chreSensorGetThreeAxisBias(
 DLL_EXPORT bool chreSensorFlushAsync(uint32_t sensorHandle,
                                      const void *cookie) {
 #ifdef CHRE_SENSORS_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return EventLoopManagerSingleton::get()->getSensorRequestManager().flushAsync(
       nanoapp, sensorHandle, cookie);
@@ -147,3 +154,18 @@ DLL_EXPORT bool chreSensorFlushAsync(uint32_t sensorHandle,
   return false;
 #endif  // CHRE_SENSORS_SUPPORT_ENABLED
 }
+
+DLL_EXPORT bool chreSensorConfigureSynchronizedBatch(
+    const uint32_t *sensorHandles, uint8_t sensorCount) {
+#ifdef CHRE_SENSORS_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
+  chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
+  return EventLoopManagerSingleton::get()
+      ->getSensorRequestManager()
+      .configureSynchronizedBatch(nanoapp, sensorHandles, sensorCount);
+#else   // CHRE_SENSORS_SUPPORT_ENABLED
+  UNUSED_VAR(sensorHandles);
+  UNUSED_VAR(sensorCount);
+  return false;
+#endif  // CHRE_SENSORS_SUPPORT_ENABLED
+}
@@ -25,12 +25,14 @@ using chre::Nanoapp;
 using chre::Setting;
 
 DLL_EXPORT int8_t chreUserSettingGetState(uint8_t setting) {
+  chre::EventLoop::SystemLockGuard lock;
   return chre::EventLoopManagerSingleton::get()
       ->getSettingManager()
       .getSettingStateAsInt8(setting);
 }
 
 DLL_EXPORT void chreUserSettingConfigureEvents(uint8_t setting, bool enable) {
+  chre::EventLoop::SystemLockGuard lock;
   if (setting < static_cast<uint8_t>(Setting::SETTING_MAX)) {
     Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
     nanoapp->configureUserSettingEvent(setting, enable);
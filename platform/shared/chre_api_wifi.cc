@@ -26,6 +26,7 @@ using chre::NanoappPermissions;
 
 DLL_EXPORT uint32_t chreWifiGetCapabilities() {
 #ifdef CHRE_WIFI_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   return chre::EventLoopManagerSingleton::get()
       ->getWifiRequestManager()
       .getCapabilities();
@@ -37,6 +38,7 @@ DLL_EXPORT uint32_t chreWifiGetCapabilities() {
 DLL_EXPORT bool chreWifiConfigureScanMonitorAsync(bool enable,
                                                   const void *cookie) {
 #ifdef CHRE_WIFI_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return nanoapp->permitPermissionUse(NanoappPermissions::CHRE_PERMS_WIFI) &&
          EventLoopManagerSingleton::get()
@@ -50,6 +52,7 @@ DLL_EXPORT bool chreWifiConfigureScanMonitorAsync(bool enable,
 DLL_EXPORT bool chreWifiRequestScanAsync(
     const struct chreWifiScanParams *params, const void *cookie) {
 #ifdef CHRE_WIFI_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return nanoapp->permitPermissionUse(NanoappPermissions::CHRE_PERMS_WIFI) &&
          EventLoopManagerSingleton::get()->getWifiRequestManager().requestScan(
@@ -62,6 +65,7 @@ DLL_EXPORT bool chreWifiRequestScanAsync(
 DLL_EXPORT bool chreWifiRequestRangingAsync(
     const struct chreWifiRangingParams *params, const void *cookie) {
 #ifdef CHRE_WIFI_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return nanoapp->permitPermissionUse(NanoappPermissions::CHRE_PERMS_WIFI) &&
          EventLoopManagerSingleton::get()
@@ -76,6 +80,7 @@ DLL_EXPORT bool chreWifiRequestRangingAsync(
 DLL_EXPORT bool chreWifiNanSubscribe(struct chreWifiNanSubscribeConfig *config,
                                      const void *cookie) {
 #if defined(CHRE_WIFI_SUPPORT_ENABLED) && defined(CHRE_WIFI_NAN_SUPPORT_ENABLED)
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return nanoapp->permitPermissionUse(NanoappPermissions::CHRE_PERMS_WIFI) &&
          EventLoopManagerSingleton::get()->getWifiRequestManager().nanSubscribe(
@@ -87,6 +92,7 @@ DLL_EXPORT bool chreWifiNanSubscribe(struct chreWifiNanSubscribeConfig *config,
 
 DLL_EXPORT bool chreWifiNanSubscribeCancel(uint32_t subscriptionId) {
 #if defined(CHRE_WIFI_SUPPORT_ENABLED) && defined(CHRE_WIFI_NAN_SUPPORT_ENABLED)
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return nanoapp->permitPermissionUse(NanoappPermissions::CHRE_PERMS_WIFI) &&
          EventLoopManagerSingleton::get()
@@ -100,6 +106,7 @@ DLL_EXPORT bool chreWifiNanSubscribeCancel(uint32_t subscriptionId) {
 DLL_EXPORT bool chreWifiNanRequestRangingAsync(
     const struct chreWifiNanRangingParams *params, const void *cookie) {
 #if defined(CHRE_WIFI_SUPPORT_ENABLED) && defined(CHRE_WIFI_NAN_SUPPORT_ENABLED)
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return nanoapp->permitPermissionUse(NanoappPermissions::CHRE_PERMS_WIFI) &&
          EventLoopManagerSingleton::get()
@@ -113,6 +120,7 @@ DLL_EXPORT bool chreWifiNanRequestRangingAsync(
 
 DLL_EXPORT bool chreWifiNanGetCapabilities(
     struct chreWifiNanCapabilities *capabilities) {
+  chre::EventLoop::SystemLockGuard lock;
   // Not implemented yet.
   UNUSED_VAR(capabilities);
   return false;
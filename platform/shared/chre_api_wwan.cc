@@ -26,6 +26,7 @@ using chre::NanoappPermissions;
 
 DLL_EXPORT uint32_t chreWwanGetCapabilities() {
 #ifdef CHRE_WWAN_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   return chre::EventLoopManagerSingleton::get()
       ->getWwanRequestManager()
       .getCapabilities();
@@ -36,6 +37,7 @@ DLL_EXPORT uint32_t chreWwanGetCapabilities() {
 
 DLL_EXPORT bool chreWwanGetCellInfoAsync(const void *cookie) {
 #ifdef CHRE_WWAN_SUPPORT_ENABLED
+  chre::EventLoop::SystemLockGuard lock;
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return nanoapp->permitPermissionUse(NanoappPermissions::CHRE_PERMS_WWAN) &&
          chre::EventLoopManagerSingleton::get()
@@ -17,6 +17,7 @@
 #include "chre/core/event_loop_manager.h"
 #include "chre/platform/shared/host_protocol_chre.h"
 #include "chre/platform/shared/nanoapp_load_manager.h"
+#include "chre/platform/tracing.h"
 
 namespace chre {
 
@@ -36,6 +37,7 @@ void HostMessageHandlers::handleDebugConfiguration(
 
 void HostMessageHandlers::finishLoadingNanoappCallback(
     SystemCallbackType /*type*/, UniquePtr<LoadNanoappCallbackData> &&cbData) {
+  CHRE_TRACE_START("Finish loading nanoapp");
   constexpr size_t kInitialBufferSize = 48;
   ChreFlatBufferBuilder builder(kInitialBufferSize);
 
@@ -54,6 +56,7 @@ void HostMessageHandlers::finishLoadingNanoappCallback(
     sendFragmentResponse(cbData->hostClientId, cbData->transactionId,
                          cbData->fragmentId, success);
   }
+  CHRE_TRACE_END("Finish loading nanoapp");
 }
 
 void HostMessageHandlers::loadNanoappData(
@@ -61,6 +64,9 @@ void HostMessageHandlers::loadNanoappData(
     uint32_t appVersion, uint32_t appFlags, uint32_t targetApiVersion,
     const void *buffer, size_t bufferLen, uint32_t fragmentId,
     size_t appBinaryLen, bool respondBeforeStart) {
+  CHRE_TRACE_START_DATA("Load nanoapp fragment",
+                        "appId:" TRACE_U64 ",fragment:" TRACE_U32, appId,
+                        fragmentId);
   bool success = true;
 
   if (fragmentId == 0 || fragmentId == 1) {
@@ -126,6 +132,7 @@ void HostMessageHandlers::loadNanoappData(
     // send a response for this fragment
     sendFragmentResponse(hostClientId, transactionId, fragmentId, success);
   }
+  CHRE_TRACE_END("Load nanoapp fragment");
 }
 
 }  // namespace chre
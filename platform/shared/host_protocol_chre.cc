@@ -103,7 +103,9 @@ bool HostProtocolChre::decodeMessageFromHost(const void *message,
       case fbs::ChreMessage::TimeSyncMessage: {
         const auto *request =
             static_cast<const fbs::TimeSyncMessage *>(container->message());
-        HostMessageHandlers::handleTimeSyncMessage(request->offset());
+        HostMessageHandlers::handleTimeSyncMessage(
+            request->offset(), request->drift_ppb(),
+            request->next_sync_delay_ns());
         break;
       }
 
@@ -309,6 +311,18 @@ void HostProtocolChre::encodeLogMessagesV2(ChreFlatBufferBuilder &builder,
   finalize(builder, fbs::ChreMessage::LogMessageV2, message.Union());
 }
 
+void HostProtocolChre::encodeLogMessagesV2(ChreFlatBufferBuilder &builder,
+                                           LogBuffer &logBuffer,
+                                           size_t *numLogsDropped) {
+  size_t numLogsDroppedByBuffer;
+  auto logBufferOffset =
+      logBuffer.drainLogsToVector(builder, &numLogsDroppedByBuffer);
+  *numLogsDropped += numLogsDroppedByBuffer;
+  auto message = fbs::CreateLogMessageV2(
+      builder, logBufferOffset, static_cast<uint32_t>(*numLogsDropped));
+  finalize(builder, fbs::ChreMessage::LogMessageV2, message.Union());
+}
+
 void HostProtocolChre::encodeDebugDumpData(ChreFlatBufferBuilder &builder,
                                            uint16_t hostClientId,
                                            const char *debugStr,
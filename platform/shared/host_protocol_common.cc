@@ -26,6 +26,70 @@ using flatbuffers::Vector;
 
 namespace chre {
 
+namespace {
+
+// Layout of the buffer written by encodeNanoappMessageInPlace(), in offsets
+// from its start. Every field is present, even with its default value, so the
+// layout doesn't depend on the message. Each vtable lists the offsets of the
+// fields of its table in field ID order, as declared in host_messages.fbs.
+constexpr size_t kRootOffset = 0;
+constexpr size_t kContainerVtable = 4;
+constexpr size_t kNanoappMessageVtable = 14;
+constexpr size_t kContainerTable = 32;
+constexpr size_t kNanoappMessageTable = 44;
+constexpr size_t kMessageVector = 76;
+
+static_assert(kMessageVector + sizeof(flatbuffers::uoffset_t) ==
+                  HostProtocolCommon::kNanoappMessagePayloadOffset,
+              "The payload must directly follow the vector length");
+static_assert((kNanoappMessageTable + sizeof(flatbuffers::soffset_t)) %
+                      sizeof(uint64_t) ==
+                  0,
+              "app_id must be 8-byte aligned");
+
+// MessageContainer fields, in offsets from the start of its table.
+constexpr uint16_t kContainerMessage = 4;
+constexpr uint16_t kContainerHostAddr = 8;
+constexpr uint16_t kContainerMessageType = 10;
+constexpr uint16_t kContainerTableSize = 12;
+
+// NanoappMessage fields, in offsets from the start of its table.
+constexpr uint16_t kAppId = 4;
+constexpr uint16_t kMessageType = 12;
+constexpr uint16_t kMessage = 16;
+constexpr uint16_t kMessagePermissions = 20;
+constexpr uint16_t kPermissions = 24;
+constexpr uint16_t kHostEndpoint = 28;
+constexpr uint16_t kWokeHost = 30;
+constexpr uint16_t kNanoappMessageTableSize = 32;
+
+//! Writes a little-endian scalar, which may be misaligned as the transport
+//! buffers encoded into have no alignment guarantee.
+template <typename T>
+void writeScalar(uint8_t *buffer, size_t offset, T value) {
+  T littleEndianValue = flatbuffers::EndianScalar(value);
+  memcpy(buffer + offset, &littleEndianValue, sizeof(littleEndianValue));
+}
+
+void writeVtable(uint8_t *buffer, size_t offset, uint16_t tableSize,
+                 const uint16_t *fieldOffsets, size_t numFields) {
+  auto vtableSize = static_cast<uint16_t>(sizeof(flatbuffers::voffset_t) *
+                                          (2 + numFields));
+  writeScalar(buffer, offset, vtableSize);
+  writeScalar(buffer, offset + 2, tableSize);
+  for (size_t i = 0; i < numFields; i++) {
+    writeScalar(buffer, offset + 4 + 2 * i, fieldOffsets[i]);
+  }
+}
+
+//! Writes the offset at the given position to the given target.
+void writeOffset(uint8_t *buffer, size_t offset, size_t target) {
+  writeScalar(buffer, offset,
+              static_cast<flatbuffers::uoffset_t>(target - offset));
+}
+
+}  // anonymous namespace
+
 void HostProtocolCommon::encodeNanoappMessage(
     FlatBufferBuilder &builder, uint64_t appId, uint32_t messageType,
     uint16_t hostEndpoint, const void *messageData, size_t messageDataLen,
@@ -39,6 +103,61 @@ void HostProtocolCommon::encodeNanoappMessage(
   finalize(builder, fbs::ChreMessage::NanoappMessage, nanoappMessage.Union());
 }
 
+size_t HostProtocolCommon::encodeNanoappMessageInPlace(
+    void *buffer, size_t bufferSize, uint64_t appId, uint32_t messageType,
+    uint16_t hostEndpoint, const void *messageData, size_t messageDataLen,
+    uint32_t permissions, uint32_t messagePermissions, bool wokeHost) {
+  if (bufferSize < kNanoappMessagePayloadOffset ||
+      messageDataLen > bufferSize - kNanoappMessagePayloadOffset) {
+    return 0;
+  }
+
+  auto *data = static_cast<uint8_t *>(buffer);
+  memset(data, 0, kNanoappMessagePayloadOffset);
+
+  writeOffset(data, kRootOffset, kContainerTable);
+
+  constexpr uint16_t kContainerFields[] = {
+      kContainerMessageType, kContainerMessage, kContainerHostAddr};
+  writeVtable(data, kContainerVtable, kContainerTableSize, kContainerFields,
+              sizeof(kContainerFields) / sizeof(kContainerFields[0]));
+  writeScalar(data, kContainerTable,
+              static_cast<flatbuffers::soffset_t>(kContainerTable -
+                                                  kContainerVtable));
+  writeScalar(data, kContainerTable + kContainerMessageType,
+              static_cast<uint8_t>(fbs::ChreMessage::NanoappMessage));
+  writeOffset(data, kContainerTable + kContainerMessage, kNanoappMessageTable);
+  writeScalar(data, kContainerTable + kContainerHostAddr,
+              kHostClientIdUnspecified);
+
+  constexpr uint16_t kNanoappMessageFields[] = {
+      kAppId, kMessageType, kHostEndpoint, kMessage, kMessagePermissions,
+      kPermissions, kWokeHost};
+  writeVtable(data, kNanoappMessageVtable, kNanoappMessageTableSize,
+              kNanoappMessageFields,
+              sizeof(kNanoappMessageFields) / sizeof(kNanoappMessageFields[0]));
+  writeScalar(data, kNanoappMessageTable,
+              static_cast<flatbuffers::soffset_t>(kNanoappMessageTable -
+                                                  kNanoappMessageVtable));
+  writeScalar(data, kNanoappMessageTable + kAppId, appId);
+  writeScalar(data, kNanoappMessageTable + kMessageType, messageType);
+  writeScalar(data, kNanoappMessageTable + kHostEndpoint, hostEndpoint);
+  writeOffset(data, kNanoappMessageTable + kMessage, kMessageVector);
+  writeScalar(data, kNanoappMessageTable + kMessagePermissions,
+              messagePermissions);
+  writeScalar(data, kNanoappMessageTable + kPermissions, permissions);
+  writeScalar(data, kNanoappMessageTable + kWokeHost,
+              static_cast<uint8_t>(wokeHost));
+
+  writeScalar(data, kMessageVector,
+              static_cast<flatbuffers::uoffset_t>(messageDataLen));
+  if (messageData != nullptr && messageDataLen > 0) {
+    memcpy(data + kNanoappMessagePayloadOffset, messageData, messageDataLen);
+  }
+
+  return kNanoappMessagePayloadOffset + messageDataLen;
+}
+
 Offset<Vector<int8_t>> HostProtocolCommon::addStringAsByteVector(
     FlatBufferBuilder &builder, const char *str) {
   return builder.CreateVector(reinterpret_cast<const int8_t *>(str),
@@ -1697,15 +1697,29 @@ inline flatbuffers::Offset<LogMessage> CreateLogMessageDirect(
 struct TimeSyncMessage FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   typedef TimeSyncMessageBuilder Builder;
   enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
-    VT_OFFSET = 4
+    VT_OFFSET = 4,
+    VT_DRIFT_PPB = 6,
+    VT_NEXT_SYNC_DELAY_NS = 8
   };
   /// Offset between AP and CHRE timestamp
   int64_t offset() const {
     return GetField<int64_t>(VT_OFFSET, 0);
   }
+  /// Estimated rate at which the offset drifts, in nanoseconds per second of
+  /// CHRE time (parts per billion). 0 if unknown.
+  int32_t drift_ppb() const {
+    return GetField<int32_t>(VT_DRIFT_PPB, 0);
+  }
+  /// Delay after which CHRE should request the next time sync, in
+  /// nanoseconds. 0 to use the default delay of the platform.
+  uint64_t next_sync_delay_ns() const {
+    return GetField<uint64_t>(VT_NEXT_SYNC_DELAY_NS, 0);
+  }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyField<int64_t>(verifier, VT_OFFSET) &&
+           VerifyField<int32_t>(verifier, VT_DRIFT_PPB) &&
+           VerifyField<uint64_t>(verifier, VT_NEXT_SYNC_DELAY_NS) &&
            verifier.EndTable();
   }
 };
@@ -1717,6 +1731,12 @@ struct TimeSyncMessageBuilder {
   void add_offset(int64_t offset) {
     fbb_.AddElement<int64_t>(TimeSyncMessage::VT_OFFSET, offset, 0);
   }
+  void add_drift_ppb(int32_t drift_ppb) {
+    fbb_.AddElement<int32_t>(TimeSyncMessage::VT_DRIFT_PPB, drift_ppb, 0);
+  }
+  void add_next_sync_delay_ns(uint64_t next_sync_delay_ns) {
+    fbb_.AddElement<uint64_t>(TimeSyncMessage::VT_NEXT_SYNC_DELAY_NS, next_sync_delay_ns, 0);
+  }
   explicit TimeSyncMessageBuilder(flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -1731,9 +1751,13 @@ struct TimeSyncMessageBuilder {
 
 inline flatbuffers::Offset<TimeSyncMessage> CreateTimeSyncMessage(
     flatbuffers::FlatBufferBuilder &_fbb,
-    int64_t offset = 0) {
+    int64_t offset = 0,
+    int32_t drift_ppb = 0,
+    uint64_t next_sync_delay_ns = 0) {
   TimeSyncMessageBuilder builder_(_fbb);
+  builder_.add_next_sync_delay_ns(next_sync_delay_ns);
   builder_.add_offset(offset);
+  builder_.add_drift_ppb(drift_ppb);
   return builder_.Finish();
 }
 
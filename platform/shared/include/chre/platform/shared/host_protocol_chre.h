@@ -24,6 +24,7 @@
 #include "chre/core/settings.h"
 #include "chre/platform/shared/generated/host_messages_generated.h"
 #include "chre/platform/shared/host_protocol_common.h"
+#include "chre/platform/shared/log_buffer.h"
 #include "chre/util/dynamic_vector.h"
 #include "chre/util/flatbuffers/helpers.h"
 #include "chre_api/chre/event.h"
@@ -85,7 +86,8 @@ class HostMessageHandlers {
                                          uint32_t transactionId, uint64_t appId,
                                          bool allowSystemNanoappUnload);
 
-  static void handleTimeSyncMessage(int64_t offset);
+  static void handleTimeSyncMessage(int64_t offset, int32_t driftPpb,
+                                    uint64_t nextSyncDelayNs);
 
   static void handleDebugDumpRequest(uint16_t hostClientId);
 
@@ -246,6 +248,18 @@ class HostProtocolChre : public HostProtocolCommon {
                                   const uint8_t *logBuffer, size_t bufferSize,
                                   uint32_t numLogsDropped);
 
+  /**
+   * Encodes the V2 log messages drained from a log buffer to the host. The logs
+   * are copied once, from the log buffer straight into the message.
+   *
+   * @param logBuffer The log buffer to drain.
+   * @param numLogsDropped Non-null pointer to the number of logs dropped since
+   * CHRE started, which is incremented by the logs dropped by logBuffer.
+   */
+  static void encodeLogMessagesV2(ChreFlatBufferBuilder &builder,
+                                  LogBuffer &logBuffer,
+                                  size_t *numLogsDropped);
+
   /**
    * Encodes a string into a DebugDumpData message.
    *
@@ -17,6 +17,7 @@
 #ifndef CHRE_PLATFORM_SHARED_HOST_PROTOCOL_COMMON_H_
 #define CHRE_PLATFORM_SHARED_HOST_PROTOCOL_COMMON_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include "chre/util/system/napp_permissions.h"
@@ -81,6 +82,42 @@ class HostProtocolCommon {
           static_cast<uint32_t>(chre::NanoappPermissions::CHRE_PERMS_ALL),
       bool wokeHost = false);
 
+  //! The offset of the payload in a nanoapp message encoded by
+  //! encodeNanoappMessageInPlace(), which is also the size of the encoding of
+  //! an empty message.
+  static constexpr size_t kNanoappMessagePayloadOffset = 80;
+
+  /**
+   * Encodes a message from a nanoapp to the host directly into the buffer it
+   * will be sent from, producing a buffer that decodes the same way as one
+   * encoded by encodeNanoappMessage().
+   *
+   * Rather than building the message with a FlatBufferBuilder and copying the
+   * finished buffer, the fixed-layout fields of the message are written around
+   * its payload, which starts at kNanoappMessagePayloadOffset. The payload is
+   * copied once, or not at all when messageData is null and the caller fills
+   * it in place, e.g. by DMA.
+   *
+   * @param buffer The buffer to encode the message into. The fields are laid
+   *        out as if it were aligned to 8 bytes, but it doesn't need to be.
+   * @param bufferSize Size of buffer, in bytes.
+   * @param messageData Pointer to message payload, or null to only reserve
+   *        messageDataLen bytes for it at kNanoappMessagePayloadOffset.
+   * @param messageDataLen Size of the message payload, in bytes.
+   *
+   * The other parameters are the same as encodeNanoappMessage().
+   *
+   * @return The size of the encoded message, or 0 if it doesn't fit in buffer.
+   */
+  static size_t encodeNanoappMessageInPlace(
+      void *buffer, size_t bufferSize, uint64_t appId, uint32_t messageType,
+      uint16_t hostEndpoint, const void *messageData, size_t messageDataLen,
+      uint32_t permissions =
+          static_cast<uint32_t>(chre::NanoappPermissions::CHRE_PERMS_ALL),
+      uint32_t messagePermissions =
+          static_cast<uint32_t>(chre::NanoappPermissions::CHRE_PERMS_ALL),
+      bool wokeHost = false);
+
   /**
    * Adds a string to the provided builder as a byte vector.
    *
@@ -185,6 +185,26 @@ class LogBuffer {
    */
   size_t copyLogs(void *destination, size_t size, size_t *numLogsDropped);
 
+  /**
+   * Moves all the logs out of the buffer into a byte vector created in a
+   * FlatBufferBuilder for their exact size, e.g. the logs of a LogMessageV2.
+   * Unlike copyLogs, the logs are copied once, from the ring buffer straight
+   * into the vector, without staging them in a linear buffer. The vector holds
+   * whole log entries in FIFO order, as formatted internally. This method is
+   * thread-safe. The vector is allocated while holding the lock of the buffer,
+   * so the allocator of the builder must not log.
+   *
+   * @param builder The builder to create the vector in.
+   * @param numLogsDropped Non-null pointer which will be set to the number of
+   * logs dropped since the last time the logs were drained, after which the
+   * count is reset.
+   *
+   * @return The offset of the vector in builder, or a null offset if there are
+   *         no logs in the buffer, in which case nothing is created.
+   */
+  flatbuffers::Offset<flatbuffers::Vector<int8_t>> drainLogsToVector(
+      flatbuffers::FlatBufferBuilder &builder, size_t *numLogsDropped);
+
   /**
    *
    * @param logSize The size of the log payload, including overhead like
@@ -106,6 +106,20 @@ size_t LogBuffer::copyLogs(void *destination, size_t size,
   return copyLogsLocked(destination, size, numLogsDropped);
 }
 
+flatbuffers::Offset<flatbuffers::Vector<int8_t>> LogBuffer::drainLogsToVector(
+    flatbuffers::FlatBufferBuilder &builder, size_t *numLogsDropped) {
+  LockGuard<Mutex> lock(mLock);
+  flatbuffers::Offset<flatbuffers::Vector<int8_t>> logs;
+  if (mBufferDataSize != 0) {
+    int8_t *destination;
+    logs = builder.CreateUninitializedVector(mBufferDataSize, &destination);
+    copyFromBuffer(mBufferDataSize, destination);
+  }
+  *numLogsDropped = mNumLogsDropped;
+  mNumLogsDropped = 0;
+  return logs;
+}
+
 bool LogBuffer::logWouldCauseOverflow(size_t logSize) {
   LockGuard<Mutex> lock(mLock);
   return (mBufferDataSize + logSize + kLogDataOffset > mBufferMaxSize);
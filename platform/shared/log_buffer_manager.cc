@@ -87,19 +87,15 @@ void LogBufferManager::startSendLogsToHostLoop() {
       auto &hostCommsMgr =
           EventLoopManagerSingleton::get()->getHostCommsManager();
       preSecondaryBufferUse();
-      if (mSecondaryLogBuffer.getBufferSize() == 0) {
-        // TODO (b/184178045): Transfer logs into the secondary buffer from
-        // primary if there is room.
-        mPrimaryLogBuffer.transferTo(mSecondaryLogBuffer);
-      }
-      // If the primary buffer was not flushed to the secondary buffer then set
-      // the flag that will cause sendLogsToHost to be run again after
-      // onLogsSentToHost has been called and the secondary buffer has been
-      // cleared out.
-      if (mPrimaryLogBuffer.getBufferSize() > 0) {
-        mLogsBecameReadyWhileFlushPending = true;
-      }
       if (mSecondaryLogBuffer.getBufferSize() > 0) {
+        // The logs moved to the secondary buffer by bufferOverflowGuard are
+        // sent first. If the primary buffer has logs too then set the flag
+        // that will cause sendLogsToHost to be run again after
+        // onLogsSentToHost has been called and the secondary buffer has been
+        // cleared out.
+        if (mPrimaryLogBuffer.getBufferSize() > 0) {
+          mLogsBecameReadyWhileFlushPending = true;
+        }
         mNumLogsDroppedTotal += mSecondaryLogBuffer.getNumLogsDropped();
         mFlushLogsMutex.unlock();
         hostCommsMgr.sendLogMessageV2(mSecondaryLogBuffer.getBufferData(),
@@ -107,6 +103,15 @@ void LogBufferManager::startSendLogsToHostLoop() {
                                       mNumLogsDroppedTotal);
         logWasSent = true;
         mFlushLogsMutex.lock();
+      } else if (mPrimaryLogBuffer.getBufferSize() > 0) {
+        // Drain the primary buffer straight into the message to the host
+        // instead of copying its logs to the secondary buffer first. Only this
+        // thread updates mNumLogsDroppedTotal.
+        mFlushLogsMutex.unlock();
+        hostCommsMgr.sendLogMessageV2(mPrimaryLogBuffer,
+                                      &mNumLogsDroppedTotal);
+        logWasSent = true;
+        mFlushLogsMutex.lock();
       }
     }
     if (!logWasSent) {
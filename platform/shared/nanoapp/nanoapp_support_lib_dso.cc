@@ -452,6 +452,16 @@ bool chreSensorFlushAsync(uint32_t sensorHandle, const void *cookie) {
   return (fptr != nullptr) ? fptr(sensorHandle, cookie) : false;
 }
 
+WEAK_SYMBOL
+bool chreSensorConfigureSynchronizedBatch(const uint32_t *sensorHandles,
+                                          uint8_t sensorCount) {
+  if (chreGetApiVersion() < CHRE_API_VERSION_1_9) {
+    return false;
+  }
+  auto *fptr = CHRE_NSL_LAZY_LOOKUP(chreSensorConfigureSynchronizedBatch);
+  return (fptr != nullptr) ? fptr(sensorHandles, sensorCount) : false;
+}
+
 WEAK_SYMBOL
 void chreConfigureDebugDumpEvent(bool enable) {
   auto *fptr = CHRE_NSL_LAZY_LOOKUP(chreConfigureDebugDumpEvent);
@@ -525,6 +535,24 @@ bool chreGetHostEndpointInfo(uint16_t hostEndpointId,
   return (fptr != nullptr) ? fptr(hostEndpointId, info) : false;
 }
 
+WEAK_SYMBOL
+bool chreEventDataRetain(const void *eventData) {
+  if (chreGetApiVersion() < CHRE_API_VERSION_1_9) {
+    return false;
+  }
+  auto *fptr = CHRE_NSL_LAZY_LOOKUP(chreEventDataRetain);
+  return (fptr != nullptr) ? fptr(eventData) : false;
+}
+
+WEAK_SYMBOL
+bool chreEventDataRelease(const void *eventData) {
+  if (chreGetApiVersion() < CHRE_API_VERSION_1_9) {
+    return false;
+  }
+  auto *fptr = CHRE_NSL_LAZY_LOOKUP(chreEventDataRelease);
+  return (fptr != nullptr) ? fptr(eventData) : false;
+}
+
 bool chreGetNanoappInfoByAppId(uint64_t appId, struct chreNanoappInfo *info) {
   auto *fptr = CHRE_NSL_LAZY_LOOKUP(chreGetNanoappInfoByAppId);
   bool success = (fptr != nullptr) ? fptr(appId, info) : false;
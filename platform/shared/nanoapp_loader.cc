@@ -239,6 +239,7 @@ const ExportedData kExportedData[] = {
     ADD_EXPORTED_C_SYMBOL(chreSendMessageWithPermissions),
     ADD_EXPORTED_C_SYMBOL(chreSensorConfigure),
     ADD_EXPORTED_C_SYMBOL(chreSensorConfigureBiasEvents),
+    ADD_EXPORTED_C_SYMBOL(chreSensorConfigureSynchronizedBatch),
     ADD_EXPORTED_C_SYMBOL(chreSensorFind),
     ADD_EXPORTED_C_SYMBOL(chreSensorFindDefault),
     ADD_EXPORTED_C_SYMBOL(chreSensorFlushAsync),
@@ -260,6 +261,8 @@ const ExportedData kExportedData[] = {
     ADD_EXPORTED_C_SYMBOL(chreConfigureHostEndpointNotifications),
     ADD_EXPORTED_C_SYMBOL(chrePublishRpcServices),
     ADD_EXPORTED_C_SYMBOL(chreGetHostEndpointInfo),
+    ADD_EXPORTED_C_SYMBOL(chreEventDataRetain),
+    ADD_EXPORTED_C_SYMBOL(chreEventDataRelease),
 };
 CHRE_DEPRECATED_EPILOGUE
 // clang-format on
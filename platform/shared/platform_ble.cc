@@ -22,6 +22,7 @@
 #include "chre/platform/log.h"
 #include "chre/platform/shared/bt_snoop_log.h"
 #include "chre/platform/shared/pal_system_api.h"
+#include "chre/platform/tracing.h"
 #include "chre_api/chre/ble.h"
 
 namespace chre {
@@ -117,12 +118,14 @@ void PlatformBleBase::requestStateResync() {
 
 void PlatformBleBase::scanStatusChangeCallback(bool enabled,
                                                uint8_t errorCode) {
+  CHRE_TRACE_INSTANT("BLE scan status callback", "pal");
   EventLoopManagerSingleton::get()->getBleRequestManager().handlePlatformChange(
       enabled, errorCode);
 }
 
 void PlatformBleBase::advertisingEventCallback(
     struct chreBleAdvertisementEvent *event) {
+  CHRE_TRACE_INSTANT("BLE advertising event callback", "pal");
   EventLoopManagerSingleton::get()
       ->getBleRequestManager()
       .handleAdvertisementEvent(event);
@@ -21,6 +21,7 @@
 #include "chre/core/event_loop_manager.h"
 #include "chre/platform/log.h"
 #include "chre/platform/shared/pal_system_api.h"
+#include "chre/platform/tracing.h"
 
 namespace chre {
 
@@ -99,6 +100,7 @@ void PlatformGnssBase::requestStateResyncCallback() {
 
 void PlatformGnssBase::locationStatusChangeCallback(bool enabled,
                                                     uint8_t errorCode) {
+  CHRE_TRACE_INSTANT("GNSS location status callback", "pal");
   EventLoopManagerSingleton::get()
       ->getGnssManager()
       .getLocationSession()
@@ -107,6 +109,7 @@ void PlatformGnssBase::locationStatusChangeCallback(bool enabled,
 
 void PlatformGnssBase::locationEventCallback(
     struct chreGnssLocationEvent *event) {
+  CHRE_TRACE_INSTANT("GNSS location event callback", "pal");
   EventLoopManagerSingleton::get()
       ->getGnssManager()
       .getLocationSession()
@@ -143,6 +146,7 @@ bool PlatformGnss::configurePassiveLocationListener(bool enable) {
 
 void PlatformGnssBase::measurementStatusChangeCallback(bool enabled,
                                                        uint8_t errorCode) {
+  CHRE_TRACE_INSTANT("GNSS measurement status callback", "pal");
   EventLoopManagerSingleton::get()
       ->getGnssManager()
       .getMeasurementSession()
@@ -151,6 +155,7 @@ void PlatformGnssBase::measurementStatusChangeCallback(bool enabled,
 
 void PlatformGnssBase::measurementEventCallback(
     struct chreGnssDataEvent *event) {
+  CHRE_TRACE_INSTANT("GNSS measurement event callback", "pal");
   EventLoopManagerSingleton::get()
       ->getGnssManager()
       .getMeasurementSession()
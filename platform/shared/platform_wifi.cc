@@ -21,6 +21,7 @@
 #include "chre/core/event_loop_manager.h"
 #include "chre/platform/log.h"
 #include "chre/platform/shared/pal_system_api.h"
+#include "chre/platform/tracing.h"
 #include "chre/util/system/wifi_util.h"
 
 namespace chre {
@@ -176,23 +177,27 @@ bool PlatformWifi::nanSubscribeCancel(uint32_t subscriptionId) {
 
 void PlatformWifiBase::rangingEventCallback(
     uint8_t errorCode, struct chreWifiRangingEvent *event) {
+  CHRE_TRACE_INSTANT("Wifi ranging event callback", "pal");
   EventLoopManagerSingleton::get()->getWifiRequestManager().handleRangingEvent(
       errorCode, event);
 }
 
 void PlatformWifiBase::scanMonitorStatusChangeCallback(bool enabled,
                                                        uint8_t errorCode) {
+  CHRE_TRACE_INSTANT("Wifi scan monitor callback", "pal");
   EventLoopManagerSingleton::get()
       ->getWifiRequestManager()
       .handleScanMonitorStateChange(enabled, errorCode);
 }
 
 void PlatformWifiBase::scanResponseCallback(bool pending, uint8_t errorCode) {
+  CHRE_TRACE_INSTANT("Wifi scan response callback", "pal");
   EventLoopManagerSingleton::get()->getWifiRequestManager().handleScanResponse(
       pending, errorCode);
 }
 
 void PlatformWifiBase::scanEventCallback(struct chreWifiScanEvent *event) {
+  CHRE_TRACE_INSTANT("Wifi scan event callback", "pal");
   EventLoopManagerSingleton::get()->getWifiRequestManager().handleScanEvent(
       event);
 }
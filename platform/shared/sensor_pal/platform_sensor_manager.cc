@@ -21,6 +21,7 @@
 #include "chre/core/event_loop_manager.h"
 #include "chre/platform/log.h"
 #include "chre/platform/shared/pal_system_api.h"
+#include "chre/platform/tracing.h"
 
 namespace chre {
 
@@ -130,6 +131,8 @@ bool PlatformSensorManager::flush(const Sensor &sensor,
 
 void PlatformSensorManagerBase::samplingStatusUpdateCallback(
     uint32_t sensorHandle, struct chreSensorSamplingStatus *status) {
+  CHRE_TRACE_INSTANT_DATA("Sensor sampling status callback",
+                          "handle:" TRACE_U32, sensorHandle);
   EventLoopManagerSingleton::get()
       ->getSensorRequestManager()
       .handleSamplingStatusUpdate(sensorHandle, status);
@@ -137,6 +140,8 @@ void PlatformSensorManagerBase::samplingStatusUpdateCallback(
 
 void PlatformSensorManagerBase::dataEventCallback(uint32_t sensorHandle,
                                                   void *data) {
+  CHRE_TRACE_INSTANT_DATA("Sensor data event callback", "handle:" TRACE_U32,
+                          sensorHandle);
   EventLoopManagerSingleton::get()
       ->getSensorRequestManager()
       .handleSensorDataEvent(sensorHandle, data);
@@ -144,6 +149,8 @@ void PlatformSensorManagerBase::dataEventCallback(uint32_t sensorHandle,
 
 void PlatformSensorManagerBase::biasEventCallback(uint32_t sensorHandle,
                                                   void *biasData) {
+  CHRE_TRACE_INSTANT_DATA("Sensor bias event callback", "handle:" TRACE_U32,
+                          sensorHandle);
   EventLoopManagerSingleton::get()->getSensorRequestManager().handleBiasEvent(
       sensorHandle, biasData);
 }
@@ -151,6 +158,8 @@ void PlatformSensorManagerBase::biasEventCallback(uint32_t sensorHandle,
 void PlatformSensorManagerBase::flushCompleteCallback(uint32_t sensorHandle,
                                                       uint32_t flushRequestId,
                                                       uint8_t errorCode) {
+  CHRE_TRACE_INSTANT_DATA("Sensor flush complete callback",
+                          "handle:" TRACE_U32, sensorHandle);
   EventLoopManagerSingleton::get()
       ->getSensorRequestManager()
       .handleFlushCompleteEvent(sensorHandle, flushRequestId, errorCode);
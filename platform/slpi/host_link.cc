@@ -37,12 +37,14 @@
 #include "chre/platform/system_time.h"
 #include "chre/platform/system_timer.h"
 #include "chre/util/fixed_size_blocking_queue.h"
+#include "chre/util/flatbuffers/builder_pool.h"
 #include "chre/util/flatbuffers/helpers.h"
 #include "chre/util/macros.h"
 #include "chre/util/nested_data_ptr.h"
 #include "chre/util/unique_ptr.h"
 #include "chre_api/chre/version.h"
 
+#include <algorithm>
 #include <inttypes.h>
 #include <limits.h>
 
@@ -52,10 +54,22 @@ namespace {
 
 constexpr size_t kOutboundQueueSize = 32;
 
+//! The builders kept for messages encoded by buildAndEnqueueMessage(), sized
+//! for the responses and notifications it sends.
+constexpr size_t kNumPooledBuilders = 4;
+constexpr size_t kPooledBuilderSize = 256;
+ChreFlatBufferBuilderPool<kNumPooledBuilders, kPooledBuilderSize> gBuilderPool;
+
 //! The last time a time sync request message has been sent.
 //! TODO: Make this a member of HostLinkBase
 Nanoseconds gLastTimeSyncRequestNanos(0);
 
+//! The period after which a time sync is requested opportunistically when
+//! sending messages to the host, which follows the delay suggested by the
+//! host once it has estimated the drift of the offset.
+constexpr Seconds kOpportunisticTimeSyncPeriod = Seconds(60 * 60 * 1);
+Nanoseconds gOpportunisticTimeSyncPeriod(kOpportunisticTimeSyncPeriod);
+
 struct NanoappListData {
   ChreFlatBufferBuilder *builder;
   DynamicVector<NanoappListEntryOffset> nanoappEntries;
@@ -181,8 +195,8 @@ bool buildAndEnqueueMessage(PendingMessageType msgType,
                             MessageBuilderFunction *msgBuilder, void *cookie) {
   bool pushed = false;
 
-  auto builder = MakeUnique<ChreFlatBufferBuilder>(initialBufferSize);
-  if (builder.isNull()) {
+  ChreFlatBufferBuilder *builder = gBuilderPool.allocate(initialBufferSize);
+  if (builder == nullptr) {
     LOGE("Couldn't allocate memory for message type %d",
          static_cast<int>(msgType));
   } else {
@@ -190,11 +204,11 @@ bool buildAndEnqueueMessage(PendingMessageType msgType,
 
     // TODO: if this fails, ideally we should block for some timeout until
     // there's space in the queue
-    if (!enqueueMessage(PendingMessage(msgType, builder.get()))) {
+    if (!enqueueMessage(PendingMessage(msgType, builder))) {
       LOGE("Couldn't push message type %d to outbound queue",
            static_cast<int>(msgType));
+      gBuilderPool.release(builder);
     } else {
-      builder.release();
       pushed = true;
     }
   }
@@ -249,17 +263,22 @@ void handleUnloadNanoappCallback(SystemCallbackType /*type*/,
 
 int generateMessageToHost(const MessageToHost *msgToHost, unsigned char *buffer,
                           size_t bufferSize, unsigned int *messageLen) {
-  // TODO: ideally we'd construct our flatbuffer directly in the
-  // host-supplied buffer
-  constexpr size_t kFixedSizePortion = 80;
-  ChreFlatBufferBuilder builder(msgToHost->message.size() + kFixedSizePortion);
-  HostProtocolChre::encodeNanoappMessage(
-      builder, msgToHost->appId, msgToHost->toHostData.messageType,
+  // The message is encoded directly in the host-supplied buffer, so its
+  // payload is only copied once.
+  int result;
+  size_t size = HostProtocolChre::encodeNanoappMessageInPlace(
+      buffer, bufferSize, msgToHost->appId, msgToHost->toHostData.messageType,
       msgToHost->toHostData.hostEndpoint, msgToHost->message.data(),
       msgToHost->message.size(), msgToHost->toHostData.appPermissions,
       msgToHost->toHostData.messagePermissions, msgToHost->toHostData.wokeHost);
-
-  int result = copyToHostBuffer(builder, buffer, bufferSize, messageLen);
+  if (size == 0) {
+    LOGE("Message of size %zu too big for host buffer %zu; dropping",
+         msgToHost->message.size(), bufferSize);
+    result = CHRE_FASTRPC_ERROR;
+  } else {
+    *messageLen = size;
+    result = CHRE_FASTRPC_SUCCESS;
+  }
 
   auto &hostCommsManager =
       EventLoopManagerSingleton::get()->getHostCommsManager();
@@ -312,8 +331,7 @@ int generateMessageFromBuilder(ChreFlatBufferBuilder *builder,
   UNUSED_VAR(isEncodedLogMessage);
 #endif
 
-  builder->~ChreFlatBufferBuilder();
-  memoryFree(builder);
+  gBuilderPool.release(builder);
   return result;
 }
 
@@ -521,10 +539,9 @@ extern "C" int chre_slpi_get_message_to_host(unsigned char *buffer,
     }
   }
 
-  // Opportunistically send a time sync message (1 hour period threshold)
-  constexpr Seconds kOpportunisticTimeSyncPeriod = Seconds(60 * 60 * 1);
+  // Opportunistically send a time sync message
   if (SystemTime::getMonotonicTime() >
-      gLastTimeSyncRequestNanos + kOpportunisticTimeSyncPeriod) {
+      gLastTimeSyncRequestNanos + gOpportunisticTimeSyncPeriod) {
     sendTimeSyncRequest();
   }
 
@@ -675,6 +692,26 @@ void HostLinkBase::sendLogMessageV2(const uint8_t *logMessage,
                          msgBuilder, &logMessageData);
 }
 
+void HostLinkBase::sendLogMessageV2(LogBuffer &logBuffer,
+                                    size_t *numLogsDropped) {
+  struct LogBufferData {
+    LogBuffer *logBuffer;
+    size_t *numLogsDropped;
+  };
+
+  LogBufferData logBufferData{&logBuffer, numLogsDropped};
+
+  auto msgBuilder = [](ChreFlatBufferBuilder &builder, void *cookie) {
+    const auto *data = static_cast<const LogBufferData *>(cookie);
+    HostProtocolChre::encodeLogMessagesV2(builder, *data->logBuffer,
+                                          data->numLogsDropped);
+  };
+
+  constexpr size_t kInitialSize = 128;
+  buildAndEnqueueMessage(PendingMessageType::EncodedLogMessage, kInitialSize,
+                         msgBuilder, &logBufferData);
+}
+
 void HostLinkBase::sendNanConfiguration(bool enable) {
   auto msgBuilder = [](ChreFlatBufferBuilder &builder, void *cookie) {
     const auto *data = static_cast<const bool *>(cookie);
@@ -873,13 +910,25 @@ void HostMessageHandlers::handleUnloadNanoappRequest(
   }
 }
 
-void HostMessageHandlers::handleTimeSyncMessage(int64_t offset) {
-  SystemTime::setEstimatedHostTimeOffset(offset);
+void HostMessageHandlers::handleTimeSyncMessage(int64_t offset,
+                                                int32_t driftPpb,
+                                                uint64_t nextSyncDelayNs) {
+  SystemTime::setEstimatedHostTimeOffset(offset, driftPpb);
 
-  // Schedule a time sync request since offset may drift
+  // Schedule a time sync request since offset may drift, when the host asks
+  // for it if it estimated how stable the drift is
   constexpr Seconds kClockDriftTimeSyncPeriod =
       Seconds(60 * 60 * 6);  // 6 hours
-  setTimeSyncRequestTimer(kClockDriftTimeSyncPeriod);
+  constexpr Seconds kMinTimeSyncPeriod = Seconds(60);
+  if (nextSyncDelayNs == 0) {
+    gOpportunisticTimeSyncPeriod = kOpportunisticTimeSyncPeriod;
+    setTimeSyncRequestTimer(kClockDriftTimeSyncPeriod);
+  } else {
+    Nanoseconds delay(
+        std::max(nextSyncDelayNs, kMinTimeSyncPeriod.toRawNanoseconds()));
+    gOpportunisticTimeSyncPeriod = delay;
+    setTimeSyncRequestTimer(delay);
+  }
 }
 
 void HostMessageHandlers::handleDebugDumpRequest(uint16_t hostClientId) {
@@ -25,6 +25,8 @@
 
 namespace chre {
 
+class LogBuffer;
+
 /**
  * Helper function to send debug dump result to host.
  */
@@ -67,6 +69,16 @@ class HostLinkBase {
   void sendLogMessageV2(const uint8_t *logMessage, size_t logMessageSize,
                         uint32_t numLogsDropped);
 
+  /**
+   * Enqueues a V2 log message to be sent to the host, with the logs drained
+   * from a log buffer straight into it.
+   *
+   * @param logBuffer The log buffer to drain.
+   * @param numLogsDropped Non-null pointer to the number of logs dropped since
+   * CHRE start, which is incremented by the logs dropped by logBuffer.
+   */
+  void sendLogMessageV2(LogBuffer &logBuffer, size_t *numLogsDropped);
+
   /**
    * Enqueues a NAN configuration request to be sent to the host.
    *
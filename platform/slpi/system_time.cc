@@ -16,7 +16,9 @@
 
 #include "chre/platform/system_time.h"
 
+#include "chre/platform/mutex.h"
 #include "chre/platform/slpi/system_time_util.h"
+#include "chre/util/lock_guard.h"
 
 extern "C" {
 
@@ -26,7 +28,18 @@ extern "C" {
 
 namespace {
 
-int64_t gEstimatedHostTimeOffset = 0;
+//! The estimated host time offset, with its drift rate and the CHRE time at
+//! which it was set.
+struct HostTimeOffset {
+  int64_t offset;
+  int32_t driftPpb;
+  uint64_t setNanos;
+};
+
+//! Set from the FastRPC thread and read from any thread, so it is only
+//! copied as a whole under gEstimatedHostTimeOffsetMutex.
+HostTimeOffset gEstimatedHostTimeOffset = {};
+chre::Mutex gEstimatedHostTimeOffsetMutex;
 
 }  // anonymous namespace
 
@@ -37,11 +50,38 @@ Nanoseconds SystemTime::getMonotonicTime() {
 }
 
 int64_t SystemTime::getEstimatedHostTimeOffset() {
-  return gEstimatedHostTimeOffset;
+  HostTimeOffset estimate;
+  {
+    LockGuard<Mutex> lock(gEstimatedHostTimeOffsetMutex);
+    estimate = gEstimatedHostTimeOffset;
+  }
+
+  int64_t offset = estimate.offset;
+  int64_t driftPpb = estimate.driftPpb;
+  if (driftPpb != 0) {
+    // Split the elapsed time in seconds so that the drift of a few days at
+    // any realistic rate doesn't overflow.
+    uint64_t elapsedNanos =
+        getMonotonicTime().toRawNanoseconds() - estimate.setNanos;
+    int64_t elapsedSeconds =
+        static_cast<int64_t>(elapsedNanos / kOneSecondInNanoseconds);
+    int64_t remainderNanos =
+        static_cast<int64_t>(elapsedNanos % kOneSecondInNanoseconds);
+    offset += elapsedSeconds * driftPpb +
+              remainderNanos * driftPpb /
+                  static_cast<int64_t>(kOneSecondInNanoseconds);
+  }
+  return offset;
 }
 
-void SystemTime::setEstimatedHostTimeOffset(int64_t offset) {
-  gEstimatedHostTimeOffset = offset;
+void SystemTime::setEstimatedHostTimeOffset(int64_t offset, int32_t driftPpb) {
+  HostTimeOffset estimate = {
+      .offset = offset,
+      .driftPpb = driftPpb,
+      .setNanos = getMonotonicTime().toRawNanoseconds(),
+  };
+  LockGuard<Mutex> lock(gEstimatedHostTimeOffsetMutex);
+  gEstimatedHostTimeOffset = estimate;
 }
 
 }  // namespace chre
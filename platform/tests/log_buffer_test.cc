@@ -17,14 +17,18 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <string>
+#include <vector>
 
 #include "chre/platform/atomic.h"
 #include "chre/platform/condition_variable.h"
 #include "chre/platform/mutex.h"
 #include "chre/platform/shared/bt_snoop_log.h"
 #include "chre/platform/shared/log_buffer.h"
+#include "chre/util/flatbuffers/helpers.h"
 
 using testing::ContainerEq;
+using testing::Each;
+using testing::ElementsAre;
 
 namespace chre {
 
@@ -48,6 +52,69 @@ void copyStringWithOffset(char *destination, const char *source,
   memcpy(destination, source + sourceOffset, strlength + 1);
 }
 
+/**
+ * Wraps the logs vector created in builder into a LogMessageV2 as
+ * HostProtocolChre does.
+ */
+void finishLogMessageV2(ChreFlatBufferBuilder &builder,
+                        flatbuffers::Offset<flatbuffers::Vector<int8_t>> logs,
+                        size_t numLogsDropped) {
+  auto message = fbs::CreateLogMessageV2(builder, logs,
+                                         static_cast<uint32_t>(numLogsDropped));
+  fbs::HostAddress hostAddr(0);
+  builder.Finish(fbs::CreateMessageContainer(
+      builder, fbs::ChreMessage::LogMessageV2, message.Union(), &hostAddr));
+}
+
+/**
+ * Decodes a LogMessageV2 the way the host does, splitting its buffer into log
+ * entries by their type.
+ *
+ * @param logs Filled with the payload of each log entry. String logs don't
+ * include their null terminator.
+ * @return false if the message is malformed.
+ */
+bool decodeLogMessageV2(const ChreFlatBufferBuilder &builder,
+                        std::vector<std::string> *logs,
+                        uint32_t *numLogsDropped) {
+  flatbuffers::Verifier verifier(builder.GetBufferPointer(),
+                                 builder.GetSize());
+  if (!fbs::VerifyMessageContainerBuffer(verifier)) {
+    return false;
+  }
+  const fbs::LogMessageV2 *message =
+      fbs::GetMessageContainer(builder.GetBufferPointer())
+          ->message_as_LogMessageV2();
+  if (message == nullptr) {
+    return false;
+  }
+  *numLogsDropped = message->num_logs_dropped();
+  const auto *buffer =
+      reinterpret_cast<const char *>(message->buffer()->data());
+  size_t size = message->buffer()->size();
+  size_t offset = 0;
+  while (offset < size) {
+    if (size - offset <= LogBuffer::kLogDataOffset) {
+      return false;
+    }
+    auto type = static_cast<LogType>(static_cast<uint8_t>(buffer[offset]) >> 4);
+    const char *data = buffer + offset + LogBuffer::kLogDataOffset;
+    size_t dataSize;
+    if (type == LogType::STRING) {
+      logs->emplace_back(data, strnlen(data, size - (data - buffer)));
+      dataSize = logs->back().size() + LogBuffer::kStringLogOverhead;
+    } else if (type == LogType::TOKENIZED) {
+      dataSize = static_cast<uint8_t>(data[0]) + LogBuffer::kTokenizedLogOffset;
+      logs->emplace_back(data + LogBuffer::kTokenizedLogOffset,
+                         dataSize - LogBuffer::kTokenizedLogOffset);
+    } else {
+      return false;
+    }
+    offset += LogBuffer::kLogDataOffset + dataSize;
+  }
+  return offset == size;
+}
+
 TEST(LogBuffer, HandleOneLogAndCopy) {
   char buffer[kDefaultBufferSize];
   constexpr size_t kOutBufferSize = 20;
@@ -439,6 +506,138 @@ TEST(LogBuffer, GetLogDataLengthTest) {
             LogBuffer::kBtSnoopLogOffset + kLogPayloadSize);
 }
 
+TEST(LogBuffer, DrainLogsToVectorPreservesLogs) {
+  char buffer[kDefaultBufferSize];
+  TestLogBufferCallback callback;
+  LogBuffer logBuffer(&callback, buffer, kDefaultBufferSize);
+
+  // Wrap around the ring buffer, dropping the first log, so the logs drained
+  // span its end.
+  constexpr size_t kLogPayloadSize = 100;
+  constexpr int kNumInsertions = 10;
+  for (int i = 0; i < kNumInsertions; i++) {
+    std::string testLogStr(kLogPayloadSize, 'a' + i);
+    logBuffer.handleLog(LogBufferLogLevel::INFO, 0, testLogStr.c_str());
+  }
+  const uint8_t kTokenizedLog[] = {1, 2, 3};
+  logBuffer.handleEncodedLog(LogBufferLogLevel::WARN, 0, kTokenizedLog,
+                             sizeof(kTokenizedLog));
+  size_t bufferSize = logBuffer.getBufferSize();
+  size_t numLogsDroppedExpected = logBuffer.getNumLogsDropped();
+  ASSERT_GT(numLogsDroppedExpected, 0);
+
+  ChreFlatBufferBuilder builder;
+  size_t numLogsDropped;
+  auto logs = logBuffer.drainLogsToVector(builder, &numLogsDropped);
+  ASSERT_FALSE(logs.IsNull());
+  EXPECT_EQ(numLogsDropped, numLogsDroppedExpected);
+  EXPECT_EQ(logBuffer.getBufferSize(), 0);
+  EXPECT_EQ(logBuffer.getNumLogsDropped(), 0);
+  finishLogMessageV2(builder, logs, numLogsDropped);
+
+  std::vector<std::string> decodedLogs;
+  uint32_t decodedNumLogsDropped;
+  ASSERT_TRUE(
+      decodeLogMessageV2(builder, &decodedLogs, &decodedNumLogsDropped));
+  EXPECT_EQ(decodedNumLogsDropped, numLogsDroppedExpected);
+  ASSERT_EQ(decodedLogs.size(), kNumInsertions - numLogsDroppedExpected + 1);
+  for (size_t i = 0; i + 1 < decodedLogs.size(); i++) {
+    EXPECT_EQ(decodedLogs[i],
+              std::string(kLogPayloadSize, 'a' + numLogsDroppedExpected + i));
+  }
+  EXPECT_EQ(decodedLogs.back(),
+            std::string(reinterpret_cast<const char *>(kTokenizedLog),
+                        sizeof(kTokenizedLog)));
+  EXPECT_EQ(
+      fbs::GetMessageContainer(builder.GetBufferPointer())
+          ->message_as_LogMessageV2()
+          ->buffer()
+          ->size(),
+      bufferSize);
+}
+
+TEST(LogBuffer, DrainLogsToVectorOfEmptyBuffer) {
+  char buffer[kDefaultBufferSize];
+  TestLogBufferCallback callback;
+  LogBuffer logBuffer(&callback, buffer, kDefaultBufferSize);
+
+  ChreFlatBufferBuilder builder;
+  size_t numLogsDropped;
+  EXPECT_TRUE(logBuffer.drainLogsToVector(builder, &numLogsDropped).IsNull());
+  EXPECT_EQ(numLogsDropped, 0);
+  EXPECT_EQ(builder.GetSize(), 0);
+
+  // The logs drained next are only the ones logged after the previous drain.
+  logBuffer.handleLog(LogBufferLogLevel::INFO, 0, "first");
+  logBuffer.drainLogsToVector(builder, &numLogsDropped);
+  logBuffer.handleLog(LogBufferLogLevel::INFO, 0, "second");
+  builder.Clear();
+  auto logs = logBuffer.drainLogsToVector(builder, &numLogsDropped);
+  finishLogMessageV2(builder, logs, numLogsDropped);
+
+  std::vector<std::string> decodedLogs;
+  uint32_t decodedNumLogsDropped;
+  ASSERT_TRUE(
+      decodeLogMessageV2(builder, &decodedLogs, &decodedNumLogsDropped));
+  EXPECT_THAT(decodedLogs, ElementsAre("second"));
+}
+
+TEST(LogBuffer, DrainLogsToVectorMatchesStagedLogs) {
+  constexpr size_t kBufferSize = 8 * 1024;
+  constexpr int kNumFlushes = 3;
+  char buffer[kBufferSize];
+  char stagingBuffer[kBufferSize];
+  TestLogBufferCallback callback;
+  LogBuffer logBuffer(&callback, buffer, kBufferSize);
+  LogBuffer stagingLogBuffer(&callback, stagingBuffer, kBufferSize);
+  ChreFlatBufferBuilder builder(kBufferSize + 128);
+  const std::string testLogStr(80, 'a');
+
+  auto fillBuffer = [&]() {
+    size_t numLogs = 0;
+    while (!logBuffer.logWouldCauseOverflow(testLogStr.size() +
+                                            LogBuffer::kStringLogOverhead)) {
+      logBuffer.handleLog(LogBufferLogLevel::INFO, 0, testLogStr.c_str());
+      numLogs++;
+    }
+    return numLogs;
+  };
+
+  for (int i = 0; i < kNumFlushes; i++) {
+    // Staged as before: the logs are copied into the secondary buffer and
+    // then into the message.
+    size_t numLogs = fillBuffer();
+    logBuffer.transferTo(stagingLogBuffer);
+    builder.Clear();
+    finishLogMessageV2(
+        builder,
+        builder.CreateVector(
+            reinterpret_cast<const int8_t *>(stagingLogBuffer.getBufferData()),
+            stagingLogBuffer.getBufferSize()),
+        stagingLogBuffer.getNumLogsDropped());
+    stagingLogBuffer.reset();
+
+    std::vector<std::string> stagedLogs;
+    uint32_t numLogsDropped;
+    ASSERT_TRUE(decodeLogMessageV2(builder, &stagedLogs, &numLogsDropped));
+    EXPECT_EQ(numLogsDropped, 0);
+
+    // Drained straight into the message.
+    ASSERT_EQ(fillBuffer(), numLogs);
+    builder.Clear();
+    size_t numLogsDroppedByBuffer;
+    auto logs = logBuffer.drainLogsToVector(builder, &numLogsDroppedByBuffer);
+    finishLogMessageV2(builder, logs, numLogsDroppedByBuffer);
+
+    std::vector<std::string> drainedLogs;
+    ASSERT_TRUE(decodeLogMessageV2(builder, &drainedLogs, &numLogsDropped));
+    EXPECT_EQ(numLogsDropped, 0);
+    EXPECT_EQ(drainedLogs.size(), numLogs);
+    EXPECT_THAT(drainedLogs, Each(testLogStr));
+    EXPECT_EQ(drainedLogs, stagedLogs);
+  }
+}
+
 // TODO(srok): Add multithreaded tests
 
 }  // namespace chre
@@ -27,6 +27,7 @@
 #include "chre/platform/shared/nanoapp_load_manager.h"
 #include "chre/platform/system_time.h"
 #include "chre/platform/system_timer.h"
+#include "chre/util/flatbuffers/builder_pool.h"
 #include "chre/util/flatbuffers/helpers.h"
 #include "chre/util/nested_data_ptr.h"
 
@@ -158,6 +159,13 @@ constexpr size_t kOutboundQueueSize = 100;
 DRAM_REGION_VARIABLE FixedSizeBlockingQueue<PendingMessage, kOutboundQueueSize>
     gOutboundQueue;
 
+//! The builders kept for messages encoded by buildAndEnqueueMessage(), sized
+//! for the responses and notifications it sends.
+constexpr size_t kNumPooledBuilders = 4;
+constexpr size_t kPooledBuilderSize = 256;
+DRAM_REGION_VARIABLE
+ChreFlatBufferBuilderPool<kNumPooledBuilders, kPooledBuilderSize> gBuilderPool;
+
 typedef void(MessageBuilderFunction)(ChreFlatBufferBuilder &builder,
                                      void *cookie);
 
@@ -173,8 +181,7 @@ DRAM_REGION_FUNCTION bool generateMessageFromBuilder(
       HostLinkBase::send(builder->GetBufferPointer(), builder->GetSize());
 
   // clean up
-  builder->~ChreFlatBufferBuilder();
-  memoryFree(builder);
+  gBuilderPool.release(builder);
   return result;
 }
 
@@ -291,18 +298,18 @@ DRAM_REGION_FUNCTION bool buildAndEnqueueMessage(
   LOGV("%s: message type %d, size %zu", __func__, msgType, initialBufferSize);
   bool pushed = false;
 
-  auto builder = MakeUnique<ChreFlatBufferBuilder>(initialBufferSize);
-  if (builder.isNull()) {
+  ChreFlatBufferBuilder *builder = gBuilderPool.allocate(initialBufferSize);
+  if (builder == nullptr) {
     LOGE("Couldn't allocate memory for message type %d",
          static_cast<int>(msgType));
   } else {
     msgBuilder(*builder, cookie);
 
-    if (!enqueueMessage(PendingMessage(msgType, builder.get()))) {
+    if (!enqueueMessage(PendingMessage(msgType, builder))) {
       LOGE("Couldn't push message type %d to outbound queue",
            static_cast<int>(msgType));
+      gBuilderPool.release(builder);
     } else {
-      builder.release();
       pushed = true;
     }
   }
@@ -356,16 +363,19 @@ DRAM_REGION_FUNCTION void handleUnloadNanoappCallback(uint16_t /*type*/,
   }
 
   constexpr size_t kInitialBufferSize = 52;
-  auto builder = MakeUnique<ChreFlatBufferBuilder>(kInitialBufferSize);
-  HostProtocolChre::encodeUnloadNanoappResponse(*builder, cbData->hostClientId,
-                                                cbData->transactionId, success);
-
-  if (!enqueueMessage(PendingMessage(PendingMessageType::UnloadNanoappResponse,
-                                     builder.get()))) {
-    LOGE("Failed to send unload response to host: %x transactionID: 0x%x",
-         cbData->hostClientId, cbData->transactionId);
+  ChreFlatBufferBuilder *builder = gBuilderPool.allocate(kInitialBufferSize);
+  if (builder == nullptr) {
+    LOG_OOM();
   } else {
-    builder.release();
+    HostProtocolChre::encodeUnloadNanoappResponse(
+        *builder, cbData->hostClientId, cbData->transactionId, success);
+
+    if (!enqueueMessage(PendingMessage(
+            PendingMessageType::UnloadNanoappResponse, builder))) {
+      LOGE("Failed to send unload response to host: %x transactionID: 0x%x",
+           cbData->hostClientId, cbData->transactionId);
+      gBuilderPool.release(builder);
+    }
   }
 
   memoryFree(data);
@@ -655,6 +665,40 @@ DRAM_REGION_FUNCTION void HostLinkBase::sendLogMessageV2(
 #endif
 }
 
+DRAM_REGION_FUNCTION void HostLinkBase::sendLogMessageV2(
+    LogBuffer &logBuffer, size_t *numLogsDropped) {
+  LOGV("%s: size %zu", __func__, logBuffer.getBufferSize());
+  struct LogBufferData {
+    LogBuffer *logBuffer;
+    size_t *numLogsDropped;
+  };
+
+  LogBufferData logBufferData{&logBuffer, numLogsDropped};
+
+  auto msgBuilder = [](ChreFlatBufferBuilder &builder, void *cookie) {
+    const auto *data = static_cast<const LogBufferData *>(cookie);
+    HostProtocolChre::encodeLogMessagesV2(builder, *data->logBuffer,
+                                          data->numLogsDropped);
+  };
+
+  constexpr size_t kInitialSize = 128;
+  bool result = false;
+  if (isInitialized()) {
+    result = buildAndEnqueueMessage(
+        PendingMessageType::EncodedLogMessage,
+        kInitialSize + logBuffer.getBufferSize() + sizeof(uint32_t),
+        msgBuilder, &logBufferData);
+  }
+
+#ifdef CHRE_USE_BUFFERED_LOGGING
+  if (LogBufferManagerSingleton::isInitialized()) {
+    LogBufferManagerSingleton::get()->onLogsSentToHost(result);
+  }
+#else
+  UNUSED_VAR(result);
+#endif
+}
+
 DRAM_REGION_FUNCTION bool HostLink::sendMessage(HostMessage const *message) {
   LOGV("HostLink::%s size(%zu)", __func__, message->message.size());
   bool success = false;
@@ -798,7 +842,8 @@ DRAM_REGION_FUNCTION void HostLink::flushMessagesSentByNanoapp(
 }
 
 DRAM_REGION_FUNCTION void HostMessageHandlers::handleTimeSyncMessage(
-    int64_t offset) {
+    int64_t /* offset */, int32_t /* driftPpb */,
+    uint64_t /* nextSyncDelayNs */) {
   LOGE("%s unsupported.", __func__);
 }
 
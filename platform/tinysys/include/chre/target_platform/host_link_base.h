@@ -91,6 +91,16 @@ class HostLinkBase {
                         size_t /*logMessageSize*/,
                         uint32_t /*num_logs_dropped*/);
 
+  /**
+   * Enqueues a V2 log message to be sent to the host, with the logs drained
+   * from a log buffer straight into it.
+   *
+   * @param logBuffer The log buffer to drain
+   * @param numLogsDropped Non-null pointer to the number of logs dropped since
+   * CHRE started, which is incremented by the logs dropped by logBuffer
+   */
+  void sendLogMessageV2(LogBuffer &logBuffer, size_t *numLogsDropped);
+
  private:
   AtomicBool mInitialized = false;
 };
@@ -33,7 +33,8 @@ int64_t SystemTime::getEstimatedHostTimeOffset() {
   return timesync_get_host_offset_time();
 }
 
-void SystemTime::setEstimatedHostTimeOffset(int64_t offset) {
+void SystemTime::setEstimatedHostTimeOffset(int64_t /* offset */,
+                                            int32_t /* driftPpb */) {
   // not implemented for Tinysys
 }
 }  // namespace chre
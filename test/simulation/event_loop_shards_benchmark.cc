@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures how the event throughput scales with the number of event loop
+// shards. Only built into chre_simulation_event_loop_shards_tests, which is not
+// part of any test suite.
+
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+
+#include <cinttypes>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "chre/core/event_loop_manager.h"
+#include "chre/platform/log.h"
+#include "chre/platform/system_time.h"
+#include "chre/util/time.h"
+#include "chre_api/chre/event.h"
+
+#include "gtest/gtest.h"
+#include "test_base.h"
+#include "test_event.h"
+#include "test_event_queue.h"
+#include "test_util.h"
+
+namespace chre {
+namespace {
+
+CREATE_CHRE_TEST_EVENT(ALL_EVENTS_HANDLED, 0);
+
+//! The event type broadcast to the nanoapps.
+constexpr uint16_t kEventType = CHRE_EVENT_FIRST_USER_VALUE;
+
+constexpr size_t kNumApps = 8;
+constexpr uint32_t kNumEvents = 40;
+
+//! The time each nanoapp spends on each event, without calling into CHRE.
+constexpr Nanoseconds kProcessingTime = Microseconds(250);
+
+/**
+ * Nanoapp registered for the broadcasts of kEventType, busy-waiting for
+ * kProcessingTime on each of them as nanoapps processing data do. It pushes
+ * ALL_EVENTS_HANDLED once it handled kNumEvents of them.
+ */
+class BenchmarkApp : public TestNanoapp {
+ public:
+  explicit BenchmarkApp(uint64_t appId)
+      : TestNanoapp(TestNanoappInfo{.id = appId}) {}
+
+  bool start() override {
+    EventLoopManagerSingleton::get()
+        ->getEventLoop()
+        .getCurrentNanoapp()
+        ->registerForBroadcastEvent(kEventType);
+    return true;
+  }
+
+  void handleEvent(uint32_t, uint16_t eventType, const void *) override {
+    if (eventType == kEventType) {
+      Nanoseconds end = SystemTime::getMonotonicTime() + kProcessingTime;
+      while (SystemTime::getMonotonicTime() < end) {
+      }
+      if (++mNumEventsHandled == kNumEvents) {
+        TestEventQueueSingleton::get()->pushEvent(ALL_EVENTS_HANDLED);
+      }
+    }
+  }
+
+ private:
+  uint32_t mNumEventsHandled = 0;
+};
+
+/**
+ * Runs the nanoapps on the number of shards given as parameter, 0 being the
+ * event loop thread as the baseline.
+ */
+class EventLoopShardsBenchmark : public TestBase,
+                                 public testing::WithParamInterface<size_t> {
+ protected:
+  size_t getNumEventLoopShards() const override {
+    return GetParam();
+  }
+
+  uint64_t getTimeoutNs() const override {
+    return 20 * kOneSecondInNanoseconds;
+  }
+};
+
+TEST_P(EventLoopShardsBenchmark, BroadcastThroughput) {
+  for (size_t i = 0; i < kNumApps; i++) {
+    loadNanoapp(MakeUnique<BenchmarkApp>(0x1234 + i));
+  }
+
+  Nanoseconds start = SystemTime::getMonotonicTime();
+  auto callback = [](uint16_t /*type*/, void * /*data*/, void * /*extra*/) {
+    for (uint32_t i = 0; i < kNumEvents; i++) {
+      EventLoopManagerSingleton::get()->getEventLoop().postEventOrDie(
+          kEventType, /* eventData= */ nullptr, /* freeCallback= */ nullptr);
+    }
+  };
+  EventLoopManagerSingleton::get()->deferCallback(
+      SystemCallbackType::FirstCallbackType, /* data= */ nullptr, callback);
+  for (size_t i = 0; i < kNumApps; i++) {
+    waitForEvent(ALL_EVENTS_HANDLED);
+  }
+  Nanoseconds duration = SystemTime::getMonotonicTime() - start;
+
+  uint64_t numDeliveries = kNumApps * kNumEvents;
+  uint64_t deliveriesPerSecond =
+      numDeliveries * kOneSecondInNanoseconds / duration.toRawNanoseconds();
+  LOGI("Event loop shards: %zu, %" PRIu64 " deliveries of %" PRIu64
+       " us in %" PRIu64 " us, %" PRIu64 " deliveries/s on %u cores",
+       GetParam(), numDeliveries,
+       Microseconds(kProcessingTime).getMicroseconds(),
+       Microseconds(duration).getMicroseconds(), deliveriesPerSecond,
+       std::thread::hardware_concurrency());
+  RecordProperty("deliveries_per_second", std::to_string(deliveriesPerSecond));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    EventLoopShards, EventLoopShardsBenchmark,
+    testing::Range<size_t>(0, EventLoop::kMaxShardCount + 1));
+
+}  // namespace
+}  // namespace chre
+
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
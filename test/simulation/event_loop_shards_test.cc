@@ -0,0 +1,281 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "chre/core/event_loop_manager.h"
+#include "chre/platform/system_time.h"
+#include "chre/util/nested_data_ptr.h"
+#include "chre/util/time.h"
+#include "chre_api/chre/event.h"
+#include "chre_api/chre/re.h"
+
+#include "gtest/gtest.h"
+#include "test_base.h"
+#include "test_event.h"
+#include "test_event_queue.h"
+#include "test_util.h"
+
+namespace chre {
+namespace {
+
+CREATE_CHRE_TEST_EVENT(EVENT_HANDLED, 0);
+CREATE_CHRE_TEST_EVENT(EVENT_FREED, 1);
+CREATE_CHRE_TEST_EVENT(SEND_EVENT, 2);
+
+//! The event type broadcast to, or sent between, the nanoapps.
+constexpr uint16_t kEventType = CHRE_EVENT_FIRST_USER_VALUE;
+
+//! The number of nanoapps the tests spread over the shards.
+constexpr size_t kNumApps = 4;
+
+//! The app ID of the nanoapp at a given index.
+constexpr uint64_t getAppId(size_t index) {
+  return 0x1234 + index;
+}
+
+//! Busy-waits for a given duration, as nanoapps processing data do.
+void spin(Nanoseconds duration) {
+  Nanoseconds end = SystemTime::getMonotonicTime() + duration;
+  while (SystemTime::getMonotonicTime() < end) {
+  }
+}
+
+/**
+ * Nanoapp registered for the broadcasts of kEventType, which checks that its
+ * code never runs on two threads at once. It spends processingTime on each of
+ * these events. If reportEvents is set, it pushes EVENT_HANDLED for each of
+ * them, and EVENT_FREED once the events it sent to all the other nanoapps are
+ * freed.
+ */
+class ShardedApp : public TestNanoapp {
+ public:
+  ShardedApp(uint64_t appId, Nanoseconds processingTime, bool reportEvents)
+      : TestNanoapp(TestNanoappInfo{.id = appId}),
+        mProcessingTime(processingTime),
+        mReportEvents(reportEvents) {}
+
+  bool start() override {
+    EventLoopManagerSingleton::get()
+        ->getEventLoop()
+        .getCurrentNanoapp()
+        ->registerForBroadcastEvent(kEventType);
+    return true;
+  }
+
+  void handleEvent(uint32_t, uint16_t eventType,
+                   const void *eventData) override {
+    enter();
+    if (eventType == kEventType) {
+      spin(mProcessingTime);
+      mNumEventsHandled++;
+      if (mReportEvents) {
+        TestEventQueueSingleton::get()->pushEvent(EVENT_HANDLED);
+      }
+    } else if (eventType == CHRE_EVENT_TEST_EVENT &&
+               static_cast<const TestEvent *>(eventData)->type == SEND_EVENT) {
+      // Sends an event to each of the other nanoapps, freed in the context of
+      // this one.
+      for (size_t i = 0; i < kNumApps; i++) {
+        chreNanoappInfo info;
+        if (getAppId(i) != id() &&
+            chreGetNanoappInfoByAppId(getAppId(i), &info)) {
+          // Rejected once this nanoapp is being unloaded.
+          bool sent = chreSendEvent(kEventType, this, freeEventCallback,
+                                    info.instanceId);
+          EXPECT_TRUE(sent || EventLoopManagerSingleton::get()
+                                  ->getEventLoop()
+                                  .currentNanoappIsStopping());
+        }
+      }
+    }
+    exit();
+  }
+
+  void end() override {
+    enter();
+    exit();
+  }
+
+  static void freeEventCallback(uint16_t /*eventType*/, void *eventData) {
+    auto *app = static_cast<ShardedApp *>(eventData);
+    EXPECT_EQ(chreGetAppId(), app->id());
+    app->enter();
+    app->exit();
+    if (++app->mNumEventsFreed == kNumApps - 1 && app->mReportEvents) {
+      TestEventQueueSingleton::get()->pushEvent(EVENT_FREED);
+    }
+  }
+
+  void enter() {
+    if (mRunning.exchange(true)) {
+      mRanConcurrently = true;
+    }
+  }
+
+  void exit() {
+    mRunning = false;
+  }
+
+  const Nanoseconds mProcessingTime;
+  const bool mReportEvents;
+  std::atomic<bool> mRunning{false};
+  std::atomic<bool> mRanConcurrently{false};
+  std::atomic<size_t> mNumEventsHandled{0};
+  std::atomic<size_t> mNumEventsFreed{0};
+};
+
+/**
+ * Loads kNumApps ShardedApp nanoapps.
+ */
+void loadShardedApps(ShardedApp *apps[kNumApps], Nanoseconds processingTime,
+                     bool reportEvents) {
+  for (size_t i = 0; i < kNumApps; i++) {
+    auto app =
+        MakeUnique<ShardedApp>(getAppId(i), processingTime, reportEvents);
+    apps[i] = app.get();
+    loadNanoapp(std::move(app));
+  }
+}
+
+void pushEventFreed(uint16_t /*eventType*/, void * /*eventData*/) {
+  TestEventQueueSingleton::get()->pushEvent(EVENT_FREED);
+}
+
+/**
+ * Broadcasts numEvents events of type kEventType from the event loop thread,
+ * pushing EVENT_FREED once freed if there is a single one.
+ */
+void broadcastEvents(uint32_t numEvents) {
+  auto callback = [](uint16_t /*type*/, void * /*data*/, void *extraData) {
+    uint32_t count = NestedDataPtr<uint32_t>(extraData);
+    for (uint32_t i = 0; i < count; i++) {
+      EventLoopManagerSingleton::get()->getEventLoop().postEventOrDie(
+          kEventType, /* eventData= */ nullptr,
+          (count == 1) ? pushEventFreed : nullptr);
+    }
+  };
+  EventLoopManagerSingleton::get()->deferCallback(
+      SystemCallbackType::FirstCallbackType, /* data= */ nullptr, callback,
+      NestedDataPtr<uint32_t>(numEvents));
+}
+
+class EventLoopShardsTest : public TestBase {
+ protected:
+  size_t getNumEventLoopShards() const override {
+    return 3;
+  }
+};
+
+TEST_F(EventLoopShardsTest, BroadcastIsFreedOnceHandledByAllShards) {
+  ShardedApp *apps[kNumApps];
+  loadShardedApps(apps, Microseconds(500), /* reportEvents= */ true);
+
+  broadcastEvents(1);
+  for (size_t i = 0; i < kNumApps; i++) {
+    waitForEvent(EVENT_HANDLED);
+  }
+  waitForEvent(EVENT_FREED);
+
+  for (ShardedApp *app : apps) {
+    EXPECT_EQ(app->mNumEventsHandled, 1);
+    EXPECT_FALSE(app->mRanConcurrently);
+  }
+}
+
+TEST_F(EventLoopShardsTest, EventSentAcrossShardsIsFreedBySender) {
+  ShardedApp *apps[kNumApps];
+  loadShardedApps(apps, Nanoseconds(0), /* reportEvents= */ true);
+
+  sendEventToNanoapp(getAppId(0), SEND_EVENT);
+  waitForEvent(EVENT_FREED);
+
+  EXPECT_EQ(apps[0]->mNumEventsHandled, 0);
+  for (size_t i = 1; i < kNumApps; i++) {
+    EXPECT_EQ(apps[i]->mNumEventsHandled, 1);
+  }
+}
+
+TEST_F(EventLoopShardsTest, NanoappsRunOnOneThreadAtATime) {
+  ShardedApp *apps[kNumApps];
+  loadShardedApps(apps, Microseconds(50), /* reportEvents= */ false);
+
+  // Broadcasts and events sent between nanoapps, whose free callbacks run
+  // while the sender handles other events, then unload while in flight.
+  broadcastEvents(10);
+  for (size_t i = 0; i < kNumApps; i++) {
+    sendEventToNanoapp(getAppId(i), SEND_EVENT);
+  }
+  for (size_t i = 0; i < kNumApps; i++) {
+    unloadNanoapp(getAppId(i));
+  }
+
+  for (ShardedApp *app : apps) {
+    EXPECT_FALSE(app->mRanConcurrently);
+  }
+}
+
+TEST_F(EventLoopShardsTest, HandlersOnDifferentShardsRunInParallel) {
+  //! The number of nanoapps in their handler, each waiting for the other.
+  static std::atomic<size_t> sNumHandling;
+  sNumHandling = 0;
+
+  // Waits for the other nanoapp without calling into the system, whose state
+  // only one thread accesses at a time.
+  class App : public ShardedApp {
+   public:
+    explicit App(uint64_t appId)
+        : ShardedApp(appId, Nanoseconds(0), /* reportEvents= */ false) {}
+
+    void handleEvent(uint32_t, uint16_t eventType, const void *) override {
+      if (eventType == kEventType) {
+        sNumHandling++;
+        Nanoseconds end = SystemTime::getMonotonicTime() +
+                          Nanoseconds(5 * kOneSecondInNanoseconds);
+        while (sNumHandling < 2 && SystemTime::getMonotonicTime() < end) {
+          std::this_thread::yield();
+        }
+        mMetOtherApp = (sNumHandling >= 2);
+        TestEventQueueSingleton::get()->pushEvent(EVENT_HANDLED);
+      }
+    }
+
+    std::atomic<bool> mMetOtherApp{false};
+  };
+
+  // Consecutive instance IDs, so on different shards.
+  auto app0 = MakeUnique<App>(getAppId(0));
+  auto app1 = MakeUnique<App>(getAppId(1));
+  App *apps[] = {app0.get(), app1.get()};
+  loadNanoapp(std::move(app0));
+  loadNanoapp(std::move(app1));
+
+  broadcastEvents(1);
+  waitForEvent(EVENT_HANDLED);
+  waitForEvent(EVENT_HANDLED);
+  for (App *app : apps) {
+    EXPECT_TRUE(app->mMetOtherApp);
+  }
+}
+
+}  // namespace
+}  // namespace chre
+
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
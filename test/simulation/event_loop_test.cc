@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "chre/core/event_loop_manager.h"
+#include "chre/util/nested_data_ptr.h"
+#include "chre/util/time.h"
+#include "chre_api/chre/event.h"
+
+#include "gtest/gtest.h"
+#include "test_base.h"
+#include "test_event.h"
+#include "test_event_queue.h"
+#include "test_util.h"
+
+namespace chre {
+namespace {
+
+CREATE_CHRE_TEST_EVENT(DATA_DONE, 0);
+
+//! The event type of the data posted to the nanoapps.
+constexpr uint16_t kDataEventType = CHRE_EVENT_FIRST_USER_VALUE;
+
+//! A data sample handed over by the "PAL" thread.
+struct DataSample {
+  uint32_t index;
+};
+
+//! Whether the deferred callbacks post the data with postEventInlineOrDie.
+bool gPostInline = true;
+
+//! The number of data events each deferred callback posts.
+uint32_t gEventsPerCallback = 1;
+
+//! Defers the data of a sample to the event loop as the request managers do
+//! with PAL data, and posts it to the nanoapp from the callback.
+void deferDataSample(DataSample *sample, uint16_t instanceId) {
+  auto callback = [](uint16_t /*type*/, void *data, void *extraData) {
+    EventLoop &eventLoop = EventLoopManagerSingleton::get()->getEventLoop();
+    uint16_t targetInstanceId = NestedDataPtr<uint16_t>(extraData);
+    for (uint32_t i = 0; i < gEventsPerCallback; i++) {
+      if (gPostInline) {
+        eventLoop.postEventInlineOrDie(kDataEventType, data,
+                                       /* freeCallback= */ nullptr,
+                                       targetInstanceId);
+      } else {
+        eventLoop.postEventOrDie(kDataEventType, data,
+                                 /* freeCallback= */ nullptr,
+                                 targetInstanceId);
+      }
+    }
+  };
+  EventLoopManagerSingleton::get()->deferCallback(
+      SystemCallbackType::FirstCallbackType, sample, callback,
+      NestedDataPtr<uint16_t>(instanceId));
+}
+
+//! Nanoapp receiving the data events, recording the number of events
+//! allocated from the pool when they are delivered.
+class DataApp : public TestNanoapp {
+ public:
+  explicit DataApp(size_t numEvents) : mNumEvents(numEvents) {}
+
+  void handleEvent(uint32_t, uint16_t eventType,
+                   const void *eventData) override {
+    if (eventType == kDataEventType) {
+      auto *sample = static_cast<const DataSample *>(eventData);
+      mIndices.push_back(sample->index);
+      mTotalEventsAllocated += EventLoopManagerSingleton::get()
+                                   ->getEventLoop()
+                                   .getNumEventsAllocated();
+      if (mIndices.size() == mNumEvents) {
+        TestEventQueueSingleton::get()->pushEvent(DATA_DONE);
+      }
+    }
+  }
+
+  const size_t mNumEvents;
+  std::vector<uint32_t> mIndices;
+  size_t mTotalEventsAllocated = 0;
+};
+
+/**
+ * Streams numSamples data samples to a nanoapp from another thread, one every
+ * interval.
+ *
+ * @return the mean number of events allocated from the pool when the data is
+ *         delivered.
+ */
+double streamData(bool postInline, size_t numSamples, Nanoseconds interval) {
+  gPostInline = postInline;
+  gEventsPerCallback = 1;
+  auto app = MakeUnique<DataApp>(numSamples);
+  DataApp *dataApp = app.get();
+  uint64_t appId = loadNanoapp(std::move(app));
+  uint16_t instanceId;
+  EXPECT_TRUE(EventLoopManagerSingleton::get()
+                  ->getEventLoop()
+                  .findNanoappInstanceIdByAppId(appId, &instanceId));
+
+  std::vector<DataSample> samples(numSamples);
+  std::thread palThread([&]() {
+    for (size_t i = 0; i < numSamples; i++) {
+      samples[i].index = static_cast<uint32_t>(i);
+      deferDataSample(&samples[i], instanceId);
+      std::this_thread::sleep_for(
+          std::chrono::nanoseconds(interval.toRawNanoseconds()));
+    }
+  });
+  TestEventQueueSingleton::get()->waitForEvent(DATA_DONE);
+  palThread.join();
+
+  double meanEventsAllocated =
+      static_cast<double>(dataApp->mTotalEventsAllocated) / numSamples;
+  unloadNanoapp(appId);
+  return meanEventsAllocated;
+}
+
+}  // namespace
+
+TEST_F(TestBase, EventLoopInlineEventsOverflowToTheQueue) {
+  // More events than kMaxInlineEventCount, so the last ones go through the
+  // inbound queue.
+  constexpr uint32_t kNumSamples = 3;
+  constexpr uint32_t kEventsPerCallback = 6;
+  gPostInline = true;
+  gEventsPerCallback = kEventsPerCallback;
+  auto app = MakeUnique<DataApp>(kNumSamples * kEventsPerCallback);
+  DataApp *dataApp = app.get();
+  uint64_t appId = loadNanoapp(std::move(app));
+  uint16_t instanceId;
+  EXPECT_TRUE(EventLoopManagerSingleton::get()
+                  ->getEventLoop()
+                  .findNanoappInstanceIdByAppId(appId, &instanceId));
+
+  DataSample samples[kNumSamples];
+  for (uint32_t i = 0; i < kNumSamples; i++) {
+    samples[i].index = i;
+    deferDataSample(&samples[i], instanceId);
+  }
+  waitForEvent(DATA_DONE);
+
+  // Each sample is delivered as many times as posted, starting with the first
+  // one.
+  ASSERT_EQ(dataApp->mIndices.size(), kNumSamples * kEventsPerCallback);
+  EXPECT_EQ(dataApp->mIndices[0], 0);
+  std::vector<uint32_t> counts(kNumSamples);
+  for (uint32_t index : dataApp->mIndices) {
+    counts[index]++;
+  }
+  for (uint32_t count : counts) {
+    EXPECT_EQ(count, kEventsPerCallback);
+  }
+  gEventsPerCallback = 1;
+}
+
+TEST_F(TestBase, EventLoopInlineEventsReducePoolUsage) {
+  // An idle event loop, where the deferred event is released before the
+  // inline event is delivered.
+  constexpr size_t kNumSamples = 50;
+  constexpr Nanoseconds kInterval = Microseconds(200);
+  double queued = streamData(/* postInline= */ false, kNumSamples, kInterval);
+  double inlined = streamData(/* postInline= */ true, kNumSamples, kInterval);
+  EXPECT_LT(inlined, queued);
+}
+
+}  // namespace chre
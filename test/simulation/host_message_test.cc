@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include "chre/core/event_loop_manager.h"
+#include "chre/core/host_comms_manager.h"
+#include "chre/platform/host_link.h"
+#include "chre_api/chre/event.h"
+
+#include "gtest/gtest.h"
+#include "test_base.h"
+#include "test_event.h"
+#include "test_event_queue.h"
+#include "test_util.h"
+
+namespace chre {
+namespace {
+
+CREATE_CHRE_TEST_EVENT(MESSAGE, 0);
+CREATE_CHRE_TEST_EVENT(BUFFER_RELEASED, 1);
+
+constexpr uint16_t kHostEndpoint = 0x1234;
+constexpr uint32_t kMessageType = 42;
+
+//! Stands for the receive buffer of a transport, with the message payload at
+//! kPayloadOffset as it would be in an encoded host message.
+constexpr size_t kPayloadOffset = 8;
+constexpr size_t kPayloadSize = 16;
+uint8_t gTransportBuffer[kPayloadOffset + kPayloadSize];
+
+//! Released by the event loop thread or synchronously by the test thread.
+std::atomic_uint32_t gNumBufferReleases(0);
+
+void releaseTransportBuffer(const void *buffer) {
+  EXPECT_EQ(buffer, gTransportBuffer);
+  gNumBufferReleases++;
+  TestEventQueueSingleton::get()->pushEvent(BUFFER_RELEASED);
+}
+
+struct MessageInfo {
+  const void *message;
+  uint32_t messageSize;
+  uint8_t firstByte;
+  uint32_t numBufferReleases;
+};
+
+class MessageApp : public TestNanoapp {
+ public:
+  void handleEvent(uint32_t, uint16_t eventType,
+                   const void *eventData) override {
+    if (eventType == CHRE_EVENT_MESSAGE_FROM_HOST) {
+      auto *msg = static_cast<const chreMessageFromHostData *>(eventData);
+      MessageInfo info{
+          .message = msg->message,
+          .messageSize = msg->messageSize,
+          .firstByte = static_cast<const uint8_t *>(msg->message)[0],
+          .numBufferReleases = gNumBufferReleases,
+      };
+      TestEventQueueSingleton::get()->pushEvent(MESSAGE, info);
+    }
+  }
+};
+
+class HostMessageTest : public TestBase {
+ protected:
+  void SetUp() override {
+    TestBase::SetUp();
+    for (size_t i = 0; i < ARRAY_SIZE(gTransportBuffer); i++) {
+      gTransportBuffer[i] = static_cast<uint8_t>(i);
+    }
+    gNumBufferReleases = 0;
+  }
+
+  void sendMessage(uint64_t appId) {
+    EventLoopManagerSingleton::get()
+        ->getHostCommsManager()
+        .sendMessageToNanoappFromHost(appId, kMessageType, kHostEndpoint,
+                                      &gTransportBuffer[kPayloadOffset],
+                                      kPayloadSize);
+  }
+
+  void lendMessage(uint64_t appId, uint16_t hostEndpoint = kHostEndpoint) {
+    HostLinkBase::receiveMessageFromHost(
+        appId, kMessageType, hostEndpoint, gTransportBuffer,
+        &gTransportBuffer[kPayloadOffset], kPayloadSize,
+        releaseTransportBuffer);
+  }
+};
+
+TEST_F(HostMessageTest, MessageIsCopiedOutOfTheTransportBuffer) {
+  uint64_t appId = loadNanoapp(MakeUnique<MessageApp>());
+
+  sendMessage(appId);
+  // The transport reuses its buffer as soon as the message is handed over.
+  memset(gTransportBuffer, 0xff, sizeof(gTransportBuffer));
+
+  MessageInfo info;
+  waitForEvent(MESSAGE, &info);
+  EXPECT_NE(info.message, &gTransportBuffer[kPayloadOffset]);
+  EXPECT_EQ(info.messageSize, kPayloadSize);
+  EXPECT_EQ(info.firstByte, kPayloadOffset);
+}
+
+TEST_F(HostMessageTest, LentBufferIsReleasedOnceTheMessageIsHandled) {
+  uint64_t appId = loadNanoapp(MakeUnique<MessageApp>());
+
+  lendMessage(appId);
+
+  MessageInfo info;
+  waitForEvent(MESSAGE, &info);
+  EXPECT_EQ(info.message, &gTransportBuffer[kPayloadOffset]);
+  EXPECT_EQ(info.messageSize, kPayloadSize);
+  EXPECT_EQ(info.firstByte, kPayloadOffset);
+  EXPECT_EQ(info.numBufferReleases, 0);
+
+  waitForEvent(BUFFER_RELEASED);
+  EXPECT_EQ(gNumBufferReleases, 1);
+}
+
+TEST_F(HostMessageTest, LentBufferIsReleasedWhenTheMessageIsRejected) {
+  uint64_t appId = loadNanoapp(MakeUnique<MessageApp>());
+
+  lendMessage(appId, kHostEndpointBroadcast);
+  EXPECT_EQ(gNumBufferReleases, 1);
+}
+
+TEST_F(HostMessageTest, LentBufferIsReleasedWhenTheNanoappIsNotFound) {
+  loadNanoapp(MakeUnique<MessageApp>());
+
+  lendMessage(/* appId= */ 0x0123456789abcdef);
+
+  waitForEvent(BUFFER_RELEASED);
+  EXPECT_EQ(gNumBufferReleases, 1);
+}
+
+}  // namespace
+}  // namespace chre
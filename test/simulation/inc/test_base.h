@@ -20,6 +20,7 @@
 #include <gtest/gtest.h>
 #include <cstdint>
 #include <thread>
+#include <vector>
 
 #include "chre/core/event_loop_manager.h"
 #include "chre/core/nanoapp.h"
@@ -46,6 +47,19 @@ class TestBase : public testing::Test {
     return 5 * kOneSecondInNanoseconds;
   }
 
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+  /**
+   * This method can be overridden in a derived class if desired.
+   *
+   * @return The number of event loop shards running the nanoapps.
+   *
+   * @see EventLoop::setNumShards
+   */
+  virtual size_t getNumEventLoopShards() const {
+    return 0;
+  }
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
+
   /**
    * A convenience method to invoke waitForEvent() for the TestEventQueue
    * singleton.
@@ -95,6 +109,9 @@ class TestBase : public testing::Test {
   }
 
   std::thread mChreThread;
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+  std::vector<std::thread> mShardThreads;
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
   SystemTimer mSystemTimer;
 };
 
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <sstream>
+#include <string>
+
+#include "chre/core/event_loop_manager.h"
+#include "chre/platform/linux/sampling_profiler.h"
+
+#include "gtest/gtest.h"
+#include "test_base.h"
+#include "test_event.h"
+#include "test_event_queue.h"
+#include "test_util.h"
+
+namespace chre {
+namespace {
+
+CREATE_CHRE_TEST_EVENT(PROFILING_STARTED, 0);
+CREATE_CHRE_TEST_EVENT(SPIN, 1);
+CREATE_CHRE_TEST_EVENT(SPIN_DONE, 2);
+
+uint64_t getThreadCpuTimeNs() {
+  struct timespec time;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+  return static_cast<uint64_t>(time.tv_sec) * 1000000000 + time.tv_nsec;
+}
+
+//! Nanoapp spending 100 ms of CPU time on each SPIN event.
+class SpinningApp : public TestNanoapp {
+ public:
+  void handleEvent(uint32_t, uint16_t eventType,
+                   const void *eventData) override {
+    if (eventType == CHRE_EVENT_TEST_EVENT &&
+        static_cast<const TestEvent *>(eventData)->type == SPIN) {
+      uint64_t end = getThreadCpuTimeNs() + 100000000;
+      while (getThreadCpuTimeNs() < end) {
+      }
+      TestEventQueueSingleton::get()->pushEvent(SPIN_DONE);
+    }
+  }
+};
+
+class SamplingProfilerTest : public TestBase {
+ protected:
+  void TearDown() override {
+    SamplingProfiler::get().stop();
+    SamplingProfiler::get().clear();
+    TestBase::TearDown();
+  }
+};
+
+TEST_F(SamplingProfilerTest, SamplesAreAttributedToTheCurrentNanoapp) {
+  SamplingProfiler::get().clear();
+  ASSERT_TRUE(SamplingProfiler::get().start(/* frequencyHz= */ 1000));
+  EventLoopManagerSingleton::get()->deferCallback(
+      SystemCallbackType::FirstCallbackType, /* data= */ nullptr,
+      [](uint16_t /*type*/, void * /*data*/, void * /*extraData*/) {
+        EXPECT_TRUE(SamplingProfiler::get().profileCurrentThread());
+        TestEventQueueSingleton::get()->pushEvent(PROFILING_STARTED);
+      });
+  waitForEvent(PROFILING_STARTED);
+
+  uint64_t appId = loadNanoapp(MakeUnique<SpinningApp>());
+  sendEventToNanoapp(appId, SPIN);
+  waitForEvent(SPIN_DONE);
+  unloadNanoapp(appId);
+  SamplingProfiler::get().stop();
+
+  char *data = nullptr;
+  size_t size = 0;
+  FILE *file = open_memstream(&data, &size);
+  size_t numSamples = SamplingProfiler::get().exportFoldedStacks(file);
+  fclose(file);
+  std::string profile(data, size);
+  free(data);
+
+  // Most of the samples are taken while the nanoapp spins, which are folded
+  // under its root.
+  char root[32];
+  snprintf(root, sizeof(root), "[nanoapp 0x%016" PRIx64 "];", appId);
+  std::istringstream lines(profile);
+  std::string line;
+  size_t numAppSamples = 0;
+  while (std::getline(lines, line)) {
+    if (line.rfind(root, 0) == 0) {
+      numAppSamples += std::stoul(line.substr(line.rfind(' ') + 1));
+    }
+  }
+  EXPECT_GT(numAppSamples, numSamples / 2) << profile;
+}
+
+}  // namespace
+}  // namespace chre
@@ -163,5 +163,145 @@ TEST_F(TestBase, SensorUnsubscribeToDataEventsOnUnload) {
   EXPECT_FALSE(chrePalSensorIsSensor0Enabled());
 }
 
+TEST_F(TestBase, SensorCanReceiveSynchronizedBatches) {
+  CREATE_CHRE_TEST_EVENT(CONFIGURE, 0);
+  CREATE_CHRE_TEST_EVENT(GROUP, 1);
+  CREATE_CHRE_TEST_EVENT(BATCH, 2);
+  CREATE_CHRE_TEST_EVENT(ACCEL_DATA, 3);
+  CREATE_CHRE_TEST_EVENT(GET_ACCEL_COUNT, 4);
+
+  struct Configuration {
+    uint32_t sensorHandle;
+    uint64_t interval;
+    enum chreSensorConfigureMode mode;
+  };
+
+  struct Group {
+    uint32_t sensorHandles[2];
+    uint8_t sensorCount;
+  };
+
+  class App : public TestNanoapp {
+   public:
+    App() = default;
+    explicit App(uint64_t id) : TestNanoapp(TestNanoappInfo{.id = id}) {}
+
+    void handleEvent(uint32_t, uint16_t eventType,
+                     const void *eventData) override {
+      switch (eventType) {
+        case CHRE_EVENT_SENSOR_SYNCHRONIZED_BATCH: {
+          auto *event =
+              static_cast<const struct chreSensorSynchronizedBatchEvent *>(
+                  eventData);
+          // Bit i is set when the entry i holds data from sensor i.
+          uint8_t dataMask = 0;
+          for (uint8_t i = 0; i < event->sensorCount; i++) {
+            auto *data = static_cast<const struct chreSensorDataHeader *>(
+                event->sensorData[i]);
+            if (data != nullptr && data->sensorHandle == i) {
+              dataMask |= 1 << i;
+            }
+          }
+          TestEventQueueSingleton::get()->pushEvent(BATCH, dataMask);
+          break;
+        }
+
+        case CHRE_EVENT_SENSOR_UNCALIBRATED_ACCELEROMETER_DATA: {
+          mAccelCount++;
+          TestEventQueueSingleton::get()->pushEvent(ACCEL_DATA);
+          break;
+        }
+
+        case CHRE_EVENT_TEST_EVENT: {
+          auto event = static_cast<const TestEvent *>(eventData);
+          switch (event->type) {
+            case CONFIGURE: {
+              auto config = static_cast<const Configuration *>(event->data);
+              const bool success = chreSensorConfigure(
+                  config->sensorHandle, config->mode, config->interval, 0);
+              TestEventQueueSingleton::get()->pushEvent(CONFIGURE, success);
+              break;
+            }
+
+            case GROUP: {
+              auto group = static_cast<const Group *>(event->data);
+              const bool success = chreSensorConfigureSynchronizedBatch(
+                  group->sensorHandles, group->sensorCount);
+              TestEventQueueSingleton::get()->pushEvent(GROUP, success);
+              break;
+            }
+
+            case GET_ACCEL_COUNT: {
+              TestEventQueueSingleton::get()->pushEvent(GET_ACCEL_COUNT,
+                                                        mAccelCount);
+              break;
+            }
+          }
+        }
+      }
+    }
+
+   private:
+    uint32_t mAccelCount = 0;
+  };
+
+  uint64_t appId = loadNanoapp(MakeUnique<App>());
+  // Does not group the sensors.
+  uint64_t otherAppId = loadNanoapp(MakeUnique<App>(kDefaultTestNanoappId + 1));
+
+  bool success;
+  Group group{.sensorHandles = {0, 1}, .sensorCount = 2};
+  sendEventToNanoapp(appId, GROUP, group);
+  waitForEvent(GROUP, &success);
+  EXPECT_TRUE(success);
+
+  for (uint32_t handle = 0; handle < 2; handle++) {
+    Configuration config{.sensorHandle = handle,
+                         .interval = 10000000,  // 10 ms
+                         .mode = CHRE_SENSOR_CONFIGURE_MODE_CONTINUOUS};
+    sendEventToNanoapp(appId, CONFIGURE, config);
+    waitForEvent(CONFIGURE, &success);
+    EXPECT_TRUE(success);
+  }
+  EXPECT_TRUE(chrePalSensorIsSensor0Enabled());
+  EXPECT_TRUE(chrePalSensorIsSensor1Enabled());
+
+  Configuration config{.sensorHandle = 0,
+                       .interval = 10000000,  // 10 ms
+                       .mode = CHRE_SENSOR_CONFIGURE_MODE_CONTINUOUS};
+  sendEventToNanoapp(otherAppId, CONFIGURE, config);
+  waitForEvent(CONFIGURE, &success);
+  EXPECT_TRUE(success);
+
+  // The first batches can be partial depending on when each sensor starts.
+  uint8_t dataMask = 0;
+  for (int i = 0; i < 10 && dataMask != 0b11; i++) {
+    waitForEvent(BATCH, &dataMask);
+  }
+  EXPECT_EQ(dataMask, 0b11);
+
+  // Only the nanoapp that does not group the sensor gets its data events.
+  waitForEvent(ACCEL_DATA);
+  uint32_t accelCount;
+  sendEventToNanoapp(appId, GET_ACCEL_COUNT);
+  waitForEvent(GET_ACCEL_COUNT, &accelCount);
+  EXPECT_EQ(accelCount, 0);
+  sendEventToNanoapp(otherAppId, GET_ACCEL_COUNT);
+  waitForEvent(GET_ACCEL_COUNT, &accelCount);
+  EXPECT_GT(accelCount, 0);
+  unloadNanoapp(otherAppId);
+
+  // Removing the group resumes the delivery of individual events.
+  group.sensorCount = 0;
+  sendEventToNanoapp(appId, GROUP, group);
+  waitForEvent(GROUP, &success);
+  EXPECT_TRUE(success);
+  waitForEvent(ACCEL_DATA);
+
+  unloadNanoapp(appId);
+  EXPECT_FALSE(chrePalSensorIsSensor0Enabled());
+  EXPECT_FALSE(chrePalSensorIsSensor1Enabled());
+}
+
 }  // namespace
-}  // namespace chre
\ No newline at end of file
+}  // namespace chre
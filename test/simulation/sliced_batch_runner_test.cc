@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre/util/nanoapp/sliced_batch_runner.h"
+
+#include <cstdint>
+
+#include "chre/util/time.h"
+#include "chre_api/chre/event.h"
+
+#include "gtest/gtest.h"
+#include "test_base.h"
+#include "test_event.h"
+#include "test_event_queue.h"
+#include "test_util.h"
+
+namespace chre {
+namespace {
+
+CREATE_CHRE_TEST_EVENT(START_BATCH, 0);
+CREATE_CHRE_TEST_EVENT(BATCH_DONE, 1);
+
+//! The event type the runner posts between slices.
+constexpr uint16_t kContinueEventType = CHRE_EVENT_FIRST_USER_VALUE;
+
+//! The event type of an event the nanoapp sends itself during a batch.
+constexpr uint16_t kOtherEventType = CHRE_EVENT_FIRST_USER_VALUE + 1;
+
+constexpr uint64_t kMaxSliceNs = kOneMillisecondInNanoseconds;
+
+//! Each step busy waits for this long, so a slice runs at most
+//! kMaxSliceNs / kStepNs steps.
+constexpr uint64_t kStepNs = 200 * kOneMicrosecondInNanoseconds;
+constexpr uint32_t kMaxStepsPerSlice = kMaxSliceNs / kStepNs;
+
+struct BatchResult {
+  uint32_t completedCount;
+  uint32_t stepCount;
+  uint32_t sliceCount;
+  bool restartRejected;
+  bool otherEventDuringBatch;
+};
+
+//! Starts a batch when receiving START_BATCH with the index of the step to
+//! fail at, and pushes BATCH_DONE with a BatchResult when it ends.
+class BatchApp : public TestNanoapp {
+ public:
+  void handleEvent(uint32_t, uint16_t eventType,
+                   const void *eventData) override {
+    if (mRunner.handleEvent(eventType)) {
+      if (!mRunner.isRunning()) {
+        mResult.completedCount = mRunner.getCompletedCount();
+        mResult.stepCount = mRunner.getStats().stepCount;
+        mResult.sliceCount = mRunner.getStats().sliceCount;
+        TestEventQueueSingleton::get()->pushEvent(BATCH_DONE, mResult);
+      }
+      return;
+    }
+
+    switch (eventType) {
+      case kOtherEventType:
+        mResult.otherEventDuringBatch = mRunner.isRunning();
+        break;
+
+      case CHRE_EVENT_TEST_EVENT: {
+        auto event = static_cast<const TestEvent *>(eventData);
+        if (event->type == START_BATCH) {
+          mFailingIndex = *static_cast<const uint32_t *>(event->data);
+          mResult = {};
+          ASSERT_TRUE(mRunner.start(kNumSteps, step, this));
+          mResult.restartRejected = !mRunner.start(kNumSteps, step, this);
+          // Queued behind the first slice, delivered before the second one.
+          ASSERT_TRUE(chreSendEvent(kOtherEventType, nullptr /* eventData */,
+                                    nullptr /* freeCallback */,
+                                    chreGetInstanceId()));
+        }
+        break;
+      }
+    }
+  }
+
+  static constexpr uint32_t kNumSteps = 5 * kMaxStepsPerSlice;
+
+ private:
+  static bool step(uint32_t index, void *cookie) {
+    auto *app = static_cast<BatchApp *>(cookie);
+    if (index == app->mFailingIndex) {
+      return false;
+    }
+    uint64_t startNs = chreGetTime();
+    while (chreGetTime() - startNs < kStepNs) {
+    }
+    return true;
+  }
+
+  SlicedBatchRunner mRunner{kContinueEventType, kMaxSliceNs};
+  uint32_t mFailingIndex = UINT32_MAX;
+  BatchResult mResult = {};
+};
+
+class SlicedBatchRunnerTest : public TestBase {};
+
+TEST_F(SlicedBatchRunnerTest, SpreadsTheBatchOverEventLoopTurns) {
+  uint64_t appId = loadNanoapp(MakeUnique<BatchApp>());
+
+  sendEventToNanoapp(appId, START_BATCH, UINT32_MAX);
+  BatchResult result;
+  waitForEvent(BATCH_DONE, &result);
+
+  EXPECT_EQ(result.completedCount, BatchApp::kNumSteps);
+  EXPECT_EQ(result.stepCount, BatchApp::kNumSteps);
+  EXPECT_GE(result.sliceCount, BatchApp::kNumSteps / kMaxStepsPerSlice);
+  EXPECT_LE(result.sliceCount, BatchApp::kNumSteps);
+  EXPECT_TRUE(result.restartRejected);
+  EXPECT_TRUE(result.otherEventDuringBatch);
+
+  // A new batch can start once the previous one is done.
+  sendEventToNanoapp(appId, START_BATCH, UINT32_MAX);
+  waitForEvent(BATCH_DONE, &result);
+  EXPECT_EQ(result.completedCount, BatchApp::kNumSteps);
+  EXPECT_EQ(result.stepCount, 2 * BatchApp::kNumSteps);
+}
+
+TEST_F(SlicedBatchRunnerTest, StopsTheBatchWhenAStepFails) {
+  uint64_t appId = loadNanoapp(MakeUnique<BatchApp>());
+
+  constexpr uint32_t kFailingIndex = kMaxStepsPerSlice + 2;
+  sendEventToNanoapp(appId, START_BATCH, kFailingIndex);
+  BatchResult result;
+  waitForEvent(BATCH_DONE, &result);
+
+  EXPECT_EQ(result.completedCount, kFailingIndex);
+  EXPECT_EQ(result.stepCount, kFailingIndex);
+  EXPECT_GE(result.sliceCount, 2);
+}
+
+}  // namespace
+}  // namespace chre
@@ -50,6 +50,14 @@ void TestBase::SetUp() {
   chre::init();
   EventLoopManagerSingleton::get()->lateInit();
 
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+  EventLoop &eventLoop = EventLoopManagerSingleton::get()->getEventLoop();
+  eventLoop.setNumShards(getNumEventLoopShards());
+  for (size_t i = 0; i < eventLoop.getNumShards(); i++) {
+    mShardThreads.emplace_back([&eventLoop, i]() { eventLoop.runShard(i); });
+  }
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
+
   mChreThread = std::thread(
       []() { EventLoopManagerSingleton::get()->getEventLoop().run(); });
 
@@ -70,6 +78,12 @@ void TestBase::TearDown() {
   TestEventQueueSingleton::get()->flush();
   EventLoopManagerSingleton::get()->getEventLoop().stop();
   mChreThread.join();
+#ifdef CHRE_EVENT_LOOP_SHARDS_ENABLED
+  for (std::thread &shardThread : mShardThreads) {
+    shardThread.join();
+  }
+  mShardThreads.clear();
+#endif  // CHRE_EVENT_LOOP_SHARDS_ENABLED
 
   chre::deinit();
   chre::PlatformLogSingleton::deinit();
@@ -34,6 +34,8 @@ namespace chre {
 namespace {
 
 CREATE_CHRE_TEST_EVENT(SCAN_REQUEST, 20);
+CREATE_CHRE_TEST_EVENT(SCAN_EVENT_RETAINED, 21);
+CREATE_CHRE_TEST_EVENT(RELEASE_SCAN_EVENT, 22);
 
 struct WifiAsyncData {
   const uint32_t *cookie;
@@ -162,9 +164,10 @@ TEST_F(WifiScanRequestQueueTestBase, WifiQueuedScanSettingChangeTest) {
 
   class WifiScanTestConcurrentNanoapp : public TestNanoapp {
    public:
-    explicit WifiScanTestConcurrentNanoapp(uint64_t id)
+    WifiScanTestConcurrentNanoapp(uint64_t id, uint8_t scanType)
         : TestNanoapp(TestNanoappInfo{
-              .id = id, .perms = NanoappPermissions::CHRE_PERMS_WIFI}) {}
+              .id = id, .perms = NanoappPermissions::CHRE_PERMS_WIFI}),
+          mScanType(scanType) {}
 
     void handleEvent(uint32_t, uint16_t eventType,
                      const void *eventData) override {
@@ -182,11 +185,21 @@ TEST_F(WifiScanRequestQueueTestBase, WifiQueuedScanSettingChangeTest) {
           auto event = static_cast<const TestEvent *>(eventData);
           bool success = false;
           switch (event->type) {
-            case SCAN_REQUEST:
+            case SCAN_REQUEST: {
               mSentCookie = *static_cast<uint32_t *>(event->data);
-              success = chreWifiRequestScanAsyncDefault(&(mSentCookie));
+              struct chreWifiScanParams params = {
+                  .scanType = mScanType,
+                  .maxScanAgeMs = 5000,
+                  .frequencyListLen = 0,
+                  .frequencyList = nullptr,
+                  .ssidListLen = 0,
+                  .ssidList = nullptr,
+                  .radioChainPref = CHRE_WIFI_RADIO_CHAIN_PREF_DEFAULT,
+                  .channelSet = CHRE_WIFI_CHANNEL_SET_NON_DFS};
+              success = chreWifiRequestScanAsync(&params, &(mSentCookie));
               TestEventQueueSingleton::get()->pushEvent(SCAN_REQUEST, success);
               break;
+            }
             case CONCURRENT_NANOAPP_READ_ASYNC_EVENT:
               TestEventQueueSingleton::get()->pushEvent(
                   CONCURRENT_NANOAPP_READ_ASYNC_EVENT, mReceivedAsyncResult);
@@ -202,14 +215,17 @@ TEST_F(WifiScanRequestQueueTestBase, WifiQueuedScanSettingChangeTest) {
     }
 
    protected:
+    uint8_t mScanType;
     uint32_t mSentCookie;
     WifiAsyncData mReceivedAsyncResult;
   };
 
-  uint64_t appOneId =
-      loadNanoapp(MakeUnique<WifiScanTestConcurrentNanoapp>(kAppOneId));
-  uint64_t appTwoId =
-      loadNanoapp(MakeUnique<WifiScanTestConcurrentNanoapp>(kAppTwoId));
+  // Use different scan types so that the second request can't join the scan
+  // in flight and stays queued.
+  uint64_t appOneId = loadNanoapp(MakeUnique<WifiScanTestConcurrentNanoapp>(
+      kAppOneId, CHRE_WIFI_SCAN_TYPE_ACTIVE));
+  uint64_t appTwoId = loadNanoapp(MakeUnique<WifiScanTestConcurrentNanoapp>(
+      kAppTwoId, CHRE_WIFI_SCAN_TYPE_PASSIVE));
 
   constexpr uint32_t appOneRequestCookie = 0x1010;
   constexpr uint32_t appTwoRequestCookie = 0x2020;
@@ -428,5 +444,124 @@ TEST_F(WifiScanRequestQueueTestBase, WifiScanActiveScanFromDistinctNanoapps) {
   unloadNanoapp(appTwoId);
 }
 
+TEST_F(WifiScanRequestQueueTestBase, WifiCompatibleScansShareOnePlatformScan) {
+  uint64_t appOneId = loadNanoapp(MakeUnique<WifiScanTestNanoapp>(kAppOneId));
+  uint64_t appTwoId = loadNanoapp(MakeUnique<WifiScanTestNanoapp>(kAppTwoId));
+
+  bool success;
+  WifiAsyncData wifiAsyncData;
+  sendEventToNanoapp(appOneId, SCAN_REQUEST, 0x1010);
+  waitForEvent(SCAN_REQUEST, &success);
+  EXPECT_TRUE(success);
+  waitForEvent(CHRE_EVENT_WIFI_ASYNC_RESULT, &wifiAsyncData);
+  EXPECT_EQ(wifiAsyncData.errorCode, CHRE_ERROR_NONE);
+
+  // The scan results are delayed so the second request joins the scan in
+  // flight and both nanoapps receive its results.
+  sendEventToNanoapp(appTwoId, SCAN_REQUEST, 0x2020);
+  waitForEvent(SCAN_REQUEST, &success);
+  EXPECT_TRUE(success);
+  waitForEvent(CHRE_EVENT_WIFI_ASYNC_RESULT, &wifiAsyncData);
+  EXPECT_EQ(wifiAsyncData.errorCode, CHRE_ERROR_NONE);
+  EXPECT_EQ(*wifiAsyncData.cookie, 0x2020);
+  waitForEvent(CHRE_EVENT_WIFI_SCAN_RESULT);
+  waitForEvent(CHRE_EVENT_WIFI_SCAN_RESULT);
+
+  EXPECT_EQ(chrePalWifiGetScanRequestCount(), 1);
+}
+
+TEST_F(TestBase, WifiScanWithinMaxAgeIsServedFromCache) {
+  uint64_t appOneId = loadNanoapp(MakeUnique<WifiScanTestNanoapp>(kAppOneId));
+  uint64_t appTwoId = loadNanoapp(MakeUnique<WifiScanTestNanoapp>(kAppTwoId));
+
+  bool success;
+  WifiAsyncData wifiAsyncData;
+  sendEventToNanoapp(appOneId, SCAN_REQUEST, 0x1010);
+  waitForEvent(SCAN_REQUEST, &success);
+  EXPECT_TRUE(success);
+  waitForEvent(CHRE_EVENT_WIFI_ASYNC_RESULT, &wifiAsyncData);
+  EXPECT_EQ(wifiAsyncData.errorCode, CHRE_ERROR_NONE);
+  waitForEvent(CHRE_EVENT_WIFI_SCAN_RESULT);
+
+  sendEventToNanoapp(appTwoId, SCAN_REQUEST, 0x2020);
+  waitForEvent(SCAN_REQUEST, &success);
+  EXPECT_TRUE(success);
+  waitForEvent(CHRE_EVENT_WIFI_ASYNC_RESULT, &wifiAsyncData);
+  EXPECT_EQ(wifiAsyncData.errorCode, CHRE_ERROR_NONE);
+  EXPECT_EQ(*wifiAsyncData.cookie, 0x2020);
+  waitForEvent(CHRE_EVENT_WIFI_SCAN_RESULT);
+
+  EXPECT_EQ(chrePalWifiGetScanRequestCount(), 1);
+}
+
+TEST_F(TestBase, WifiCachedScanEventCanBeRetained) {
+  class App : public WifiScanTestNanoapp {
+   public:
+    explicit App(uint64_t id) : WifiScanTestNanoapp(id) {}
+
+    void handleEvent(uint32_t senderInstanceId, uint16_t eventType,
+                     const void *eventData) override {
+      if (eventType == CHRE_EVENT_WIFI_SCAN_RESULT) {
+        if (chreEventDataRetain(eventData)) {
+          mRetainedEvent = static_cast<const chreWifiScanEvent *>(eventData);
+        }
+        TestEventQueueSingleton::get()->pushEvent(SCAN_EVENT_RETAINED,
+                                                  mRetainedEvent != nullptr);
+      } else if (eventType == CHRE_EVENT_TEST_EVENT &&
+                 static_cast<const TestEvent *>(eventData)->type ==
+                     RELEASE_SCAN_EVENT) {
+        // The retained event is still valid after its delivery.
+        bool released = false;
+        if (mRetainedEvent != nullptr) {
+          EXPECT_EQ(mRetainedEvent->resultCount, 1);
+          EXPECT_EQ(mRetainedEvent->results[0].ssidLen, 0);
+          // Only the data of the event being handled can be retained.
+          EXPECT_FALSE(chreEventDataRetain(mRetainedEvent));
+          released = chreEventDataRelease(mRetainedEvent);
+          mRetainedEvent = nullptr;
+        }
+        TestEventQueueSingleton::get()->pushEvent(RELEASE_SCAN_EVENT,
+                                                  released);
+      } else {
+        WifiScanTestNanoapp::handleEvent(senderInstanceId, eventType,
+                                         eventData);
+      }
+    }
+
+    const chreWifiScanEvent *mRetainedEvent = nullptr;
+  };
+
+  uint64_t appOneId = loadNanoapp(MakeUnique<App>(kAppOneId));
+  uint64_t appTwoId = loadNanoapp(MakeUnique<App>(kAppTwoId));
+  EventPayloadArena &arena =
+      EventLoopManagerSingleton::get()->getEventPayloadArena();
+
+  // The event of the platform scan can't be retained, but the one served from
+  // the cache shares the cached results. The results are cached as the event
+  // of the platform scan is freed, after it is handled, so the arena is only
+  // checked once the next request is served.
+  bool success;
+  sendEventToNanoapp(appOneId, SCAN_REQUEST, 0x1010);
+  waitForEvent(SCAN_REQUEST, &success);
+  EXPECT_TRUE(success);
+  waitForEvent(SCAN_EVENT_RETAINED, &success);
+  EXPECT_FALSE(success);
+
+  sendEventToNanoapp(appTwoId, SCAN_REQUEST, 0x2020);
+  waitForEvent(SCAN_REQUEST, &success);
+  EXPECT_TRUE(success);
+  waitForEvent(SCAN_EVENT_RETAINED, &success);
+  EXPECT_TRUE(success);
+  EXPECT_EQ(arena.getPayloadCount(), 1);
+
+  sendEventToNanoapp(appTwoId, RELEASE_SCAN_EVENT);
+  waitForEvent(RELEASE_SCAN_EVENT, &success);
+  EXPECT_TRUE(success);
+  EXPECT_EQ(chrePalWifiGetScanRequestCount(), 1);
+
+  unloadNanoapp(appOneId);
+  unloadNanoapp(appTwoId);
+}
+
 }  // namespace
-}  // namespace chre
\ No newline at end of file
+}  // namespace chre
@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre_api/chre/wwan.h"
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "chre/core/event_loop_manager.h"
+#include "chre/platform/linux/pal_wwan.h"
+#include "chre/platform/log.h"
+#include "chre/util/nested_data_ptr.h"
+#include "chre/util/system/napp_permissions.h"
+#include "chre/util/time.h"
+#include "chre_api/chre/event.h"
+
+#include "gtest/gtest.h"
+#include "test_base.h"
+#include "test_event.h"
+#include "test_event_queue.h"
+#include "test_util.h"
+
+namespace chre {
+namespace {
+
+CREATE_CHRE_TEST_EVENT(CELL_INFO_REQUEST, 0);
+CREATE_CHRE_TEST_EVENT(CACHE_MAX_AGE_SET, 1);
+
+constexpr uint64_t kAppOneId = 0x0123456789000001;
+constexpr uint64_t kAppTwoId = 0x0123456789000002;
+
+//! Nanoapp requesting cell info and reporting the cookie of each result.
+class App : public TestNanoapp {
+ public:
+  explicit App(uint64_t id)
+      : TestNanoapp(TestNanoappInfo{
+            .id = id, .perms = NanoappPermissions::CHRE_PERMS_WWAN}) {}
+
+  void handleEvent(uint32_t, uint16_t eventType,
+                   const void *eventData) override {
+    switch (eventType) {
+      case CHRE_EVENT_WWAN_CELL_INFO_RESULT: {
+        auto *result = static_cast<const chreWwanCellInfoResult *>(eventData);
+        if (result->errorCode == CHRE_ERROR_NONE &&
+            result->cellInfoCount == 1) {
+          TestEventQueueSingleton::get()->pushEvent(
+              CHRE_EVENT_WWAN_CELL_INFO_RESULT,
+              *(static_cast<const uint32_t *>(result->cookie)));
+        }
+        break;
+      }
+
+      case CHRE_EVENT_TEST_EVENT: {
+        auto event = static_cast<const TestEvent *>(eventData);
+        switch (event->type) {
+          case CELL_INFO_REQUEST: {
+            mCookie = *static_cast<const uint32_t *>(event->data);
+            bool success = chreWwanGetCellInfoAsync(&mCookie);
+            TestEventQueueSingleton::get()->pushEvent(CELL_INFO_REQUEST,
+                                                      success);
+            break;
+          }
+        }
+      }
+    }
+  }
+
+ protected:
+  uint32_t mCookie;
+};
+
+void requestCellInfo(uint64_t appId, uint32_t cookie) {
+  bool success;
+  sendEventToNanoapp(appId, CELL_INFO_REQUEST, cookie);
+  TestEventQueueSingleton::get()->waitForEvent(CELL_INFO_REQUEST, &success);
+  EXPECT_TRUE(success);
+}
+
+//! Sets the max age of the cached cell info result from the event loop.
+void setCellInfoCacheMaxAge(Nanoseconds maxAge) {
+  EventLoopManagerSingleton::get()->deferCallback(
+      SystemCallbackType::FirstCallbackType, /* data= */ nullptr,
+      [](uint16_t /*type*/, void * /*data*/, void *extraData) {
+        EventLoopManagerSingleton::get()
+            ->getWwanRequestManager()
+            .setCellInfoCacheMaxAge(
+                Nanoseconds(NestedDataPtr<uint64_t>(extraData)));
+        TestEventQueueSingleton::get()->pushEvent(CACHE_MAX_AGE_SET);
+      },
+      NestedDataPtr<uint64_t>(maxAge.toRawNanoseconds()));
+  TestEventQueueSingleton::get()->waitForEvent(CACHE_MAX_AGE_SET);
+}
+
+//! Waits up to a second for the PAL to get a given number of cell info
+//! results back.
+//!
+//! @return false if the results are not all released in time.
+bool waitForCellInfoReleaseCount(uint32_t count) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+  while (chrePalWwanGetCellInfoReleaseCount() < count) {
+    if (std::chrono::steady_clock::now() >= deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+TEST_F(TestBase, WwanConcurrentRequestsShareOnePlatformRequest) {
+  uint64_t appOneId = loadNanoapp(MakeUnique<App>(kAppOneId));
+  uint64_t appTwoId = loadNanoapp(MakeUnique<App>(kAppTwoId));
+
+  chrePalWwanDelaySendingCellInfoResults(true);
+  requestCellInfo(appOneId, 0x1);
+  requestCellInfo(appTwoId, 0x2);
+  chrePalWwanStartSendingCellInfoResults();
+
+  // Results are delivered in the order the requests were made.
+  uint32_t cookie;
+  waitForEvent(CHRE_EVENT_WWAN_CELL_INFO_RESULT, &cookie);
+  EXPECT_EQ(cookie, 0x1);
+  waitForEvent(CHRE_EVENT_WWAN_CELL_INFO_RESULT, &cookie);
+  EXPECT_EQ(cookie, 0x2);
+
+  EXPECT_EQ(chrePalWwanGetCellInfoRequestCount(), 1);
+  chrePalWwanDelaySendingCellInfoResults(false);
+}
+
+TEST_F(TestBase, WwanSameNanoappCanJoinItsInFlightRequest) {
+  uint64_t appId = loadNanoapp(MakeUnique<App>(kAppOneId));
+
+  chrePalWwanDelaySendingCellInfoResults(true);
+  requestCellInfo(appId, 0x1);
+  requestCellInfo(appId, 0x2);
+  chrePalWwanStartSendingCellInfoResults();
+
+  // The nanoapp stores a single cookie so both results carry the last one.
+  uint32_t cookie;
+  waitForEvent(CHRE_EVENT_WWAN_CELL_INFO_RESULT, &cookie);
+  EXPECT_EQ(cookie, 0x2);
+  waitForEvent(CHRE_EVENT_WWAN_CELL_INFO_RESULT, &cookie);
+  EXPECT_EQ(cookie, 0x2);
+
+  EXPECT_EQ(chrePalWwanGetCellInfoRequestCount(), 1);
+  chrePalWwanDelaySendingCellInfoResults(false);
+}
+
+TEST_F(TestBase, WwanRequestWithinMaxAgeIsServedFromCache) {
+  uint64_t appOneId = loadNanoapp(MakeUnique<App>(kAppOneId));
+  uint64_t appTwoId = loadNanoapp(MakeUnique<App>(kAppTwoId));
+
+  uint32_t cookie;
+  requestCellInfo(appOneId, 0x1);
+  waitForEvent(CHRE_EVENT_WWAN_CELL_INFO_RESULT, &cookie);
+  EXPECT_EQ(cookie, 0x1);
+
+  requestCellInfo(appTwoId, 0x2);
+  waitForEvent(CHRE_EVENT_WWAN_CELL_INFO_RESULT, &cookie);
+  EXPECT_EQ(cookie, 0x2);
+
+  EXPECT_EQ(chrePalWwanGetCellInfoRequestCount(), 1);
+}
+
+TEST_F(TestBase, WwanExpiredResultIsReleasedAndQueriedAgain) {
+  setCellInfoCacheMaxAge(Milliseconds(20));
+  uint64_t appId = loadNanoapp(MakeUnique<App>(kAppOneId));
+
+  uint32_t cookie;
+  requestCellInfo(appId, 0x1);
+  waitForEvent(CHRE_EVENT_WWAN_CELL_INFO_RESULT, &cookie);
+  EXPECT_EQ(cookie, 0x1);
+
+  // The cache releases the result to the PAL once it expires, without waiting
+  // for another request.
+  ASSERT_TRUE(waitForCellInfoReleaseCount(1));
+
+  requestCellInfo(appId, 0x2);
+  waitForEvent(CHRE_EVENT_WWAN_CELL_INFO_RESULT, &cookie);
+  EXPECT_EQ(cookie, 0x2);
+
+  EXPECT_EQ(chrePalWwanGetCellInfoRequestCount(), 2);
+}
+
+}  // namespace
+}  // namespace chre
@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_UTIL_FLATBUFFERS_BUILDER_POOL_H_
+#define CHRE_UTIL_FLATBUFFERS_BUILDER_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "chre/platform/mutex.h"
+#include "chre/util/flatbuffers/helpers.h"
+#include "chre/util/lock_guard.h"
+#include "chre/util/memory.h"
+#include "chre/util/non_copyable.h"
+#include "chre/util/raw_storage.h"
+#include "chre/util/synchronized_memory_pool.h"
+
+namespace chre {
+
+/**
+ * A flatbuffers allocator serving buffers of up to kBlockSize bytes from a
+ * fixed pool of blocks. Larger buffers, and buffers requested while all blocks
+ * are in use, come from a fallback allocator.
+ *
+ * This class is thread-safe, so that it can be shared by builders that are
+ * encoded and released from different threads.
+ *
+ * @tparam kBlockSize The size of a block, in bytes.
+ * @tparam kNumBlocks The number of blocks in the pool.
+ */
+template <size_t kBlockSize, size_t kNumBlocks>
+class FlatBufferPoolAllocator : public flatbuffers::Allocator,
+                                public NonCopyable {
+ public:
+  /**
+   * @param fallbackAllocator Optional allocator used when a buffer can't be
+   *        served from the pool, which must outlive this allocator. CHRE's
+   *        allocator is used if null.
+   */
+  explicit FlatBufferPoolAllocator(
+      flatbuffers::Allocator *fallbackAllocator = nullptr)
+      : mFallbackAllocator((fallbackAllocator != nullptr)
+                               ? fallbackAllocator
+                               : &mDefaultAllocator) {}
+
+  uint8_t *allocate(size_t size) override {
+    if (size <= kBlockSize) {
+      Block *block = mBlocks.allocate();
+      if (block != nullptr) {
+        return block->data;
+      }
+    }
+    return mFallbackAllocator->allocate(size);
+  }
+
+  void deallocate(uint8_t *p, size_t size) override {
+    auto *block = reinterpret_cast<Block *>(p);
+    if (mBlocks.containsAddress(block)) {
+      mBlocks.deallocate(block);
+    } else {
+      mFallbackAllocator->deallocate(p, size);
+    }
+  }
+
+  /**
+   * @return The number of blocks that are not in use.
+   */
+  size_t getFreeBlockCount() {
+    return mBlocks.getFreeBlockCount();
+  }
+
+ private:
+  struct Block {
+    alignas(alignof(std::max_align_t)) uint8_t data[kBlockSize];
+  };
+
+  SynchronizedMemoryPool<Block, kNumBlocks> mBlocks;
+  FlatBufferAllocator mDefaultAllocator;
+  flatbuffers::Allocator *const mFallbackAllocator;
+};
+
+/**
+ * A fixed set of ChreFlatBufferBuilders that are reused across messages
+ * instead of being allocated for each one.
+ *
+ * The buffers of the builders come from a FlatBufferPoolAllocator shared by the
+ * pool with one block of kBuilderSize bytes per builder. A released builder is
+ * cleared but keeps its block, so that encoding a message of up to
+ * kBuilderSize bytes with a pooled builder allocates nothing. A builder whose
+ * buffer had to grow past kBuilderSize releases it to the heap when returned.
+ *
+ * When all builders are in use, allocate() falls back to a builder on the
+ * heap, which release() destroys.
+ *
+ * This class is thread-safe.
+ *
+ * @tparam kNumBuilders The number of builders in the pool.
+ * @tparam kBuilderSize The size of the buffer kept by each builder, in bytes.
+ */
+template <size_t kNumBuilders, size_t kBuilderSize>
+class ChreFlatBufferBuilderPool : public NonCopyable {
+  static_assert(kBuilderSize % sizeof(flatbuffers::largest_scalar_t) == 0,
+                "Builder buffers are reserved in multiples of their alignment");
+
+ public:
+  /**
+   * @param fallbackAllocator Optional allocator used for buffers that don't
+   *        fit the blocks of the pool, which must outlive the pool. CHRE's
+   *        allocator is used if null.
+   */
+  explicit ChreFlatBufferBuilderPool(
+      flatbuffers::Allocator *fallbackAllocator = nullptr)
+      : mAllocator(fallbackAllocator) {
+    for (size_t i = 0; i < kNumBuilders; i++) {
+      new (&mBuilders[i]) ChreFlatBufferBuilder(kBuilderSize, &mAllocator);
+      mInUse[i] = false;
+    }
+  }
+
+  ~ChreFlatBufferBuilderPool() {
+    for (size_t i = 0; i < kNumBuilders; i++) {
+      mBuilders[i].~ChreFlatBufferBuilder();
+    }
+  }
+
+  /**
+   * @param initialSize The initial buffer size of the builder, only used when
+   *        all pooled builders are in use.
+   * @return A cleared builder to be returned with release(), or nullptr if all
+   *         pooled builders are in use and the heap is exhausted.
+   */
+  ChreFlatBufferBuilder *allocate(size_t initialSize) {
+    {
+      LockGuard<Mutex> lock(mMutex);
+      for (size_t i = 0; i < kNumBuilders; i++) {
+        if (!mInUse[i]) {
+          mInUse[i] = true;
+          return &mBuilders[i];
+        }
+      }
+    }
+    return memoryAlloc<ChreFlatBufferBuilder>(initialSize, &mAllocator);
+  }
+
+  /**
+   * Returns a builder obtained from allocate().
+   *
+   * @param builder The builder to return, which must not be used afterwards.
+   */
+  void release(ChreFlatBufferBuilder *builder) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(builder);
+    uintptr_t baseAddress = reinterpret_cast<uintptr_t>(mBuilders.data());
+    size_t index = (address - baseAddress) / sizeof(ChreFlatBufferBuilder);
+    if (address < baseAddress || index >= kNumBuilders) {
+      memoryFreeAndDestroy(builder);
+    } else {
+      if (builder->GetBufferCapacity() > kBuilderSize) {
+        builder->Reset();
+      } else {
+        builder->Clear();
+      }
+      LockGuard<Mutex> lock(mMutex);
+      mInUse[index] = false;
+    }
+  }
+
+ private:
+  FlatBufferPoolAllocator<kBuilderSize, kNumBuilders> mAllocator;
+  RawStorage<ChreFlatBufferBuilder, kNumBuilders> mBuilders;
+  bool mInUse[kNumBuilders];
+  Mutex mMutex;
+};
+
+}  // namespace chre
+
+#endif  // CHRE_UTIL_FLATBUFFERS_BUILDER_POOL_H_
@@ -37,12 +37,34 @@ class FlatBufferAllocator : public flatbuffers::Allocator {
   }
 };
 
+//! Holds the default allocator of ChreFlatBufferBuilder. It is a base of the
+//! builder rather than a member so that it outlives the FlatBufferBuilder
+//! base, which releases its buffer when destroyed.
+struct ChreFlatBufferBuilderAllocator {
+  FlatBufferAllocator mAllocator;
+};
+
 //! CHRE-specific FlatBufferBuilder that utilizes CHRE's allocator and adds
 //! additional helper methods that make use of CHRE utilities.
-class ChreFlatBufferBuilder : public flatbuffers::FlatBufferBuilder {
+class ChreFlatBufferBuilder : private ChreFlatBufferBuilderAllocator,
+                              public flatbuffers::FlatBufferBuilder {
  public:
-  explicit ChreFlatBufferBuilder(size_t initialSize = 1024)
-      : flatbuffers::FlatBufferBuilder(initialSize, &mAllocator) {}
+  /**
+   * @param initialSize The number of bytes reserved by the first allocation of
+   *        the buffer.
+   * @param allocator Optional allocator shared with other builders, which must
+   *        outlive the builder. CHRE's allocator is used if null.
+   */
+  explicit ChreFlatBufferBuilder(size_t initialSize = 1024,
+                                 flatbuffers::Allocator *allocator = nullptr)
+      : flatbuffers::FlatBufferBuilder(
+            initialSize, (allocator != nullptr) ? allocator : &mAllocator) {}
+
+  //! @return The number of bytes currently reserved by the buffer, which is
+  //!         kept by Clear() and released by Reset().
+  size_t GetBufferCapacity() const {
+    return buf_.capacity();
+  }
 
   // This is defined in flatbuffers::FlatBufferBuilder, but must be further
   // defined here since template functions aren't inherited.
@@ -66,9 +88,6 @@ class ChreFlatBufferBuilder : public flatbuffers::FlatBufferBuilder {
       const DynamicVector<T> &v) {
     return flatbuffers::FlatBufferBuilder::CreateVector(v.data(), v.size());
   }
-
- private:
-  FlatBufferAllocator mAllocator;
 };
 
 }  // namespace chre
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_UTIL_NANOAPP_MODEL_RUNNER_H_
+#define CHRE_UTIL_NANOAPP_MODEL_RUNNER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "chre/util/nanoapp/sliced_batch_runner.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_op_resolver.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace chre {
+
+/**
+ * Runs a TFLM model from a nanoapp built with USE_TFLM. This header only
+ * depends on util/nanoapp/sliced_batch_runner.cc, so that the CHRE framework
+ * builds, which glob util/, do not need the TFLM sources.
+ *
+ * The tensor arena is provided by the nanoapp, usually as a static buffer, so
+ * that inference does not depend on the size of the CHRE heap. Size it from
+ * getArenaUsedBytes() after init().
+ *
+ * Batches of inferences are run by a SlicedBatchRunner, so they do not block
+ * the event loop for longer than the slice duration.
+ */
+class ModelRunner {
+ public:
+  //! Writes the input tensor of the inference at index in the batch.
+  typedef void(FillInputFunction)(uint32_t index, TfLiteTensor *input,
+                                  void *cookie);
+
+  //! Reads the output tensor of the inference at index in the batch.
+  typedef void(ConsumeOutputFunction)(uint32_t index,
+                                      const TfLiteTensor *output,
+                                      void *cookie);
+
+  //! @see SlicedBatchRunner::SlicedBatchRunner
+  explicit ModelRunner(
+      uint16_t continueEventType = CHRE_EVENT_FIRST_USER_VALUE,
+      uint64_t maxSliceNs = SlicedBatchRunner::kDefaultMaxSliceNs)
+      : mBatchRunner(continueEventType, maxSliceNs) {}
+
+  ~ModelRunner() {
+    destroyInterpreter();
+  }
+
+  /**
+   * Creates the interpreter and allocates the model tensors in arena. The
+   * model, resolver and arena must outlive the runner.
+   *
+   * @return false if the tensors do not fit in the arena.
+   */
+  bool init(const tflite::Model *model,
+            const tflite::MicroOpResolver &resolver, uint8_t *arena,
+            size_t arenaSize) {
+    destroyInterpreter();
+    mInterpreter = new (mInterpreterStorage)
+        tflite::MicroInterpreter(model, resolver, arena, arenaSize);
+    if (mInterpreter->AllocateTensors() != kTfLiteOk) {
+      destroyInterpreter();
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * Starts count inferences, run from handleEvent(). fillInput and
+   * consumeOutput are called with cookie around each inference.
+   *
+   * @return false if the model is not initialized, a batch is already running
+   *         or the first slice could not be scheduled.
+   */
+  bool startBatch(uint32_t count, FillInputFunction *fillInput,
+                  ConsumeOutputFunction *consumeOutput, void *cookie) {
+    if (mInterpreter == nullptr) {
+      return false;
+    }
+    mFillInput = fillInput;
+    mConsumeOutput = consumeOutput;
+    mCookie = cookie;
+    return mBatchRunner.start(count, runInference, this);
+  }
+
+  //! @see SlicedBatchRunner::handleEvent
+  bool handleEvent(uint16_t eventType) {
+    return mBatchRunner.handleEvent(eventType);
+  }
+
+  bool isBatchRunning() const {
+    return mBatchRunner.isRunning();
+  }
+
+  //! @return the inference costs, one step per inference including the
+  //! input and output functions.
+  const SlicedBatchRunner::Stats &getStats() const {
+    return mBatchRunner.getStats();
+  }
+
+  //! @return the arena bytes used by the model, 0 before init().
+  size_t getArenaUsedBytes() const {
+    return (mInterpreter == nullptr) ? 0 : mInterpreter->arena_used_bytes();
+  }
+
+  void logStats() const {
+    mBatchRunner.logStats();
+  }
+
+ private:
+  static bool runInference(uint32_t index, void *cookie) {
+    auto *runner = static_cast<ModelRunner *>(cookie);
+    tflite::MicroInterpreter *interpreter = runner->mInterpreter;
+    runner->mFillInput(index, interpreter->input(0), runner->mCookie);
+    if (interpreter->Invoke() != kTfLiteOk) {
+      return false;
+    }
+    runner->mConsumeOutput(index, interpreter->output(0), runner->mCookie);
+    return true;
+  }
+
+  void destroyInterpreter() {
+    if (mInterpreter != nullptr) {
+      mInterpreter->~MicroInterpreter();
+      mInterpreter = nullptr;
+    }
+  }
+
+  SlicedBatchRunner mBatchRunner;
+
+  //! The interpreter is constructed in place by init() to keep it off the
+  //! heap.
+  alignas(tflite::MicroInterpreter) uint8_t
+      mInterpreterStorage[sizeof(tflite::MicroInterpreter)];
+  tflite::MicroInterpreter *mInterpreter = nullptr;
+
+  FillInputFunction *mFillInput = nullptr;
+  ConsumeOutputFunction *mConsumeOutput = nullptr;
+  void *mCookie = nullptr;
+};
+
+}  // namespace chre
+
+#endif  // CHRE_UTIL_NANOAPP_MODEL_RUNNER_H_
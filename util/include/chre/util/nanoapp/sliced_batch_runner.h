@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_UTIL_NANOAPP_SLICED_BATCH_RUNNER_H_
+#define CHRE_UTIL_NANOAPP_SLICED_BATCH_RUNNER_H_
+
+#include <cstdint>
+
+#include "chre/util/time.h"
+#include "chre_api/chre.h"
+
+namespace chre {
+
+/**
+ * Runs a batch of steps from a nanoapp without blocking its event loop for
+ * long, e.g. the inferences of an ML model (see ModelRunner).
+ *
+ * The batch is split into slices that each run steps for at most a configured
+ * duration. Between slices the runner posts an event to its own nanoapp, which
+ * lets the event loop deliver other events before the batch continues.
+ */
+class SlicedBatchRunner {
+ public:
+  /**
+   * Runs the step at index in the batch.
+   *
+   * @return false to stop the batch.
+   */
+  typedef bool(StepFunction)(uint32_t index, void *cookie);
+
+  //! Step costs gathered across batches.
+  struct Stats {
+    uint32_t stepCount = 0;
+    uint64_t minStepNs = UINT64_MAX;
+    uint64_t maxStepNs = 0;
+    uint64_t totalStepNs = 0;
+    //! Number of event loop turns spent running steps.
+    uint32_t sliceCount = 0;
+    //! Longest time a single turn kept the event loop busy.
+    uint64_t maxSliceNs = 0;
+  };
+
+  //! Default upper bound of the time spent in one slice of a batch.
+  static constexpr uint64_t kDefaultMaxSliceNs = kOneMillisecondInNanoseconds;
+
+  /**
+   * @param continueEventType event type posted to this nanoapp between
+   *        slices. The nanoapp must pass it to handleEvent().
+   * @param maxSliceNs a slice stops starting steps once it has run for this
+   *        long. At least one step runs per slice.
+   */
+  explicit SlicedBatchRunner(
+      uint16_t continueEventType = CHRE_EVENT_FIRST_USER_VALUE,
+      uint64_t maxSliceNs = kDefaultMaxSliceNs)
+      : mContinueEventType(continueEventType), mMaxSliceNs(maxSliceNs) {}
+
+  /**
+   * Starts count steps, run from handleEvent(). step is called with cookie.
+   *
+   * @return false if a batch is already running or the first slice could not
+   *         be scheduled.
+   */
+  bool start(uint32_t count, StepFunction *step, void *cookie);
+
+  /**
+   * Runs the next slice of the current batch if eventType is the continue
+   * event of this runner.
+   *
+   * @return true if the event was handled by the runner.
+   */
+  bool handleEvent(uint16_t eventType);
+
+  bool isRunning() const {
+    return mNextIndex < mBatchSize;
+  }
+
+  //! @return the number of steps run in the current or last batch.
+  uint32_t getCompletedCount() const {
+    return mNextIndex;
+  }
+
+  const Stats &getStats() const {
+    return mStats;
+  }
+
+  void logStats() const;
+
+ private:
+  //! Runs steps of the current batch until it ends or the slice is over.
+  void runSlice();
+
+  //! Posts the event that runs the next slice.
+  bool scheduleSlice();
+
+  const uint16_t mContinueEventType;
+  const uint64_t mMaxSliceNs;
+
+  uint32_t mBatchSize = 0;
+  uint32_t mNextIndex = 0;
+  StepFunction *mStep = nullptr;
+  void *mCookie = nullptr;
+
+  Stats mStats;
+};
+
+}  // namespace chre
+
+#endif  // CHRE_UTIL_NANOAPP_SLICED_BATCH_RUNNER_H_
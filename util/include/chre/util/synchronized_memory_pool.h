@@ -51,6 +51,11 @@ class SynchronizedMemoryPool : public NonCopyable {
    */
   void deallocate(ElementType *element);
 
+  /**
+   * @see MemoryPool::containsAddress
+   */
+  bool containsAddress(ElementType *element);
+
   /**
    * @return the number of unused blocks in this memory pool.
    */
@@ -37,6 +37,13 @@ void SynchronizedMemoryPool<ElementType, kSize>::deallocate(
   mMemoryPool.deallocate(element);
 }
 
+template <typename ElementType, size_t kSize>
+bool SynchronizedMemoryPool<ElementType, kSize>::containsAddress(
+    ElementType *element) {
+  // The address range of the pool never changes, so no lock is needed.
+  return mMemoryPool.containsAddress(element);
+}
+
 template <typename ElementType, size_t kSize>
 size_t SynchronizedMemoryPool<ElementType, kSize>::getFreeBlockCount() {
   LockGuard<Mutex> lock(mMutex);
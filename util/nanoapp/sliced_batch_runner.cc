@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre/util/nanoapp/sliced_batch_runner.h"
+
+#include <cinttypes>
+
+#ifdef CHRE_IS_NANOAPP_BUILD
+#include "chre/util/nanoapp/log.h"
+#else
+#include "chre/platform/log.h"
+#endif  // CHRE_IS_NANOAPP_BUILD
+
+#ifndef LOG_TAG
+#define LOG_TAG "[SlicedBatchRunner]"
+#endif  // LOG_TAG
+
+namespace chre {
+
+bool SlicedBatchRunner::start(uint32_t count, StepFunction *step,
+                              void *cookie) {
+  if (isRunning()) {
+    LOGE("Cannot start a batch of %" PRIu32 " steps", count);
+    return false;
+  }
+
+  mBatchSize = count;
+  mNextIndex = 0;
+  mStep = step;
+  mCookie = cookie;
+  if (count > 0 && !scheduleSlice()) {
+    mBatchSize = 0;
+    return false;
+  }
+  return true;
+}
+
+bool SlicedBatchRunner::handleEvent(uint16_t eventType) {
+  if (eventType != mContinueEventType) {
+    return false;
+  }
+  if (isRunning()) {
+    runSlice();
+  }
+  return true;
+}
+
+void SlicedBatchRunner::runSlice() {
+  uint64_t sliceStartNs = chreGetTime();
+  uint64_t nowNs = sliceStartNs;
+
+  do {
+    uint64_t stepStartNs = nowNs;
+    bool success = mStep(mNextIndex, mCookie);
+    nowNs = chreGetTime();
+    if (!success) {
+      LOGE("Step %" PRIu32 " failed", mNextIndex);
+      mBatchSize = mNextIndex;
+      break;
+    }
+
+    uint64_t stepNs = nowNs - stepStartNs;
+    mStats.stepCount++;
+    mStats.totalStepNs += stepNs;
+    if (stepNs < mStats.minStepNs) {
+      mStats.minStepNs = stepNs;
+    }
+    if (stepNs > mStats.maxStepNs) {
+      mStats.maxStepNs = stepNs;
+    }
+    mNextIndex++;
+  } while (isRunning() && nowNs - sliceStartNs < mMaxSliceNs);
+
+  uint64_t sliceNs = nowNs - sliceStartNs;
+  mStats.sliceCount++;
+  if (sliceNs > mStats.maxSliceNs) {
+    mStats.maxSliceNs = sliceNs;
+  }
+
+  if (isRunning() && !scheduleSlice()) {
+    LOGE("Batch stopped after %" PRIu32 " of %" PRIu32 " steps", mNextIndex,
+         mBatchSize);
+    mBatchSize = mNextIndex;
+  }
+}
+
+bool SlicedBatchRunner::scheduleSlice() {
+  if (!chreSendEvent(mContinueEventType, nullptr /* eventData */,
+                     nullptr /* freeCallback */, chreGetInstanceId())) {
+    LOGE("Failed to schedule the next slice");
+    return false;
+  }
+  return true;
+}
+
+void SlicedBatchRunner::logStats() const {
+  if (mStats.stepCount == 0) {
+    LOGI("No step ran");
+    return;
+  }
+  LOGI("%" PRIu32 " steps: min %" PRIu64 " ns, avg %" PRIu64
+       " ns, max %" PRIu64 " ns",
+       mStats.stepCount, mStats.minStepNs,
+       mStats.totalStepNs / mStats.stepCount, mStats.maxStepNs);
+  LOGI("Event loop blocked for at most %" PRIu64 " ns over %" PRIu32
+       " slices",
+       mStats.maxSliceNs, mStats.sliceCount);
+}
+
+}  // namespace chre
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre/util/flatbuffers/builder_pool.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+using chre::ChreFlatBufferBuilder;
+using chre::ChreFlatBufferBuilderPool;
+using chre::FlatBufferAllocator;
+
+namespace {
+
+constexpr size_t kNumBuilders = 4;
+constexpr size_t kBuilderSize = 256;
+constexpr size_t kNumMessages = 100;
+
+//! Forwards to CHRE's allocator, counting the calls made through it.
+class CountingAllocator : public FlatBufferAllocator {
+ public:
+  uint8_t *allocate(size_t size) override {
+    numAllocations++;
+    numOutstanding++;
+    return FlatBufferAllocator::allocate(size);
+  }
+
+  void deallocate(uint8_t *p, size_t size) override {
+    numOutstanding--;
+    FlatBufferAllocator::deallocate(p, size);
+  }
+
+  size_t numAllocations = 0;
+  size_t numOutstanding = 0;
+};
+
+//! Encodes a message of about the given size, similar to the responses sent by
+//! the host links.
+void encodeMessage(ChreFlatBufferBuilder &builder, size_t size) {
+  char payload[1024];
+  ASSERT_LE(size, sizeof(payload));
+  memset(payload, 'a', size);
+  builder.Finish(builder.CreateString(payload, size));
+}
+
+}  // namespace
+
+TEST(ChreFlatBufferBuilderPool, SmallMessagesDontAllocate) {
+  constexpr size_t kMessageSize = 64;
+
+  CountingAllocator baselineAllocator;
+  for (size_t i = 0; i < kNumMessages; i++) {
+    ChreFlatBufferBuilder builder(kMessageSize, &baselineAllocator);
+    encodeMessage(builder, kMessageSize);
+  }
+
+  CountingAllocator fallbackAllocator;
+  ChreFlatBufferBuilderPool<kNumBuilders, kBuilderSize> pool(
+      &fallbackAllocator);
+  for (size_t i = 0; i < kNumMessages; i++) {
+    ChreFlatBufferBuilder *builder = pool.allocate(kMessageSize);
+    ASSERT_NE(builder, nullptr);
+    encodeMessage(*builder, kMessageSize);
+    EXPECT_GT(builder->GetSize(), kMessageSize);
+    pool.release(builder);
+  }
+
+  printf("%zu messages: %zu allocations without the pool, %zu with it\n",
+         kNumMessages, baselineAllocator.numAllocations,
+         fallbackAllocator.numAllocations);
+  EXPECT_GE(baselineAllocator.numAllocations, kNumMessages);
+  EXPECT_EQ(fallbackAllocator.numAllocations, 0);
+  EXPECT_EQ(baselineAllocator.numOutstanding, 0);
+}
+
+TEST(ChreFlatBufferBuilderPool, ReleasedBuilderIsReused) {
+  ChreFlatBufferBuilderPool<1, kBuilderSize> pool;
+
+  ChreFlatBufferBuilder *builder = pool.allocate(kBuilderSize);
+  ASSERT_NE(builder, nullptr);
+  encodeMessage(*builder, 32);
+  pool.release(builder);
+
+  ChreFlatBufferBuilder *reused = pool.allocate(kBuilderSize);
+  EXPECT_EQ(reused, builder);
+  EXPECT_EQ(reused->GetSize(), 0);
+  pool.release(reused);
+}
+
+TEST(ChreFlatBufferBuilderPool, GrownBufferIsTrimmedOnRelease) {
+  constexpr size_t kLargeMessageSize = 4 * kBuilderSize;
+
+  CountingAllocator fallbackAllocator;
+  ChreFlatBufferBuilderPool<1, kBuilderSize> pool(&fallbackAllocator);
+
+  ChreFlatBufferBuilder *builder = pool.allocate(kBuilderSize);
+  ASSERT_NE(builder, nullptr);
+  encodeMessage(*builder, kLargeMessageSize);
+  EXPECT_GT(builder->GetBufferCapacity(), kBuilderSize);
+  EXPECT_EQ(fallbackAllocator.numOutstanding, 1);
+  pool.release(builder);
+  EXPECT_EQ(fallbackAllocator.numOutstanding, 0);
+
+  // The next small message is back in the block of the pool.
+  builder = pool.allocate(kBuilderSize);
+  encodeMessage(*builder, 32);
+  EXPECT_EQ(fallbackAllocator.numOutstanding, 0);
+  pool.release(builder);
+}
+
+TEST(ChreFlatBufferBuilderPool, ExhaustedPoolFallsBackToHeap) {
+  constexpr size_t kMessageSize = 32;
+
+  CountingAllocator fallbackAllocator;
+  ChreFlatBufferBuilderPool<kNumBuilders, kBuilderSize> pool(
+      &fallbackAllocator);
+  ChreFlatBufferBuilder *builders[kNumBuilders + 1];
+  for (size_t i = 0; i < kNumBuilders + 1; i++) {
+    builders[i] = pool.allocate(kMessageSize);
+    ASSERT_NE(builders[i], nullptr);
+    for (size_t j = 0; j < i; j++) {
+      EXPECT_NE(builders[i], builders[j]);
+    }
+    encodeMessage(*builders[i], kMessageSize);
+  }
+
+  // Only the builder allocated once the pool was exhausted needed a buffer
+  // from outside the pool.
+  EXPECT_EQ(fallbackAllocator.numOutstanding, 1);
+  for (size_t i = 0; i < kNumBuilders + 1; i++) {
+    pool.release(builders[i]);
+  }
+  EXPECT_EQ(fallbackAllocator.numOutstanding, 0);
+}